@@ -27,6 +27,7 @@ MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/desc$(LIB_SUFFIX)	\
 
 
 MAK_INCL=$(MEN_INC_DIR)/z146_drv.h	\
+         $(MEN_INC_DIR)/z146_regs.h	\
          $(MEN_INC_DIR)/men_typs.h	\
          $(MEN_INC_DIR)/oss.h		\
          $(MEN_INC_DIR)/mdis_err.h	\
@@ -72,12 +72,52 @@
 	interface with M_getblock().
 
 
+    \n \subsection RxCopy Data Copy
+	M_getblock() copies the words from the driver buffer to the user
+	buffer in at most two blocks without locking the interrupt, so the
+	cost per word is one memory copy. To keep the number of calls low,
+	read with a user buffer which can take the complete driver buffer and
+	use the data signal instead of polling #Z146_RX_DATA_LEN.
+
+	The driver buffer is not published to user space: MDIS does not
+	provide a memory mapping function for low-level drivers, so there is
+	no shared ring and no doorbell, all data passes M_getblock(). An
+	application which needs to read without copies and system calls
+	polls the core itself, see \ref UioAccess.
+
+    \n \subsection RxBroadcast Several Readers
+	Normally the words are removed from the driver buffer when they are
+	read, so several processes reading the same device share the data
+	between them. With the descriptor key RX_READERS = n (1..8) the driver
+	runs in broadcast mode: it provides n channels and each channel has
+	its own read position in the driver buffer. Each process selects its
+	own channel with M_setstat() M_MK_CH_CURRENT and receives every word.
+	The interrupt stores each word once, independent of the number of
+	readers.
+
+	A slow reader does not stop the others. If the interrupt overwrites
+	words a reader did not read yet, the reader continues with the oldest
+	word left in the buffer and the lost words are counted. The count is
+	returned and cleared by #Z146_RX_OVERRUN. #Z146_RX_READER_SYNC moves
+	the reader to the newest word, e.g. when a process attaches late.
+	#Z146_RX_DATA_LEN and #Z146_SET_SIGNAL apply to the reader of the
+	current channel. RX_OVERFLOW is not used in broadcast mode. Broadcast
+	mode needs the data interrupt, in polling mode the fifo is read
+	directly as before.
+
     \n \subsection RxInterrupts Interrupt and Signal
     
     If an interrupt is enabled the driver will send the signal which was assigned
     using M_setstat() #Z146_SET_SIGNAL to the application when data is received. 
 	The signal can be uninstalled using #Z146_CLR_SIGNAL.
 
+    \n \subsection RxStats Statistics
+	The block getstat #Z146_BLK_RX_STATS returns the receive counters in a
+	#Z146_RX_STATS structure: words stored, words lost by a full buffer
+	(overwritten or discarded according to RX_OVERFLOW), the maximum buffer
+	depth, line status interrupts, the words discarded with them and the
+	LSR error bits seen. The counters are reset on every read.
+
   	\n \subsection RxSetget Driver Configuration 
 	The driver can be configured using M_setstat(), using following options:
 	
@@ -107,6 +147,33 @@
 	- #Z146_RX_RESET_LABEL\n
 		0x00 ... 0xFF\n 
     
+    \n \subsection RxLineCfg Line Configuration
+	The block setstat #Z146_BLK_LINE_CFG applies a complete
+	#Z146_LINE_CFG (speed, error write, parity, label and SDI settings) with
+	a single write of the line control register, so no words are received
+	with a partially changed configuration. If the flush flag is set, the
+	data in the fifo and in the driver buffer is discarded and the line
+	status is cleared. The block getstat returns the current configuration.
+
+    \n \subsection RxLabels Receive Labels
+	Z146_RX_SET_LABEL and Z146_RX_RESET_LABEL change the label filter with
+	a single effective register write: a new label is written to an unused
+	register before the label count is incremented, a removed label is
+	replaced by the last one before the count is decremented. Words with
+	labels which stay configured are never dropped.
+
+	The block setstat #Z146_BLK_RX_LABELS replaces the complete list (up to
+	16 labels, one byte each). In interrupt mode the words already received
+	are stored first. During the register update the hardware filter is
+	opened and the new list is applied by the driver until the fifo has
+	been read once, so every word is filtered either by the old or by the
+	new list. The driver filter is only used while the label filter is
+	enabled (#Z146_LAB_EN), otherwise all labels pass. The number of words
+	dropped by the driver filter is returned by #Z146_RX_LABEL_GATED.
+
+	#Z146_RX_LABEL_CFG_US returns the duration of the last label change,
+	measured with Z146_TIMESTAMP() (see \ref IrqLat).
+
     \n \subsection RxDefault Default values
     M_open() and M_close() configures the Receive driver as follows: 
     
@@ -142,7 +209,25 @@
     </table>
 
     \n \section RxDescriptor_entries Descriptor Entries
-    (no descriptor entries supported)    
+	The receiver is configured completely from the descriptor when the
+	device is opened, so no setstat calls are needed before data is
+	received. Keys which are not present keep the default values of the
+	"Default values" section.
+
+    - RX_SPEED, RX_ERR_WE, RX_PAR_EN, RX_PAR_TYP, RX_LAB_EN, RX_SDI_EN:
+      0 or 1, see the corresponding setstat codes
+    - RX_SDI: 0..3
+    - RX_THR_LEV: fifo threshold level 0..7 (default 5)
+    - RX_TIMEOUT: character timeout 0..0xFF (default 0x1E)
+    - RX_IRQ_ENABLE: bit 0 = data interrupt, bit 1 = line status interrupt
+      (default 3)
+    - RX_LABEL: binary array of up to 16 receive labels
+    - RX_RING_SIZE: size of the driver buffer, 256..65536 words (default 4096)
+    - RX_OVERFLOW: if the driver buffer is full, 0 = discard new words
+      (default), 1 = overwrite the oldest words
+    - RX_READERS: 0 (default) or number of readers in broadcast mode, 1..8
+
+    See Z146_Init() for the complete list.
     
     \n \section RxCodes Driver specific Getstat/Setstat codes
     see \ref rx_getstat_setstat_codes "section about Getstat/Setstat codes"
@@ -160,9 +245,104 @@
 	
     \n \subsection TxWrite Transmitting Data
 	The M_setblock() writes data from the user provided buffer to the device.
-	The user can write a maximum of 4096 words at a time. The fifo size for the
+	The user can write a maximum of 4096 words (descriptor key TX_RING_SIZE)
+	at a time. The fifo size for the
 	transmit is limited to 255 words. Therefore, whenever the user data is more
 	than 255 words, the interrupt routine is used to transmit data.
+	If no data is queued in the driver, the words which fit into the free
+	space of the fifo are written directly from the user buffer; only the
+	remainder is stored in the internal buffer.
+
+    \n \subsection TxLineCfg Line Configuration
+	The block setstat #Z246_BLK_LINE_CFG applies a complete
+	#Z246_LINE_CFG (speed, loop back, parity and SDI settings) with a single
+	write of the line control register. If the flush flag is set, the data
+	queued in the driver is discarded and the words already in the fifo are
+	sent with the old configuration before the new one is applied. The
+	block getstat returns the current configuration.
+
+    \n \subsection TxSingle Single Words
+	M_write() transmits a single data word with the label set by
+	#Z246_TX_LABEL. While no data is queued and the fifo has room, the word
+	is written to the fifo at once; otherwise it is queued behind the
+	pending data like a block of one word, so the order of M_write() and
+	M_setblock() data is kept. As the transmitter has one label register,
+	the label is not taken from the channel number; use channel 0.
+
+    \n \subsection TxConcurrent Concurrent Writers
+	Several processes may write to the same transmitter concurrently. Each
+	write reserves space in the queue, copies its data without holding a
+	lock and commits it afterwards, so writers do not block each other and
+	every write is sent contiguously, in the order the space was reserved.
+	A write is passed to the interrupt routine as soon as it and all writes
+	reserved before it are copied, a continuous stream of writers does not
+	hold it back. Only urgent words (see below) may be sent between the words of a bulk
+	write.
+
+    \n \subsection TxUrgent Urgent Data
+	Data written with the block setstat #Z246_BLK_TX_URGENT is queued in a
+	separate urgent queue of 256 words (descriptor key TX_URG_SIZE). At every fifo refill the urgent queue
+	is served first, so urgent words only wait for the words already in the
+	fifo, not for the queued bulk data. To avoid starving bulk traffic, up to
+	#Z246_TX_LOW_RESERVE words (default 16, at most half of the free fifo
+	space) are kept for it per refill while bulk data is pending.
+	The worst-case latency of an urgent word, from submission until it is
+	sent, is reported in #Z246_TX_STATS. Each urgent write is time stamped
+	with Z246_TIMESTAMP() when it is queued, the latency is this queueing
+	time plus the drain time of the words ahead of it in the fifo.
+
+    \n \subsection TxRate Rate Limits
+	The bulk and the urgent queue can be limited to a number of words per
+	second with #Z246_TX_RATE_LOW and #Z246_TX_RATE_HIGH (0 = unlimited,
+	default). The limits are token buckets: after an idle time up to
+	#Z246_TX_RATE_BURST words (default 32) are sent at line speed. Setting a
+	limit or the burst size refills the buckets. Words held back by a limit
+	are counted in #Z246_TX_STATS, together with the bus utilization
+	relative to the line rate of the configured #Z246_TX_SPEED.
+	These two buckets are shared by all writers of the device.
+
+	With the descriptor key TX_WRITERS = n (1..8) the driver provides n
+	writer channels. Each producer selects its own channel with
+	M_setstat() M_MK_CH_CURRENT and sets the limit of this channel with
+	#Z246_TX_RATE_WRITER (0 = unlimited, default). The limit is a token
+	bucket of the same burst size and applies to M_write(), M_setblock()
+	and #Z246_BLK_TX_URGENT of the channel. A write is accepted or
+	rejected as a whole: it is rejected with ERR_MBUF_OVERFLOW while the
+	producer is over its limit, and a block larger than the burst size is
+	accepted once and then delays the next writes of the producer. The
+	rejected words are counted in #Z246_TX_STATS. The queue limits above
+	still apply to the accepted data. Without TX_WRITERS all paths share
+	one writer channel.
+
+    \n \subsection TxTimed Timed Transmission
+	With the block setstat #Z246_BLK_TX_TIMED a burst of up to 64 words is
+	sent at a given tick. The first u_int32 of the block is the release
+	tick of the driver's time base, the data words follow. The current tick
+	and the ticks per second are returned by #Z246_TX_TICK and
+	#Z246_TX_TICK_RATE. Up to 8 bursts can be pending, #Z246_TX_TIMED_PEND returns
+	their number. Each burst is held until its tick is reached and then
+	passed to the urgent queue by the driver's alarm or the next fifo
+	refill interrupt. Bursts which are already due are sent at once.
+
+	For each burst a result with the release error is logged when its
+	first word is written to the fifo (up to 16, older results are
+	overwritten; bursts discarded by a flush give no result). The results
+	are read with the block getstat #Z246_BLK_TX_TIMED_RES, the block size
+	returned is a multiple of sizeof(#Z246_TX_TIMED_RES). The release error
+	is the release delay in ticks plus the time from the release to the
+	fifo write, taken with the driver's fine clock (see \ref IrqLat), plus
+	the time to send the words ahead in the fifo.
+
+    \n \subsection TxStats Statistics
+	The block getstat #Z246_BLK_TX_STATS returns the transmit counters in a
+	#Z246_TX_STATS structure: words accepted and written to the fifo (directly
+	or via the internal buffer), refill interrupts, underruns, rejected writes,
+	the maximum internal buffer depth and the minimum free fifo space. The
+	counters are reset on every read, so periodic reads give per-interval values.
+
+	#Z246_TX_LEVEL returns the words not yet sent: the fifo level plus the
+	words in both queues. Poll it for 0 before changing #Z246_TX_LABEL, so
+	no queued word is sent with the new label.
 
     \n \subsection TxInterrupts Interrupt and Signal
     
@@ -197,6 +377,23 @@
 
 	- #Z246_TX_LABEL\n
 		0x00 ... 0xFF\n
+
+	- #Z246_TX_THR_LEV\n
+		0 ... 7 = fifo threshold level for the refill interrupt\n
+
+	- #Z246_TX_THR_AUTO\n
+		0 = threshold level is set manually with #Z246_TX_THR_LEV\n
+		1 = threshold level is adapted by the driver\n
+
+	At every refill interrupt the driver compares the drain time of the
+	words left in the fifo at interrupt entry with the measured time until
+	it has written the fifo (refill latency). When the fifo ran empty
+	before the refill (bus idle gap) the threshold level is raised in
+	automatic mode. When a margin of more than 4 words was left over 32
+	refills, also after subtracting the words by which the next lower
+	level requests the refill later (known once that level was used), it
+	is lowered to save interrupts. The idle gaps, the minimum margin in us
+	and the current level are reported in #Z246_TX_STATS.
 			
     
     \n \subsection TxDefault Default values
@@ -221,6 +418,8 @@
 
     <tr><td>M_close()     </td><td>Close device             </td>
     <td>Z246_Exit())</td></tr>
+    <tr><td>M_write()     </td><td>Write value to device    </td>
+    <td>Z246_Write()</td></tr>
     <tr><td>M_setblock()  </td><td>Block write from device  </td>
     <td>Z246_BlockWrite()</td></tr>
     <tr><td>M_setstat()   </td><td>Set device parameter     </td>
@@ -231,11 +430,183 @@
     </table>
 
     \n \section TxDescriptor_entries Descriptor Entries
-    (no descriptor entries supported)    
+	The transmitter is configured completely from the descriptor when the
+	device is opened. Keys which are not present keep the default values.
+
+    - TX_SPEED, TX_LOOP, TX_PAR_EN, TX_PAR_TYP, TX_SDI_EN: 0 or 1, see the
+      corresponding setstat codes
+    - TX_SDI: 0..3
+    - TX_LABEL: transmit label 0..0xFF
+    - TX_THR_LEV: fifo threshold level 0..7 (default 6)
+    - TX_THR_AUTO: 1 = automatic threshold level
+    - TX_RING_SIZE: size of the bulk queue, 256..65536 words (default 4096),
+      this is also the maximum size of one M_setblock()
+    - TX_URG_SIZE: size of the urgent queue, 16..4096 words (default 256)
+    - TX_LOW_RESERVE: see #Z246_TX_LOW_RESERVE
+    - TX_WRITERS: 0 (default) or number of writer channels with their own
+      rate limit, 1..8, see \ref TxRate
+
+    See Z246_Init() for the complete list.
     
     \n \section TxCodes Driver specific Getstat/Setstat codes
     see \ref tx_getstat_setstat_codes "section about Getstat/Setstat codes"
 
+    \n \section IrqLat Interrupt Instrumentation
+	Both drivers count every interrupt they handle. The block getstats
+	#Z146_BLK_IRQLAT and #Z246_BLK_IRQLAT return a #Z146_IRQLAT or
+	#Z246_IRQLAT structure with histograms of the ISR execution time, the
+	words handled per interrupt and the time from the fifo threshold to the
+	ISR entry, and reset the counters. The threshold latency is computed
+	from the fifo level at ISR entry and the word time of the configured
+	speed, it is only logged for the receive data interrupt and the
+	transmit refill interrupt. The fifo threshold in words is not derived
+	from the threshold level but taken from the fifo levels seen at these
+	interrupts since the level was set. The execution time is taken with
+	Z146_TIMESTAMP() and Z246_TIMESTAMP() after the interrupt was
+	identified as ours. On Linux they read the monotonic kernel clock in
+	microseconds; on other systems they fall back to the operating system
+	tick (resUs) unless they are defined to a finer clock of the target
+	when the drivers are built. The counters are always compiled in, a
+	debug build is not needed.
+
+    \n \section UioAccess Polled User Space Access
+	For the lowest latency the cores can be polled from an application
+	thread instead of using the drivers. The z146_uio library maps the
+	register window of one core from a Linux UIO device (Z146_UioOpen())
+	or uses a window in memory (Z146_UioAttach()), e.g. a register model
+	for tests. Z146_UioRxPoll() reads and acknowledges the receive fifo
+	like the polled M_getblock(), Z146_UioTxWrite() fills the transmit
+	fifo like the driver. Both use the register map of z146_regs.h which
+	is shared with the drivers. A core which is accessed this way must not
+	be opened with MDIS at the same time.
+
+	z146_uio_latency measures the loopback latency of single words for
+	both paths.
+
+    \n \section Bench Throughput Benchmark
+	z146_bench sends a continuous word sequence from a transmitter to a
+	receiver for each combination of speed, M_setblock() size, M_getblock()
+	buffer size, RX and TX FIFO threshold and RX interrupt or polled mode
+	(Z146_RX_RXC_IRQ_STAT). It prints one CSV line per combination with
+	words per second, bus utilization, CPU time per word, lost words, the
+	receive ring overflows and line error losses (#Z146_BLK_RX_STATS) and
+	the transmit underruns, so a receive overflow can be told from a
+	transmit stall. The \c -n option puts a tag, e.g.
+	the driver version, in the first column so the output of several runs
+	can be merged and compared.
+
+	z146_latency measures the time from M_setblock() on the transmitter
+	until M_getblock() on the receiver returns the word. The data field
+	carries a sequence number, the submit time of each number is stored
+	by the transmit thread and the receive thread computes the latency of
+	every word. It reports min, median, p99, p99.9, max and jitter for RX
+	interrupt and polled mode, optionally with pinned SCHED_FIFO threads
+	and the loop back mode of the transmitter.
+
+	z146_soak runs traffic on several transmitters, each on its own label
+	to one or more receivers, for hours. The data field carries a sequence
+	number and a CRC, every drop, duplicate, reorder and corrupted word is
+	counted and printed with the driver counters (#Z146_BLK_RX_STATS,
+	#Z246_BLK_TX_STATS) read at that time, so a loss can be matched with a
+	buffer overflow or line error. Rates and losses are reported in a
+	fixed interval and at the end.
+
+	z146_gen generates traffic for load tests of receivers from a profile
+	with one line per label: transmitter, label, rate and a BNR, BCD or
+	discrete payload with SSM pattern, SDI and burst size. It reports the
+	achieved rate and the schedule lag of every label. As the transmitter
+	has one label register, several labels on one transmitter are sent in
+	runs with a label change when the fifo is empty; a transmitter with
+	one label is fed continuously up to 100% bus utilization.
+
+    \n \section Capture Capture Files
+	z146_capture records up to 8 receivers to a binary file in the format
+	of z146_cap.h: a header with the device names and speeds followed by
+	16 byte records with channel, time stamp, received word and flags.
+	The receivers are read with large M_getblock() calls in a fixed
+	interval, the records are collected in write buffers (-b, -n) which a
+	writer thread writes to the disk, so the receive buffers of the
+	driver are emptied even while a write is delayed. Large captures can
+	be split into several files (-m). The file is little endian on every
+	host. The driver has no receive time per word, the time of a word is
+	estimated from the M_getblock() return time and the word time of the
+	words behind it and the record is flagged Z146_CAP_F_TIME_EST, so
+	intervals and jitter below the read interval (-i) are not measured.
+
+	Every loss is stored in the file as a loss record at the position of
+	the gap: words lost in the driver (#Z146_BLK_RX_STATS,
+	#Z146_RX_OVERRUN), words discarded with a line error and words which
+	the capture dropped because all write buffers were waiting for the
+	disk. The losses per channel and the write times are reported in a
+	fixed interval and at the end. The z146_cap library reads capture
+	files of any size with constant memory.
+
+	z146_replay sends a capture on one or more transmitters with the
+	recorded timing, optionally faster (-x), with other labels (-L) and
+	in a loop (-l). The file is streamed, so the memory needed does not
+	depend on its size. The words of a channel are sent as timed bursts
+	(#Z246_BLK_TX_TIMED) of words with the same label and without gaps,
+	the timing error of every burst is computed from the release error
+	of the driver (#Z246_BLK_TX_TIMED_RES) and reported with mean, p99
+	and maximum. As the label is a register of the transmitter, a burst
+	with another label is submitted when the previous one has been sent,
+	so channels with frequent label changes are replayed with an error
+	in the range of the tick of the operating system.
+
+	z146_archive converts captures to an indexed archive (z146_arc.h) for
+	offline queries. The words are partitioned by channel and label into
+	chunks of up to 4096 words, time and value are stored as varint coded
+	differences, typically 2..3 bytes instead of 16 per word. An index of
+	all chunks with channel, label and time range is stored at the end,
+	so a query like \c "-q -c 2 -l 0205 -f 100 -t 200" reads only the
+	chunks of label 0205 on channel 2 which overlap that time range.
+	Losses are kept as separate series per channel. Header and index are
+	little endian like the capture files, so archives can be queried on
+	any host.
+
+	z146_analyze computes per label rate, interval, jitter, gaps, SSM
+	distribution, parity errors and value range of a capture. The
+	records are split into equal ranges, one thread per CPU (-j), and the
+	partial results are merged in time order, so the result does not
+	depend on the number of threads. Parity errors can only be seen in
+	captures made with Z146_PAR_EN 0, with parity checking enabled the
+	receiver drops these words and they show up as line losses. The
+	capture stores Z146_PAR_EN and Z146_PAR_TYP of every receiver in the
+	header, z146_analyze checks the parity only on channels without
+	parity checking in the receiver, with the configured type unless -p
+	is given.
+
+    \n \section HostSim Host Simulator
+	SIM contains a register level model of both cores which runs the
+	unmodified drivers on a development host (GNU make, native compiler,
+	\c make \c run in SIM). The model implements the registers of
+	z146_regs.h, the FIFOs, the word time of both speeds, parity, the
+	label and SDI filters, receive overruns and the interrupt requests
+	with their thresholds. Time is simulated and advances only in
+	SIM_Run() and OSS_Delay(), so a run is repeatable. The host side OSS,
+	DESC and DBG functions implement only what the drivers use.
+
+	z146_sim connects one transmitter to one receiver, sends a sequence
+	of words and reports lost words, throughput, bus utilization, single
+	word latency and the host CPU time per word. Behaviour which the
+	hardware documentation leaves open, e.g. the unit of RX_TIMEOUT, is
+	listed in sim_dev.c.
+
+	z146_simtest runs checked scenarios and exits with 1 if one fails
+	(\c make \c test in SIM). The uio scenario links the z146_uio library
+	against the model: its register accesses are routed to the model
+	instead of a mapped window, and the words sent with
+	Z146_UioTxWrite() are compared with those read by Z146_UioRxPoll().
+	The other scenarios run the drivers and check the label and SDI
+	filters, parity errors, the character timeout, the line status
+	interrupt for framing errors and overruns, 12.5 kHz and the threshold
+	latency of #Z146_BLK_IRQLAT and #Z246_BLK_IRQLAT.
+
+	The handlers are called at the time of the interrupt request unless
+	SIM_IrqLatencySet() gives an interrupt latency, so without it the
+	threshold latency is 0. The ISRs take no simulated time. A nested
+	OSS_IrqMaskR(), which deadlocks on Linux, aborts the simulation.
+
     \n \section Documents Overview of all Documents
 
     \subsection z146_example  Simple example for using the driver
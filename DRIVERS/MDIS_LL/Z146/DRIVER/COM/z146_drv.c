@@ -41,6 +41,7 @@
 #include <MEN/mdis_com.h>    /* MDIS common defs               */
 #include <MEN/mdis_err.h>    /* MDIS error codes               */
 #include <MEN/ll_defs.h>     /* low-level driver definitions   */
+#include <MEN/z146_regs.h>   /* register map                   */
 
 /*-----------------------------------------+
 |  DEFINES                                 |
@@ -55,7 +56,44 @@
 #define DBH                llHdl->dbgHdl      /**< debug handle */
 #define OSH                llHdl->osHdl       /**< OS handle    */
 
-#define Z146_MAX_BUFF_SIZE		4096
+#define DRV_NAME           "Z146"     /**< driver name for messages */
+
+#define Z146_RING_SIZE_DEFAULT	4096		/**< default ring buffer size in words */
+#define Z146_RING_SIZE_MIN		256			/**< min. ring buffer size in words */
+#define Z146_RING_SIZE_MAX		65536		/**< max. ring buffer size in words */
+
+#define Z146_OVERFLOW_DROP_NEW	0			/**< ring buffer full: discard new words */
+#define Z146_OVERFLOW_DROP_OLD	1			/**< ring buffer full: overwrite the oldest words */
+
+#define Z146_READERS_MAX		8			/**< max. readers in broadcast mode */
+
+#define Z146_WORD_US_HIGH		360			/**< time per word at 100 kHz incl. 4 bit gap [us] */
+#define Z146_WORD_US_LOW		2880		/**< time per word at 12.5 kHz incl. 4 bit gap [us] */
+#define Z146_IRQ_BINS			16			/**< histogram bins, see Z146_IRQLAT_BINS */
+
+/** reader index of a channel, 0 if not in broadcast mode */
+#define Z146_READER(llHdl, ch)	((llHdl)->rdNum ? (u_int32)(ch) : 0)
+
+#ifndef Z146_TIMESTAMP
+# if defined(LINUX) && defined(__KERNEL__)
+#  include <linux/ktime.h>
+/** time stamp in us for driver measurements (monotonic clock) */
+#  define Z146_TIMESTAMP(llHdl)	((u_int32)ktime_to_us(ktime_get()))
+# else
+/** time stamp in us for driver measurements; should be defined to a
+ *  fine clock of the target, the fallback has tick resolution */
+#  define Z146_TIMESTAMP(llHdl)	((u_int32)OSS_TickGet((llHdl)->osHdl) * (llHdl)->tickUs)
+#  define Z146_TIMESTAMP_RES(llHdl)	((llHdl)->tickUs)
+# endif
+#endif
+#ifndef Z146_TIMESTAMP_RES
+/** resolution of a Z146_TIMESTAMP defined for the target [us] */
+#define Z146_TIMESTAMP_RES(llHdl)	1
+#endif
+
+/** word dropped by the software label filter */
+#define Z146_LAB_GATED(llHdl, w) ((llHdl)->labGate && \
+		!((llHdl)->labGateMap[((w) & 0xFF) >> 5] & (1 << ((w) & 0x1F))))
 
 
 /* toggle mode defines */
@@ -68,66 +106,6 @@
 #define RESET_DEFAULT      0          /**< default arwen reset (enabled)     */
 #define RESET_OFF          1          /**< disables the arwen reset function */
 
-#define Z146_STAT_REG				0x400			/**< Offset of the status register. */
-#define Z146_LSR_REG_OFFSET			0x402		/**< Offset of the LSR status register. */
-#define Z146_LSR_RESET_VAL 			0x1E		/**< Reset value of the LSR status register. */
-#define Z146_RX_IRQ_MASK    		0x7			/**< Receive IRQ mask. */
-#define Z146_RX_RXC_OFFSET			0x03		/**< Status register for received word count. */
-#define Z146_RX_RXC_REG_OFFSET  	0x403		/**< Status register for received word count. */
-
-#define Z146_RX_RXA_OFFSET			0x404		/**< Status register for acknowledge word count. */
-
-#define Z146_RX_IER_OFFSET			0x408		/**< Offset of the RX interrupt register */
-#define Z146_RX_IER_DEFAULT			0x3		    /**< Default value of the RX interrupt register */
-
-#define Z146_RX_RXCIEN_OFFSET		0x0	    	/**< Offset of the RX and character timout interrupt enable bit. */
-#define Z146_RX_RXCIEN_MASK 		0x1	    	/**< Mask of the RX and character timout interrupt enable bit. */
-#define Z146_RX_RLSIEN_OFFSET		0x1  		/**< Offset of the receive line status interrupt enable bit. */
-#define Z146_RX_RLSIEN_MASK  		0x2  		/**< Mask of the receive line status interrupt enable bit. */
-
-#define Z146_RX_LCR_OFFSET			0x409		/**< Offset of the RX_LCR register */
-#define Z146_RX_LCR_DEFAULT			0x17		/**< Default value of the RX_LCR register */
-
-
-#define Z146_RX_SPEED_OFFSET		0x00		/**< Offset of the register RX_LCR RX_SPEED bit */
-#define Z146_RX_SPEED_MASK  		0x01		/**< Mask of the register RX_LCR RX_SPEED bit */
-#define Z146_RX_ERR_WE_OFFSET		0x01		/**< Offset of the register RX_LCR RX error write enable bit */
-#define Z146_RX_ERR_WE_MASK			0x02		/**< Mask of the register RX_LCR RX error write enable bit */
-#define Z146_RX_PAR_EN_OFFSET		0x02		/**< Offset of the register RX_LCR RX parity enable bit */
-#define Z146_RX_PAR_EN_MASK 		0x04		/**< Mask of the register RX_LCR RX parity enable bit */
-#define Z146_RX_PAR_TYP_OFFSET		0x03		/**< Offset of the register RX_LCR RX parity type bit */
-#define Z146_RX_PAR_TYP_MASK		0x08		/**< Mask of the register RX_LCR RX parity type bit */
-#define Z146_RX_LAB_EN_OFFSET		0x04		/**< Offset of the register RX_LCR RX label enable bit */
-#define Z146_RX_LAB_EN_MASK			0x10		/**< Mask of the register RX_LCR RX label enable bit */
-#define Z146_RX_SDI_EN_OFFSET		0x05		/**< Offset of the register RX_LCR RX source/destination identifier enable bit */
-#define Z146_RX_SDI_EN_MASK  		0x20		/**< Mask of the register RX_LCR RX source/destination identifier enable bit */
-#define Z146_RX_SDI_OFFSET	     	0x06		/**< Offset of the register RX_LCR RX source/destination identifier mask */
-#define Z146_RX_SDI_MASK	     	0xC0		/**< Mask of the register RX_LCR RX source/destination identifier mask */
-#define Z146_RX_SDI_MAX  	     	0x03		/**< RX_LCR RX source/destination identifier max value */
-#define Z146_RX_THR_LEV_MASK		0x07		/**< Offset of the register RX_LCR RX threshold level mask */
-
-#define Z146_RX_FCR_OFFSET			0x40A		/**< Offset of the RX_FCR register */
-#define Z146_RX_FCR_DEFAULT			0x5			/**< Default value of the RX_FCR register */
-
-#define Z146_RX_TIMEOUT_OFFSET		0x414		/**< Offset of the RX timeout register */
-#define Z146_RX_TIMEOUT_DEFAULT		0x1E		/**< Default value of the RX timeout register */
-
-
-#define Z146_RX_LA_OFFSET			0x480		/**< Offset of the receive labels register */
-#define Z146_RX_LA_SIZE				16			/**< Size of the receive labels register in bytes */
-#define Z146_RX_LA_DEFAULT			0		    /**< Default value of the receive label register */
-
-#define Z146_RX_LA_NUM_OFFSET		0x40B		/**< Offset of the RX label numbers register */
-#define Z146_RX_LA_NUM_DEFAULT		0		    /**< Default value of the RX label numbers register */
-#define Z146_RX_LA_NUM_MASK 		0x1F		/**< Bit mask of the RX label numbers register */
-
-#define Z146_RX_FIFO_START_ADDR		0x000		/**< Receive FIFO start address. */
-#define Z146_RX_FIFO_LEN			255		    /**< Receive FIFO size. */
-
-#define Z146_RX_LINE_STAT_IRQ		1			/**< Receive line status interrupt offset */
-#define Z146_RX_DATA_AVAIL_IRQ		2			/**< Receive data available interrupt offset */
-#define Z146_RX_CHAR_TIMEOUT_IRQ	4			/**< Receive character timeout offset */
-
 /*-----------------------------------------+
 |  TYPEDEFS                                |
 +-----------------------------------------*/
@@ -144,7 +122,7 @@ typedef struct {
 	u_int32                 dbgLevel;       /**< debug level  */
 	DBG_HANDLE              *dbgHdl;        /**< debug handle */
 
-	OSS_SIG_HANDLE          *rxDataSig; /**< signal for port change */
+	OSS_SIG_HANDLE          *rxDataSig[Z146_READERS_MAX]; /**< data signal per reader */
 	OSS_SIG_HANDLE          *rxErrorSig; /**< signal for error in reception */
 
 	/* toggle mode */
@@ -152,10 +130,61 @@ typedef struct {
 	OSS_SEM_HANDLE          *devSemHdl;     /**< device semaphore handle    */
 
 	/* Ring buffer parameters */
-	u_int32					ringBuffer[Z146_MAX_BUFF_SIZE];
+	u_int32					*ringBuffer;
+	u_int32					ringSize;		/**< ring buffer size in words */
+	u_int32					ringAlloc;		/**< bytes allocated for ringBuffer */
+	u_int32					overflowPolicy;	/**< Z146_OVERFLOW_xxx */
 	volatile u_int32	    ringHead;
 	volatile u_int32 		ringTail;
 	volatile u_int32 		ringDataCnt;
+	volatile u_int32		ringDropped;	/**< oldest words overwritten (drop old policy) */
+
+	/* receive statistics, see Z146_RX_STATS */
+	u_int32					statStored;		/**< words stored */
+	u_int32					statDropBase;	/**< ringDropped at the last read */
+	u_int32					statRejected;	/**< words discarded, ring buffer full */
+	u_int32					statMaxDepth;	/**< max. ringDataCnt */
+	u_int32					statLineIrqs;	/**< line status interrupts */
+	u_int32					statLineWords;	/**< words discarded by line errors */
+	u_int32					statLsr;		/**< LSR error bits seen */
+
+	/* broadcast mode: one read cursor per channel */
+	u_int32					rdNum;			/**< readers, 0 = consuming mode */
+	volatile u_int32		rxSeq;			/**< words stored since init */
+	u_int32					rdSeq[Z146_READERS_MAX];	/**< next word to read */
+	u_int32					rdIdx[Z146_READERS_MAX];	/**< ring index of rdSeq */
+	u_int32					rdOverrun[Z146_READERS_MAX];	/**< words lost by the reader */
+
+	/* configuration from the descriptor, applied by ConfigureDefault() */
+	u_int8					cfgLcr;			/**< RX_LCR */
+	u_int8					cfgFcr;			/**< RX_FCR */
+	u_int8					cfgTimeout;		/**< RX timeout */
+	u_int8					cfgIer;			/**< RX_IER, restored after each interrupt */
+	u_int8					cfgLabel[Z146_RX_LA_SIZE];	/**< receive labels */
+	u_int32					cfgLabNum;		/**< number of receive labels */
+
+	/* receive labels, shadow of RX_LA and RX_LA_NUM */
+	u_int8					laShadow[Z146_RX_LA_SIZE];
+	u_int32					laNum;			/**< active labels */
+	volatile u_int32		labGate;		/**< software label filter active */
+	u_int32					labGateMap[8];	/**< labels passed by the software filter */
+	u_int32					labGated;		/**< words dropped by the software filter */
+	u_int32					labCfgUs;		/**< duration of the last label change [us] */
+	u_int32					tickUs;			/**< OSS tick period [us], 0 = unknown */
+
+	/* interrupt instrumentation, see Z146_IRQLAT */
+	u_int32					irqCnt;			/**< interrupts handled */
+	u_int32					irqWords;		/**< words handled */
+	u_int32					irqMaxWords;	/**< max. words per interrupt */
+	u_int32					irqDurMaxUs;	/**< max. ISR execution time [us] */
+	u_int32					irqDurSumUs;	/**< sum of the ISR execution times [us] */
+	u_int32					irqLatNum;		/**< interrupts with a threshold latency */
+	u_int32					rxThrSeen;		/**< min. FIFO level at a data interrupt */
+	u_int32					irqLatMaxUs;	/**< max. threshold latency [us] */
+	u_int32					irqLatSumUs;	/**< sum of the threshold latencies [us] */
+	u_int32					irqDurHist[Z146_IRQ_BINS];
+	u_int32					irqWordsHist[Z146_IRQ_BINS];
+	u_int32					irqLatHist[Z146_IRQ_BINS];
 
 } LL_HANDLE;
 
@@ -164,6 +193,10 @@ typedef struct {
 #include <MEN/ll_entry.h>       /* low-level driver jump table */
 #include <MEN/z146_drv.h>        /* Z146 driver header file      */
 
+#if Z146_IRQ_BINS != Z146_IRQLAT_BINS
+#error "Z146_IRQ_BINS must match Z146_IRQLAT_BINS"
+#endif
+
 /*-----------------------------------------+
 |  PROTOTYPES                              |
 +-----------------------------------------*/
@@ -188,8 +221,25 @@ static char* Ident(void);
 static int32 Cleanup(LL_HANDLE *llHdl, int32 retCode);
 static void  ConfigureDefault( LL_HANDLE *llHdl );
 static void RegStatus(LL_HANDLE *llHdl);
-static u_int32 ReadFromBuffer( LL_HANDLE *llHdl, int8 * result);
+static u_int32 RingCopy(LL_HANDLE *llHdl, u_int32 idx, u_int32 *buf,
+						u_int32 num);
 static int8 StoreInBuffer( LL_HANDLE *llHdl , u_int32 data);
+static int32 LineCfgSet(LL_HANDLE *llHdl, Z146_LINE_CFG *cfg);
+static int32 LabelAdd(LL_HANDLE *llHdl, u_int8 label);
+static int32 LabelRemove(LL_HANDLE *llHdl, u_int8 label);
+static void LabelCommit(LL_HANDLE *llHdl, u_int8 *labels, u_int32 num);
+static void RxDrain(LL_HANDLE *llHdl);
+static u_int32 ReaderAvail(LL_HANDLE *llHdl, u_int32 rd);
+static u_int32 ReaderRead(LL_HANDLE *llHdl, u_int32 rd, u_int32 *buf,
+						  u_int32 max);
+static void ReaderSync(LL_HANDLE *llHdl, u_int32 rd);
+static void ReaderSyncLocked(LL_HANDLE *llHdl, u_int32 rd);
+static u_int32 RxSeqGet(LL_HANDLE *llHdl);
+static void IrqLatLog(LL_HANDLE *llHdl, u_int32 t0, u_int32 words,
+					  int32 latUs);
+static u_int32 HistBin(u_int32 value);
+static int32 DescGet(LL_HANDLE *llHdl, char *key, u_int32 def, u_int32 min,
+					 u_int32 max, u_int32 *valueP);
 
 
 /****************************** Z146_GetEntry ********************************/
@@ -233,6 +283,21 @@ static int8 StoreInBuffer( LL_HANDLE *llHdl , u_int32 data);
  * DEBUG_LEVEL_DESC      OSS_DBG_DEFAULT  see dbg.h
  * DEBUG_LEVEL           OSS_DBG_DEFAULT  see dbg.h
  * ID_CHECK              1                0..1
+ * RX_SPEED              1                0..1 (0 = 12.5 kHz, 1 = 100 kHz)
+ * RX_ERR_WE             1                0..1
+ * RX_PAR_EN             1                0..1
+ * RX_PAR_TYP            0                0..1
+ * RX_LAB_EN             1                0..1
+ * RX_SDI_EN             0                0..1
+ * RX_SDI                0                0..3
+ * RX_THR_LEV            5                0..7
+ * RX_TIMEOUT            0x1E             0..0xFF
+ * RX_IRQ_ENABLE         3                0..3 (bit 0 = RX data, bit 1 = line status)
+ * RX_LABEL              (none)           up to 16 labels (binary)
+ * RX_RING_SIZE          4096             256..65536 words
+ * RX_OVERFLOW           0                0 = discard new words,
+ *                                        1 = overwrite oldest words
+ * RX_READERS            0                0..8 (0 = one consuming reader)
  * \endcode
  *
  *  \param descP      \IN  pointer to descriptor data
@@ -257,6 +322,7 @@ static int32 Z146_Init(
 	u_int32 gotsize;
 	int32 error;
 	u_int32 value;
+	u_int32 speed, errWe, parEn, parTyp, labEn, sdiEn, sdi;
 
 	/*------------------------------+
 	|  prepare the handle           |
@@ -281,6 +347,10 @@ static int32 Z146_Init(
 	/* Receive buffer */
 	llHdl->ringHead    = 0;
 	llHdl->ringTail    = 0;
+	/* an OSS without tick rate leaves the fallback time stamps at 0 */
+	llHdl->tickUs      = (OSS_TickRateGet(osHdl) > 0) ?
+						 1000000 / OSS_TickRateGet(osHdl) : 0;
+	llHdl->rxThrSeen   = Z146_RX_FIFO_LEN;
 	/*------------------------------+
 	|  init id function table       |
 	+------------------------------*/
@@ -321,7 +391,62 @@ static int32 Z146_Init(
 
 	DBGWRT_1((DBH, "Z146_Init: base address = %08p\n", (void*)llHdl->ma));
 
-	/* Initialize all elements in one shot */
+	/* line configuration */
+	if ((error = DescGet(llHdl, "RX_SPEED",  1, 0, 1, &speed))  ||
+		(error = DescGet(llHdl, "RX_ERR_WE", 1, 0, 1, &errWe))  ||
+		(error = DescGet(llHdl, "RX_PAR_EN", 1, 0, 1, &parEn))  ||
+		(error = DescGet(llHdl, "RX_PAR_TYP", 0, 0, 1, &parTyp)) ||
+		(error = DescGet(llHdl, "RX_LAB_EN", 1, 0, 1, &labEn))  ||
+		(error = DescGet(llHdl, "RX_SDI_EN", 0, 0, 1, &sdiEn))  ||
+		(error = DescGet(llHdl, "RX_SDI", 0, 0, Z146_RX_SDI_MAX, &sdi)))
+		return (Cleanup(llHdl, error));
+
+	llHdl->cfgLcr = (u_int8)((speed  << Z146_RX_SPEED_OFFSET)   |
+							 (errWe  << Z146_RX_ERR_WE_OFFSET)  |
+							 (parEn  << Z146_RX_PAR_EN_OFFSET)  |
+							 (parTyp << Z146_RX_PAR_TYP_OFFSET) |
+							 (labEn  << Z146_RX_LAB_EN_OFFSET)  |
+							 (sdiEn  << Z146_RX_SDI_EN_OFFSET)  |
+							 (sdi    << Z146_RX_SDI_OFFSET));
+
+	/* FIFO threshold, timeout and interrupts */
+	if ((error = DescGet(llHdl, "RX_THR_LEV", Z146_RX_FCR_DEFAULT, 0,
+						 Z146_RX_THR_LEV_MASK, &value)))
+		return (Cleanup(llHdl, error));
+	llHdl->cfgFcr = (u_int8)value;
+
+	if ((error = DescGet(llHdl, "RX_TIMEOUT", Z146_RX_TIMEOUT_DEFAULT, 0,
+						 0xFF, &value)))
+		return (Cleanup(llHdl, error));
+	llHdl->cfgTimeout = (u_int8)value;
+
+	if ((error = DescGet(llHdl, "RX_IRQ_ENABLE", Z146_RX_IER_DEFAULT, 0,
+						 Z146_RX_IER_DEFAULT, &value)))
+		return (Cleanup(llHdl, error));
+	llHdl->cfgIer = (u_int8)value;
+
+	/* receive labels */
+	value = Z146_RX_LA_SIZE;
+	if ((error = DESC_GetBinary(llHdl->descHdl, (u_int8*)"", 0,
+								llHdl->cfgLabel, &value, "RX_LABEL")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return (Cleanup(llHdl, error));
+	llHdl->cfgLabNum = value;
+
+	/* ring buffer */
+	if ((error = DescGet(llHdl, "RX_RING_SIZE", Z146_RING_SIZE_DEFAULT,
+						 Z146_RING_SIZE_MIN, Z146_RING_SIZE_MAX,
+						 &llHdl->ringSize)) ||
+		(error = DescGet(llHdl, "RX_OVERFLOW", Z146_OVERFLOW_DROP_NEW,
+						 Z146_OVERFLOW_DROP_NEW, Z146_OVERFLOW_DROP_OLD,
+						 &llHdl->overflowPolicy)) ||
+		(error = DescGet(llHdl, "RX_READERS", 0, 0, Z146_READERS_MAX,
+						 &llHdl->rdNum)))
+		return (Cleanup(llHdl, error));
+
+	if ((llHdl->ringBuffer = (u_int32*)OSS_MemGet(
+			osHdl, llHdl->ringSize * sizeof(u_int32), &llHdl->ringAlloc)) == NULL)
+		return (Cleanup(llHdl, ERR_OSS_MEM_ALLOC));
 
 	/*------------------------------+
 	|  init hardware                |
@@ -434,10 +559,6 @@ static int32 Z146_SetStat(
 	int32 value = (int32)value32_or_64;		/* 32bit value */
 	int32 error = ERR_SUCCESS;
 	u_int8 regData = 0;
-	u_int8 label = 0;
-	u_int8 labCnt = 0;
-	u_int8 isLab = 0;
-	u_int32 i = 0;
 	DBGWRT_1((DBH, "LL - Z146_SetStat: ch=%d code=0x%04x value=0x%x\n",
 				ch, code, value));
 
@@ -468,22 +589,33 @@ static int32 Z146_SetStat(
 		+--------------------------*/
 		case Z146_SET_SIGNAL:
 			/* signal already installed ? */
-			if (llHdl->rxDataSig) {
+			if (llHdl->rxDataSig[Z146_READER(llHdl, ch)]) {
 				error = ERR_OSS_SIG_SET;
 				break;
 			}
-			error = OSS_SigCreate(OSH, value, &llHdl->rxDataSig);
+			error = OSS_SigCreate(OSH, value, &llHdl->rxDataSig[Z146_READER(llHdl, ch)]);
 			break;
 			/*--------------------------+
 		|  unregister signal        |
 		+--------------------------*/
 		case Z146_CLR_SIGNAL:
 			/* signal already installed ? */
-			if (llHdl->rxDataSig == NULL) {
+			if (llHdl->rxDataSig[Z146_READER(llHdl, ch)] == NULL) {
 				error = ERR_OSS_SIG_CLR;
 				break;
 			}
-			error = OSS_SigRemove(OSH, &llHdl->rxDataSig);
+			error = OSS_SigRemove(OSH, &llHdl->rxDataSig[Z146_READER(llHdl, ch)]);
+			break;
+
+		/*--------------------------+
+		|  reader to newest word    |
+		+--------------------------*/
+		case Z146_RX_READER_SYNC:
+			if (llHdl->rdNum == 0) {
+				error = ERR_LL_ILL_PARAM;
+				break;
+			}
+			ReaderSync(llHdl, (u_int32)ch);
 			break;
 
 			/*--------------------------+
@@ -521,6 +653,7 @@ static int32 Z146_SetStat(
 				regData = regData & (~Z146_RX_RXCIEN_MASK);
 			}
 			MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, regData);
+			llHdl->cfgIer = regData;
 			DBGWRT_1((DBH, "LL - Z146_SetStat: Z146_RX_RXC_IRQ_STAT 0x%04x\n", MREAD_D8(llHdl->ma, Z146_RX_IER_OFFSET)));
 			break;
 
@@ -536,6 +669,7 @@ static int32 Z146_SetStat(
 				regData = regData & (~Z146_RX_RLSIEN_MASK);
 			}
 			MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, regData);
+			llHdl->cfgIer = regData;
 			DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_RLS_IRQ_STAT 0x%04x\n", MREAD_D8(llHdl->ma, Z146_RX_IER_OFFSET)));
 			break;
 
@@ -543,73 +677,32 @@ static int32 Z146_SetStat(
 		|  Set Receive Label     |
 		+------------------------*/
 		case Z146_RX_SET_LABEL:
-			regData = (value32_or_64 & 0xFF);
-			labCnt = (MREAD_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET) & Z146_RX_LA_NUM_MASK);
-			/* Check for the max limit of the count. */
-			if(labCnt < Z146_RX_LA_NUM_MASK){
-				for(i=0;i<labCnt;i++){
-					label = MREAD_D8(llHdl->ma, Z146_RX_LA_OFFSET + i);
-					/* Check whether the label exists. */
-					if(label == regData){
-						DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_SET_LABEL = 0x%04x already exists in the list.\n", regData));
-						isLab = 1;
-						break;
-					}
-				}
-				if(isLab == 0){
-					/* Write the label. */
-					MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + i, regData);
-					/* Increment the count */
-					labCnt = labCnt + 1;
-					MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (labCnt &  Z146_RX_LA_NUM_MASK));
-					DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_SET_LABEL = 0x%04x set @ %d position\n", regData, i));
-				}
-			}else{
-				error = ERR_LL_WRITE;
-				DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_SET_LABEL = 0x%04x; Error- label queue is full\n", regData));
-			}
+			error = LabelAdd(llHdl, (u_int8)(value32_or_64 & 0xFF));
 			break;
 
-
 		/*-------------------------+
 		|  Reset Receive Label     |
 		+--------------------------*/
 		case Z146_RX_RESET_LABEL:
-			regData = (value32_or_64 & 0xFF);
-			labCnt = (MREAD_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET) & Z146_RX_LA_NUM_MASK);
-			/* Check for the max limit of the count. */
-			if(labCnt != 0){
-				for(i=0;i<labCnt;i++){
-					label = MREAD_D8(llHdl->ma, Z146_RX_LA_OFFSET + i);
-					/* Check whether the label exists. */
-					if((label == regData) && (isLab == 0)){
-						/* The last label count shall be treated differently. */
-						if((i+1) == labCnt){
-							/* Reset the label. */
-							MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + i, 0);
-							/* Decrement the count */
-							labCnt = (labCnt - 1);
-							MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (labCnt &  Z146_RX_LA_NUM_MASK));
-							DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_RESET_LABEL : New label count set to = %d\n", labCnt &  Z146_RX_LA_NUM_MASK));
-						}else{
-							/* Else set the flag for the next loop. */
-							isLab = 1;
-						}
-					}else if(isLab == 1){
-						/* Decrement the label position.*/
-						MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + (i - 1), label);
-						/* Decrement the count */
-						regData = (labCnt - 1);
-						MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (regData &  Z146_RX_LA_NUM_MASK));
-						DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_RESET_LABEL : label = %d old position = %d, new position = %d\n", label, i, i-1));
-					} /* Else continue the loop. */
-				}
+			error = LabelRemove(llHdl, (u_int8)(value32_or_64 & 0xFF));
+			break;
 
-			}else{
-				error = ERR_LL_WRITE;
-				DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_RESET_LABEL = 0x%04x; Error- label queue is empty\n", regData));
+		/*-------------------------------+
+		|  Set complete label list       |
+		+--------------------------------*/
+		case Z146_BLK_RX_LABELS:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64;
+
+			if ((blk->size < 0) || (blk->size > Z146_RX_LA_SIZE) ||
+				((blk->size != 0) && (blk->data == NULL))) {
+				error = ERR_LL_ILL_PARAM;
+				break;
 			}
+			LabelCommit(llHdl, (u_int8*)blk->data, (u_int32)blk->size);
 			break;
+		}
+
 		/*---------------------------+
 		|  Receive speed status      |
 		+----------------------------*/
@@ -672,6 +765,8 @@ static int32 Z146_SetStat(
 				regData = regData | Z146_RX_LAB_EN_MASK;
 			}else{
 				regData = regData & (~Z146_RX_LAB_EN_MASK);
+				/* no label filter, also not in software */
+				llHdl->labGate = 0;
 			}
 			MWRITE_D8(llHdl->ma, Z146_RX_LCR_OFFSET, regData);
 			break;
@@ -710,7 +805,23 @@ static int32 Z146_SetStat(
 			regData = regData & (~Z146_RX_THR_LEV_MASK);
 			regData |= (value32_or_64 & Z146_RX_THR_LEV_MASK);
 			MWRITE_D8(llHdl->ma, Z146_RX_FCR_OFFSET, regData);
+			llHdl->rxThrSeen = Z146_RX_FIFO_LEN;
+			break;
+
+		/*--------------------------------------+
+		|  Complete line configuration          |
+		+---------------------------------------*/
+		case Z146_BLK_LINE_CFG:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64;
+
+			if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z146_LINE_CFG))) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+			error = LineCfgSet(llHdl, (Z146_LINE_CFG*)blk->data);
 			break;
+		}
 
 		/*--------------------------+
 		|  (unknown)                |
@@ -764,7 +875,8 @@ static int32 Z146_GetStat(
 		|  number of channels       |
 		+--------------------------*/
 		case M_LL_CH_NUMBER:
-			*valueP = CH_NUMBER;
+			/* broadcast mode: one channel per reader */
+			*valueP = llHdl->rdNum ? llHdl->rdNum : CH_NUMBER;
 			break;
 
 		/*--------------------------+
@@ -799,7 +911,23 @@ static int32 Z146_GetStat(
 		|  RX data length           |
 		+--------------------------*/
 		case Z146_RX_DATA_LEN:
-			*value64P = (INT32_OR_64)llHdl->ringDataCnt;
+			if (llHdl->rdNum)
+				*value64P = (INT32_OR_64)ReaderAvail(llHdl, (u_int32)ch);
+			else
+				*value64P = (INT32_OR_64)llHdl->ringDataCnt;
+			break;
+
+		/*------------------------------------------+
+		|  Words lost by the reader (broadcast)     |
+		+-------------------------------------------*/
+		case Z146_RX_OVERRUN:
+			if (llHdl->rdNum == 0) {
+				error = ERR_LL_ILL_PARAM;
+				break;
+			}
+			ReaderAvail(llHdl, (u_int32)ch);
+			*value64P = (INT32_OR_64)llHdl->rdOverrun[ch];
+			llHdl->rdOverrun[ch] = 0;
 			break;
 
 		/*------------------------------------------------+
@@ -881,6 +1009,137 @@ static int32 Z146_GetStat(
 			*value64P = (INT32_OR_64)((regData & Z146_RX_THR_LEV_MASK));
 			break;
 
+		/*-------------------------------+
+		|  Label reconfiguration         |
+		+--------------------------------*/
+		case Z146_RX_LABEL_CFG_US:
+			*value64P = (INT32_OR_64)llHdl->labCfgUs;
+			break;
+
+		case Z146_RX_LABEL_GATED:
+			*value64P = (INT32_OR_64)llHdl->labGated;
+			llHdl->labGated = 0;
+			break;
+
+		/*--------------------------------------+
+		|  Interrupt instrumentation            |
+		+---------------------------------------*/
+		case Z146_BLK_IRQLAT:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+			Z146_IRQLAT *lat = (Z146_IRQLAT*)blk->data;
+			OSS_IRQ_STATE irqState;
+			u_int32 i = 0;
+
+			if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z146_IRQLAT))) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+			/* read and reset as one snapshot */
+			irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+			lat->irqs     = llHdl->irqCnt;
+			lat->words    = llHdl->irqWords;
+			lat->maxWords = llHdl->irqMaxWords;
+			lat->durMaxUs = llHdl->irqDurMaxUs;
+			lat->durSumUs = llHdl->irqDurSumUs;
+			lat->latNum   = llHdl->irqLatNum;
+			lat->latMaxUs = llHdl->irqLatMaxUs;
+			lat->latSumUs = llHdl->irqLatSumUs;
+			lat->resUs    = Z146_TIMESTAMP_RES(llHdl);
+			for (i = 0; i < Z146_IRQ_BINS; i++) {
+				lat->durHist[i]   = llHdl->irqDurHist[i];
+				lat->wordsHist[i] = llHdl->irqWordsHist[i];
+				lat->latHist[i]   = llHdl->irqLatHist[i];
+				llHdl->irqDurHist[i]   = 0;
+				llHdl->irqWordsHist[i] = 0;
+				llHdl->irqLatHist[i]   = 0;
+			}
+			llHdl->irqCnt      = 0;
+			llHdl->irqWords    = 0;
+			llHdl->irqMaxWords = 0;
+			llHdl->irqDurMaxUs = 0;
+			llHdl->irqDurSumUs = 0;
+			llHdl->irqLatNum   = 0;
+			llHdl->irqLatMaxUs = 0;
+			llHdl->irqLatSumUs = 0;
+			OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+			blk->size = sizeof(Z146_IRQLAT);
+			break;
+		}
+
+		case Z146_BLK_RX_STATS:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+			Z146_RX_STATS *stats = (Z146_RX_STATS*)blk->data;
+			OSS_IRQ_STATE irqState;
+
+			if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z146_RX_STATS))) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+			/* ringDropped is used by Z146_BlockRead(), keep it running */
+			irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+			stats->wordsStored  = llHdl->statStored;
+			stats->ringDropped  = llHdl->ringDropped - llHdl->statDropBase;
+			stats->ringRejected = llHdl->statRejected;
+			stats->maxRingDepth = llHdl->statMaxDepth;
+			stats->lineErrIrqs  = llHdl->statLineIrqs;
+			stats->lineErrWords = llHdl->statLineWords;
+			stats->lineErrLsr   = llHdl->statLsr;
+			llHdl->statStored    = 0;
+			llHdl->statDropBase  = llHdl->ringDropped;
+			llHdl->statRejected  = 0;
+			llHdl->statMaxDepth  = llHdl->ringDataCnt;
+			llHdl->statLineIrqs  = 0;
+			llHdl->statLineWords = 0;
+			llHdl->statLsr       = 0;
+			OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+			blk->size = sizeof(Z146_RX_STATS);
+			break;
+		}
+
+		case Z146_BLK_RX_LABELS:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+			u_int8 *labels = (u_int8*)blk->data;
+			u_int32 i = 0;
+
+			if ((blk->data == NULL) || (blk->size < (int32)llHdl->laNum)) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+			for (i = 0; i < llHdl->laNum; i++) {
+				labels[i] = llHdl->laShadow[i];
+			}
+			blk->size = llHdl->laNum;
+			break;
+		}
+
+		/*--------------------------------------+
+		|  Complete line configuration          |
+		+---------------------------------------*/
+		case Z146_BLK_LINE_CFG:
+		{
+			M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+			Z146_LINE_CFG *cfg = (Z146_LINE_CFG*)blk->data;
+
+			if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z146_LINE_CFG))) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+			regData = MREAD_D8(llHdl->ma, Z146_RX_LCR_OFFSET);
+			cfg->speed  = (regData & Z146_RX_SPEED_MASK) >> Z146_RX_SPEED_OFFSET;
+			cfg->errWe  = (regData & Z146_RX_ERR_WE_MASK) >> Z146_RX_ERR_WE_OFFSET;
+			cfg->parEn  = (regData & Z146_RX_PAR_EN_MASK) >> Z146_RX_PAR_EN_OFFSET;
+			cfg->parTyp = (regData & Z146_RX_PAR_TYP_MASK) >> Z146_RX_PAR_TYP_OFFSET;
+			cfg->labEn  = (regData & Z146_RX_LAB_EN_MASK) >> Z146_RX_LAB_EN_OFFSET;
+			cfg->sdiEn  = (regData & Z146_RX_SDI_EN_MASK) >> Z146_RX_SDI_EN_OFFSET;
+			cfg->sdi    = (regData & Z146_RX_SDI_MASK) >> Z146_RX_SDI_OFFSET;
+			cfg->flush  = 0;
+			blk->size = sizeof(Z146_LINE_CFG);
+			break;
+		}
+
 
 		/*--------------------------+
 		|  (unknown)                |
@@ -918,9 +1177,12 @@ static int32 Z146_BlockRead(
 	u_int32 * userBuf = (u_int32*)buf;
 	u_int32 llRxLen = 0;
 	u_int32 statReg = 0;
-	u_int32 dataLenByte = (llHdl->ringDataCnt * 4);
-	u_int32 dataLenWord = llHdl->ringDataCnt;
-	int8 readRes = 0;
+	u_int32 dataLenByte = 0;
+	u_int32 dataLenWord = 0;
+	u_int32 tail = 0;
+	u_int32 dropped = 0;
+	u_int32 lost = 0;
+	OSS_IRQ_STATE irqState;
 
 	DBGWRT_1((DBH, ">>> LL - Z146_BlockRead: ch=%d, size=%d\n",ch,size));
 
@@ -941,13 +1203,24 @@ static int32 Z146_BlockRead(
 			IDBGWRT_1((DBH, ">>> LL - Z146_BlockrRead: RXC Data length = %d\n", llRxLen));
 
 			if(size >= (int32)llRxLen){
+				u_int32 rdLen = 0;
+				u_int32 word = 0;
+
 				for(i=0; i<llRxLen; i++){
-					*userBuf++ = MREAD_D32(llHdl->ma, (Z146_RX_FIFO_START_ADDR + (i * 4)));
-					IDBGWRT_1((DBH, ">>> LL - Z146_BlockRead: Data[%d] = 0x%x\n",i, *userBuf));
+					word = MREAD_D32(llHdl->ma, (Z146_RX_FIFO_START_ADDR + (i * 4)));
+					IDBGWRT_1((DBH, ">>> LL - Z146_BlockRead: Data[%d] = 0x%x\n",i, word));
+					if(Z146_LAB_GATED(llHdl, word)){
+						llHdl->labGated++;
+						continue;
+					}
+					*userBuf++ = word;
+					rdLen++;
 				}
 				MWRITE_D8(llHdl->ma, Z146_RX_RXA_OFFSET, llRxLen);
+				/* the label change is complete when the FIFO was read once */
+				llHdl->labGate = 0;
 				/* return number of read bytes */
-				*nbrRdBytesP = (llRxLen * 4);
+				*nbrRdBytesP = (rdLen * 4);
 			}else{
 				IDBGWRT_1((DBH, ">>> LL - Z146_BlockRead: (size >= llHdl->rxDataLen)\n"));
 				result = ERR_MBUF_USERBUF;
@@ -955,20 +1228,45 @@ static int32 Z146_BlockRead(
 				*nbrRdBytesP = 0;
 			}
 
+		}else if(llHdl->rdNum){
+			/* Broadcast mode, read from the cursor of this channel. */
+			*nbrRdBytesP = ReaderRead(llHdl, (u_int32)ch, userBuf, size / 4) * 4;
 		}else{
-			/* The interrupt is enabled therefore read from ring buffer. */
+			/*
+			 * The interrupt is enabled therefore read from ring buffer.
+			 * Count, tail and drop counter are taken together, a drop old
+			 * overwrite moves the tail and must be seen relative to them.
+			 */
+			irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+			dataLenWord = llHdl->ringDataCnt;
+			tail        = llHdl->ringTail;
+			dropped     = llHdl->ringDropped;
+			OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+			dataLenByte = dataLenWord * 4;
+
 		    if(dataLenWord != 0 ){
 		    	/* Check user buffer length */
 		    	if(size >= (int32)dataLenByte){
-		    		/* Do not use the ringDataCnt because it can be influenced by IRQ during the data copy. */
-		    		for(i=0; i<dataLenWord; i++){
-		    			*userBuf++ = ReadFromBuffer(llHdl, &readRes);
-		    			if(readRes != 0){
-		    				*nbrRdBytesP = 0;
-		    				result = ERR_MBUF_OVERFLOW;
-		    				IDBGWRT_1((DBH, ">>> LL - Z146_BlockRead: ring buffer problem \n"));
-		    			}
+		    		/*
+		    		 * Copy without masking the interrupt, it only appends to the
+		    		 * buffer. With the drop old policy it may overwrite the first
+		    		 * words during the copy, these are removed afterwards.
+		    		 */
+		    		RingCopy(llHdl, tail, userBuf, dataLenWord);
+
+		    		irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+		    		lost = llHdl->ringDropped - dropped;
+		    		if(lost > dataLenWord)
+		    			lost = dataLenWord;
+		    		/* the tail moved by one per drop since the snapshot */
+		    		llHdl->ringTail = (llHdl->ringTail + dataLenWord - lost) % llHdl->ringSize;
+		    		llHdl->ringDataCnt -= dataLenWord - lost;
+		    		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+		    		for(i=lost; i<dataLenWord; i++){
+		    			userBuf[i - lost] = userBuf[i];
 		    		}
+		    		dataLenByte = (dataLenWord - lost) * 4;
 		    		*nbrRdBytesP = dataLenByte;
 		    		IDBGWRT_1((DBH, ">>> LL - Z146_BlockRead: Data length byte = %d\n", dataLenByte));
 		    	}else{
@@ -1041,6 +1339,8 @@ static int32 Z146_Irq(LL_HANDLE *llHdl){
 
 	int32 result = LL_IRQ_DEV_NOT;
 	u_int32 statReg = 0;
+	u_int32 t0 = 0;
+	int32 latUs = -1;
 
     statReg = MREAD_D32(llHdl->ma, Z146_STAT_REG);
 
@@ -1050,6 +1350,8 @@ static int32 Z146_Irq(LL_HANDLE *llHdl){
 		u_int32 data = 0;
 		u_int32 dataLen = 0;
 	    u_int16 i = 0;
+
+		t0 = Z146_TIMESTAMP(llHdl);
 		IDBGWRT_3((DBH, ">>> LL - Z146_Irq: status register = %08x\n", statReg));
 		IDBGWRT_3((DBH, ">>> LL - Z146_Irq: LSR = %08x\n", MREAD_D32(llHdl->ma, Z146_LSR_REG_OFFSET)));
 		MWRITE_D32(llHdl->ma, 0x00, 0xFFFFFFFF);
@@ -1068,6 +1370,10 @@ static int32 Z146_Irq(LL_HANDLE *llHdl){
 
 			/* Acknowledge the received data, which will lead to discard. */
 			MWRITE_D8(llHdl->ma, Z146_RX_RXA_OFFSET, dataLen);
+			llHdl->labGate = 0;
+			llHdl->statLineIrqs++;
+			llHdl->statLineWords += dataLen & 0xFF;
+			llHdl->statLsr |= MREAD_D8(llHdl->ma, Z146_LSR_REG_OFFSET) & Z146_LSR_RESET_VAL;
 
 			/* Clear the errors */
 			MWRITE_D8(llHdl->ma, Z146_LSR_REG_OFFSET, Z146_LSR_RESET_VAL);
@@ -1081,30 +1387,53 @@ static int32 Z146_Irq(LL_HANDLE *llHdl){
 			dataLen = (statReg >> (Z146_RX_RXC_OFFSET * 8)) &  0xFF;
 			IDBGWRT_1((DBH, ">>> LL - Z146_Irq: Data length = %d\n", dataLen));
 
+			/*
+			 * Words received since the threshold was reached. The
+			 * threshold in words is the lowest FIFO level seen at a data
+			 * interrupt since the threshold level was set.
+			 */
+			if(statReg & Z146_RX_DATA_AVAIL_IRQ){
+				if(dataLen < llHdl->rxThrSeen){
+					llHdl->rxThrSeen = dataLen;
+				}
+				latUs = (int32)(dataLen - llHdl->rxThrSeen);
+				latUs *= (MREAD_D8(llHdl->ma, Z146_RX_LCR_OFFSET) & Z146_RX_SPEED_MASK) ?
+						 Z146_WORD_US_HIGH : Z146_WORD_US_LOW;
+			}
+
 			/* Create buffer for the user data. */
 			for(i=0; i<dataLen; i++){
 
 				data = MREAD_D32(llHdl->ma, (Z146_RX_FIFO_START_ADDR + (i * 4)));
-				StoreInBuffer(llHdl, data);
 				IDBGWRT_1((DBH, ">>> LL - Z146_Irq: Rx Data word-%d = 0x%x\n",i, data));
+				if(Z146_LAB_GATED(llHdl, data)){
+					llHdl->labGated++;
+					continue;
+				}
+				StoreInBuffer(llHdl, data);
 
 			}
 
 			/* Acknowledge the data . */
 			MWRITE_D8(llHdl->ma, Z146_RX_RXA_OFFSET, dataLen);
+			/* the label change is complete when the FIFO was read once */
+			llHdl->labGate = 0;
 
 			/* FIFO is empty now send signal to the application. */
 			/* if requested send signal to application */
-			if (llHdl->rxDataSig){
-				OSS_SigSend(OSH, llHdl->rxDataSig);
+			for(i=0; i<Z146_READERS_MAX; i++){
+				if (llHdl->rxDataSig[i]){
+					OSS_SigSend(OSH, llHdl->rxDataSig[i]);
+				}
 			}
 
 			result = LL_IRQ_DEVICE ;
 
 		}
-		/* Enable the default interrupts */
-		MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, Z146_RX_IER_DEFAULT);
+		/* Enable the configured interrupts */
+		MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, llHdl->cfgIer);
 
+		IrqLatLog(llHdl, t0, dataLen, latUs);
 	}
 
 	return result;
@@ -1270,6 +1599,8 @@ static int32 Cleanup(
 	int32     retCode
 )
 {
+	u_int32 i = 0;
+
 	/*------------------------------+
 	|  close handles                |
 	+------------------------------*/
@@ -1283,6 +1614,17 @@ static int32 Cleanup(
     /* reset the default interrupts */
     MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, 0);
 
+	/* remove the data signals */
+	for (i = 0; i < Z146_READERS_MAX; i++) {
+		if (llHdl->rxDataSig[i])
+			OSS_SigRemove(llHdl->osHdl, &llHdl->rxDataSig[i]);
+	}
+
+	/* free the ring buffer */
+	if (llHdl->ringBuffer)
+		OSS_MemFree(llHdl->osHdl, (int8*)llHdl->ringBuffer, llHdl->ringAlloc);
+	llHdl->ringBuffer = NULL;
+
     /* Doesn't need to clear the rest of the configuration c */
 
 	/*return error code */
@@ -1292,7 +1634,8 @@ static int32 Cleanup(
 /**********************************************************************/
 /** Configure default values to registers.
  *
- *  Sets the controller registers to default values:
+ *  Sets the controller registers to the configuration read from the
+ *  descriptor by Z146_Init() (defaults if no keys are given):
  *  - all interrupt enabled
  *  - default timeout and receive settings
  *
@@ -1303,26 +1646,29 @@ static int32 Cleanup(
 static void
 ConfigureDefault( LL_HANDLE *llHdl )
 {
-    int i =0;
+    u_int32 i =0;
 
     /* Configure RX LCR */
-    MWRITE_D8(llHdl->ma, Z146_RX_LCR_OFFSET, Z146_RX_LCR_DEFAULT);
+    MWRITE_D8(llHdl->ma, Z146_RX_LCR_OFFSET, llHdl->cfgLcr);
 
     /* Configure RX FCR */
-    MWRITE_D8(llHdl->ma, Z146_RX_FCR_OFFSET, Z146_RX_FCR_DEFAULT);
+    MWRITE_D8(llHdl->ma, Z146_RX_FCR_OFFSET, llHdl->cfgFcr);
+    llHdl->rxThrSeen = Z146_RX_FIFO_LEN;
 
     /* Configure RX timeout */
-    MWRITE_D8(llHdl->ma, Z146_RX_TIMEOUT_OFFSET, Z146_RX_TIMEOUT_DEFAULT);
+    MWRITE_D8(llHdl->ma, Z146_RX_TIMEOUT_OFFSET, llHdl->cfgTimeout);
 
-    /* Enable the default interrupts */
-    MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, Z146_RX_IER_DEFAULT);
-
-    /* Reset the receive label. */
+    /* Set the receive labels, reset the unused ones. */
     for(i=0;i<Z146_RX_LA_SIZE;i++ ){
-    	MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET, Z146_RX_LA_DEFAULT);
+    	llHdl->laShadow[i] = (i < llHdl->cfgLabNum) ? llHdl->cfgLabel[i] : Z146_RX_LA_DEFAULT;
+    	MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + i, llHdl->laShadow[i]);
     }
-    /* Reset the receive label numbers. */
-    MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (Z146_RX_LA_NUM_DEFAULT &  Z146_RX_LA_NUM_MASK));
+    /* Set the receive label numbers. */
+    llHdl->laNum = llHdl->cfgLabNum;
+    MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (llHdl->laNum &  Z146_RX_LA_NUM_MASK));
+
+    /* Enable the configured interrupts */
+    MWRITE_D8(llHdl->ma, Z146_RX_IER_OFFSET, llHdl->cfgIer);
 
     /* Clear the error register. */
     MWRITE_D8(llHdl->ma, Z146_LSR_REG_OFFSET, 0xFF);
@@ -1332,33 +1678,280 @@ ConfigureDefault( LL_HANDLE *llHdl )
 }
 
 /**********************************************************************/
-/** Read data from the buffer.
+/** Read a numeric descriptor key with range check.
  *
- *  Read one word from the ring buffer.
+ *  \param llHdl      \IN  low-level handle
+ *  \param key        \IN  descriptor key
+ *  \param def        \IN  default value if the key is not present
+ *  \param min        \IN  minimum value
+ *  \param max        \IN  maximum value
+ *  \param valueP     \OUT value
+ *  \return           \c 0 on success or error code
+ */
+int32 DescGet(LL_HANDLE *llHdl, char *key, u_int32 def, u_int32 min,
+			  u_int32 max, u_int32 *valueP){
+	int32 error;
+
+	if ((error = DESC_GetUInt32(llHdl->descHdl, def, valueP, "%s", key)) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return (error);
+
+	if ((*valueP < min) || (*valueP > max)) {
+		DBGWRT_ERR((DBH, "*** %s: descriptor key %s=%d out of range\n",
+					DRV_NAME, key, *valueP));
+		return (ERR_LL_DESC_PARAM);
+	}
+	return (ERR_SUCCESS);
+}
+
+/**********************************************************************/
+/** Apply a complete line configuration.
+ *
+ *  All RX_LCR fields are written with one register access, so the
+ *  receiver never runs with a partial configuration. With cfg->flush the
+ *  data received so far is discarded: the FIFO is acknowledged, the line
+ *  status is cleared and the ring buffer is emptied, all with the
+ *  interrupt masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param cfg        \IN  line configuration
+ *  \return           \c 0 on success or error code
+ */
+int32 LineCfgSet(LL_HANDLE *llHdl, Z146_LINE_CFG *cfg){
+	OSS_IRQ_STATE irqState;
+	u_int8 regData = 0;
+	u_int32 i = 0;
+
+	if(cfg->sdi > Z146_RX_SDI_MAX){
+		return ERR_LL_ILL_PARAM;
+	}
+	regData = ((cfg->speed  ? 1 : 0) << Z146_RX_SPEED_OFFSET) |
+			  ((cfg->errWe  ? 1 : 0) << Z146_RX_ERR_WE_OFFSET) |
+			  ((cfg->parEn  ? 1 : 0) << Z146_RX_PAR_EN_OFFSET) |
+			  ((cfg->parTyp ? 1 : 0) << Z146_RX_PAR_TYP_OFFSET) |
+			  ((cfg->labEn  ? 1 : 0) << Z146_RX_LAB_EN_OFFSET) |
+			  ((cfg->sdiEn  ? 1 : 0) << Z146_RX_SDI_EN_OFFSET) |
+			  (cfg->sdi << Z146_RX_SDI_OFFSET);
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	MWRITE_D8(llHdl->ma, Z146_RX_LCR_OFFSET, regData);
+	if(!cfg->labEn){
+		llHdl->labGate = 0;
+	}
+	if(cfg->flush){
+		/* discard the words received with the old configuration */
+		MWRITE_D8(llHdl->ma, Z146_RX_RXA_OFFSET, MREAD_D8(llHdl->ma, Z146_RX_RXC_REG_OFFSET));
+		MWRITE_D8(llHdl->ma, Z146_LSR_REG_OFFSET, Z146_LSR_RESET_VAL);
+		llHdl->ringHead    = 0;
+		llHdl->ringTail    = 0;
+		llHdl->ringDataCnt = 0;
+		for(i=0; i<llHdl->rdNum; i++){
+			ReaderSyncLocked(llHdl, i);
+		}
+	}
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+	DBGWRT_1((DBH, "LL - Z146 LineCfgSet: LCR = 0x%x, flush = %d\n", regData, cfg->flush));
+	return ERR_SUCCESS;
+}
+
+/**********************************************************************/
+/** Add a receive label.
+ *
+ *  The label is written to the first unused register before the label
+ *  count is incremented, so the filter changes with one register write.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param label      \IN  label
+ *  \return           \c 0 on success or ERR_LL_WRITE if the table is full
+ */
+int32 LabelAdd(LL_HANDLE *llHdl, u_int8 label){
+	u_int32 t0 = Z146_TIMESTAMP(llHdl);
+	u_int32 i = 0;
+
+	for(i=0;i<llHdl->laNum;i++){
+		/* Check whether the label exists. */
+		if(llHdl->laShadow[i] == label){
+			DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_SET_LABEL = 0x%04x already exists in the list.\n", label));
+			return ERR_SUCCESS;
+		}
+	}
+	if(llHdl->laNum >= Z146_RX_LA_SIZE){
+		DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_SET_LABEL = 0x%04x; Error- label queue is full\n", label));
+		return ERR_LL_WRITE;
+	}
+
+	llHdl->laShadow[llHdl->laNum] = label;
+	MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + llHdl->laNum, label);
+	llHdl->laNum++;
+	MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (llHdl->laNum & Z146_RX_LA_NUM_MASK));
+
+	llHdl->labCfgUs = Z146_TIMESTAMP(llHdl) - t0;
+	DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_SET_LABEL = 0x%04x set @ %d position\n", label, llHdl->laNum - 1));
+	return ERR_SUCCESS;
+}
+
+/**********************************************************************/
+/** Remove a receive label.
+ *
+ *  The last label is moved into the place of the removed one before the
+ *  label count is decremented. The first write removes the label, the
+ *  second one only drops the duplicate of the moved label, so the filter
+ *  never misses a label which stays configured.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param label      \IN  label
+ *  \return           \c 0 on success or ERR_LL_WRITE if the table is empty
+ */
+int32 LabelRemove(LL_HANDLE *llHdl, u_int8 label){
+	u_int32 t0 = Z146_TIMESTAMP(llHdl);
+	u_int32 last = 0;
+	u_int32 i = 0;
+
+	if(llHdl->laNum == 0){
+		DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_RESET_LABEL = 0x%04x; Error- label queue is empty\n", label));
+		return ERR_LL_WRITE;
+	}
+	for(i=0;i<llHdl->laNum;i++){
+		if(llHdl->laShadow[i] == label){
+			break;
+		}
+	}
+	if(i == llHdl->laNum){
+		/* not configured, nothing to do */
+		return ERR_SUCCESS;
+	}
+
+	last = llHdl->laNum - 1;
+	if(i != last){
+		llHdl->laShadow[i] = llHdl->laShadow[last];
+		MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + i, llHdl->laShadow[i]);
+	}
+	llHdl->laNum = last;
+	MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (llHdl->laNum & Z146_RX_LA_NUM_MASK));
+	llHdl->laShadow[last] = Z146_RX_LA_DEFAULT;
+	MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + last, Z146_RX_LA_DEFAULT);
+
+	llHdl->labCfgUs = Z146_TIMESTAMP(llHdl) - t0;
+	DBGWRT_1((DBH, "LL - Z146_SetStat:Z146_RX_RESET_LABEL : New label count set to = %d\n", llHdl->laNum));
+	return ERR_SUCCESS;
+}
+
+/**********************************************************************/
+/** Replace the complete receive label list.
+ *
+ *  An arbitrary change of the label list needs several register writes.
+ *  To make it atomic for the receiver, the words already received are
+ *  moved to the ring buffer first (interrupt mode only), then the new
+ *  list is enabled in a software filter and the hardware filter is opened
+ *  while the registers are rewritten. Words received in this window are
+ *  filtered by the driver until the FIFO has been read once. With the
+ *  label filter disabled (RX_LCR LAB_EN = 0) only the registers are
+ *  written.
  *
  *  \param llHdl      \IN  low-level handle
- *  \param result     \OUT result of the operation; 0 on success and -1 on error
- *  \return           \OUT uint32 data
+ *  \param labels     \IN  new labels
+ *  \param num        \IN  number of labels (<= Z146_RX_LA_SIZE)
  */
-u_int32 ReadFromBuffer( LL_HANDLE *llHdl, int8 * result){
+void LabelCommit(LL_HANDLE *llHdl, u_int8 *labels, u_int32 num){
+	OSS_IRQ_STATE irqState;
+	u_int32 t0 = 0;
+	u_int32 i = 0;
+	u_int8 lcr = 0;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	t0 = Z146_TIMESTAMP(llHdl);
+
+	/* words received with the old list */
+	if(llHdl->cfgIer & Z146_RX_RXCIEN_MASK){
+		RxDrain(llHdl);
+	}
+
+	/*
+	 * Stage the new list in the software filter. Without LAB_EN the
+	 * receiver passes all labels, so the software filter stays off.
+	 */
+	lcr = MREAD_D8(llHdl->ma, Z146_RX_LCR_OFFSET);
+	if(lcr & Z146_RX_LAB_EN_MASK){
+		for(i=0;i<8;i++){
+			llHdl->labGateMap[i] = 0;
+		}
+		for(i=0;i<num;i++){
+			llHdl->labGateMap[labels[i] >> 5] |= (1 << (labels[i] & 0x1F));
+		}
+		llHdl->labGate = 1;
+
+		/* open the hardware filter while the registers are inconsistent */
+		MWRITE_D8(llHdl->ma, Z146_RX_LCR_OFFSET, lcr & ~Z146_RX_LAB_EN_MASK);
+	}
+	for(i=0;i<Z146_RX_LA_SIZE;i++){
+		llHdl->laShadow[i] = (i < num) ? labels[i] : Z146_RX_LA_DEFAULT;
+		MWRITE_D8(llHdl->ma, Z146_RX_LA_OFFSET + i, llHdl->laShadow[i]);
+	}
+	llHdl->laNum = num;
+	MWRITE_D8(llHdl->ma, Z146_RX_LA_NUM_OFFSET, (num & Z146_RX_LA_NUM_MASK));
+	if(lcr & Z146_RX_LAB_EN_MASK){
+		MWRITE_D8(llHdl->ma, Z146_RX_LCR_OFFSET, lcr);
+	}
 
+	llHdl->labCfgUs = Z146_TIMESTAMP(llHdl) - t0;
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+	DBGWRT_1((DBH, "LL - Z146 LabelCommit: %d labels, %d us\n", num, llHdl->labCfgUs));
+}
+
+/**********************************************************************/
+/** Move the words in the FIFO to the ring buffer.
+ *
+ *  Must be called with the interrupt masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ */
+void RxDrain(LL_HANDLE *llHdl){
+	u_int32 dataLen = MREAD_D8(llHdl->ma, Z146_RX_RXC_REG_OFFSET);
 	u_int32 data = 0;
-	/* if the head isn't ahead of the tail, we don't have any characters */
-	if ((llHdl->ringHead == llHdl->ringTail) || (llHdl->ringDataCnt == 0)) {
-		data = 0;        /* quit with an error */
-		*result = -1;
-		DBGWRT_1((DBH, " >>  LL - Z146: ReadFromBuffer either llHdl->ringHead(0x%lx) == llHdl->ringTail(0x%lx), or llHdl->ringDataCnt[%d] == 0\n", llHdl->ringHead == llHdl->ringTail, llHdl->ringDataCnt));
-	} else {
-		data = llHdl->ringBuffer[llHdl->ringTail];
-		llHdl->ringTail = (unsigned int)(llHdl->ringTail + 1) % Z146_MAX_BUFF_SIZE;
-		llHdl->ringDataCnt--;
-		*result = 0;
+	u_int32 i = 0;
+
+	for(i=0; i<dataLen; i++){
+		data = MREAD_D32(llHdl->ma, (Z146_RX_FIFO_START_ADDR + (i * 4)));
+		if(Z146_LAB_GATED(llHdl, data)){
+			llHdl->labGated++;
+			continue;
+		}
+		StoreInBuffer(llHdl, data);
 	}
-	return data;
+	MWRITE_D8(llHdl->ma, Z146_RX_RXA_OFFSET, dataLen);
+}
+
+/**********************************************************************/
+/** Copy words from the ring buffer.
+ *
+ *  The words are copied in at most two blocks. The ring indices are not
+ *  changed, this is up to the caller.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param idx        \IN  ring index of the first word
+ *  \param buf        \OUT destination
+ *  \param num        \IN  number of words (<= ring size)
+ *  \return           ring index after the last word
+ */
+u_int32 RingCopy(LL_HANDLE *llHdl, u_int32 idx, u_int32 *buf, u_int32 num){
+	u_int32 first = llHdl->ringSize - idx;
+
+	if (first > num)
+		first = num;
+	OSS_MemCopy(OSH, first * sizeof(u_int32),
+				(char*)&llHdl->ringBuffer[idx], (char*)buf);
+	if (num > first)
+		OSS_MemCopy(OSH, (num - first) * sizeof(u_int32),
+					(char*)llHdl->ringBuffer, (char*)(buf + first));
+	return (idx + num) % llHdl->ringSize;
 }
 
 /**********************************************************************/
 /** Store data in the ring buffer.
+ *
+ *  If the ring buffer is full, the word is discarded or the oldest word is
+ *  overwritten, according to the overflow policy.
  *
  *  \param llHdl      \IN low-level handle
  *  \param data       \IN uint32 data
@@ -1367,18 +1960,205 @@ u_int32 ReadFromBuffer( LL_HANDLE *llHdl, int8 * result){
 int8 StoreInBuffer( LL_HANDLE *llHdl , u_int32 data){
 
 	int8 result = 0;
-	unsigned int next = (unsigned int)(llHdl->ringHead + 1) % Z146_MAX_BUFF_SIZE;
-	if (next != llHdl->ringTail)
+	unsigned int next = (unsigned int)(llHdl->ringHead + 1) % llHdl->ringSize;
+	if (llHdl->rdNum)
+	{
+		/* broadcast mode: the readers detect overwritten words themselves */
+		llHdl->ringBuffer[llHdl->ringHead] = data;
+		llHdl->ringHead = next;
+		llHdl->rxSeq++;
+		llHdl->statStored++;
+	}else if (next != llHdl->ringTail)
 	{
 		llHdl->ringBuffer[llHdl->ringHead] = data;
 		llHdl->ringHead = next;
 		llHdl->ringDataCnt++;
+		llHdl->statStored++;
+		if(llHdl->ringDataCnt > llHdl->statMaxDepth)
+			llHdl->statMaxDepth = llHdl->ringDataCnt;
+	}else if(llHdl->overflowPolicy == Z146_OVERFLOW_DROP_OLD){
+		/* drop the oldest word */
+		llHdl->ringTail = (unsigned int)(llHdl->ringTail + 1) % llHdl->ringSize;
+		llHdl->ringBuffer[llHdl->ringHead] = data;
+		llHdl->ringHead = next;
+		llHdl->ringDropped++;
+		llHdl->statStored++;
+		result = -1;
 	}else{
+		llHdl->statRejected++;
 		result = -1;
 	}
 	return result;
 }
 
+/**********************************************************************/
+/** Get the words available for a reader in broadcast mode.
+ *
+ *  If the interrupt has overwritten words the reader did not read yet,
+ *  the cursor is moved to the oldest word still in the ring buffer and
+ *  the lost words are added to the overrun count of the reader.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param rd         \IN  reader (channel)
+ *  \return           number of words available
+ */
+u_int32 ReaderAvail(LL_HANDLE *llHdl, u_int32 rd){
+	u_int32 avail = RxSeqGet(llHdl) - llHdl->rdSeq[rd];
+	u_int32 lost = 0;
+
+	/* the oldest word may be overwritten by the next interrupt */
+	if (avail >= llHdl->ringSize) {
+		lost = avail - llHdl->ringSize + 1;
+		llHdl->rdOverrun[rd] += lost;
+		llHdl->rdSeq[rd] += lost;
+		llHdl->rdIdx[rd] = (llHdl->rdIdx[rd] + lost) % llHdl->ringSize;
+		avail -= lost;
+	}
+	return avail;
+}
+
+/**********************************************************************/
+/** Read words for a reader in broadcast mode.
+ *
+ *  The words are copied without masking the interrupt, the word count
+ *  is read before and after the copy by RxSeqGet(). Words which were
+ *  overwritten during the copy are removed from the buffer afterwards
+ *  and counted as overrun.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param rd         \IN  reader (channel)
+ *  \param buf        \OUT user buffer
+ *  \param max        \IN  size of buf in words
+ *  \return           number of words read
+ */
+u_int32 ReaderRead(LL_HANDLE *llHdl, u_int32 rd, u_int32 *buf, u_int32 max){
+	u_int32 num = ReaderAvail(llHdl, rd);
+	u_int32 idx = llHdl->rdIdx[rd];
+	u_int32 behind = 0;
+	u_int32 lost = 0;
+	u_int32 i = 0;
+
+	if (num > max)
+		num = max;
+	idx = RingCopy(llHdl, idx, buf, num);
+
+	/* words overwritten while copying */
+	behind = RxSeqGet(llHdl) - llHdl->rdSeq[rd];
+	if (behind >= llHdl->ringSize) {
+		lost = behind - llHdl->ringSize + 1;
+		if (lost > num)
+			lost = num;
+		for (i = lost; i < num; i++)
+			buf[i - lost] = buf[i];
+		llHdl->rdOverrun[rd] += lost;
+	}
+
+	llHdl->rdSeq[rd] += num;
+	llHdl->rdIdx[rd] = idx;
+	return num - lost;
+}
+
+/**********************************************************************/
+/** Move a reader to the newest word in broadcast mode.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param rd         \IN  reader (channel)
+ */
+void ReaderSync(LL_HANDLE *llHdl, u_int32 rd){
+	OSS_IRQ_STATE irqState;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	ReaderSyncLocked(llHdl, rd);
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+}
+
+/**********************************************************************/
+/** Move a reader to the newest word, interrupt already masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param rd         \IN  reader (channel)
+ */
+void ReaderSyncLocked(LL_HANDLE *llHdl, u_int32 rd){
+	llHdl->rdSeq[rd]     = llHdl->rxSeq;
+	llHdl->rdIdx[rd]     = llHdl->ringHead;
+	llHdl->rdOverrun[rd] = 0;
+}
+
+/**********************************************************************/
+/** Get the number of words stored in broadcast mode.
+ *
+ *  The interrupt stores the word in the ring buffer before it increments
+ *  rxSeq. The count is read with the interrupt masked, the lock orders
+ *  the ring buffer stores of the interrupt before the reader's copy on
+ *  SMP systems. Do not call with the interrupt masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \return           words stored since init
+ */
+u_int32 RxSeqGet(LL_HANDLE *llHdl){
+	OSS_IRQ_STATE irqState;
+	u_int32 seq = 0;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	seq = llHdl->rxSeq;
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+	return seq;
+}
+
+/**********************************************************************/
+/** Log one interrupt in the instrumentation counters.
+ *
+ *  Called at the end of the ISR, the execution time includes everything
+ *  since t0 was taken at ISR entry.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param t0         \IN  Z146_TIMESTAMP() at ISR entry
+ *  \param words      \IN  words handled
+ *  \param latUs      \IN  time from FIFO threshold to ISR entry [us],
+ *                         -1 if not a threshold interrupt
+ */
+void IrqLatLog(LL_HANDLE *llHdl, u_int32 t0, u_int32 words, int32 latUs){
+	u_int32 durUs = Z146_TIMESTAMP(llHdl) - t0;
+
+	llHdl->irqCnt++;
+	llHdl->irqWords += words;
+	if(words > llHdl->irqMaxWords){
+		llHdl->irqMaxWords = words;
+	}
+	llHdl->irqWordsHist[HistBin(words)]++;
+
+	llHdl->irqDurSumUs += durUs;
+	if(durUs > llHdl->irqDurMaxUs){
+		llHdl->irqDurMaxUs = durUs;
+	}
+	llHdl->irqDurHist[HistBin(durUs)]++;
+
+	if(latUs >= 0){
+		llHdl->irqLatNum++;
+		llHdl->irqLatSumUs += (u_int32)latUs;
+		if((u_int32)latUs > llHdl->irqLatMaxUs){
+			llHdl->irqLatMaxUs = (u_int32)latUs;
+		}
+		llHdl->irqLatHist[HistBin((u_int32)latUs)]++;
+	}
+}
+
+/**********************************************************************/
+/** Histogram bin of a value.
+ *
+ *  \param value      \IN  value
+ *  \return           0 for 0, n for 2^(n-1)..2^n-1, last bin for larger values
+ */
+u_int32 HistBin(u_int32 value){
+	u_int32 bin = 0;
+
+	while((value != 0) && (bin < (Z146_IRQ_BINS - 1))){
+		value >>= 1;
+		bin++;
+	}
+	return bin;
+}
+
 /**********************************************************************/
 /** Print register configuration.
  *
@@ -41,6 +41,7 @@
 #include <MEN/mdis_com.h>    /* MDIS common defs               */
 #include <MEN/mdis_err.h>    /* MDIS error codes               */
 #include <MEN/ll_defs.h>     /* low-level driver definitions   */
+#include <MEN/z146_regs.h>   /* register map                   */
 
 /*-----------------------------------------+
 |  DEFINES                                 |
@@ -59,53 +60,124 @@
 #define RESET_DEFAULT      0          /**< default arwen reset (enabled)     */
 #define RESET_OFF          1          /**< disables the arwen reset function */
 
-#define Z246_TX_IIR_OFFSET		0x400		/**< Offset of the TX_IIR register */
-#define Z246_TX_TXC_OFFSET		0x403		/**< Offset of the TX_TXC register */
-#define Z246_TX_TXA_OFFSET	    0x404		/**< Offset of the TX_TXA register */
-#define Z246_TX_IER_OFFSET	    0x408		/**< Offset of the TX_IER register */
-#define Z246_TX_IER_DEFAULT	    0x0         /**< Offset of the TX_LA register */
-#define Z246_TX_IRQ_MASK    	0x1			/**< Transmit IRQ mask. */
-
-#define Z246_TX_LCR_OFFSET		0x409		/**< Offset of the TX_LCR register */
-#define Z246_TX_SPEED_OFFSET	0			/**< Offset of the TX_LCR SPEED bit */
-#define Z246_TX_SPEED_MASK  	0x01		/**< MASK of the TX_LCR SPEED bit */
-#define Z246_TX_LOOP_OFFSET		1			/**< Offset of the TX_LCR LOOP bit */
-#define Z246_TX_LOOP_MASK  		0x02		/**< MASK of the TX_LCR LOOP bit */
-#define Z246_TX_PAR_EN_OFFSET	2			/**< Offset of the TX_LCR PAR_EN bit */
-#define Z246_TX_PAR_EN_MASK  	0x04		/**< MASK of the TX_LCR PAR_EN bit */
-#define Z246_TX_PAR_TYP_OFFSET	3			/**< Offset of the TX_LCR PAR_TYP bit */
-#define Z246_TX_PAR_TYP_MASK  	0x08		/**< MASK of the TX_LCR PAR_TYP bit */
-#define Z246_TX_SDI_EN_OFFSET	5			/**< Offset of the TX_LCR SDI_EN bit */
-#define Z246_TX_SDI_EN_MASK  	0x20		/**< MASK of the TX_LCR SDI_EN bit */
-#define Z246_TX_SDI_OFFSET	    6			/**< Offset of the TX_LCR SDI_EN bit */
-#define Z246_TX_SDI_MASK    	0xC0		/**< MASK of the TX_LCR SDI bit */
-#define Z146_TX_SDI_MAX    	    0x03		/**< TX_LCR SDI max value */
-
-#define Z246_LCR_PAR_MASK		0x04
-#define Z246_LCR_SDI_MASK		0x20
-
-#define Z246_TX_LCR_DEFAULT		0x05		/**< Offset of the TX_LCR register */
-
-#define Z246_TX_FCR_OFFSET		0x40A		/**< Offset of the TX_FCR register */
-#define Z246_TX_FCR_DEFAULT 	0x6			/**< Default of the TX_FCR register */
-#define Z246_TX_FCR_MASK    	0x7			/**< Mask of the TX_FCR register */
-
-#define Z246_TX_LA_OFFSET		0x40B		/**< Default of the TX_IER register */
-#define Z246_TX_LA_DEFAULT		0x0			/**< Default of the TX_LA register */
-
-#define Z246_FIFO_START_ADDR    0x000		/**< Start address of the hardware FIFO of the transmitter. */
-#define Z246_TX_FIFO_MAX 		255			/**< Size of the hardware FIFO of the transmitter. */
-
-#define Z246_24_BIT_MASK			0xFFFFFF
-#define Z246_23_BIT_MASK			0x7FFFFF
-#define Z246_22_BIT_MASK			0x3FFFFF
-#define Z246_21_BIT_MASK			0x1FFFFF
-
-#define Z246_MAX_BUFF_SIZE			4097	/**< 4096 + 1 to avoid buffer overflow. */
-#define Z246_RING_SIZE_DEFAULT		0
+#define Z246_THR_AUTO_WINDOW	32			/**< refill IRQs per automatic threshold evaluation */
+#define Z246_THR_AUTO_MARGIN	4			/**< FIFO reserve [words] above which the threshold is lowered */
+
+#define Z246_WORD_US_HIGH		360			/**< time per word at 100 kHz incl. 4 bit gap [us] */
+#define Z246_WORD_US_LOW		2880		/**< time per word at 12.5 kHz incl. 4 bit gap [us] */
+
+#define DRV_NAME           "Z246"     /**< driver name for messages */
+
+#define Z246_RING_SIZE_DEFAULT		4096	/**< default size of the bulk queue in words */
+#define Z246_RING_SIZE_MIN			256		/**< min. size of the bulk queue in words */
+#define Z246_RING_SIZE_MAX			65536	/**< max. size of the bulk queue in words */
+#define Z246_URG_SIZE_DEFAULT		256		/**< default size of the urgent queue in words */
+#define Z246_URG_SIZE_MIN			16		/**< min. size of the urgent queue in words */
+#define Z246_URG_SIZE_MAX			4096	/**< max. size of the urgent queue in words */
+
+#define Z246_PRIO_LOW				0		/**< bulk traffic queue */
+#define Z246_PRIO_HIGH				1		/**< urgent traffic queue */
+#define Z246_PRIO_NUM				2		/**< number of TX queues */
+
+#define Z246_TX_LOW_RESERVE_DEFAULT	16		/**< FIFO words kept for bulk traffic per refill */
+
+#define Z246_TX_RATE_BURST_DEFAULT	32		/**< token bucket depth in words */
+#define Z246_TX_RATE_MAX			1000000	/**< max. rate limit in words per second */
+
+#define Z246_WRITERS_MAX			8		/**< max. writer channels with own rate limit */
+/** writer of a channel, all channels share writer 0 if TX_WRITERS is 0 */
+#define Z246_WRITER(llHdl, ch)		((llHdl)->wrNum ? (u_int32)(ch) : 0)
+
+#define Z246_TIMED_SLOTS			8		/**< pending timed bursts */
+#define Z246_TIMED_MAX_WORDS		64		/**< words per timed burst */
+#define Z246_TIMED_RES_NUM			16		/**< logged timed burst results */
+
+#define Z246_URG_MARKS				32		/**< urgent bursts with their own time stamp */
+#define Z246_RESV_SLOTS				16		/**< open reservations per TX queue */
+
+#define Z246_IRQ_BINS				16		/**< histogram bins, see Z246_IRQLAT_BINS */
+
+#ifndef Z246_TIMESTAMP
+# if defined(LINUX) && defined(__KERNEL__)
+#  include <linux/ktime.h>
+/** time stamp in us for driver measurements (monotonic clock) */
+#  define Z246_TIMESTAMP(llHdl)	((u_int32)ktime_to_us(ktime_get()))
+# else
+/** time stamp in us for driver measurements; should be defined to a
+ *  fine clock of the target, the fallback has tick resolution */
+#  define Z246_TIMESTAMP(llHdl)	((u_int32)OSS_TickGet((llHdl)->osHdl) * (llHdl)->tickUs)
+#  define Z246_TIMESTAMP_RES(llHdl)	((llHdl)->tickUs)
+# endif
+#endif
+#ifndef Z246_TIMESTAMP_RES
+/** resolution of a Z246_TIMESTAMP defined for the target [us] */
+#define Z246_TIMESTAMP_RES(llHdl)	1
+#endif
+
+/** Data encoding loop, masks a burst of words for the current line configuration */
+typedef void (*Z246_ENCODE_FUNC)(u_int32 *dst, const u_int32 *src, u_int32 len);
 /*-----------------------------------------+
 |  TYPEDEFS                                |
 +-----------------------------------------*/
+/** reservation of a writer in a TX queue */
+typedef struct {
+	u_int32					len;			/**< reserved words */
+	u_int32					ready;			/**< data copied, may be committed */
+} Z246_RESV;
+
+/** TX queue (ring buffer) */
+typedef struct {
+	u_int32					*buf;			/**< ring buffer */
+	u_int32					size;			/**< ring buffer size in words */
+	volatile u_int32		head;			/**< write index (committed words) */
+	volatile u_int32		tail;			/**< read index */
+	volatile u_int32		cnt;			/**< committed words in the ring buffer */
+	volatile u_int32		resv;			/**< reservation index */
+	volatile u_int32		resvCnt;		/**< reserved, not yet committed words */
+	Z246_RESV				slot[Z246_RESV_SLOTS];	/**< open reservations, oldest first */
+	u_int32					slotFirst;		/**< oldest open reservation */
+	u_int32					slotNum;		/**< open reservations */
+} Z246_QUEUE;
+
+/** token bucket of a TX queue */
+typedef struct {
+	u_int32					rate;			/**< words per second, 0 = unlimited */
+	u_int32					credit;			/**< available words * tickRate */
+	u_int32					tick;			/**< tick of the last refill */
+	u_int32					held;			/**< queued words already counted as throttled */
+} Z246_RATE;
+
+/** token bucket of a writer channel */
+typedef struct {
+	u_int32					rate;			/**< words per second, 0 = unlimited */
+	int32					credit;			/**< available words * tickRate, < 0 = debt */
+	u_int32					tick;			/**< tick of the last refill */
+} Z246_WR_RATE;
+
+/** burst in the urgent queue */
+typedef struct {
+	u_int32					end;			/**< urgent word sequence number after the burst */
+	u_int32					len;			/**< number of words */
+	u_int32					tUs;			/**< Z246_TIMESTAMP() of the submission */
+	u_int32					timed;			/**< words of a timed burst, 0 = not timed */
+	u_int32					tick;			/**< timed burst: requested release tick */
+	u_int32					lateUs;			/**< timed burst: release tick - requested tick [us] */
+} Z246_URG_MARK;
+
+/** timed burst */
+typedef struct {
+	u_int32					tick;			/**< release tick */
+	u_int32					len;			/**< number of words */
+	u_int32					data[Z246_TIMED_MAX_WORDS];
+} Z246_TIMED;
+
+/** result of a released timed burst */
+typedef struct {
+	u_int32					tick;			/**< requested release tick */
+	int32					errUs;			/**< release error [us] */
+	u_int32					len;			/**< number of words */
+} Z246_TIMED_LOG;
+
 /** low-level handle */
 typedef struct {
 	/* general */
@@ -125,11 +197,82 @@ typedef struct {
 	OSS_ALARM_HANDLE        *alarmHdl;      /**< alarm handle               */
 	OSS_SEM_HANDLE          *devSemHdl;     /**< device semaphore handle    */
 
-	/* Ring buffer parameters */
-	u_int32					ringBuffer[Z246_MAX_BUFF_SIZE];
-	volatile u_int32	    ringHead;
-	volatile u_int32 		ringTail;
-	volatile u_int32 		ringDataCnt;
+	/* TX queues, index Z246_PRIO_xxx */
+	u_int32					*ringBuffer;	/**< bulk queue buffer */
+	u_int32					ringAlloc;		/**< bytes allocated for ringBuffer */
+	u_int32					*urgBuffer;		/**< urgent queue buffer */
+	u_int32					urgAlloc;		/**< bytes allocated for urgBuffer */
+	Z246_QUEUE				txq[Z246_PRIO_NUM];
+	u_int32					txLowReserve;	/**< FIFO words kept for bulk traffic */
+	Z246_URG_MARK			urgMark[Z246_URG_MARKS];	/**< queued urgent bursts, oldest first */
+	u_int32					urgMarkFirst;	/**< oldest entry of urgMark */
+	u_int32					urgMarkNum;		/**< entries in urgMark */
+	u_int32					urgSeqIn;		/**< urgent words reserved since init */
+	u_int32					urgSeqOut;		/**< urgent words taken from the queue since init */
+	u_int32					tickRate;		/**< OSS ticks per second */
+	u_int32					tickUs;			/**< OSS tick period [us], 0 = unknown */
+
+	/* TX rate limits, index Z246_PRIO_xxx */
+	Z246_RATE				txRate[Z246_PRIO_NUM];
+	u_int32					txRateBurst;	/**< token bucket depth in words */
+	u_int32					txRateRetryMs;	/**< retry time of throttled data, 0 = not throttled */
+	u_int32					wrNum;			/**< writer channels, 0 = one shared writer */
+	Z246_WR_RATE			wrRate[Z246_WRITERS_MAX];	/**< rate limit per writer */
+
+	/* timed transmission */
+	Z246_TIMED				timed[Z246_TIMED_SLOTS];
+	u_int8					timedOrder[Z246_TIMED_SLOTS];	/**< slots, pending ones sorted by tick */
+	u_int32					timedCnt;		/**< pending timed bursts */
+	Z246_TIMED_LOG			timedLog[Z246_TIMED_RES_NUM];
+	u_int32					timedLogHead;	/**< next log entry to write */
+	u_int32					timedLogCnt;	/**< unread log entries */
+
+	/* configuration from the descriptor, applied by ConfigureDefault() */
+	u_int8					cfgLcr;			/**< TX_LCR */
+	u_int8					cfgLabel;		/**< TX_LA */
+	u_int8					cfgThrLev;		/**< TX_FCR threshold level */
+
+	/* TX encoding, updated on line configuration changes */
+	u_int32					txMask;			/**< data bit mask of the current configuration */
+	Z246_ENCODE_FUNC		txEncode;		/**< burst encoding loop for txMask */
+	u_int32					txStage[Z246_TX_FIFO_MAX];	/**< encoded burst for the FIFO */
+	u_int32					txWordUs;		/**< time per word on the bus [us] */
+
+	/* automatic TX threshold */
+	u_int32					thrAuto;		/**< automatic threshold enabled */
+	u_int32					thrLevel;		/**< current TX_FCR threshold level */
+	u_int32					thrIrqCnt;		/**< refill IRQs in the current window */
+	u_int32					thrMinMarginUs;	/**< min. refill margin in the current window [us] */
+	u_int8					thrLevSeen[Z246_TX_FCR_MASK + 1];	/**< max. FIFO level at a refill interrupt per level */
+
+	/* TX statistics, see Z246_TX_STATS */
+	u_int32					txAccepted;		/**< words accepted by Z246_BlockWrite */
+	u_int32					txDirectWords;	/**< words written directly from the user buffer */
+	u_int32					txRingWords;	/**< words written from the ring buffer */
+	u_int32					txRefillIrqs;	/**< refill interrupts */
+	u_int32					txUnderruns;	/**< HwWrite underrun returns */
+	u_int32					txOverflows;	/**< rejected writes */
+	u_int32					txMaxRingDepth;	/**< max. words in the ring buffer */
+	u_int32					txMinFifoFree;	/**< min. observed free FIFO space */
+	u_int32					txIdleGaps;		/**< refills after the FIFO ran empty */
+	u_int32					txMinMarginUs;	/**< min. FIFO reserve at refill [us] */
+	u_int32					txUrgentWords;	/**< urgent words written to the FIFO */
+	u_int32					txUrgMaxLatUs;	/**< max. urgent word latency [us] */
+	u_int32					txThrottled;	/**< words held back or rejected by the rate limits */
+	u_int32					txStatsTick;	/**< tick of the last statistics reset */
+
+	/* interrupt instrumentation, see Z246_IRQLAT */
+	u_int32					irqCnt;			/**< interrupts handled */
+	u_int32					irqWords;		/**< words handled */
+	u_int32					irqMaxWords;	/**< max. words per interrupt */
+	u_int32					irqDurMaxUs;	/**< max. ISR execution time [us] */
+	u_int32					irqDurSumUs;	/**< sum of the ISR execution times [us] */
+	u_int32					irqLatNum;		/**< interrupts with a threshold latency */
+	u_int32					irqLatMaxUs;	/**< max. threshold latency [us] */
+	u_int32					irqLatSumUs;	/**< sum of the threshold latencies [us] */
+	u_int32					irqDurHist[Z246_IRQ_BINS];
+	u_int32					irqWordsHist[Z246_IRQ_BINS];
+	u_int32					irqLatHist[Z246_IRQ_BINS];
 
 } LL_HANDLE;
 
@@ -137,6 +280,10 @@ typedef struct {
 #include <MEN/ll_entry.h>       /* low-level driver jump table */
 #include <MEN/z246_drv.h>        /* Z246 driver header file      */
 
+#if Z246_IRQ_BINS != Z246_IRQLAT_BINS
+#error "Z246_IRQ_BINS must match Z246_IRQLAT_BINS"
+#endif
+
 /*-----------------------------------------+
 |  PROTOTYPES                              |
 +-----------------------------------------*/
@@ -162,9 +309,43 @@ static char* Ident(void);
 static int32 Cleanup(LL_HANDLE *llHdl, int32 retCode);
 static void  ConfigureDefault( LL_HANDLE *llHdl );
 static int HwWrite(LL_HANDLE    *llHdl);
+static int32 TxSubmit(LL_HANDLE *llHdl, u_int32 wr, u_int32 prio, u_int32 *data,
+					  u_int32 len);
+static u_int32 DirectWrite(LL_HANDLE *llHdl, u_int32 prio, u_int32 *data, u_int32 len);
+static int32 TxIdle(LL_HANDLE *llHdl);
+static void QueueCopy(Z246_QUEUE *q, u_int32 start, u_int32 *data, u_int32 len);
+static void QueueAppend(Z246_QUEUE *q, u_int32 *data, u_int32 len);
+static u_int32 QueueCommit(Z246_QUEUE *q);
+static int32 QueueEncode(LL_HANDLE *llHdl, Z246_QUEUE *q, u_int32 *dst, u_int32 len);
+static void UrgentLatency(LL_HANDLE *llHdl, u_int32 queuedUs, u_int32 fifoWords);
+static Z246_URG_MARK *UrgMarkPush(LL_HANDLE *llHdl, u_int32 len, u_int32 tUs);
+static void UrgMarkTake(LL_HANDLE *llHdl, u_int32 num, u_int32 fifoWords);
+static int32 TimedSubmit(LL_HANDLE *llHdl, u_int32 tick, u_int32 *data, u_int32 len);
+static u_int32 TimedRelease(LL_HANDLE *llHdl);
+static void TimedLog(LL_HANDLE *llHdl, Z246_URG_MARK *m, int32 errUs);
+static void TxAlarmArm(LL_HANDLE *llHdl);
+static void TxAlarm(void *arg);
+static u_int32 RateTake(LL_HANDLE *llHdl, u_int32 prio, u_int32 want);
+static void RateSet(LL_HANDLE *llHdl, u_int32 prio, u_int32 rate);
+static int32 WrRateTake(LL_HANDLE *llHdl, u_int32 wr, u_int32 len);
+static void WrRateSet(LL_HANDLE *llHdl, u_int32 wr, u_int32 rate);
+static u_int32 BusUtil(LL_HANDLE *llHdl);
+static int32 LineCfgSet(LL_HANDLE *llHdl, Z246_LINE_CFG *cfg);
+static int32 DescGet(LL_HANDLE *llHdl, char *key, u_int32 def, u_int32 min,
+					 u_int32 max, u_int32 *valueP);
+static void UpdateTxEncoding(LL_HANDLE *llHdl);
+static void FifoWrite(LL_HANDLE *llHdl, u_int32 len);
+static void TxFifoFree(LL_HANDLE *llHdl, u_int32 fifoFree);
+static void ThrAutoUpdate(LL_HANDLE *llHdl, u_int32 reserve, u_int32 refillUs);
+static void ThrLevelSet(LL_HANDLE *llHdl, u_int32 level);
+static void Encode24(u_int32 *dst, const u_int32 *src, u_int32 len);
+static void Encode23(u_int32 *dst, const u_int32 *src, u_int32 len);
+static void Encode22(u_int32 *dst, const u_int32 *src, u_int32 len);
+static void Encode21(u_int32 *dst, const u_int32 *src, u_int32 len);
 static void RegStatus(LL_HANDLE *llHdl );
-static u_int32 ReadFromBuffer( LL_HANDLE *llHdl, int8 * result);
-static int8 StoreInBuffer( LL_HANDLE *llHdl , u_int32 data);
+static void IrqLatLog(LL_HANDLE *llHdl, u_int32 t0, u_int32 words,
+					  int32 latUs);
+static u_int32 HistBin(u_int32 value);
 
 
 /****************************** Z246_GetEntry ********************************/
@@ -208,6 +389,19 @@ extern void __Z246_GetEntry(
  * DEBUG_LEVEL_DESC      OSS_DBG_DEFAULT  see dbg.h
  * DEBUG_LEVEL           OSS_DBG_DEFAULT  see dbg.h
  * ID_CHECK              1                0..1
+ * TX_SPEED              1                0..1 (0 = 12.5 kHz, 1 = 100 kHz)
+ * TX_LOOP               0                0..1
+ * TX_PAR_EN             1                0..1
+ * TX_PAR_TYP            0                0..1
+ * TX_SDI_EN             0                0..1
+ * TX_SDI                0                0..3
+ * TX_LABEL              0                0..0xFF
+ * TX_THR_LEV            6                0..7
+ * TX_THR_AUTO           0                0..1
+ * TX_RING_SIZE          4096             256..65536 words
+ * TX_URG_SIZE           256              16..4096 words
+ * TX_LOW_RESERVE        16               0..255 words
+ * TX_WRITERS            0                0..8 (0 = one shared writer)
  * \endcode
  *
  *  \param descP      \IN  pointer to descriptor data
@@ -232,6 +426,7 @@ static int32 Z246_Init(
 	u_int32 gotsize;
 	int32 error;
 	u_int32 value;
+	u_int32 speed, loop, parEn, parTyp, sdiEn, sdi;
 
 	/*------------------------------+
 	|  prepare the handle           |
@@ -252,9 +447,17 @@ static int32 Z246_Init(
 	llHdl->irqHdl      = irqHdl;
 	llHdl->ma          = *ma;
 	llHdl->devSemHdl   = devSemHdl;
-	llHdl->ringTail    = Z246_RING_SIZE_DEFAULT;
-	llHdl->ringHead    = Z246_RING_SIZE_DEFAULT;
-	llHdl->ringDataCnt = 0;
+	llHdl->tickRate     = OSS_TickRateGet(osHdl);
+	/* an OSS without tick rate leaves the fallback time stamps at 0 */
+	llHdl->tickUs       = llHdl->tickRate ? 1000000 / llHdl->tickRate : 0;
+	llHdl->txMinFifoFree = Z246_TX_FIFO_MAX;
+	llHdl->txMinMarginUs = 0xFFFFFFFF;
+	llHdl->thrMinMarginUs = 0xFFFFFFFF;
+	llHdl->txRateBurst   = Z246_TX_RATE_BURST_DEFAULT;
+	llHdl->txStatsTick   = OSS_TickGet(osHdl);
+	for(value=0;value<Z246_TIMED_SLOTS;value++){
+		llHdl->timedOrder[value] = (u_int8)value;
+	}
 	/*------------------------------+
 	|  init id function table       |
 	+------------------------------*/
@@ -295,6 +498,59 @@ static int32 Z246_Init(
 
 	DBGWRT_1((DBH, "Z246_Init: base address = %08p\n", (void*)llHdl->ma));
 
+	/* line configuration */
+	if ((error = DescGet(llHdl, "TX_SPEED",  1, 0, 1, &speed))  ||
+		(error = DescGet(llHdl, "TX_LOOP",   0, 0, 1, &loop))   ||
+		(error = DescGet(llHdl, "TX_PAR_EN", 1, 0, 1, &parEn))  ||
+		(error = DescGet(llHdl, "TX_PAR_TYP", 0, 0, 1, &parTyp)) ||
+		(error = DescGet(llHdl, "TX_SDI_EN", 0, 0, 1, &sdiEn))  ||
+		(error = DescGet(llHdl, "TX_SDI", 0, 0, Z146_TX_SDI_MAX, &sdi)))
+		return (Cleanup(llHdl, error));
+
+	llHdl->cfgLcr = (u_int8)((speed  << Z246_TX_SPEED_OFFSET)   |
+							 (loop   << Z246_TX_LOOP_OFFSET)    |
+							 (parEn  << Z246_TX_PAR_EN_OFFSET)  |
+							 (parTyp << Z246_TX_PAR_TYP_OFFSET) |
+							 (sdiEn  << Z246_TX_SDI_EN_OFFSET)  |
+							 (sdi    << Z246_TX_SDI_OFFSET));
+
+	/* label and FIFO threshold */
+	if ((error = DescGet(llHdl, "TX_LABEL", Z246_TX_LA_DEFAULT, 0, 0xFF, &value)))
+		return (Cleanup(llHdl, error));
+	llHdl->cfgLabel = (u_int8)value;
+
+	if ((error = DescGet(llHdl, "TX_THR_LEV", Z246_TX_FCR_DEFAULT, 0,
+						 Z246_TX_FCR_MASK, &value)) ||
+		(error = DescGet(llHdl, "TX_THR_AUTO", 0, 0, 1, &llHdl->thrAuto)))
+		return (Cleanup(llHdl, error));
+	llHdl->cfgThrLev = (u_int8)value;
+
+	/* queues */
+	if ((error = DescGet(llHdl, "TX_RING_SIZE", Z246_RING_SIZE_DEFAULT,
+						 Z246_RING_SIZE_MIN, Z246_RING_SIZE_MAX,
+						 &llHdl->txq[Z246_PRIO_LOW].size)) ||
+		(error = DescGet(llHdl, "TX_URG_SIZE", Z246_URG_SIZE_DEFAULT,
+						 Z246_URG_SIZE_MIN, Z246_URG_SIZE_MAX,
+						 &llHdl->txq[Z246_PRIO_HIGH].size)) ||
+		(error = DescGet(llHdl, "TX_LOW_RESERVE", Z246_TX_LOW_RESERVE_DEFAULT,
+						 0, Z246_TX_FIFO_MAX, &llHdl->txLowReserve)) ||
+		(error = DescGet(llHdl, "TX_WRITERS", 0, 0, Z246_WRITERS_MAX,
+						 &llHdl->wrNum)))
+		return (Cleanup(llHdl, error));
+
+	if ((llHdl->ringBuffer = (u_int32*)OSS_MemGet(osHdl,
+			llHdl->txq[Z246_PRIO_LOW].size * sizeof(u_int32), &llHdl->ringAlloc)) == NULL)
+		return (Cleanup(llHdl, ERR_OSS_MEM_ALLOC));
+	if ((llHdl->urgBuffer = (u_int32*)OSS_MemGet(osHdl,
+			llHdl->txq[Z246_PRIO_HIGH].size * sizeof(u_int32), &llHdl->urgAlloc)) == NULL)
+		return (Cleanup(llHdl, ERR_OSS_MEM_ALLOC));
+	llHdl->txq[Z246_PRIO_LOW].buf  = llHdl->ringBuffer;
+	llHdl->txq[Z246_PRIO_HIGH].buf = llHdl->urgBuffer;
+
+	/* alarm for timed transmission */
+	if ((error = OSS_AlarmCreate(osHdl, TxAlarm, llHdl, &llHdl->alarmHdl)))
+		return (Cleanup(llHdl, error));
+
 	/*------------------------------+
 	|  init hardware                |
 	+------------------------------*/
@@ -357,7 +613,10 @@ static int32 Z246_Read(
 /****************************** Z246_Write ***********************************/
 /** Description:  Write a value to the device
  *
- *  The function is not supported and always returns an ERR_LL_ILL_FUNC error.
+ *  Transmits one data word as bulk traffic with the label of Z246_TX_LABEL.
+ *  If nothing is queued and the FIFO has room, the word is written directly
+ *  to the FIFO, without the queue and the TX encoding of a burst. Otherwise
+ *  it is queued behind the pending words like a block write of one word.
  *
  *  \param llHdl      \IN  low-level handle
  *  \param ch         \IN  current channel
@@ -371,9 +630,28 @@ static int32 Z246_Write(
 		int32 value
 )
 {
+	u_int32 data = (u_int32)value;
+	u_int32 wr = Z246_WRITER(llHdl, ch);
+	OSS_IRQ_STATE irqState;
+
 	DBGWRT_1((DBH, "LL - Z246_Write: ch=%d, valueP=%d\n",ch,value));
 
-	return( ERR_LL_ILL_FUNC );
+	/* a writer with its own limit is checked by TxSubmit() */
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	if((llHdl->wrRate[wr].rate == 0) && TxIdle(llHdl) &&
+	   (MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET) < Z246_TX_FIFO_MAX) &&
+	   (RateTake(llHdl, Z246_PRIO_LOW, 1) == 1)){
+		MWRITE_D32(llHdl->ma, Z246_FIFO_START_ADDR, data & llHdl->txMask);
+		MWRITE_D8(llHdl->ma, Z246_TX_TXA_OFFSET, 1);
+		llHdl->txAccepted++;
+		llHdl->txDirectWords++;
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		return (ERR_SUCCESS);
+	}
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+	/* keep the order behind queued words */
+	return (TxSubmit(llHdl, wr, Z246_PRIO_LOW, &data, 1));
 }
 
 /****************************** Z246_SetStat *********************************/
@@ -401,6 +679,7 @@ static int32 Z246_SetStat(
 
 	int32 error = ERR_SUCCESS;
 	u_int8 regData = 0;
+	u_int32 wr = 0;
 
 	DBGWRT_1((DBH, "LL - Z246_SetStat: ch=%d code=0x%04x value=0x%x\n",
 			ch, code, value));
@@ -470,6 +749,7 @@ static int32 Z246_SetStat(
 			regData = regData & (~Z246_TX_SPEED_MASK);
 		}
 		MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, regData);
+		UpdateTxEncoding(llHdl);
 		DBGWRT_1((DBH, "LL - Z246_SetStat: Z246_TX_SPEED: value = %d\n", value32_or_64));
 		break;
 		/*--------------------------+
@@ -498,6 +778,7 @@ static int32 Z246_SetStat(
 			regData = regData & (~Z246_TX_PAR_EN_MASK);
 		}
 		MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, regData);
+		UpdateTxEncoding(llHdl);
 		break;
 
 		/*--------------------------+
@@ -526,6 +807,7 @@ static int32 Z246_SetStat(
 			regData = regData & (~Z246_TX_SDI_EN_MASK);
 		}
 		MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, regData);
+		UpdateTxEncoding(llHdl);
 		break;
 
 		/*--------------------------+
@@ -535,6 +817,7 @@ static int32 Z246_SetStat(
 		/* Set SDI */
 		if(value32_or_64 <= Z146_TX_SDI_MAX){
 			regData = MREAD_D8(llHdl->ma, Z246_TX_LCR_OFFSET);
+			regData &= ~Z246_TX_SDI_MASK;
 			regData |= (value32_or_64 << Z246_TX_SDI_OFFSET) & Z246_TX_SDI_MASK;
 			DBGWRT_1((DBH, "LL - Z246_SetStat: Z246_SDI: LCR = 0x%x.\n", regData));
 			MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, regData);
@@ -548,9 +831,98 @@ static int32 Z246_SetStat(
 		|  Transmit threshold level status    |
 		+---------------------------------------*/
 	case Z246_TX_THR_LEV:
-		regData = (value32_or_64 & Z246_TX_FCR_MASK);
-		MWRITE_D8(llHdl->ma, Z246_TX_FCR_OFFSET, regData);
+		/* a manual level ends the automatic mode */
+		llHdl->thrAuto = 0;
+		ThrLevelSet(llHdl, (u_int32)value32_or_64);
+		break;
+
+		/*--------------------------------------+
+		|  Automatic threshold level            |
+		+---------------------------------------*/
+	case Z246_TX_THR_AUTO:
+		llHdl->thrAuto       = (value32_or_64 != 0);
+		llHdl->thrIrqCnt      = 0;
+		llHdl->thrMinMarginUs = 0xFFFFFFFF;
+		break;
+
+		/*--------------------------------------+
+		|  FIFO space kept for bulk traffic     |
+		+---------------------------------------*/
+	case Z246_TX_LOW_RESERVE:
+		if((value32_or_64 >= 0) && (value32_or_64 <= Z246_TX_FIFO_MAX)){
+			llHdl->txLowReserve = (u_int32)value32_or_64;
+		}else{
+			error = ERR_LL_ILL_PARAM;
+		}
+		break;
+
+		/*--------------------------+
+		|  rate limits              |
+		+--------------------------*/
+	case Z246_TX_RATE_LOW:
+	case Z246_TX_RATE_HIGH:
+		if((value32_or_64 >= 0) && (value32_or_64 <= Z246_TX_RATE_MAX)){
+			RateSet(llHdl,
+					(code == Z246_TX_RATE_LOW) ? Z246_PRIO_LOW : Z246_PRIO_HIGH,
+					(u_int32)value32_or_64);
+		}else{
+			error = ERR_LL_ILL_PARAM;
+		}
+		break;
+
+	case Z246_TX_RATE_WRITER:
+		if((value32_or_64 >= 0) && (value32_or_64 <= Z246_TX_RATE_MAX)){
+			WrRateSet(llHdl, Z246_WRITER(llHdl, ch), (u_int32)value32_or_64);
+		}else{
+			error = ERR_LL_ILL_PARAM;
+		}
+		break;
+
+	case Z246_TX_RATE_BURST:
+		if((value32_or_64 >= 1) && (value32_or_64 <= (INT32_OR_64)llHdl->txq[Z246_PRIO_LOW].size)){
+			llHdl->txRateBurst = (u_int32)value32_or_64;
+			RateSet(llHdl, Z246_PRIO_LOW, llHdl->txRate[Z246_PRIO_LOW].rate);
+			RateSet(llHdl, Z246_PRIO_HIGH, llHdl->txRate[Z246_PRIO_HIGH].rate);
+			for(wr=0; wr<Z246_WRITERS_MAX; wr++){
+				WrRateSet(llHdl, wr, llHdl->wrRate[wr].rate);
+			}
+		}else{
+			error = ERR_LL_ILL_PARAM;
+		}
+		break;
+
+		/*--------------------------+
+		|  urgent transmission      |
+		+--------------------------*/
+	case Z246_BLK_TX_URGENT:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64;
+
+		if((blk->data == NULL) || (blk->size < 4)){
+			error = ERR_MBUF_ILL_SIZE;
+			break;
+		}
+		error = TxSubmit(llHdl, Z246_WRITER(llHdl, ch), Z246_PRIO_HIGH,
+						 (u_int32*)blk->data, blk->size/4);
+		break;
+	}
+
+		/*--------------------------+
+		|  timed transmission       |
+		+--------------------------*/
+	case Z246_BLK_TX_TIMED:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64;
+		u_int32 *data = (u_int32*)blk->data;
+
+		if((data == NULL) || (blk->size < 8) ||
+		   ((blk->size/4 - 1) > Z246_TIMED_MAX_WORDS)){
+			error = ERR_MBUF_ILL_SIZE;
+			break;
+		}
+		error = TimedSubmit(llHdl, data[0], &data[1], blk->size/4 - 1);
 		break;
+	}
 
 		/*-------------------+
 		|  Transmit Label    |
@@ -560,6 +932,21 @@ static int32 Z246_SetStat(
 		MWRITE_D8(llHdl->ma, Z246_TX_LA_OFFSET, regData);
 		break;
 
+		/*--------------------------------------+
+		|  Complete line configuration          |
+		+---------------------------------------*/
+	case Z246_BLK_LINE_CFG:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64;
+
+		if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z246_LINE_CFG))) {
+			error = ERR_LL_USERBUF;
+			break;
+		}
+		error = LineCfgSet(llHdl, (Z246_LINE_CFG*)blk->data);
+		break;
+	}
+
 		/*--------------------------+
 		|  (unknown)                |
 		+--------------------------*/
@@ -612,7 +999,7 @@ static int32 Z246_GetStat(
 		|  number of channels       |
 		+--------------------------*/
 	case M_LL_CH_NUMBER:
-		*valueP = CH_NUMBER;
+		*valueP = llHdl->wrNum ? llHdl->wrNum : CH_NUMBER;
 		break;
 
 		/*--------------------------+
@@ -705,6 +1092,20 @@ static int32 Z246_GetStat(
 		*value64P = (MREAD_D8(llHdl->ma, Z246_TX_FCR_OFFSET) & Z246_TX_FCR_MASK);
 		break;
 
+		/*--------------------------------------+
+		|  Automatic threshold level            |
+		+---------------------------------------*/
+	case Z246_TX_THR_AUTO:
+		*value64P = (INT32_OR_64)llHdl->thrAuto;
+		break;
+
+		/*--------------------------------------+
+		|  FIFO space kept for bulk traffic     |
+		+---------------------------------------*/
+	case Z246_TX_LOW_RESERVE:
+		*value64P = (INT32_OR_64)llHdl->txLowReserve;
+		break;
+
 		/*-------------------+
 		|  Transmit Label    |
 		+--------------------*/
@@ -712,6 +1113,212 @@ static int32 Z246_GetStat(
 		*value64P = (MREAD_D8(llHdl->ma, Z246_TX_LA_OFFSET) & 0xFF);
 		break;
 
+		/*--------------------------------------+
+		|  Complete line configuration          |
+		+---------------------------------------*/
+	case Z246_BLK_LINE_CFG:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+		Z246_LINE_CFG *cfg = (Z246_LINE_CFG*)blk->data;
+
+		if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z246_LINE_CFG))) {
+			error = ERR_LL_USERBUF;
+			break;
+		}
+		regData = MREAD_D8(llHdl->ma, Z246_TX_LCR_OFFSET);
+		cfg->speed  = (regData & Z246_TX_SPEED_MASK) >> Z246_TX_SPEED_OFFSET;
+		cfg->loop   = (regData & Z246_TX_LOOP_MASK) >> Z246_TX_LOOP_OFFSET;
+		cfg->parEn  = (regData & Z246_TX_PAR_EN_MASK) >> Z246_TX_PAR_EN_OFFSET;
+		cfg->parTyp = (regData & Z246_TX_PAR_TYP_MASK) >> Z246_TX_PAR_TYP_OFFSET;
+		cfg->sdiEn  = (regData & Z246_TX_SDI_EN_MASK) >> Z246_TX_SDI_EN_OFFSET;
+		cfg->sdi    = (regData & Z246_TX_SDI_MASK) >> Z246_TX_SDI_OFFSET;
+		cfg->flush  = 0;
+		blk->size = sizeof(Z246_LINE_CFG);
+		break;
+	}
+
+		/*--------------------------+
+		|  TX statistics            |
+		+--------------------------*/
+	case Z246_BLK_TX_STATS:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+		Z246_TX_STATS *stats = (Z246_TX_STATS*)blk->data;
+		OSS_IRQ_STATE irqState;
+
+		if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z246_TX_STATS))) {
+			error = ERR_LL_USERBUF;
+			break;
+		}
+		/* read and reset without losing counts of a concurrent refill */
+		irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+		stats->wordsAccepted = llHdl->txAccepted;
+		stats->directWords   = llHdl->txDirectWords;
+		stats->ringWords     = llHdl->txRingWords;
+		stats->wordsWritten  = llHdl->txDirectWords + llHdl->txRingWords;
+		stats->refillIrqs    = llHdl->txRefillIrqs;
+		stats->underruns     = llHdl->txUnderruns;
+		stats->overflows     = llHdl->txOverflows;
+		stats->maxRingDepth  = llHdl->txMaxRingDepth;
+		stats->minFifoFree   = llHdl->txMinFifoFree;
+		stats->idleGaps      = llHdl->txIdleGaps;
+		stats->minMarginUs   = llHdl->txMinMarginUs;
+		stats->thrLevel      = llHdl->thrLevel;
+		stats->urgentWords   = llHdl->txUrgentWords;
+		stats->urgMaxLatUs   = llHdl->txUrgMaxLatUs;
+		stats->throttledWords = llHdl->txThrottled;
+		stats->busUtil       = BusUtil(llHdl);
+
+		llHdl->txAccepted     = 0;
+		llHdl->txDirectWords  = 0;
+		llHdl->txRingWords    = 0;
+		llHdl->txRefillIrqs   = 0;
+		llHdl->txUnderruns    = 0;
+		llHdl->txOverflows    = 0;
+		llHdl->txMaxRingDepth = llHdl->txq[Z246_PRIO_LOW].cnt + llHdl->txq[Z246_PRIO_HIGH].cnt;
+		llHdl->txMinFifoFree  = Z246_TX_FIFO_MAX;
+		llHdl->txIdleGaps     = 0;
+		llHdl->txMinMarginUs  = 0xFFFFFFFF;
+		llHdl->txUrgentWords  = 0;
+		llHdl->txUrgMaxLatUs  = 0;
+		llHdl->txThrottled    = 0;
+		llHdl->txStatsTick    = OSS_TickGet(OSH);
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+		blk->size = sizeof(Z246_TX_STATS);
+		break;
+	}
+
+		/*--------------------------+
+		|  interrupt instrumentation|
+		+--------------------------*/
+	case Z246_BLK_IRQLAT:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+		Z246_IRQLAT *lat = (Z246_IRQLAT*)blk->data;
+		OSS_IRQ_STATE irqState;
+		u_int32 i = 0;
+
+		if ((blk->data == NULL) || (blk->size < (int32)sizeof(Z246_IRQLAT))) {
+			error = ERR_LL_USERBUF;
+			break;
+		}
+		/* read and reset as one snapshot */
+		irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+		lat->irqs     = llHdl->irqCnt;
+		lat->words    = llHdl->irqWords;
+		lat->maxWords = llHdl->irqMaxWords;
+		lat->durMaxUs = llHdl->irqDurMaxUs;
+		lat->durSumUs = llHdl->irqDurSumUs;
+		lat->latNum   = llHdl->irqLatNum;
+		lat->latMaxUs = llHdl->irqLatMaxUs;
+		lat->latSumUs = llHdl->irqLatSumUs;
+		lat->resUs    = Z246_TIMESTAMP_RES(llHdl);
+		for (i = 0; i < Z246_IRQ_BINS; i++) {
+			lat->durHist[i]   = llHdl->irqDurHist[i];
+			lat->wordsHist[i] = llHdl->irqWordsHist[i];
+			lat->latHist[i]   = llHdl->irqLatHist[i];
+			llHdl->irqDurHist[i]   = 0;
+			llHdl->irqWordsHist[i] = 0;
+			llHdl->irqLatHist[i]   = 0;
+		}
+		llHdl->irqCnt      = 0;
+		llHdl->irqWords    = 0;
+		llHdl->irqMaxWords = 0;
+		llHdl->irqDurMaxUs = 0;
+		llHdl->irqDurSumUs = 0;
+		llHdl->irqLatNum   = 0;
+		llHdl->irqLatMaxUs = 0;
+		llHdl->irqLatSumUs = 0;
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		blk->size = sizeof(Z246_IRQLAT);
+		break;
+	}
+
+		/*--------------------------+
+		|  timed burst results      |
+		+--------------------------*/
+	case Z246_BLK_TX_TIMED_RES:
+	{
+		M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P;
+		Z246_TX_TIMED_RES *res = (Z246_TX_TIMED_RES*)blk->data;
+		Z246_TIMED_LOG *log;
+		OSS_IRQ_STATE irqState;
+		u_int32 n = 0;
+		u_int32 max = blk->size / sizeof(Z246_TX_TIMED_RES);
+
+		if ((blk->data == NULL) || (max == 0)) {
+			error = ERR_LL_USERBUF;
+			break;
+		}
+		irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+		while((n < max) && (llHdl->timedLogCnt != 0)){
+			/* oldest entry first */
+			log = &llHdl->timedLog[(llHdl->timedLogHead + Z246_TIMED_RES_NUM -
+									llHdl->timedLogCnt) % Z246_TIMED_RES_NUM];
+			res[n].releaseTick = log->tick;
+			res[n].errUs       = log->errUs;
+			res[n].words       = log->len;
+			llHdl->timedLogCnt--;
+			n++;
+		}
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+		blk->size = n * sizeof(Z246_TX_TIMED_RES);
+		break;
+	}
+
+		/*--------------------------+
+		|  pending timed bursts     |
+		+--------------------------*/
+	case Z246_TX_TIMED_PEND:
+		*value64P = (INT32_OR_64)llHdl->timedCnt;
+		break;
+
+		/*--------------------------+
+		|  rate limits              |
+		+--------------------------*/
+	case Z246_TX_RATE_LOW:
+		*value64P = (INT32_OR_64)llHdl->txRate[Z246_PRIO_LOW].rate;
+		break;
+
+	case Z246_TX_RATE_HIGH:
+		*value64P = (INT32_OR_64)llHdl->txRate[Z246_PRIO_HIGH].rate;
+		break;
+
+	case Z246_TX_RATE_WRITER:
+		*value64P = (INT32_OR_64)llHdl->wrRate[Z246_WRITER(llHdl, ch)].rate;
+		break;
+
+	case Z246_TX_RATE_BURST:
+		*value64P = (INT32_OR_64)llHdl->txRateBurst;
+		break;
+
+	case Z246_TX_TICK:
+		*value64P = (INT32_OR_64)OSS_TickGet(OSH);
+		break;
+
+	case Z246_TX_TICK_RATE:
+		*value64P = (INT32_OR_64)llHdl->tickRate;
+		break;
+
+		/*--------------------------+
+		|  words not yet sent       |
+		+--------------------------*/
+	case Z246_TX_LEVEL:
+	{
+		OSS_IRQ_STATE irqState;
+
+		irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+		*value64P = (INT32_OR_64)(MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET) +
+								  llHdl->txq[Z246_PRIO_LOW].cnt +
+								  llHdl->txq[Z246_PRIO_LOW].resvCnt +
+								  llHdl->txq[Z246_PRIO_HIGH].cnt +
+								  llHdl->txq[Z246_PRIO_HIGH].resvCnt);
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		break;
+	}
+
 		/*--------------------------+
 		|  (unknown)                |
 		+--------------------------*/
@@ -754,6 +1361,9 @@ static int32 Z246_BlockRead(
 
 /****************************** Z246_BlockWrite *****************************/
 /** Write a data block from the device
+ *
+ *  The data is queued as bulk traffic, see TxSubmit(). Urgent data is
+ *  written with the block setstat #Z246_BLK_TX_URGENT.
  *
  *  \param llHdl  	   \IN  low-level handle
  *  \param ch          \IN  current channel
@@ -772,9 +1382,6 @@ static int32 Z246_BlockWrite(
 )
 {
 	int32 result = ERR_SUCCESS;
-	int8  ringResult = 0;
-	u_int32 i = 0;
-	u_int32 gotsize = 0;
 	u_int32 llDataLen = size/4;
 	u_int32 * userBuf = (u_int32*)buf;
 
@@ -782,23 +1389,12 @@ static int32 Z246_BlockWrite(
 
 	/* Check for user buffer size */
 	if((size != 0) && (buf != NULL)){
-		if(llDataLen <= (Z246_MAX_BUFF_SIZE - 1)){
-			/* Copy data from user space to kernel space (ring buffer). */
-			for(i=0;i<llDataLen;i++){
-				ringResult = StoreInBuffer(llHdl, userBuf[i]);
-				if(ringResult != 0){
-					result = ERR_MBUF_OVERFLOW;
-					IDBGWRT_1((DBH, ">>> LL - Z246_BlockWrite: ring buffer problem \n"));
-				}
-			}
-			if(result == ERR_SUCCESS){
-				if(HwWrite(llHdl) == 0){
-					/* Write operation successful */
-					result = ERR_SUCCESS;
-				} /* Else return the result */
-			}
+		if(llDataLen <= llHdl->txq[Z246_PRIO_LOW].size){
+			result = TxSubmit(llHdl, Z246_WRITER(llHdl, ch), Z246_PRIO_LOW,
+							  userBuf, llDataLen);
 		}else{
 			result = ERR_MBUF_OVERFLOW;
+			llHdl->txOverflows++;
 		}
 	}else{
 		result = ERR_MBUF_ILL_SIZE;
@@ -833,26 +1429,53 @@ static int32 Z246_Irq(
 {
 	u_int32 irqReq;
 	u_int32 ier1, ier2;
+	u_int32 t0 = 0;
+	u_int32 written = 0;
+	u_int32 thrWords = 0;
+	u_int8 txc = 0;
 
 	/* interrupt caused by TX ? */
 	irqReq = MREAD_D8(llHdl->ma, Z246_TX_IIR_OFFSET);
 
 	if (irqReq & Z246_TX_IRQ_MASK) {
 
+		t0 = Z246_TIMESTAMP(llHdl);
+
 		IDBGWRT_1((DBH, ">>> LL - Z246_Irq: request %08x\n", irqReq));
 
 		/* Else disable the queue space interrupt. */
 		MWRITE_D8(llHdl->ma, Z246_TX_IER_OFFSET, 0);
 		/* interrupt is cleared by disabling it.  */
 
+		/*
+		 * The words still queued in the FIFO are the drain time left for
+		 * the refill. The threshold in words is the highest FIFO level
+		 * seen at a refill interrupt at the current threshold level.
+		 */
+		txc = MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET);
+		if(txc > llHdl->thrLevSeen[llHdl->thrLevel]){
+			llHdl->thrLevSeen[llHdl->thrLevel] = txc;
+		}
+		thrWords = llHdl->thrLevSeen[llHdl->thrLevel];
+
 		/* Call the tx routine to send remaining data. */
+		llHdl->txRefillIrqs++;
+		written = llHdl->txRingWords + llHdl->txDirectWords;
+		TimedRelease(llHdl);
 		HwWrite(llHdl);
+		written = llHdl->txRingWords + llHdl->txDirectWords - written;
+		if(written != 0){
+			ThrAutoUpdate(llHdl, txc, Z246_TIMESTAMP(llHdl) - t0);
+		}
 
 		/* if requested send signal to application */
 		if (llHdl->portChangeSig){
 			OSS_SigSend(OSH, llHdl->portChangeSig);
 		}
 
+		/* words sent since the FIFO fell to the threshold */
+		IrqLatLog(llHdl, t0, written, (int32)((thrWords - txc) * llHdl->txWordUs));
+
 		return (LL_IRQ_DEVICE);
 	}
 
@@ -970,6 +1593,7 @@ static int32 Z246_Info(
 	{
 		u_int32 *lockModeP = va_arg(argptr, u_int32*);
 
+		/* TX submission is protected by the driver itself, see TxSubmit() */
 		*lockModeP = LL_LOCK_NONE;
 		break;
 	}
@@ -1014,6 +1638,10 @@ static int32 Cleanup(
 	/*------------------------------+
 	|  close handles                |
 	+------------------------------*/
+	/* remove alarm */
+	if (llHdl->alarmHdl)
+		OSS_AlarmRemove(llHdl->osHdl, &llHdl->alarmHdl);
+
 	/* clean up desc */
 	if (llHdl->descHdl)
 		DESC_Exit(&llHdl->descHdl);
@@ -1028,6 +1656,12 @@ static int32 Cleanup(
 	/*------------------------------+
 	|  free memory                  |
 	+------------------------------*/
+	/* free the queues */
+	if (llHdl->ringBuffer)
+		OSS_MemFree(llHdl->osHdl, (int8*)llHdl->ringBuffer, llHdl->ringAlloc);
+	if (llHdl->urgBuffer)
+		OSS_MemFree(llHdl->osHdl, (int8*)llHdl->urgBuffer, llHdl->urgAlloc);
+
 	/* free my handle */
 	OSS_MemFree(llHdl->osHdl, (int8*)llHdl, llHdl->memAlloc);
 
@@ -1049,89 +1683,224 @@ ConfigureDefault( LL_HANDLE *llHdl )
 	int i =0;
 
 	/* Configure TX LCR */
-	MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, Z246_TX_LCR_DEFAULT);
+	MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, llHdl->cfgLcr);
 
 	/* Configure TX LA */
-	MWRITE_D8(llHdl->ma, Z246_TX_LA_OFFSET, Z246_TX_LA_DEFAULT);
+	MWRITE_D8(llHdl->ma, Z246_TX_LA_OFFSET, llHdl->cfgLabel);
 
 	/* Configure TX FCR */
-	MWRITE_D8(llHdl->ma, Z246_TX_FCR_OFFSET, Z246_TX_FCR_DEFAULT);
+	ThrLevelSet(llHdl, llHdl->cfgThrLev);
 
 	/* Disable the interrupt */
 	MWRITE_D8(llHdl->ma, Z246_TX_IER_OFFSET, Z246_TX_IER_DEFAULT);
 
+	UpdateTxEncoding(llHdl);
+}
+
+/**********************************************************************/
+/** Submit data for transmission.
+ *
+ *  If the transmitter is idle, the words which fit into the free space of
+ *  the FPGA FIFO are written directly from the caller's buffer. Only the
+ *  remaining words are stored in the queue of the given priority and
+ *  transmitted by the interrupt routine. The data is either accepted
+ *  completely or rejected with ERR_MBUF_OVERFLOW.
+ *
+ *  Several processes may submit concurrently. Queue space is reserved
+ *  with the device interrupt masked and the data is copied into the
+ *  reservation without any lock. The writer then marks its reservation
+ *  ready and commits the ready reservations at the start of the open
+ *  ones, see QueueCommit(). Reservations are contiguous and committed in
+ *  reservation order, so each burst is sent without words of other
+ *  writers of the same priority in between, and a slow writer only holds
+ *  back the reservations made after its own. If all Z246_RESV_SLOTS
+ *  reservations are open, the data is copied with the interrupt masked.
+ *
+ *  If the writer has a rate limit of its own, see WrRateTake(), data
+ *  above this limit is rejected with ERR_MBUF_OVERFLOW, too.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param wr         \IN  writer, see Z246_WRITER()
+ *  \param prio       \IN  Z246_PRIO_LOW or Z246_PRIO_HIGH
+ *  \param data       \IN  data words
+ *  \param len        \IN  number of words
+ *  \return           \c 0 on success or error code
+ */
+int32 TxSubmit(LL_HANDLE *llHdl, u_int32 wr, u_int32 prio, u_int32 *data,
+			   u_int32 len){
+	Z246_QUEUE *q = &llHdl->txq[prio];
+	OSS_IRQ_STATE irqState;
+	int32 result = ERR_SUCCESS;
+	u_int32 done = 0;
+	u_int32 start = 0;
+	u_int32 depth = 0;
+	u_int32 slot = 0;
+
+	/*--- reserve queue space ---*/
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	if(len > (q->size - q->cnt - q->resvCnt)){
+		llHdl->txOverflows++;
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		DBGWRT_1((DBH, ">>> LL - Z246 TxSubmit: queue %d full\n", prio));
+		return ERR_MBUF_OVERFLOW;
+	}
+	if(WrRateTake(llHdl, wr, len) == 0){
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		DBGWRT_1((DBH, ">>> LL - Z246 TxSubmit: writer %d over its rate\n", wr));
+		return ERR_MBUF_OVERFLOW;
+	}
+	llHdl->txAccepted += len;
+
+	/* Nothing queued or reserved: bypass the queues as far as the FIFO allows. */
+	if(TxIdle(llHdl)){
+		done = DirectWrite(llHdl, prio, data, len);
+	}
+	if(done == len){
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		return ERR_SUCCESS;
+	}
+	if(prio == Z246_PRIO_HIGH){
+		UrgMarkPush(llHdl, len - done, Z246_TIMESTAMP(llHdl));
+	}
+	if(q->slotNum == Z246_RESV_SLOTS){
+		/* no reservation slot left, committed by the newest open one */
+		QueueAppend(q, data + done, len - done);
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		return ERR_SUCCESS;
+	}
+	start = q->resv;
+	q->resv = (start + len - done) % q->size;
+	q->resvCnt += len - done;
+	slot = (q->slotFirst + q->slotNum) % Z246_RESV_SLOTS;
+	q->slot[slot].len   = len - done;
+	q->slot[slot].ready = 0;
+	q->slotNum++;
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+	/*--- copy the remaining data to the queue, unlocked ---*/
+	QueueCopy(q, start, data + done, len - done);
+
+	/*--- commit ---*/
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	q->slot[slot].ready = 1;
+	if(QueueCommit(q) != 0){
+		/* publish the committed words to the interrupt routine */
+		depth = llHdl->txq[Z246_PRIO_LOW].cnt + llHdl->txq[Z246_PRIO_HIGH].cnt;
+		if(depth > llHdl->txMaxRingDepth){
+			llHdl->txMaxRingDepth = depth;
+		}
+		result = HwWrite(llHdl);
+	}
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+	return result;
+}
+
+/**********************************************************************/
+/** Check if the transmitter queues are idle.
+ *
+ *  Must be called with the device interrupt masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \return           1 if no words are queued or reserved, else 0
+ */
+int32 TxIdle(LL_HANDLE *llHdl){
+	u_int32 prio = 0;
+
+	for(prio=0;prio<Z246_PRIO_NUM;prio++){
+		if((llHdl->txq[prio].cnt != 0) || (llHdl->txq[prio].resvCnt != 0)){
+			return 0;
+		}
+	}
+	return 1;
 }
 
 /**********************************************************************/
-/** Write data from the ring buffer to the FPGA FIFO.
+/** Write data from the queues to the FPGA FIFO.
  *
- *  Writes data according to the configuration and space available.
+ *  Writes data according to the configuration and space available. The
+ *  urgent queue is served first, but while bulk data is pending up to
+ *  txLowReserve words (at most half of the free space) are kept for it,
+ *  so bulk traffic is never starved completely.
  *
  *  \param llHdl      \IN  low-level handle
  */
 int HwWrite(LL_HANDLE    *llHdl){
 	int32 result = ERR_SUCCESS;
-	int8 ringResult = 0;
-	u_int32 dataBitMask = 0;
-	u_int16 lcrRegData = 0;
+	Z246_QUEUE *hi = &llHdl->txq[Z246_PRIO_HIGH];
+	Z246_QUEUE *lo = &llHdl->txq[Z246_PRIO_LOW];
+	u_int32 fifoFree = 0;
+	u_int32 reserve = 0;
+	u_int32 hiCount = 0;
+	u_int32 loCount = 0;
 	u_int32 dataCount = 0;
-	u_int32 data = 0;
-	u_int8 isSdiEn = 0;
-	u_int8 isParityEn = 0;
-	u_int16 i = 0;
 	u_int8 txcStatus = 0;
 
 	DBGWRT_2((DBH, "LL - Z246_Write: \n"));
 
-	lcrRegData = MREAD_D8(llHdl->ma, Z246_TX_LCR_OFFSET);
-	isParityEn = (lcrRegData & Z246_LCR_PAR_MASK);
-	isSdiEn = (lcrRegData & Z246_LCR_SDI_MASK);
-
 	/* Check TXC register for remaining space in the TX queue. */
 	txcStatus = MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET);
+	fifoFree = Z246_TX_FIFO_MAX - txcStatus;
 
 	DBGWRT_2((DBH, "LL - Z246_Write: txcStatus = %d\n", txcStatus));
+	TxFifoFree(llHdl, fifoFree);
 
-	if(llHdl->ringDataCnt > (u_int32)(Z246_TX_FIFO_MAX - txcStatus)){
-		/* If data length is greater than the queue space then transmit that much data only. */
-		dataCount = (Z246_TX_FIFO_MAX - txcStatus);
-	}else{
-		/* If data length is smaller than the queue space then transmit all the data. */
-		dataCount = llHdl->ringDataCnt;
+	/* space kept for bulk traffic */
+	reserve = llHdl->txLowReserve;
+	if(reserve > lo->cnt){
+		reserve = lo->cnt;
+	}
+	if(reserve > (fifoFree / 2)){
+		reserve = fifoFree / 2;
+	}
+
+	hiCount = hi->cnt;
+	if(hiCount > (fifoFree - reserve)){
+		hiCount = fifoFree - reserve;
 	}
-	DBGWRT_2((DBH, "LL - Z246_Write: writing %d bytes\n", dataCount));
+	/* rate limits */
+	llHdl->txRateRetryMs = 0;
+	hiCount = RateTake(llHdl, Z246_PRIO_HIGH, hiCount);
+	loCount = lo->cnt;
+	if(loCount > (fifoFree - hiCount)){
+		loCount = fifoFree - hiCount;
+	}
+	loCount = RateTake(llHdl, Z246_PRIO_LOW, loCount);
+	dataCount = hiCount + loCount;
+	DBGWRT_2((DBH, "LL - Z246_Write: writing %d urgent + %d words\n", hiCount, loCount));
 
 	/* If enough space then write the data to the queue */
 	if(dataCount != 0){
-		/* Check if the parity and SDI is disabled.	If disabled then 24 bit space. */
-		if((isParityEn == 0) && (isSdiEn == 0)){
-			dataBitMask = Z246_24_BIT_MASK;
-		}
-		/* Else if parity is enabled and SDI is disabled then 23 bit space */
-		else if((isParityEn != 0) && (isSdiEn == 0)){
-			dataBitMask = Z246_23_BIT_MASK;
-		}
-		/* Else if parity is disabled and SDI is enabled then 22 bit space */
-		else if((isParityEn == 0) && (isSdiEn != 0)){
-			dataBitMask = Z246_22_BIT_MASK;
-		}
-		/* Else if parity is enabled and SDI is enabled then 21 bit space */
-		else{
-			dataBitMask = Z246_21_BIT_MASK;
+		if(hiCount != 0){
+			if(QueueEncode(llHdl, hi, llHdl->txStage, hiCount) != 0){
+				llHdl->txUnderruns++;
+				return ERR_MBUF_UNDERRUN;
+			}
 		}
-		/* Need to add support for user buffer tx */
-		for(i=0;i<dataCount;i++){
-			data = ReadFromBuffer(llHdl, &ringResult);
-			if(ringResult != 0){
+		if(loCount != 0){
+			if(QueueEncode(llHdl, lo, llHdl->txStage + hiCount, loCount) != 0){
+				llHdl->txUnderruns++;
 				return ERR_MBUF_UNDERRUN;
 			}
-			MWRITE_D32(llHdl->ma, Z246_FIFO_START_ADDR + (i*4), (dataBitMask & data));
-			DBGWRT_2((DBH, "LL - Z246_Write: Tx Data[%d] = 0x%x\n",i, (dataBitMask & data)));
 		}
-	} /* Else dataCount < len so it will land in if(dataCount < len) condition */
+		FifoWrite(llHdl, dataCount);
+		if(hiCount != 0){
+			UrgMarkTake(llHdl, hiCount, txcStatus);
+		}
+		llHdl->txRingWords   += dataCount;
+		llHdl->txUrgentWords += hiCount;
+	}
 
-	/* If data is remaining then enable the queue space interrupt. */
-	if(llHdl->ringDataCnt != 0){
+	/*
+	 * If data is remaining then enable the queue space interrupt. Data
+	 * which is only held back by the rate limits is retried by the alarm,
+	 * so the interrupt does not fire continuously on a draining FIFO.
+	 */
+	if(llHdl->txRateRetryMs != 0){
+		TxAlarmArm(llHdl);
+	}
+	if(((hi->cnt != 0) || (lo->cnt != 0)) &&
+	   ((llHdl->txRateRetryMs == 0) || (dataCount == fifoFree))){
 		DBGWRT_2((DBH, ">>> Z246_Write: TXA data len %d\n", dataCount));
 		/* Acknowledge the the data before enabling the queue space interrupt. */
 		MWRITE_D8(llHdl->ma, Z246_TX_TXA_OFFSET, dataCount);
@@ -1150,61 +1919,916 @@ int HwWrite(LL_HANDLE    *llHdl){
 	return result;
 }
 
-
 /**********************************************************************/
-/** Read data from the buffer.
+/** Write data from the user buffer directly to the FPGA FIFO.
  *
- *  Read one word from the ring buffer.
+ *  Writes as many words as fit into the free space of the FIFO, bypassing
+ *  the queues. Must only be called while both queues are empty, otherwise
+ *  the data would overtake the queued words.
  *
  *  \param llHdl      \IN  low-level handle
- *  \param result     \OUT result of the operation; 0 on success and -1 on error
- *  \return           \OUT uint32 data
+ *  \param prio       \IN  priority of the data, for the statistics
+ *  \param data       \IN  user data
+ *  \param len        \IN  number of words in the user data
+ *  \return           \OUT number of words written to the FIFO
  */
-u_int32 ReadFromBuffer( LL_HANDLE *llHdl, int8 * result){
-
-	u_int32 data = 0;
-	/* if the head isn't ahead of the tail, we don't have any characters */
-	if ((llHdl->ringHead == llHdl->ringTail) || (llHdl->ringDataCnt == 0)) {
-		data = 0;        /* quit with an error */
-		*result = -1;
-	} else {
-		data = llHdl->ringBuffer[llHdl->ringTail];
-		llHdl->ringTail = (unsigned int)(llHdl->ringTail + 1);
-		llHdl->ringDataCnt--;
-		if (llHdl->ringDataCnt == 0) {
-			llHdl->ringTail = Z246_RING_SIZE_DEFAULT;
-			llHdl->ringHead = Z246_RING_SIZE_DEFAULT;
-		}
-		*result = 0;
+u_int32 DirectWrite(LL_HANDLE *llHdl, u_int32 prio, u_int32 *data, u_int32 len){
+	u_int32 dataCount = 0;
+	u_int8 txcStatus = 0;
+
+	txcStatus = MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET);
+	dataCount = Z246_TX_FIFO_MAX - txcStatus;
+	TxFifoFree(llHdl, dataCount);
+	if(dataCount > len){
+		dataCount = len;
+	}
+	dataCount = RateTake(llHdl, prio, dataCount);
+	DBGWRT_2((DBH, "LL - Z246 DirectWrite: txcStatus = %d, writing %d words\n", txcStatus, dataCount));
 
+	if(dataCount != 0){
+		llHdl->txEncode(llHdl->txStage, data, dataCount);
+		FifoWrite(llHdl, dataCount);
+		/* Acknowledge the data, the queue space interrupt stays disabled. */
+		MWRITE_D8(llHdl->ma, Z246_TX_TXA_OFFSET, dataCount);
+		llHdl->txDirectWords += dataCount;
+		if(prio == Z246_PRIO_HIGH){
+			llHdl->txUrgentWords += dataCount;
+			UrgentLatency(llHdl, 0, txcStatus);
+		}
 	}
-	return data;
+	return dataCount;
 }
 
 /**********************************************************************/
-/** Store data in the buffer.
- *
+/** Read a numeric descriptor key with range check.
  *
- *  \param llHdl      \IN low-level handle
- *  \param data       \IN uint32 data
- *  \return           \OUT result of the operation; 0 on success and -1 on error.
+ *  \param llHdl      \IN  low-level handle
+ *  \param key        \IN  descriptor key
+ *  \param def        \IN  default value if the key is not present
+ *  \param min        \IN  minimum value
+ *  \param max        \IN  maximum value
+ *  \param valueP     \OUT value
+ *  \return           \c 0 on success or error code
  */
-int8 StoreInBuffer( LL_HANDLE *llHdl , u_int32 data){
+int32 DescGet(LL_HANDLE *llHdl, char *key, u_int32 def, u_int32 min,
+			  u_int32 max, u_int32 *valueP){
+	int32 error;
 
-	int8 result = 0;
-	unsigned int next = (unsigned int)(llHdl->ringHead + 1);
-	if (next != llHdl->ringTail)
-	{
-		llHdl->ringBuffer[llHdl->ringHead] = data;
-		llHdl->ringHead = next;
-		llHdl->ringDataCnt++;
-	}else{
-		DBGWRT_1((DBH, ">>> Z246: StoreInBuffer next[0x%lx] == llHdl->ringTail[0x%lx]\n", next, llHdl->ringTail));
-		result = -1;
+	if ((error = DESC_GetUInt32(llHdl->descHdl, def, valueP, "%s", key)) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return (error);
+
+	if ((*valueP < min) || (*valueP > max)) {
+		DBGWRT_ERR((DBH, "*** %s: descriptor key %s=%d out of range\n",
+					DRV_NAME, key, *valueP));
+		return (ERR_LL_DESC_PARAM);
 	}
-	return result;
+	return (ERR_SUCCESS);
 }
 
+/**********************************************************************/
+/** Apply a complete line configuration.
+ *
+ *  All TX_LCR fields are written with one register access together with
+ *  the TX encoding, so no word is sent with a partial configuration.
+ *  With cfg->flush the data queued in the driver (including timed bursts)
+ *  is discarded and the words already in the FIFO are sent with the old
+ *  configuration before the new one is applied. Data reserved by a
+ *  concurrent writer is not discarded.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param cfg        \IN  line configuration
+ *  \return           \c 0 on success or error code
+ */
+int32 LineCfgSet(LL_HANDLE *llHdl, Z246_LINE_CFG *cfg){
+	OSS_IRQ_STATE irqState;
+	u_int32 prio = 0;
+	u_int32 waitMs = 0;
+	u_int8 regData = 0;
+
+	if(cfg->sdi > Z146_TX_SDI_MAX){
+		return ERR_LL_ILL_PARAM;
+	}
+	regData = ((cfg->speed  ? 1 : 0) << Z246_TX_SPEED_OFFSET) |
+			  ((cfg->loop   ? 1 : 0) << Z246_TX_LOOP_OFFSET) |
+			  ((cfg->parEn  ? 1 : 0) << Z246_TX_PAR_EN_OFFSET) |
+			  ((cfg->parTyp ? 1 : 0) << Z246_TX_PAR_TYP_OFFSET) |
+			  ((cfg->sdiEn  ? 1 : 0) << Z246_TX_SDI_EN_OFFSET) |
+			  (cfg->sdi << Z246_TX_SDI_OFFSET);
+
+	if(cfg->flush){
+		irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+		/* the discarded urgent words leave the queue without latency */
+		llHdl->urgSeqOut += llHdl->txq[Z246_PRIO_HIGH].cnt;
+		UrgMarkTake(llHdl, 0, 0);
+		for(prio=0;prio<Z246_PRIO_NUM;prio++){
+			llHdl->txq[prio].tail = llHdl->txq[prio].head;
+			llHdl->txq[prio].cnt  = 0;
+		}
+		llHdl->timedCnt = 0;
+		MWRITE_D8(llHdl->ma, Z246_TX_IER_OFFSET, 0);
+		waitMs = (MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET) * llHdl->txWordUs) / 1000 + 10;
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+		/* let the FIFO run empty with the old configuration */
+		while((MREAD_D8(llHdl->ma, Z246_TX_TXC_OFFSET) != 0) && (waitMs != 0)){
+			OSS_Delay(OSH, 1);
+			waitMs--;
+		}
+	}
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	MWRITE_D8(llHdl->ma, Z246_TX_LCR_OFFSET, regData);
+	UpdateTxEncoding(llHdl);
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+	DBGWRT_1((DBH, "LL - Z246 LineCfgSet: LCR = 0x%x, flush = %d\n", regData, cfg->flush));
+	return ERR_SUCCESS;
+}
+
+/**********************************************************************/
+/** Update the TX encoding for the current line configuration.
+ *
+ *  The usable data width depends on whether the parity bit and the SDI
+ *  bits are inserted by the controller. The data mask and the matching
+ *  encoding loop are kept in the handle, so the transmit path does not
+ *  need to decode the LCR. The time per word for the configured speed is
+ *  updated as well. Must be called whenever SPEED, PAR_EN or SDI_EN change.
+ *
+ *  \param llHdl      \IN  low-level handle
+ */
+void UpdateTxEncoding(LL_HANDLE *llHdl){
+	u_int8 lcrRegData = 0;
+	u_int8 isSdiEn = 0;
+	u_int8 isParityEn = 0;
+
+	lcrRegData = MREAD_D8(llHdl->ma, Z246_TX_LCR_OFFSET);
+	isParityEn = (lcrRegData & Z246_LCR_PAR_MASK);
+	isSdiEn = (lcrRegData & Z246_LCR_SDI_MASK);
+
+	if(lcrRegData & Z246_TX_SPEED_MASK){
+		llHdl->txWordUs = Z246_WORD_US_HIGH;
+	}else{
+		llHdl->txWordUs = Z246_WORD_US_LOW;
+	}
+
+	/* Check if the parity and SDI is disabled.	If disabled then 24 bit space. */
+	if((isParityEn == 0) && (isSdiEn == 0)){
+		llHdl->txMask   = Z246_24_BIT_MASK;
+		llHdl->txEncode = Encode24;
+	}
+	/* Else if parity is enabled and SDI is disabled then 23 bit space */
+	else if((isParityEn != 0) && (isSdiEn == 0)){
+		llHdl->txMask   = Z246_23_BIT_MASK;
+		llHdl->txEncode = Encode23;
+	}
+	/* Else if parity is disabled and SDI is enabled then 22 bit space */
+	else if((isParityEn == 0) && (isSdiEn != 0)){
+		llHdl->txMask   = Z246_22_BIT_MASK;
+		llHdl->txEncode = Encode22;
+	}
+	/* Else if parity is enabled and SDI is enabled then 21 bit space */
+	else{
+		llHdl->txMask   = Z246_21_BIT_MASK;
+		llHdl->txEncode = Encode21;
+	}
+	DBGWRT_2((DBH, "LL - Z246 UpdateTxEncoding: LCR = 0x%x, mask = 0x%x\n", lcrRegData, llHdl->txMask));
+}
+
+/*
+ * Encoding loops, one per data width. The mask is a constant and the loop
+ * is unrolled by four without dependencies between the words, so the
+ * compiler can turn it into vector code where the target supports it.
+ */
+#define Z246_ENCODE_BODY(mask) \
+	u_int32 i = 0; \
+	for(; (i + 4) <= len; i += 4){ \
+		dst[i]   = src[i]   & (mask); \
+		dst[i+1] = src[i+1] & (mask); \
+		dst[i+2] = src[i+2] & (mask); \
+		dst[i+3] = src[i+3] & (mask); \
+	} \
+	for(; i < len; i++){ \
+		dst[i] = src[i] & (mask); \
+	}
+
+static void Encode24(u_int32 *dst, const u_int32 *src, u_int32 len){ Z246_ENCODE_BODY(Z246_24_BIT_MASK) }
+static void Encode23(u_int32 *dst, const u_int32 *src, u_int32 len){ Z246_ENCODE_BODY(Z246_23_BIT_MASK) }
+static void Encode22(u_int32 *dst, const u_int32 *src, u_int32 len){ Z246_ENCODE_BODY(Z246_22_BIT_MASK) }
+static void Encode21(u_int32 *dst, const u_int32 *src, u_int32 len){ Z246_ENCODE_BODY(Z246_21_BIT_MASK) }
+
+/**********************************************************************/
+/** Write the encoded burst to the FPGA FIFO.
+ *
+ *  The words are not acknowledged, the caller writes TXA.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param len        \IN  number of words in llHdl->txStage
+ */
+void FifoWrite(LL_HANDLE *llHdl, u_int32 len){
+	u_int32 i = 0;
+
+	for(i=0;i<len;i++){
+		MWRITE_D32(llHdl->ma, Z246_FIFO_START_ADDR + (i*4), llHdl->txStage[i]);
+	}
+}
+
+/**********************************************************************/
+/** Record the observed free FIFO space for the TX statistics.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param fifoFree   \IN  free FIFO space in words
+ */
+void TxFifoFree(LL_HANDLE *llHdl, u_int32 fifoFree){
+	if(fifoFree < llHdl->txMinFifoFree){
+		llHdl->txMinFifoFree = fifoFree;
+	}
+}
+
+/**********************************************************************/
+/** Set the TX_FCR threshold level.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param level      \IN  threshold level
+ */
+void ThrLevelSet(LL_HANDLE *llHdl, u_int32 level){
+	llHdl->thrLevel = level & Z246_TX_FCR_MASK;
+	MWRITE_D8(llHdl->ma, Z246_TX_FCR_OFFSET, llHdl->thrLevel);
+}
+
+/**********************************************************************/
+/** Evaluate the refill of the FIFO at a refill interrupt.
+ *
+ *  The drain time is the time the words still queued in the FIFO at
+ *  interrupt entry need on the bus, the refill latency the measured time
+ *  from the interrupt entry until the FIFO was written. The time from the
+ *  threshold to the interrupt entry is already contained in the drain
+ *  time, the words sent in between have left the FIFO. The difference is
+ *  the margin of the refill; without margin the bus went idle while data
+ *  was pending.
+ *
+ *  In automatic mode an idle gap raises the threshold level at once, so the
+ *  refill is requested earlier. If the margin stayed above
+ *  Z246_THR_AUTO_MARGIN words for a whole window of refills, also after
+ *  subtracting the words by which the next lower level requests the refill
+ *  later (if that level was measured before), the level is lowered by one
+ *  to save interrupts.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param reserve    \IN  words in the FIFO at interrupt entry
+ *  \param refillUs   \IN  time from interrupt entry until the FIFO was written [us]
+ */
+void ThrAutoUpdate(LL_HANDLE *llHdl, u_int32 reserve, u_int32 refillUs){
+	u_int32 marginUs = reserve * llHdl->txWordUs;
+	u_int32 stepUs = 0;
+	u_int32 lev = llHdl->thrLevel;
+
+	marginUs = (marginUs > refillUs) ? marginUs - refillUs : 0;
+	if(marginUs < llHdl->txMinMarginUs){
+		llHdl->txMinMarginUs = marginUs;
+	}
+	if(marginUs == 0){
+		llHdl->txIdleGaps++;
+		IDBGWRT_2((DBH, ">>> LL - Z246_Irq: bus idle gap at threshold level %d\n", lev));
+	}
+
+	if(!llHdl->thrAuto){
+		return;
+	}
+
+	if(marginUs == 0){
+		if(lev < Z246_TX_FCR_MASK){
+			ThrLevelSet(llHdl, lev + 1);
+		}
+		llHdl->thrIrqCnt      = 0;
+		llHdl->thrMinMarginUs = 0xFFFFFFFF;
+		return;
+	}
+
+	if(marginUs < llHdl->thrMinMarginUs){
+		llHdl->thrMinMarginUs = marginUs;
+	}
+	if(++llHdl->thrIrqCnt >= Z246_THR_AUTO_WINDOW){
+		if(lev > 0){
+			if(llHdl->thrLevSeen[lev - 1] < llHdl->thrLevSeen[lev]){
+				stepUs = (llHdl->thrLevSeen[lev] - llHdl->thrLevSeen[lev - 1]) *
+						 llHdl->txWordUs;
+			}
+			if(llHdl->thrMinMarginUs > stepUs + Z246_THR_AUTO_MARGIN * llHdl->txWordUs){
+				ThrLevelSet(llHdl, lev - 1);
+			}
+		}
+		llHdl->thrIrqCnt      = 0;
+		llHdl->thrMinMarginUs = 0xFFFFFFFF;
+	}
+}
+
+/**********************************************************************/
+/** Record the latency of urgent words for the TX statistics.
+ *
+ *  The latency is the time the words waited in the urgent queue plus the
+ *  time to send the words which are ahead of them in the FIFO.
+ *
+ *  \param llHdl       \IN  low-level handle
+ *  \param queuedUs    \IN  time the words waited in the urgent queue [us]
+ *  \param fifoWords   \IN  words ahead in the FIFO
+ */
+void UrgentLatency(LL_HANDLE *llHdl, u_int32 queuedUs, u_int32 fifoWords){
+	u_int32 latUs = queuedUs + fifoWords * llHdl->txWordUs;
+
+	if(latUs > llHdl->txUrgMaxLatUs){
+		llHdl->txUrgMaxLatUs = latUs;
+	}
+}
+
+/**********************************************************************/
+/** Add an urgent burst to the time stamps of the urgent queue.
+ *
+ *  Must be called with the device interrupt masked, in the order the
+ *  words are placed in the urgent queue. If all entries are in use, the
+ *  words are added to the newest burst and measured from its time stamp,
+ *  i.e. their latency is overstated.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param len        \IN  words of the burst
+ *  \param tUs        \IN  Z246_TIMESTAMP() of the submission
+ *  \return           new entry or NULL if the words were added to the newest
+ */
+Z246_URG_MARK *UrgMarkPush(LL_HANDLE *llHdl, u_int32 len, u_int32 tUs){
+	Z246_URG_MARK *m;
+
+	llHdl->urgSeqIn += len;
+	if(llHdl->urgMarkNum == Z246_URG_MARKS){
+		m = &llHdl->urgMark[(llHdl->urgMarkFirst + Z246_URG_MARKS - 1) % Z246_URG_MARKS];
+		m->end  = llHdl->urgSeqIn;
+		m->len += len;
+		return NULL;
+	}
+	m = &llHdl->urgMark[(llHdl->urgMarkFirst + llHdl->urgMarkNum) % Z246_URG_MARKS];
+	m->end   = llHdl->urgSeqIn;
+	m->len   = len;
+	m->tUs   = tUs;
+	m->timed = 0;
+	llHdl->urgMarkNum++;
+	return m;
+}
+
+/**********************************************************************/
+/** Log the latency of urgent words taken from the urgent queue.
+ *
+ *  Must be called with the device interrupt masked, after the words were
+ *  written to the FIFO. The latency of each burst with words among the
+ *  taken ones is logged for its first taken word. For a timed burst whose
+ *  first word was written, the release result is logged. Bursts which
+ *  left the queue completely are removed.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param num        \IN  words taken from the urgent queue, 0 = only remove
+ *                          the bursts discarded by a flush
+ *  \param fifoWords  \IN  words in the FIFO ahead of the taken words
+ */
+void UrgMarkTake(LL_HANDLE *llHdl, u_int32 num, u_int32 fifoWords){
+	Z246_URG_MARK *m;
+	u_int32 now = Z246_TIMESTAMP(llHdl);
+	u_int32 first = llHdl->urgSeqOut;
+	u_int32 start = 0;
+	u_int32 i = 0;
+
+	llHdl->urgSeqOut += num;
+	for(i=0; (num != 0) && (i < llHdl->urgMarkNum); i++){
+		m = &llHdl->urgMark[(llHdl->urgMarkFirst + i) % Z246_URG_MARKS];
+		start = m->end - m->len;
+		if((int32)(start - llHdl->urgSeqOut) >= 0){
+			break;
+		}
+		if((int32)(start - first) < 0){
+			start = first;
+		}else if(m->timed){
+			/* first word of a timed burst written to the FIFO */
+			TimedLog(llHdl, m, (int32)(m->lateUs + (now - m->tUs) +
+									   (fifoWords + start - first) * llHdl->txWordUs));
+		}
+		UrgentLatency(llHdl, now - m->tUs, fifoWords + (start - first));
+	}
+	while(llHdl->urgMarkNum != 0){
+		m = &llHdl->urgMark[llHdl->urgMarkFirst];
+		if((int32)(m->end - llHdl->urgSeqOut) > 0){
+			break;
+		}
+		llHdl->urgMarkFirst = (llHdl->urgMarkFirst + 1) % Z246_URG_MARKS;
+		llHdl->urgMarkNum--;
+	}
+}
+
+/**********************************************************************/
+/** Submit a burst for transmission at a given tick.
+ *
+ *  The burst is held in a slot, sorted by release tick, until the tick is
+ *  reached. It is then released by the alarm or by the refill interrupt,
+ *  see TimedRelease(). Bursts which are already due are released at once.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param tick       \IN  release tick (OSS_TickGet() time base)
+ *  \param data       \IN  data words
+ *  \param len        \IN  number of words (<= Z246_TIMED_MAX_WORDS)
+ *  \return           \c 0 on success or ERR_MBUF_OVERFLOW if all slots
+ *                    are in use
+ */
+int32 TimedSubmit(LL_HANDLE *llHdl, u_int32 tick, u_int32 *data, u_int32 len){
+	OSS_IRQ_STATE irqState;
+	Z246_TIMED *t;
+	u_int32 pos = 0;
+	u_int32 i = 0;
+	u_int8 slot = 0;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	if(llHdl->timedCnt == Z246_TIMED_SLOTS){
+		llHdl->txOverflows++;
+		OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+		return ERR_MBUF_OVERFLOW;
+	}
+	llHdl->txAccepted += len;
+
+	/* take the first free slot */
+	slot = llHdl->timedOrder[llHdl->timedCnt];
+	t = &llHdl->timed[slot];
+	t->tick = tick;
+	t->len  = len;
+	for(i=0;i<len;i++){
+		t->data[i] = data[i];
+	}
+
+	/* insert sorted by tick, after bursts with the same tick */
+	pos = llHdl->timedCnt;
+	while((pos > 0) &&
+		  ((int32)(llHdl->timed[llHdl->timedOrder[pos-1]].tick - tick) > 0)){
+		llHdl->timedOrder[pos] = llHdl->timedOrder[pos-1];
+		pos--;
+	}
+	llHdl->timedOrder[pos] = slot;
+	llHdl->timedCnt++;
+
+	if(TimedRelease(llHdl) != 0){
+		HwWrite(llHdl);
+	}
+	TxAlarmArm(llHdl);
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+
+	return ERR_SUCCESS;
+}
+
+/**********************************************************************/
+/** Release due timed bursts into the urgent queue.
+ *
+ *  Must be called with the device interrupt masked. A due burst which does
+ *  not fit into the urgent queue, or finds no free entry for its time
+ *  stamp, stays pending until the next refill interrupt. The result of
+ *  the burst is logged when its first word is written to the FIFO, see
+ *  UrgMarkTake().
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \return           number of released bursts
+ */
+u_int32 TimedRelease(LL_HANDLE *llHdl){
+	Z246_QUEUE *q = &llHdl->txq[Z246_PRIO_HIGH];
+	Z246_URG_MARK *m;
+	Z246_TIMED *t;
+	u_int32 now = OSS_TickGet(OSH);
+	u_int32 released = 0;
+	u_int32 i = 0;
+	u_int8 slot = 0;
+
+	while(llHdl->timedCnt != 0){
+		slot = llHdl->timedOrder[0];
+		t = &llHdl->timed[slot];
+		if((int32)(now - t->tick) < 0){
+			break;
+		}
+		if((t->len > (q->size - q->cnt - q->resvCnt)) ||
+		   (llHdl->urgMarkNum == Z246_URG_MARKS)){
+			break;
+		}
+
+		/* append to the urgent queue, behind reservations of writers */
+		m = UrgMarkPush(llHdl, t->len, Z246_TIMESTAMP(llHdl));
+		m->timed  = t->len;
+		m->tick   = t->tick;
+		m->lateUs = (now - t->tick) * llHdl->tickUs;
+		QueueAppend(q, t->data, t->len);
+
+		/* free the slot */
+		llHdl->timedCnt--;
+		for(i=0;i<llHdl->timedCnt;i++){
+			llHdl->timedOrder[i] = llHdl->timedOrder[i+1];
+		}
+		llHdl->timedOrder[llHdl->timedCnt] = slot;
+		released++;
+	}
+	return released;
+}
+
+/**********************************************************************/
+/** Log the result of a timed burst.
+ *
+ *  Must be called with the device interrupt masked. The oldest result is
+ *  overwritten if Z246_TIMED_RES_NUM results are unread.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param m          \IN  urgent queue entry of the burst
+ *  \param errUs      \IN  release error [us]
+ */
+void TimedLog(LL_HANDLE *llHdl, Z246_URG_MARK *m, int32 errUs){
+	Z246_TIMED_LOG *log = &llHdl->timedLog[llHdl->timedLogHead];
+
+	log->tick  = m->tick;
+	log->len   = m->timed;
+	log->errUs = errUs;
+	llHdl->timedLogHead = (llHdl->timedLogHead + 1) % Z246_TIMED_RES_NUM;
+	if(llHdl->timedLogCnt < Z246_TIMED_RES_NUM){
+		llHdl->timedLogCnt++;
+	}
+}
+
+/**********************************************************************/
+/** Arm the alarm for the next pending timed burst or throttled data.
+ *
+ *  Must be called with the device interrupt masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ */
+void TxAlarmArm(LL_HANDLE *llHdl){
+	u_int32 delta = 0;
+	u_int32 msec = 0;
+	u_int32 realMsec = 0;
+
+	if(llHdl->timedCnt != 0){
+		msec = 1;
+		delta = llHdl->timed[llHdl->timedOrder[0]].tick - OSS_TickGet(OSH);
+		if(((int32)delta > 0) && (llHdl->tickRate != 0)){
+			msec = (delta * 1000) / llHdl->tickRate;
+			if(msec == 0){
+				msec = 1;
+			}
+		}
+	}
+	if((llHdl->txRateRetryMs != 0) &&
+	   ((msec == 0) || (llHdl->txRateRetryMs < msec))){
+		msec = llHdl->txRateRetryMs;
+	}
+
+	if(msec == 0){
+		OSS_AlarmClear(OSH, llHdl->alarmHdl);
+	}else{
+		OSS_AlarmSet(OSH, llHdl->alarmHdl, msec, 0, &realMsec);
+	}
+}
+
+/**********************************************************************/
+/** Alarm routine for timed transmission and throttled data.
+ *
+ *  \param arg        \IN  low-level handle
+ */
+void TxAlarm(void *arg){
+	LL_HANDLE *llHdl = (LL_HANDLE*)arg;
+	OSS_IRQ_STATE irqState;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	TimedRelease(llHdl);
+	HwWrite(llHdl);
+	TxAlarmArm(llHdl);
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+}
+
+/**********************************************************************/
+/** Take words from the token bucket of a TX queue.
+ *
+ *  The bucket is refilled with the configured rate for the ticks elapsed
+ *  since the last call, up to txRateBurst words. Words held back are
+ *  counted once in the statistics, even if they are held back at several
+ *  refills.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param prio       \IN  Z246_PRIO_LOW or Z246_PRIO_HIGH
+ *  \param want       \IN  words which fit into the FIFO
+ *  \return           words which may be written
+ */
+u_int32 RateTake(LL_HANDLE *llHdl, u_int32 prio, u_int32 want){
+	Z246_RATE *r = &llHdl->txRate[prio];
+	u_int32 now = 0;
+	u_int32 elapsed = 0;
+	u_int32 max = 0;
+	u_int32 allowed = 0;
+	u_int32 held = 0;
+
+	if((r->rate == 0) || (llHdl->tickRate == 0)){
+		return want;
+	}
+
+	/* refill */
+	now = OSS_TickGet(OSH);
+	elapsed = now - r->tick;
+	r->tick = now;
+	max = llHdl->txRateBurst * llHdl->tickRate;
+	if(elapsed >= ((max - r->credit) / r->rate)){
+		r->credit = max;
+	}else{
+		r->credit += elapsed * r->rate;
+	}
+
+	allowed = r->credit / llHdl->tickRate;
+	if(allowed > want){
+		allowed = want;
+	}
+	r->credit -= allowed * llHdl->tickRate;
+
+	/* count each held back word once */
+	held = want - allowed;
+	r->held = (r->held > allowed) ? (r->held - allowed) : 0;
+	if(held > r->held){
+		llHdl->txThrottled += held - r->held;
+		r->held = held;
+	}
+	if(held != 0){
+		/* retry when the next word is available */
+		llHdl->txRateRetryMs = (1000 + r->rate - 1) / r->rate;
+	}
+	return allowed;
+}
+
+/**********************************************************************/
+/** Set the rate limit of a TX queue.
+ *
+ *  The token bucket starts full.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param prio       \IN  Z246_PRIO_LOW or Z246_PRIO_HIGH
+ *  \param rate       \IN  words per second, 0 = unlimited
+ */
+void RateSet(LL_HANDLE *llHdl, u_int32 prio, u_int32 rate){
+	Z246_RATE *r = &llHdl->txRate[prio];
+	OSS_IRQ_STATE irqState;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	r->rate   = rate;
+	r->credit = llHdl->txRateBurst * llHdl->tickRate;
+	r->tick   = OSS_TickGet(OSH);
+	r->held   = 0;
+	/* restart data held back by the old limit */
+	HwWrite(llHdl);
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+}
+
+/**********************************************************************/
+/** Charge a submission to the token bucket of a writer.
+ *
+ *  The bucket is refilled like the queue buckets, see RateTake(). A
+ *  submission is accepted while at least one word is left in the bucket
+ *  and then charged completely, so a block larger than txRateBurst is accepted
+ *  once and the writer has to wait until the debt is paid back. Rejected
+ *  words are counted in the statistics.
+ *
+ *  Must be called with the device interrupt masked.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param wr         \IN  writer, see Z246_WRITER()
+ *  \param len        \IN  number of words
+ *  \return           1 if the words may be submitted, else 0
+ */
+int32 WrRateTake(LL_HANDLE *llHdl, u_int32 wr, u_int32 len){
+	Z246_WR_RATE *r = &llHdl->wrRate[wr];
+	u_int32 now = 0;
+	u_int32 elapsed = 0;
+	int32 max = 0;
+
+	if((r->rate == 0) || (llHdl->tickRate == 0)){
+		return 1;
+	}
+
+	/* refill */
+	now = OSS_TickGet(OSH);
+	elapsed = now - r->tick;
+	r->tick = now;
+	max = (int32)(llHdl->txRateBurst * llHdl->tickRate);
+	if(elapsed >= ((u_int32)(max - r->credit) / r->rate)){
+		r->credit = max;
+	}else{
+		r->credit += (int32)(elapsed * r->rate);
+	}
+
+	if(r->credit < (int32)llHdl->tickRate){
+		llHdl->txThrottled += len;
+		return 0;
+	}
+	r->credit -= (int32)(len * llHdl->tickRate);
+	return 1;
+}
+
+/**********************************************************************/
+/** Set the rate limit of a writer.
+ *
+ *  The token bucket starts full.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param wr         \IN  writer, see Z246_WRITER()
+ *  \param rate       \IN  words per second, 0 = unlimited
+ */
+void WrRateSet(LL_HANDLE *llHdl, u_int32 wr, u_int32 rate){
+	Z246_WR_RATE *r = &llHdl->wrRate[wr];
+	OSS_IRQ_STATE irqState;
+
+	irqState = OSS_IrqMaskR(OSH, llHdl->irqHdl);
+	r->rate   = rate;
+	r->credit = (int32)(llHdl->txRateBurst * llHdl->tickRate);
+	r->tick   = OSS_TickGet(OSH);
+	OSS_IrqRestore(OSH, llHdl->irqHdl, irqState);
+}
+
+/**********************************************************************/
+/** Calculate the bus utilization since the last statistics reset.
+ *
+ *  The time per word of the configured speed includes the gap between
+ *  words, so a continuously busy bus reaches 1000.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \return           utilization in permille
+ */
+u_int32 BusUtil(LL_HANDLE *llHdl){
+	u_int32 words = llHdl->txDirectWords + llHdl->txRingWords;
+	u_int32 busyMs = 0;
+	u_int32 elapsedMs = 0;
+
+	if(llHdl->tickRate == 0){
+		return 0;
+	}
+	busyMs = (words / 1000) * llHdl->txWordUs +
+			 ((words % 1000) * llHdl->txWordUs) / 1000;
+	elapsedMs = OSS_TickGet(OSH) - llHdl->txStatsTick;
+	elapsedMs = (elapsedMs / llHdl->tickRate) * 1000 +
+				((elapsedMs % llHdl->tickRate) * 1000) / llHdl->tickRate;
+	if(elapsedMs == 0){
+		return 0;
+	}
+	/* avoid an overflow of busyMs * 1000 on long intervals */
+	if(elapsedMs > 1000000){
+		return busyMs / (elapsedMs / 1000);
+	}
+	return (busyMs * 1000) / elapsedMs;
+}
+
+/**********************************************************************/
+/** Copy data into a queue reservation.
+ *
+ *  \param q          \IN queue
+ *  \param start      \IN first index of the reservation
+ *  \param data       \IN data words
+ *  \param len        \IN number of words
+ */
+void QueueCopy(Z246_QUEUE *q, u_int32 start, u_int32 *data, u_int32 len){
+	u_int32 i = 0;
+
+	for(i=0;i<len;i++){
+		q->buf[start] = data[i];
+		if(++start == q->size){
+			start = 0;
+		}
+	}
+}
+
+/**********************************************************************/
+/** Append words to a TX queue with the interrupt masked.
+ *
+ *  Must be called with the device interrupt masked and enough free space.
+ *  The words are placed behind the open reservations. Without open
+ *  reservation they are committed at once, else they are added to the
+ *  newest reservation and committed with it.
+ *
+ *  \param q          \IN  queue
+ *  \param data       \IN  data words
+ *  \param len        \IN  number of words
+ */
+void QueueAppend(Z246_QUEUE *q, u_int32 *data, u_int32 len){
+	QueueCopy(q, q->resv, data, len);
+	q->resv = (q->resv + len) % q->size;
+	if(q->slotNum == 0){
+		q->head = q->resv;
+		q->cnt += len;
+	}else{
+		q->slot[(q->slotFirst + q->slotNum - 1) % Z246_RESV_SLOTS].len += len;
+		q->resvCnt += len;
+	}
+}
+
+/**********************************************************************/
+/** Commit the ready reservations at the start of a TX queue.
+ *
+ *  Must be called with the device interrupt masked. The head is advanced
+ *  over the oldest open reservations as long as they are ready, so the
+ *  words become visible to the interrupt routine in reservation order.
+ *
+ *  \param q          \IN  queue
+ *  \return           number of committed words
+ */
+u_int32 QueueCommit(Z246_QUEUE *q){
+	Z246_RESV *r;
+	u_int32 num = 0;
+
+	while(q->slotNum != 0){
+		r = &q->slot[q->slotFirst];
+		if(!r->ready){
+			break;
+		}
+		q->head = (q->head + r->len) % q->size;
+		q->cnt += r->len;
+		q->resvCnt -= r->len;
+		num += r->len;
+		q->slotFirst = (q->slotFirst + 1) % Z246_RESV_SLOTS;
+		q->slotNum--;
+	}
+	return num;
+}
+
+/**********************************************************************/
+/** Take data from a queue and encode it for the FIFO.
+ *
+ *  The queued words are contiguous from the tail up to the end of the ring
+ *  buffer, so they are encoded in at most two bursts.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param q          \IN  queue
+ *  \param dst        \OUT encoded words
+ *  \param len        \IN  number of words
+ *  \return           \c 0 on success or -1 if less data is queued
+ */
+int32 QueueEncode(LL_HANDLE *llHdl, Z246_QUEUE *q, u_int32 *dst, u_int32 len){
+	u_int32 seg = q->size - q->tail;
+
+	if(len > q->cnt){
+		return -1;
+	}
+	if(seg > len){
+		seg = len;
+	}
+	llHdl->txEncode(dst, &q->buf[q->tail], seg);
+	if(seg < len){
+		llHdl->txEncode(dst + seg, q->buf, len - seg);
+	}
+	q->tail = (q->tail + len) % q->size;
+	q->cnt -= len;
+	return 0;
+}
+
+/**********************************************************************/
+/** Log one interrupt in the instrumentation counters.
+ *
+ *  Called at the end of the ISR, the execution time includes everything
+ *  since t0 was taken at ISR entry.
+ *
+ *  \param llHdl      \IN  low-level handle
+ *  \param t0         \IN  Z246_TIMESTAMP() at ISR entry
+ *  \param words      \IN  words written to the FIFO
+ *  \param latUs      \IN  time from FIFO threshold to ISR entry [us]
+ */
+void IrqLatLog(LL_HANDLE *llHdl, u_int32 t0, u_int32 words, int32 latUs){
+	u_int32 durUs = Z246_TIMESTAMP(llHdl) - t0;
+
+	llHdl->irqCnt++;
+	llHdl->irqWords += words;
+	if(words > llHdl->irqMaxWords){
+		llHdl->irqMaxWords = words;
+	}
+	llHdl->irqWordsHist[HistBin(words)]++;
+
+	llHdl->irqDurSumUs += durUs;
+	if(durUs > llHdl->irqDurMaxUs){
+		llHdl->irqDurMaxUs = durUs;
+	}
+	llHdl->irqDurHist[HistBin(durUs)]++;
+
+	if(latUs >= 0){
+		llHdl->irqLatNum++;
+		llHdl->irqLatSumUs += (u_int32)latUs;
+		if((u_int32)latUs > llHdl->irqLatMaxUs){
+			llHdl->irqLatMaxUs = (u_int32)latUs;
+		}
+		llHdl->irqLatHist[HistBin((u_int32)latUs)]++;
+	}
+}
+
+/**********************************************************************/
+/** Histogram bin of a value.
+ *
+ *  \param value      \IN  value
+ *  \return           0 for 0, n for 2^(n-1)..2^n-1, last bin for larger values
+ */
+u_int32 HistBin(u_int32 value){
+	u_int32 bin = 0;
+
+	while((value != 0) && (bin < (Z246_IRQ_BINS - 1))){
+		value >>= 1;
+		bin++;
+	}
+	return bin;
+}
 
 /**********************************************************************/
 /** Print register configuration.
@@ -0,0 +1,625 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  z146_arc.c
+ *
+ *      \brief   Write and query capture archives (see z146_arc.h)
+ *
+ *               The writer collects the words of every channel and label
+ *               in a chunk buffer of Z146_ARC_CHUNK_MAX bytes, which is
+ *               allocated with the first word of the series. A full
+ *               chunk is appended to the file and gets an index entry,
+ *               the index is written by Z146_ArcFinish(). The records of
+ *               a channel must be in time order, as in a capture file.
+ *
+ *               A query holds the index in memory and reads only the
+ *               chunks of the requested series whose time range overlaps
+ *               the requested one.
+ *
+ *     Required: -
+ *     \switches (none)
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <MEN/men_typs.h>
+#include <MEN/z146_cap.h>
+#include <MEN/z146_arc.h>
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define VARINT_MAX		10			/* bytes of a 64 bit varint */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** series being written */
+typedef struct {
+	u_int8	*buf;			/* chunk buffer, NULL = no words yet */
+	u_int32	len;			/* bytes in buf */
+	u_int32	words;			/* words in buf */
+	u_int64	tFirst;
+	u_int64	t;				/* previous word, kept across chunks */
+	int64	dt;
+	u_int32	v;
+} ARC_SER;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static int32 ChunkWrite(Z146_ARC_WRITER *aw, u_int32 chan, u_int32 label,
+						ARC_SER *s);
+static int IdxCmp(const void *a, const void *b);
+static void HdrLe(Z146_ARC_HDR *hdr);
+static void IdxLe(Z146_ARC_IDX *idx, u_int32 num);
+static int32 IdxFind(Z146_ARC_FILE *af, int32 chan, int32 label,
+					 u_int64 fromUs);
+static u_int32 VarPut(u_int8 *buf, int64 n);
+static int32 VarGet(Z146_ARC_QUERY *q, int64 *n);
+
+/**********************************************************************/
+/** Create an archive.
+ *
+ *  \param aw         \OUT writer
+ *  \param name       \IN  file name
+ *  \param cap        \IN  header of the capture file
+ *  \param chunkWords \IN  max. words per chunk, 0 = Z146_ARC_CHUNK_WORDS
+ *  \return           \c 0 on success or -1 on error (see errno)
+ */
+int32 Z146_ArcCreate(Z146_ARC_WRITER *aw, const char *name,
+					 const Z146_CAP_HDR *cap, u_int32 chunkWords)
+{
+	Z146_ARC_HDR hdr;
+
+	memset(aw, 0, sizeof(*aw));
+	if (cap->chNum > Z146_CAP_CH_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+	aw->ser = calloc(Z146_CAP_CH_MAX * Z146_ARC_LABELS, sizeof(ARC_SER));
+	if (aw->ser == NULL)
+		return -1;
+	if ((aw->fp = fopen(name, "wb")) == NULL) {
+		free(aw->ser);
+		aw->ser = NULL;
+		return -1;
+	}
+
+	aw->hdr.magic      = Z146_ARC_MAGIC;
+	aw->hdr.version    = Z146_ARC_VERSION;
+	aw->hdr.hdrSize    = sizeof(Z146_ARC_HDR);
+	aw->hdr.chNum      = cap->chNum;
+	aw->hdr.speed      = cap->speed;
+	aw->hdr.startUs    = cap->startUs;
+	aw->hdr.chunkWords = chunkWords ? chunkWords : Z146_ARC_CHUNK_WORDS;
+	memcpy(aw->hdr.chName, cap->chName, sizeof(aw->hdr.chName));
+
+	/* the header is written again by Z146_ArcFinish() */
+	hdr = aw->hdr;
+	HdrLe(&hdr);
+	if (fwrite(&hdr, sizeof(hdr), 1, (FILE*)aw->fp) != 1) {
+		fclose((FILE*)aw->fp);
+		free(aw->ser);
+		aw->fp  = NULL;
+		aw->ser = NULL;
+		return -1;
+	}
+	aw->off = sizeof(Z146_ARC_HDR);
+	return 0;
+}
+
+/**********************************************************************/
+/** Store a record of a capture file.
+ *
+ *  A record before the previous record of its series gets the time of
+ *  the previous record.
+ *
+ *  \param aw         \IN  writer
+ *  \param rec        \IN  record
+ *  \return           \c 0 on success or -1 on error (see errno)
+ */
+int32 Z146_ArcPut(Z146_ARC_WRITER *aw, const Z146_CAP_REC *rec)
+{
+	ARC_SER *s = NULL;
+	u_int64 t = rec->timeUs;
+	u_int32 label = rec->word & 0xFF;
+	u_int32 v = rec->word >> 8;
+	int64 dt = 0;
+
+	if (rec->chan >= aw->hdr.chNum) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (rec->flags & Z146_CAP_F_LOSS) {
+		if (rec->flags & Z146_CAP_F_LOSS_DRV)
+			label = Z146_ARC_LOSS_DRV;
+		else if (rec->flags & Z146_CAP_F_LOSS_LINE)
+			label = Z146_ARC_LOSS_LINE;
+		else
+			label = Z146_ARC_LOSS_CAP;
+		v = rec->word;
+	}
+	else
+		aw->hdr.recFlags |= rec->flags & Z146_CAP_F_TIME_EST;
+	s = (ARC_SER*)aw->ser + rec->chan * Z146_ARC_LABELS + label;
+
+	/* clamp before a new chunk starts, IdxFind() needs monotonic chunks */
+	if (s->buf != NULL && t < s->t)
+		t = s->t;
+	if (s->words == 0) {
+		if (s->buf == NULL && (s->buf = malloc(Z146_ARC_CHUNK_MAX)) == NULL)
+			return -1;
+		s->len    = 0;
+		s->tFirst = t;
+		s->t      = t;
+		s->dt     = 0;
+		s->v      = 0;
+	}
+
+	dt = (int64)(t - s->t);
+	s->len += VarPut(s->buf + s->len, dt - s->dt);
+	s->len += VarPut(s->buf + s->len, (int64)v - (int64)s->v);
+	s->t  = t;
+	s->dt = dt;
+	s->v  = v;
+	s->words++;
+
+	if (aw->hdr.words == 0 || t < aw->hdr.tFirst)
+		aw->hdr.tFirst = t;
+	if (t > aw->hdr.tLast)
+		aw->hdr.tLast = t;
+	aw->hdr.words++;
+
+	if (s->words == aw->hdr.chunkWords ||
+		s->len + 2 * VARINT_MAX > Z146_ARC_CHUNK_MAX)
+		return ChunkWrite(aw, rec->chan, label, s);
+	return 0;
+}
+
+/**********************************************************************/
+/** Write the open chunks and the index and close the archive.
+ *
+ *  \param aw         \IN  writer
+ *  \return           \c 0 on success or -1 on error (see errno)
+ */
+int32 Z146_ArcFinish(Z146_ARC_WRITER *aw)
+{
+	FILE *fp = (FILE*)aw->fp;
+	ARC_SER *s = (ARC_SER*)aw->ser;
+	Z146_ARC_HDR hdr;
+	u_int32 ch = 0;
+	u_int32 label = 0;
+	int32 error = 0;
+
+	for (ch = 0; ch < Z146_CAP_CH_MAX && !error; ch++) {
+		for (label = 0; label < Z146_ARC_LABELS && !error; label++) {
+			if (s[ch * Z146_ARC_LABELS + label].words)
+				error = ChunkWrite(aw, ch, label, &s[ch * Z146_ARC_LABELS + label]);
+		}
+	}
+	for (ch = 0; ch < Z146_CAP_CH_MAX * Z146_ARC_LABELS; ch++)
+		free(s[ch].buf);
+	free(aw->ser);
+	aw->ser = NULL;
+
+	if (!error && aw->hdr.idxNum)
+		qsort(aw->idx, aw->hdr.idxNum, sizeof(Z146_ARC_IDX), IdxCmp);
+	aw->hdr.idxOff = aw->off;
+	hdr = aw->hdr;
+	HdrLe(&hdr);
+	IdxLe(aw->idx, aw->hdr.idxNum);
+	if (error ||
+		fwrite(aw->idx, sizeof(Z146_ARC_IDX), aw->hdr.idxNum, fp) !=
+		aw->hdr.idxNum ||
+		fseeko(fp, 0, SEEK_SET) != 0 ||
+		fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		error = -1;
+	if (fclose(fp) != 0)
+		error = -1;
+	free(aw->idx);
+	aw->idx = NULL;
+	aw->fp  = NULL;
+	return error;
+}
+
+/**********************************************************************/
+/** Open an archive for queries.
+ *
+ *  \param af         \OUT archive
+ *  \param name       \IN  file name
+ *  \return           \c 0 on success or -1 on error (see errno, EINVAL
+ *                    for a file which is no archive)
+ */
+int32 Z146_ArcOpen(Z146_ARC_FILE *af, const char *name)
+{
+	FILE *fp = NULL;
+	u_int32 i = 0;
+
+	memset(af, 0, sizeof(*af));
+	if ((fp = fopen(name, "rb")) == NULL)
+		return -1;
+
+	if (fread(&af->hdr, sizeof(af->hdr), 1, fp) != 1)
+		goto BAD;
+	HdrLe(&af->hdr);
+	if (af->hdr.magic != Z146_ARC_MAGIC ||
+		af->hdr.version != Z146_ARC_VERSION ||
+		af->hdr.hdrSize != sizeof(Z146_ARC_HDR) ||
+		af->hdr.chNum > Z146_CAP_CH_MAX)
+		goto BAD;
+
+	if (af->hdr.idxNum) {
+		af->idx = malloc(af->hdr.idxNum * sizeof(Z146_ARC_IDX));
+		if (af->idx == NULL) {
+			fclose(fp);
+			return -1;
+		}
+		if (fseeko(fp, (off_t)af->hdr.idxOff, SEEK_SET) != 0 ||
+			fread(af->idx, sizeof(Z146_ARC_IDX), af->hdr.idxNum, fp) !=
+			af->hdr.idxNum)
+			goto BAD;
+		IdxLe(af->idx, af->hdr.idxNum);
+		for (i = 0; i < af->hdr.idxNum; i++) {
+			if (af->idx[i].size > Z146_ARC_CHUNK_MAX ||
+				af->idx[i].chan >= af->hdr.chNum ||
+				af->idx[i].label >= Z146_ARC_LABELS)
+				goto BAD;
+		}
+	}
+	af->fp = fp;
+	return 0;
+
+BAD:
+	free(af->idx);
+	af->idx = NULL;
+	fclose(fp);
+	errno = EINVAL;
+	return -1;
+}
+
+/**********************************************************************/
+/** Start a query.
+ *
+ *  With a channel and a label the first chunk is found by a binary
+ *  search. The records of a query with Z146_ARC_ANY are returned series
+ *  by series, each in time order.
+ *
+ *  \param q          \OUT query
+ *  \param af         \IN  archive
+ *  \param chan       \IN  channel or Z146_ARC_ANY
+ *  \param label      \IN  label, Z146_ARC_LOSS_xxx or Z146_ARC_ANY
+ *  \param fromUs     \IN  first time [us since 1970]
+ *  \param toUs       \IN  last time [us since 1970]
+ */
+void Z146_ArcQueryInit(Z146_ARC_QUERY *q, Z146_ARC_FILE *af,
+					   int32 chan, int32 label,
+					   u_int64 fromUs, u_int64 toUs)
+{
+	q->af         = af;
+	q->chan       = chan;
+	q->label      = label;
+	q->fromUs     = fromUs;
+	q->toUs       = toUs;
+	q->chunksRead = 0;
+	q->cur        = NULL;
+	q->left       = 0;
+	q->next       = IdxFind(af, chan, label, fromUs);
+}
+
+/**********************************************************************/
+/** Read the next records of a query.
+ *
+ *  Data records carry the received word and the Z146_CAP_F_TIME_EST flag
+ *  of the capture, loss records the lost words and the
+ *  Z146_CAP_F_LOSS_xxx flag.
+ *
+ *  \param q          \IN  query
+ *  \param rec        \OUT records
+ *  \param max        \IN  size of rec in records
+ *  \return           number of records, 0 at the end of the query or -1
+ *                    on error (see errno)
+ */
+int32 Z146_ArcQueryRead(Z146_ARC_QUERY *q, Z146_CAP_REC *rec, u_int32 max)
+{
+	Z146_ARC_FILE *af = q->af;
+	Z146_ARC_IDX *e = NULL;
+	int64 dod = 0;
+	int64 dv = 0;
+	u_int32 n = 0;
+
+	while (n < max) {
+		/* next chunk of the query */
+		if (q->left == 0) {
+			q->cur = NULL;
+			for (; q->next < af->hdr.idxNum; q->next++) {
+				e = &af->idx[q->next];
+				if (q->chan != Z146_ARC_ANY && e->chan != q->chan) {
+					if (e->chan > q->chan)
+						q->next = af->hdr.idxNum;
+					continue;
+				}
+				if (q->label != Z146_ARC_ANY && e->label != q->label) {
+					if (q->chan != Z146_ARC_ANY && e->label > q->label)
+						q->next = af->hdr.idxNum;
+					continue;
+				}
+				if (e->tFirst > q->toUs && q->chan != Z146_ARC_ANY &&
+					q->label != Z146_ARC_ANY)
+					q->next = af->hdr.idxNum;
+				if (e->tLast < q->fromUs || e->tFirst > q->toUs)
+					continue;
+				q->cur = e;
+				q->next++;
+				break;
+			}
+			if (q->cur == NULL)
+				break;
+
+			e = q->cur;
+			if (fseeko((FILE*)af->fp, (off_t)e->off, SEEK_SET) != 0 ||
+				fread(q->buf, 1, e->size, (FILE*)af->fp) != e->size) {
+				if (!ferror((FILE*)af->fp))
+					errno = EINVAL;
+				return -1;
+			}
+			q->pos  = 0;
+			q->left = e->words;
+			q->t    = e->tFirst;
+			q->dt   = 0;
+			q->v    = 0;
+			q->chunksRead++;
+		}
+
+		e = q->cur;
+		if (VarGet(q, &dod) < 0 || VarGet(q, &dv) < 0) {
+			errno = EINVAL;
+			return -1;
+		}
+		q->dt += dod;
+		q->t  += q->dt;
+		q->v   = (u_int32)((int64)q->v + dv);
+		q->left--;
+
+		if (q->t < q->fromUs)
+			continue;
+		if (q->t > q->toUs) {
+			q->left = 0;
+			continue;
+		}
+		rec[n].timeUs   = q->t;
+		rec[n].chan     = e->chan;
+		rec[n].reserved = 0;
+		switch (e->label) {
+		case Z146_ARC_LOSS_DRV:
+			rec[n].word  = q->v;
+			rec[n].flags = Z146_CAP_F_LOSS_DRV;
+			break;
+		case Z146_ARC_LOSS_LINE:
+			rec[n].word  = q->v;
+			rec[n].flags = Z146_CAP_F_LOSS_LINE;
+			break;
+		case Z146_ARC_LOSS_CAP:
+			rec[n].word  = q->v;
+			rec[n].flags = Z146_CAP_F_LOSS_CAP;
+			break;
+		default:
+			rec[n].word  = (q->v << 8) | e->label;
+			rec[n].flags = (u_int8)af->hdr.recFlags;
+		}
+		n++;
+	}
+	return (int32)n;
+}
+
+/**********************************************************************/
+/** Close an archive.
+ *
+ *  \param af         \IN  archive
+ */
+void Z146_ArcClose(Z146_ARC_FILE *af)
+{
+	if (af->fp != NULL)
+		fclose((FILE*)af->fp);
+	free(af->idx);
+	af->fp  = NULL;
+	af->idx = NULL;
+}
+
+/**********************************************************************/
+/** Append the chunk of a series to the archive.
+ *
+ *  \param aw         \IN  writer
+ *  \param chan       \IN  channel
+ *  \param label      \IN  series label
+ *  \param s          \IN  series, the chunk is emptied
+ *  \return           \c 0 on success or -1 on error (see errno)
+ */
+static int32 ChunkWrite(Z146_ARC_WRITER *aw, u_int32 chan, u_int32 label,
+						ARC_SER *s)
+{
+	Z146_ARC_IDX *e = NULL;
+	void *idx = NULL;
+
+	if (aw->hdr.idxNum == aw->idxMax) {
+		idx = realloc(aw->idx, (aw->idxMax ? 2 * aw->idxMax : 1024) *
+					  sizeof(Z146_ARC_IDX));
+		if (idx == NULL)
+			return -1;
+		aw->idx = idx;
+		aw->idxMax = aw->idxMax ? 2 * aw->idxMax : 1024;
+	}
+	if (fwrite(s->buf, 1, s->len, (FILE*)aw->fp) != s->len)
+		return -1;
+
+	e = &aw->idx[aw->hdr.idxNum++];
+	memset(e, 0, sizeof(*e));
+	e->off    = aw->off;
+	e->tFirst = s->tFirst;
+	e->tLast  = s->t;
+	e->size   = s->len;
+	e->words  = s->words;
+	e->chan   = (u_int8)chan;
+	e->label  = (u_int16)label;
+
+	aw->off += s->len;
+	s->len   = 0;
+	s->words = 0;
+	return 0;
+}
+
+/**********************************************************************/
+/** Order of the index: channel, label, time.
+ */
+static int IdxCmp(const void *a, const void *b)
+{
+	const Z146_ARC_IDX *x = (const Z146_ARC_IDX*)a;
+	const Z146_ARC_IDX *y = (const Z146_ARC_IDX*)b;
+
+	if (x->chan != y->chan)
+		return (x->chan < y->chan) ? -1 : 1;
+	if (x->label != y->label)
+		return (x->label < y->label) ? -1 : 1;
+	if (x->tFirst != y->tFirst)
+		return (x->tFirst < y->tFirst) ? -1 : 1;
+	return (x->off < y->off) ? -1 : (x->off > y->off);
+}
+
+/**********************************************************************/
+/** Convert the header between host and file byte order.
+ *
+ *  \param hdr        \IN  header, converted in place
+ */
+static void HdrLe(Z146_ARC_HDR *hdr)
+{
+	hdr->magic      = Z146_CapLe32(hdr->magic);
+	hdr->version    = Z146_CapLe16(hdr->version);
+	hdr->hdrSize    = Z146_CapLe16(hdr->hdrSize);
+	hdr->chNum      = Z146_CapLe16(hdr->chNum);
+	hdr->recFlags   = Z146_CapLe16(hdr->recFlags);
+	hdr->speed      = Z146_CapLe32(hdr->speed);
+	hdr->startUs    = Z146_CapLe64(hdr->startUs);
+	hdr->idxOff     = Z146_CapLe64(hdr->idxOff);
+	hdr->idxNum     = Z146_CapLe32(hdr->idxNum);
+	hdr->chunkWords = Z146_CapLe32(hdr->chunkWords);
+	hdr->words      = Z146_CapLe64(hdr->words);
+	hdr->tFirst     = Z146_CapLe64(hdr->tFirst);
+	hdr->tLast      = Z146_CapLe64(hdr->tLast);
+}
+
+/**********************************************************************/
+/** Convert index entries between host and file byte order.
+ *
+ *  \param idx        \IN  index entries, converted in place
+ *  \param num        \IN  number of entries
+ */
+static void IdxLe(Z146_ARC_IDX *idx, u_int32 num)
+{
+	u_int32 i = 0;
+
+	if (Z146_CapLe16(1) == 1)
+		return;
+	for (i = 0; i < num; i++) {
+		idx[i].off    = Z146_CapLe64(idx[i].off);
+		idx[i].tFirst = Z146_CapLe64(idx[i].tFirst);
+		idx[i].tLast  = Z146_CapLe64(idx[i].tLast);
+		idx[i].size   = Z146_CapLe32(idx[i].size);
+		idx[i].words  = Z146_CapLe32(idx[i].words);
+		idx[i].label  = Z146_CapLe16(idx[i].label);
+	}
+}
+
+/**********************************************************************/
+/** Find the first index entry which may hold records of a query.
+ *
+ *  \param af         \IN  archive
+ *  \param chan       \IN  channel or Z146_ARC_ANY
+ *  \param label      \IN  label or Z146_ARC_ANY
+ *  \param fromUs     \IN  first time
+ *  \return           index entry
+ */
+static int32 IdxFind(Z146_ARC_FILE *af, int32 chan, int32 label,
+					 u_int64 fromUs)
+{
+	Z146_ARC_IDX *e = NULL;
+	u_int32 lo = 0;
+	u_int32 hi = af->hdr.idxNum;
+	u_int32 mid = 0;
+	int before = 0;
+
+	if (chan == Z146_ARC_ANY)
+		return 0;
+	if (label == Z146_ARC_ANY) {
+		label  = 0;
+		fromUs = 0;
+	}
+
+	/* first entry not before (chan, label, fromUs), by its end time */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		e = &af->idx[mid];
+		if (e->chan != chan)
+			before = e->chan < chan;
+		else if (e->label != label)
+			before = e->label < label;
+		else
+			before = e->tLast < fromUs;
+		if (before)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return (int32)lo;
+}
+
+/**********************************************************************/
+/** Store a zigzag coded LEB128 varint.
+ *
+ *  \param buf        \OUT buffer, VARINT_MAX bytes
+ *  \param n          \IN  value
+ *  \return           bytes stored
+ */
+static u_int32 VarPut(u_int8 *buf, int64 n)
+{
+	u_int64 u = ((u_int64)n << 1) ^ (u_int64)(n >> 63);
+	u_int32 len = 0;
+
+	while (u >= 0x80) {
+		buf[len++] = (u_int8)(u | 0x80);
+		u >>= 7;
+	}
+	buf[len++] = (u_int8)u;
+	return len;
+}
+
+/**********************************************************************/
+/** Decode a zigzag coded LEB128 varint of the current chunk.
+ *
+ *  \param q          \IN  query
+ *  \param n          \OUT value
+ *  \return           \c 0 on success or -1 at the end of the chunk
+ */
+static int32 VarGet(Z146_ARC_QUERY *q, int64 *n)
+{
+	u_int64 u = 0;
+	u_int32 shift = 0;
+	u_int8 b = 0;
+
+	do {
+		if (q->pos >= q->cur->size || shift >= 64)
+			return -1;
+		b = q->buf[q->pos++];
+		u |= (u_int64)(b & 0x7F) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	*n = (int64)(u >> 1) ^ -(int64)(u & 1);
+	return 0;
+}
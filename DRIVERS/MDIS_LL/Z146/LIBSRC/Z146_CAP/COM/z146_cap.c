@@ -0,0 +1,228 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  z146_cap.c
+ *
+ *      \brief   Read capture files of z146_capture
+ *
+ *               The records are read with stdio in the order they are
+ *               stored, so files of any size are read in constant memory.
+ *               Z146_CapSeek() positions to a record, e.g. to split a
+ *               file between threads. Files above 2 GB need large file
+ *               support, it is enabled here with _FILE_OFFSET_BITS.
+ *
+ *               The file is little endian, the byte order of the host
+ *               is checked at run time, so no compiler switch is needed.
+ *
+ *     Required: -
+ *     \switches (none)
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <MEN/men_typs.h>
+#include <MEN/z146_cap.h>
+
+/**********************************************************************/
+/** Initialize a file header.
+ *
+ *  Sets magic, version and sizes, all other fields are cleared.
+ *
+ *  \param hdr        \OUT file header
+ */
+void Z146_CapHdrInit(Z146_CAP_HDR *hdr)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->magic   = Z146_CAP_MAGIC;
+	hdr->version = Z146_CAP_VERSION;
+	hdr->hdrSize = sizeof(Z146_CAP_HDR);
+	hdr->recSize = sizeof(Z146_CAP_REC);
+}
+
+/**********************************************************************/
+/** Convert a 16 bit value between host and file byte order.
+ *
+ *  The file byte order is little endian, the conversion is the same in
+ *  both directions.
+ *
+ *  \param v          \IN  value
+ *  \return           converted value
+ */
+u_int16 Z146_CapLe16(u_int16 v)
+{
+	static const u_int16 one = 1;
+
+	if (*(const u_int8*)&one)
+		return v;
+	return (u_int16)((v >> 8) | (v << 8));
+}
+
+/**********************************************************************/
+/** Convert a 32 bit value between host and file byte order.
+ *
+ *  \param v          \IN  value
+ *  \return           converted value
+ */
+u_int32 Z146_CapLe32(u_int32 v)
+{
+	static const u_int16 one = 1;
+
+	if (*(const u_int8*)&one)
+		return v;
+	return (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+}
+
+/**********************************************************************/
+/** Convert a 64 bit value between host and file byte order.
+ *
+ *  \param v          \IN  value
+ *  \return           converted value
+ */
+u_int64 Z146_CapLe64(u_int64 v)
+{
+	return ((u_int64)Z146_CapLe32((u_int32)v) << 32) |
+		Z146_CapLe32((u_int32)(v >> 32));
+}
+
+/**********************************************************************/
+/** Convert a file header between host and file byte order.
+ *
+ *  \param hdr        \IN  file header, converted in place
+ */
+void Z146_CapHdrLe(Z146_CAP_HDR *hdr)
+{
+	hdr->magic   = Z146_CapLe32(hdr->magic);
+	hdr->version = Z146_CapLe16(hdr->version);
+	hdr->hdrSize = Z146_CapLe16(hdr->hdrSize);
+	hdr->recSize = Z146_CapLe16(hdr->recSize);
+	hdr->chNum   = Z146_CapLe16(hdr->chNum);
+	hdr->speed   = Z146_CapLe32(hdr->speed);
+	hdr->startUs = Z146_CapLe64(hdr->startUs);
+	hdr->fileNo  = Z146_CapLe32(hdr->fileNo);
+	hdr->parEn   = Z146_CapLe32(hdr->parEn);
+	hdr->parTyp  = Z146_CapLe32(hdr->parTyp);
+}
+
+/**********************************************************************/
+/** Convert records between host and file byte order.
+ *
+ *  \param rec        \IN  records, converted in place
+ *  \param num        \IN  number of records
+ */
+void Z146_CapRecLe(Z146_CAP_REC *rec, u_int32 num)
+{
+	static const u_int16 one = 1;
+	u_int32 i = 0;
+
+	if (*(const u_int8*)&one)
+		return;
+	for (i = 0; i < num; i++) {
+		rec[i].timeUs = Z146_CapLe64(rec[i].timeUs);
+		rec[i].word   = Z146_CapLe32(rec[i].word);
+	}
+}
+
+/**********************************************************************/
+/** Open a capture file for reading.
+ *
+ *  The header is read, converted to host byte order and checked, the
+ *  file is positioned at the first record.
+ *
+ *  \param cf         \OUT file handle
+ *  \param name       \IN  file name
+ *  \return           \c 0 on success or -1 on error (see errno, EINVAL
+ *                    for a file which is no capture file)
+ */
+int32 Z146_CapOpen(Z146_CAP_FILE *cf, const char *name)
+{
+	FILE *fp = NULL;
+	off_t size = 0;
+
+	memset(cf, 0, sizeof(*cf));
+	if ((fp = fopen(name, "rb")) == NULL)
+		return -1;
+
+	if (fread(&cf->hdr, sizeof(cf->hdr), 1, fp) != 1) {
+		fclose(fp);
+		errno = EINVAL;
+		return -1;
+	}
+	Z146_CapHdrLe(&cf->hdr);
+	if (cf->hdr.magic != Z146_CAP_MAGIC ||
+		cf->hdr.version != Z146_CAP_VERSION ||
+		cf->hdr.hdrSize != sizeof(Z146_CAP_HDR) ||
+		cf->hdr.recSize != sizeof(Z146_CAP_REC) ||
+		cf->hdr.chNum > Z146_CAP_CH_MAX) {
+		fclose(fp);
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* a record cut off at the end is ignored */
+	if (fseeko(fp, 0, SEEK_END) != 0 || (size = ftello(fp)) < 0 ||
+		fseeko(fp, sizeof(Z146_CAP_HDR), SEEK_SET) != 0) {
+		fclose(fp);
+		return -1;
+	}
+	cf->recNum = (u_int64)(size - sizeof(Z146_CAP_HDR)) / sizeof(Z146_CAP_REC);
+	cf->fp = fp;
+	return 0;
+}
+
+/**********************************************************************/
+/** Read the next records.
+ *
+ *  The records are converted to host byte order.
+ *
+ *  \param cf         \IN  file handle
+ *  \param rec        \OUT records
+ *  \param max        \IN  size of rec in records
+ *  \return           number of records, 0 at the end of the file or -1
+ *                    on error (see errno)
+ */
+int32 Z146_CapRead(Z146_CAP_FILE *cf, Z146_CAP_REC *rec, u_int32 max)
+{
+	size_t num = fread(rec, sizeof(Z146_CAP_REC), max, (FILE*)cf->fp);
+
+	if (num == 0 && ferror((FILE*)cf->fp))
+		return -1;
+	Z146_CapRecLe(rec, (u_int32)num);
+	return (int32)num;
+}
+
+/**********************************************************************/
+/** Position to a record.
+ *
+ *  \param cf         \IN  file handle
+ *  \param rec        \IN  record number, 0 = first record
+ *  \return           \c 0 on success or -1 on error (see errno)
+ */
+int32 Z146_CapSeek(Z146_CAP_FILE *cf, u_int64 rec)
+{
+	if (rec > cf->recNum) {
+		errno = EINVAL;
+		return -1;
+	}
+	return fseeko((FILE*)cf->fp,
+				  (off_t)(sizeof(Z146_CAP_HDR) + rec * sizeof(Z146_CAP_REC)),
+				  SEEK_SET);
+}
+
+/**********************************************************************/
+/** Close a capture file.
+ *
+ *  \param cf         \IN  file handle
+ */
+void Z146_CapClose(Z146_CAP_FILE *cf)
+{
+	if (cf->fp != NULL)
+		fclose((FILE*)cf->fp);
+	cf->fp = NULL;
+}
@@ -0,0 +1,19 @@
+#***************************  M a k e f i l e  *******************************
+#
+#    Description: Makefile definitions for the Z146 user space access library
+#
+#---------------------------------[ History ]---------------------------------
+#
+#-----------------------------------------------------------------------------
+#   (c) Copyright 2000 by MEN mikro elektronik GmbH, Nuernberg, Germany
+#*****************************************************************************
+
+MAK_NAME=z146_uio
+
+MAK_INCL=$(MEN_INC_DIR)/z146_uio.h	\
+         $(MEN_INC_DIR)/z146_regs.h	\
+         $(MEN_INC_DIR)/men_typs.h	\
+
+MAK_INP1=z146_uio$(INP_SUFFIX)
+
+MAK_INP=$(MAK_INP1)
@@ -0,0 +1,236 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  z146_uio.c
+ *
+ *      \brief   Polled user space access to the 16Z146 receiver and the
+ *               16Z246 transmitter
+ *
+ *               The functions work on the register window of one core,
+ *               mapped from a Linux UIO device with Z146_UioOpen() or
+ *               given as plain memory with Z146_UioAttach(), e.g. a
+ *               register model. They do the same register accesses as the
+ *               polled read of z146_drv.c and the FIFO refill of
+ *               z246_drv.c, without interrupt, signal and system call.
+ *
+ *               The core must not be opened by the MDIS driver at the
+ *               same time. The registers are accessed in host byte order.
+ *
+ *     Required: -
+ *     \switches UIO_READ_D8/D32, UIO_WRITE_D8/D32: register accesses,
+ *               predefined e.g. by the host simulator to route them to its
+ *               register model
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <MEN/men_typs.h>
+#include <MEN/z146_regs.h>
+#include <MEN/z146_uio.h>
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#ifndef UIO_READ_D8
+# define UIO_READ_D8(u, offs)		(*(volatile u_int8*)((u)->base + (offs)))
+# define UIO_READ_D32(u, offs)		(*(volatile u_int32*)((u)->base + (offs)))
+# define UIO_WRITE_D8(u, offs, val)	(*(volatile u_int8*)((u)->base + (offs)) = (u_int8)(val))
+# define UIO_WRITE_D32(u, offs, val)	(*(volatile u_int32*)((u)->base + (offs)) = (u_int32)(val))
+#endif
+
+/**********************************************************************/
+/** Map the register window of a UIO device.
+ *
+ *  \param uio        \OUT access handle
+ *  \param device     \IN  UIO device, e.g. "/dev/uio0"
+ *  \param size       \IN  size of the mapping, 0 = Z146_UIO_WIN_SIZE
+ *  \return           \c 0 on success or -1 on error (see errno)
+ */
+int32 Z146_UioOpen(Z146_UIO *uio, const char *device, u_int32 size)
+{
+	void *map = NULL;
+	int fd = -1;
+
+	if (size == 0)
+		size = Z146_UIO_WIN_SIZE;
+
+	if ((fd = open(device, O_RDWR | O_SYNC)) < 0)
+		return -1;
+
+	/* map 0 of the UIO device */
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+
+	Z146_UioAttach(uio, map);
+	uio->map     = map;
+	uio->mapSize = size;
+	uio->fd      = fd;
+	return 0;
+}
+
+/**********************************************************************/
+/** Use a register window which is already mapped.
+ *
+ *  \param uio        \OUT access handle
+ *  \param base       \IN  start of the register window
+ */
+void Z146_UioAttach(Z146_UIO *uio, void *base)
+{
+	uio->base        = (volatile u_int8*)base;
+	uio->map         = NULL;
+	uio->mapSize     = 0;
+	uio->fd          = -1;
+	uio->txMask      = Z246_24_BIT_MASK;
+	uio->rxLsrErrors = 0;
+}
+
+/**********************************************************************/
+/** Release the register window.
+ *
+ *  \param uio        \IN  access handle
+ */
+void Z146_UioClose(Z146_UIO *uio)
+{
+	if (uio->map != NULL)
+		munmap(uio->map, uio->mapSize);
+	if (uio->fd >= 0)
+		close(uio->fd);
+	uio->map  = NULL;
+	uio->fd   = -1;
+	uio->base = NULL;
+}
+
+/**********************************************************************/
+/** Configure the receiver for polling.
+ *
+ *  The interrupts are disabled, the received data is discarded.
+ *
+ *  \param uio        \IN  access handle
+ *  \param lcr        \IN  RX_LCR value
+ *  \param fcr        \IN  RX_FCR value
+ *  \param labels     \IN  receive labels
+ *  \param labNum     \IN  number of labels, up to Z146_RX_LA_SIZE
+ */
+void Z146_UioRxInit(Z146_UIO *uio, u_int8 lcr, u_int8 fcr,
+					const u_int8 *labels, u_int32 labNum)
+{
+	u_int32 i = 0;
+
+	if (labNum > Z146_RX_LA_SIZE)
+		labNum = Z146_RX_LA_SIZE;
+
+	UIO_WRITE_D8(uio, Z146_RX_IER_OFFSET, 0);
+	UIO_WRITE_D8(uio, Z146_RX_LCR_OFFSET, lcr);
+	UIO_WRITE_D8(uio, Z146_RX_FCR_OFFSET, fcr);
+	UIO_WRITE_D8(uio, Z146_RX_TIMEOUT_OFFSET, Z146_RX_TIMEOUT_DEFAULT);
+	for (i = 0; i < Z146_RX_LA_SIZE; i++) {
+		UIO_WRITE_D8(uio, Z146_RX_LA_OFFSET + i,
+					 (i < labNum) ? labels[i] : Z146_RX_LA_DEFAULT);
+	}
+	UIO_WRITE_D8(uio, Z146_RX_LA_NUM_OFFSET, labNum & Z146_RX_LA_NUM_MASK);
+
+	UIO_WRITE_D8(uio, Z146_RX_RXA_OFFSET, UIO_READ_D8(uio, Z146_RX_RXC_REG_OFFSET));
+	UIO_WRITE_D8(uio, Z146_LSR_REG_OFFSET, Z146_LSR_RESET_VAL);
+}
+
+/**********************************************************************/
+/** Read the received words from the FIFO.
+ *
+ *  Reads up to max words and acknowledges them. Line status errors are
+ *  counted in uio->rxLsrErrors and cleared; the words are returned as
+ *  written to the FIFO by the core (see RX_ERR_WE).
+ *
+ *  \param uio        \IN  access handle
+ *  \param buf        \OUT received words
+ *  \param max        \IN  size of buf in words
+ *  \return           number of words read
+ */
+int32 Z146_UioRxPoll(Z146_UIO *uio, u_int32 *buf, u_int32 max)
+{
+	u_int32 len = UIO_READ_D8(uio, Z146_RX_RXC_REG_OFFSET);
+	u_int32 i = 0;
+
+	if (UIO_READ_D8(uio, Z146_LSR_REG_OFFSET) & Z146_LSR_RESET_VAL) {
+		uio->rxLsrErrors++;
+		UIO_WRITE_D8(uio, Z146_LSR_REG_OFFSET, Z146_LSR_RESET_VAL);
+	}
+	if (len == 0)
+		return 0;
+
+	if (len > max)
+		len = max;
+	for (i = 0; i < len; i++)
+		buf[i] = UIO_READ_D32(uio, Z146_RX_FIFO_START_ADDR + (i * 4));
+	UIO_WRITE_D8(uio, Z146_RX_RXA_OFFSET, len);
+
+	return (int32)len;
+}
+
+/**********************************************************************/
+/** Configure the transmitter for polling.
+ *
+ *  \param uio        \IN  access handle
+ *  \param lcr        \IN  TX_LCR value
+ *  \param label      \IN  transmit label (TX_LA)
+ */
+void Z146_UioTxInit(Z146_UIO *uio, u_int8 lcr, u_int8 label)
+{
+	UIO_WRITE_D8(uio, Z246_TX_IER_OFFSET, 0);
+	UIO_WRITE_D8(uio, Z246_TX_LCR_OFFSET, lcr);
+	UIO_WRITE_D8(uio, Z246_TX_LA_OFFSET, label);
+
+	/* data bits left by parity and SDI, as UpdateTxEncoding() */
+	if ((lcr & Z246_LCR_PAR_MASK) && (lcr & Z246_LCR_SDI_MASK))
+		uio->txMask = Z246_21_BIT_MASK;
+	else if (lcr & Z246_LCR_SDI_MASK)
+		uio->txMask = Z246_22_BIT_MASK;
+	else if (lcr & Z246_LCR_PAR_MASK)
+		uio->txMask = Z246_23_BIT_MASK;
+	else
+		uio->txMask = Z246_24_BIT_MASK;
+}
+
+/**********************************************************************/
+/** Get the free space of the transmit FIFO.
+ *
+ *  \param uio        \IN  access handle
+ *  \return           free FIFO space in words
+ */
+u_int32 Z146_UioTxFree(Z146_UIO *uio)
+{
+	return Z246_TX_FIFO_MAX - UIO_READ_D8(uio, Z246_TX_TXC_OFFSET);
+}
+
+/**********************************************************************/
+/** Write words to the transmit FIFO.
+ *
+ *  Writes as many words as fit into the free FIFO space and starts the
+ *  transmission. The remaining words must be written again by the caller.
+ *
+ *  \param uio        \IN  access handle
+ *  \param buf        \IN  words to send
+ *  \param num        \IN  number of words
+ *  \return           number of words written
+ */
+u_int32 Z146_UioTxWrite(Z146_UIO *uio, const u_int32 *buf, u_int32 num)
+{
+	u_int32 len = Z146_UioTxFree(uio);
+	u_int32 i = 0;
+
+	if (len > num)
+		len = num;
+	for (i = 0; i < len; i++)
+		UIO_WRITE_D32(uio, Z246_FIFO_START_ADDR + (i * 4), buf[i] & uio->txMask);
+	if (len != 0)
+		UIO_WRITE_D8(uio, Z246_TX_TXA_OFFSET, len);
+
+	return len;
+}
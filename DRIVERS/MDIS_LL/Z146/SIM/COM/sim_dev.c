@@ -0,0 +1,652 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  sim_dev.c
+ *
+ *      \brief   Register level model of the 16Z146 receiver and the 16Z246
+ *               transmitter
+ *
+ *               Behaviour which is not documented for the cores is modelled
+ *               as follows:
+ *               - RX data interrupt at SIM_RX_THR_WORDS() words in the
+ *                 FIFO (1 << RX_FCR[2:0])
+ *               - RX character timeout after RX_TIMEOUT bit times without
+ *                 a new word, 0 = off; the line is not idle while a
+ *                 connected transmitter sends a word
+ *               - TX refill interrupt at SIM_TX_THR_WORDS() words or less
+ *                 in the FIFO (TX_FCR[2:0] * 32)
+ *               - RX_LSR bits SIM_LSR_xxx, cleared by writing 1
+ *               - label filter with RX_LA_NUM = 0 drops all words
+ *               - parity type 0 = odd, 1 = even
+ *               - an interrupt request is dispatched SIM_IrqLatencySet()
+ *                 us after it was raised, again after each handler call
+ *
+ *     Required: -
+ *     \switches (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <assert.h>
+#include <string.h>
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/maccess.h>
+#include <MEN/z146_regs.h>
+#include <MEN/z146_sim.h>
+#include "sim_int.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define SIM_MAX_DEVS		16			/**< simulated devices */
+#define SIM_WORD_BITS		36			/**< bit times per word incl. gap */
+#define SIM_BIT_US_HIGH		10			/**< bit time at 100 kHz [us] */
+#define SIM_BIT_US_LOW		80			/**< bit time at 12.5 kHz [us] */
+#define SIM_IRQ_LOOPS		64			/**< max. handler calls per check */
+
+/** FIFO words which raise the RX data interrupt at threshold level lev */
+#define SIM_RX_THR_WORDS(lev)	(1 << ((lev) & Z146_RX_THR_LEV_MASK))
+/** FIFO words at or below which the TX refill interrupt is raised */
+#define SIM_TX_THR_WORDS(lev)	(((lev) & Z246_TX_FCR_MASK) * 32)
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static SIM_DEV	*G_dev[SIM_MAX_DEVS];
+static u_int32	G_devNum;
+static u_int64	G_nowUs;
+static u_int32	G_irqMask;
+static u_int32	G_irqLatUs;
+static int		G_inIrq;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static u_int32 BitUs(u_int8 lcr);
+static int RxLineBusy(SIM_DEV *dev);
+static u_int32 RxIrqPending(SIM_DEV *dev);
+static u_int32 TxIrqPending(SIM_DEV *dev);
+static u_int32 IrqPending(SIM_DEV *dev);
+static void RxReceive(SIM_DEV *dev, u_int32 word, u_int8 txLcr);
+static void TxCommit(SIM_DEV *dev, u_int32 num);
+static void TxComplete(SIM_DEV *dev);
+static u_int32 TxWord(SIM_DEV *dev, u_int32 data);
+static u_int32 Ones(u_int32 word);
+static void IrqCheck(void);
+
+/**********************************************************************/
+/** Initialize a simulated device.
+ *
+ *  The registers are cleared, the device is added to the simulation.
+ *
+ *  \param dev        \IN  device
+ *  \param type       \IN  SIM_TYPE_RX or SIM_TYPE_TX
+ */
+void SIM_DevInit(SIM_DEV *dev, u_int32 type)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->type = type;
+	if (G_devNum < SIM_MAX_DEVS)
+		G_dev[G_devNum++] = dev;
+}
+
+/**********************************************************************/
+/** Remove a device from the simulation.
+ *
+ *  The device must not be connected to a transmitter which stays in the
+ *  simulation.
+ *
+ *  \param dev        \IN  device
+ */
+void SIM_DevExit(SIM_DEV *dev)
+{
+	u_int32 i = 0;
+
+	for (i = 0; i < G_devNum; i++) {
+		if (G_dev[i] == dev) {
+			G_dev[i] = G_dev[--G_devNum];
+			break;
+		}
+	}
+}
+
+/**********************************************************************/
+/** Connect a transmitter to a receiver.
+ *
+ *  \param tx         \IN  transmitter
+ *  \param rx         \IN  receiver
+ *  \return           \c 0 on success or -1 if too many receivers
+ */
+int32 SIM_Connect(SIM_DEV *tx, SIM_DEV *rx)
+{
+	if (tx->peerNum >= SIM_MAX_PEERS)
+		return -1;
+	tx->peer[tx->peerNum++] = rx;
+	return 0;
+}
+
+/**********************************************************************/
+/** Install the interrupt handler of a device.
+ *
+ *  \param dev        \IN  device
+ *  \param isr        \IN  handler, e.g. the Irq() function of the driver
+ *  \param arg        \IN  argument of the handler, e.g. the driver handle
+ */
+void SIM_IrqAttach(SIM_DEV *dev, int32 (*isr)(void *arg), void *arg)
+{
+	dev->isr    = isr;
+	dev->isrArg = arg;
+}
+
+/**********************************************************************/
+/** Enable or disable the interrupt of a device.
+ *
+ *  \param dev        \IN  device
+ *  \param enable     \IN  1 = enable
+ */
+void SIM_IrqEnable(SIM_DEV *dev, int enable)
+{
+	dev->irqEnabled = enable;
+	IrqCheck();
+}
+
+/**********************************************************************/
+/** Set the interrupt latency.
+ *
+ *  The time from an interrupt request of a device until its handler is
+ *  called, e.g. to see the threshold latency of the drivers. The default
+ *  is 0, the handler is called at once.
+ *
+ *  \param us         \IN  latency [us]
+ */
+void SIM_IrqLatencySet(u_int32 us)
+{
+	G_irqLatUs = us;
+}
+
+/**********************************************************************/
+/** Get the simulated time.
+ *
+ *  \return           time since start [us]
+ */
+u_int64 SIM_TimeUs(void)
+{
+	return G_nowUs;
+}
+
+/**********************************************************************/
+/** Advance the simulated time.
+ *
+ *  Words are sent and received, timeouts and alarms expire and the
+ *  interrupts are dispatched in time order.
+ *
+ *  \param untilUs    \IN  end time [us]
+ */
+void SIM_Run(u_int64 untilUs)
+{
+	SIM_DEV *dev = NULL;
+	u_int64 next = 0;
+	u_int64 t = 0;
+	u_int32 timeout = 0;
+	u_int32 i = 0;
+
+	for (;;) {
+		/* next event */
+		next = untilUs;
+		for (i = 0; i < G_devNum; i++) {
+			dev = G_dev[i];
+			if (dev->type == SIM_TYPE_TX) {
+				if (dev->txDoneUs != 0 && dev->txDoneUs < next)
+					next = dev->txDoneUs;
+			} else {
+				timeout = dev->reg[Z146_RX_TIMEOUT_OFFSET];
+				if (dev->fifoCnt != 0 && !dev->rxTimeout && timeout != 0 &&
+					!RxLineBusy(dev)) {
+					t = dev->rxLastUs + timeout * BitUs(dev->reg[Z146_RX_LCR_OFFSET]);
+					if (t < next)
+						next = t;
+				}
+			}
+		}
+		if (!G_irqMask) {
+			t = SIM_AlarmNext();
+			if (t < next)
+				next = t;
+			/* delayed interrupt requests */
+			for (i = 0; i < G_devNum; i++) {
+				dev = G_dev[i];
+				t = dev->irqReqUs + G_irqLatUs;
+				if (dev->irqReq && t > G_nowUs && t < next)
+					next = t;
+			}
+		}
+		if (next > G_nowUs)
+			G_nowUs = next;
+
+		/* process the events */
+		for (i = 0; i < G_devNum; i++) {
+			dev = G_dev[i];
+			if (dev->type == SIM_TYPE_TX) {
+				while (dev->txDoneUs != 0 && dev->txDoneUs <= G_nowUs)
+					TxComplete(dev);
+			} else {
+				timeout = dev->reg[Z146_RX_TIMEOUT_OFFSET];
+				if (dev->fifoCnt != 0 && !dev->rxTimeout && timeout != 0 &&
+					!RxLineBusy(dev) &&
+					dev->rxLastUs + timeout * BitUs(dev->reg[Z146_RX_LCR_OFFSET]) <= G_nowUs)
+					dev->rxTimeout = 1;
+			}
+		}
+		IrqCheck();
+
+		if (G_nowUs >= untilUs)
+			break;
+	}
+}
+
+/**********************************************************************/
+/** Mask the interrupts.
+ *
+ *  OSS_IrqMaskR() is a spinlock on Linux which must not be nested, so a
+ *  nested call aborts the simulation.
+ *
+ *  \return           previous state for SIM_IrqUnmask()
+ */
+u_int32 SIM_IrqMask(void)
+{
+	u_int32 old = G_irqMask;
+
+	assert(!G_irqMask);
+	G_irqMask = 1;
+	return old;
+}
+
+/**********************************************************************/
+/** Restore the interrupt mask.
+ *
+ *  Pending interrupts are dispatched when the interrupts are unmasked.
+ *
+ *  \param oldState   \IN  state returned by SIM_IrqMask()
+ */
+void SIM_IrqUnmask(u_int32 oldState)
+{
+	G_irqMask = oldState;
+	IrqCheck();
+}
+
+/**********************************************************************/
+/** Read an 8 bit register.
+ */
+u_int8 SIM_Read8(MACCESS dev, u_int32 offs)
+{
+	offs &= (SIM_WIN_SIZE - 1);
+
+	if (dev->type == SIM_TYPE_RX) {
+		switch (offs) {
+		case Z146_STAT_REG:				return (u_int8)RxIrqPending(dev);
+		case Z146_STAT_REG + 1:			return 0;
+		case Z146_LSR_REG_OFFSET:		return dev->lsr;
+		case Z146_RX_RXC_REG_OFFSET:	return (u_int8)dev->fifoCnt;
+		}
+	} else {
+		switch (offs) {
+		case Z246_TX_IIR_OFFSET:		return (u_int8)TxIrqPending(dev);
+		case Z246_TX_TXC_OFFSET:		return (u_int8)dev->fifoCnt;
+		}
+	}
+	return dev->reg[offs];
+}
+
+/**********************************************************************/
+/** Read a 16 bit register.
+ */
+u_int16 SIM_Read16(MACCESS dev, u_int32 offs)
+{
+	return (u_int16)(SIM_Read8(dev, offs) | (SIM_Read8(dev, offs + 1) << 8));
+}
+
+/**********************************************************************/
+/** Read a 32 bit register or FIFO word.
+ */
+u_int32 SIM_Read32(MACCESS dev, u_int32 offs)
+{
+	u_int32 i = 0;
+
+	offs &= (SIM_WIN_SIZE - 1);
+	if (offs < Z146_STAT_REG) {
+		i = offs / 4;
+		if (dev->type == SIM_TYPE_TX)
+			return (i < SIM_FIFO_SIZE) ? dev->stage[i] : 0;
+		if (i >= dev->fifoCnt)
+			return 0;
+		return dev->fifo[(dev->fifoHead + i) % SIM_FIFO_SIZE];
+	}
+	return (u_int32)SIM_Read8(dev, offs) |
+		   ((u_int32)SIM_Read8(dev, offs + 1) << 8) |
+		   ((u_int32)SIM_Read8(dev, offs + 2) << 16) |
+		   ((u_int32)SIM_Read8(dev, offs + 3) << 24);
+}
+
+/**********************************************************************/
+/** Write an 8 bit register.
+ */
+void SIM_Write8(MACCESS dev, u_int32 offs, u_int8 val)
+{
+	u_int32 num = val;
+
+	offs &= (SIM_WIN_SIZE - 1);
+	if (dev->type == SIM_TYPE_RX) {
+		switch (offs) {
+		case Z146_LSR_REG_OFFSET:
+			dev->lsr &= ~val;
+			break;
+		case Z146_RX_RXA_OFFSET:
+			if (num > dev->fifoCnt)
+				num = dev->fifoCnt;
+			dev->fifoHead = (dev->fifoHead + num) % SIM_FIFO_SIZE;
+			dev->fifoCnt -= num;
+			if (dev->fifoCnt == 0)
+				dev->rxTimeout = 0;
+			break;
+		default:
+			dev->reg[offs] = val;
+		}
+	} else {
+		switch (offs) {
+		case Z246_TX_TXA_OFFSET:
+			TxCommit(dev, num);
+			break;
+		default:
+			dev->reg[offs] = val;
+		}
+	}
+	IrqCheck();
+}
+
+/**********************************************************************/
+/** Write a 16 bit register.
+ */
+void SIM_Write16(MACCESS dev, u_int32 offs, u_int16 val)
+{
+	SIM_Write8(dev, offs, (u_int8)val);
+	SIM_Write8(dev, offs + 1, (u_int8)(val >> 8));
+}
+
+/**********************************************************************/
+/** Write a 32 bit register or FIFO word.
+ *
+ *  Writes to the receive FIFO are ignored.
+ */
+void SIM_Write32(MACCESS dev, u_int32 offs, u_int32 val)
+{
+	offs &= (SIM_WIN_SIZE - 1);
+	if (offs < Z146_STAT_REG) {
+		if (dev->type == SIM_TYPE_TX && (offs / 4) < SIM_FIFO_SIZE)
+			dev->stage[offs / 4] = val;
+		return;
+	}
+	SIM_Write8(dev, offs,     (u_int8)val);
+	SIM_Write8(dev, offs + 1, (u_int8)(val >> 8));
+	SIM_Write8(dev, offs + 2, (u_int8)(val >> 16));
+	SIM_Write8(dev, offs + 3, (u_int8)(val >> 24));
+}
+
+/**********************************************************************/
+/** Bit time of the speed configured in an LCR value.
+ */
+static u_int32 BitUs(u_int8 lcr)
+{
+	return (lcr & Z146_RX_SPEED_MASK) ? SIM_BIT_US_HIGH : SIM_BIT_US_LOW;
+}
+
+/**********************************************************************/
+/** Check if a transmitter connected to a receiver sends a word.
+ */
+static int RxLineBusy(SIM_DEV *dev)
+{
+	SIM_DEV *tx = NULL;
+	u_int32 i = 0;
+	u_int32 j = 0;
+
+	for (i = 0; i < G_devNum; i++) {
+		tx = G_dev[i];
+		if (tx->type != SIM_TYPE_TX || tx->txDoneUs == 0)
+			continue;
+		for (j = 0; j < tx->peerNum; j++) {
+			if (tx->peer[j] == dev)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+/**********************************************************************/
+/** Interrupt request of a receiver (STAT bits 2..0).
+ */
+static u_int32 RxIrqPending(SIM_DEV *dev)
+{
+	u_int8 ier = dev->reg[Z146_RX_IER_OFFSET];
+	u_int32 thr = SIM_RX_THR_WORDS(dev->reg[Z146_RX_FCR_OFFSET]);
+	u_int32 pend = 0;
+
+	if ((ier & Z146_RX_RLSIEN_MASK) && dev->lsr)
+		pend |= Z146_RX_LINE_STAT_IRQ;
+	if (ier & Z146_RX_RXCIEN_MASK) {
+		if (dev->fifoCnt >= thr)
+			pend |= Z146_RX_DATA_AVAIL_IRQ;
+		if (dev->fifoCnt != 0 && dev->rxTimeout)
+			pend |= Z146_RX_CHAR_TIMEOUT_IRQ;
+	}
+	return pend;
+}
+
+/**********************************************************************/
+/** Interrupt request of a transmitter (TX_IIR bit 0).
+ */
+static u_int32 TxIrqPending(SIM_DEV *dev)
+{
+	u_int32 thr = SIM_TX_THR_WORDS(dev->reg[Z246_TX_FCR_OFFSET]);
+
+	if ((dev->reg[Z246_TX_IER_OFFSET] & Z246_TX_IRQ_MASK) && dev->fifoCnt <= thr)
+		return Z246_TX_IRQ_MASK;
+	return 0;
+}
+
+/**********************************************************************/
+/** Interrupt request of an enabled device.
+ */
+static u_int32 IrqPending(SIM_DEV *dev)
+{
+	if (!dev->irqEnabled || dev->isr == NULL)
+		return 0;
+	return (dev->type == SIM_TYPE_RX) ? RxIrqPending(dev) : TxIrqPending(dev);
+}
+
+/**********************************************************************/
+/** Move acknowledged words to the transmit FIFO.
+ */
+static void TxCommit(SIM_DEV *dev, u_int32 num)
+{
+	u_int32 i = 0;
+
+	for (i = 0; i < num && i < SIM_FIFO_SIZE; i++) {
+		if (dev->fifoCnt == SIM_FIFO_SIZE) {
+			dev->stats.txFifoOverflow++;
+			continue;
+		}
+		dev->fifo[(dev->fifoHead + dev->fifoCnt) % SIM_FIFO_SIZE] = dev->stage[i];
+		dev->fifoCnt++;
+	}
+	/* start the transmission if the line is idle */
+	if (dev->fifoCnt != 0 && dev->txDoneUs == 0)
+		dev->txDoneUs = G_nowUs + SIM_WORD_BITS * BitUs(dev->reg[Z246_TX_LCR_OFFSET]);
+}
+
+/**********************************************************************/
+/** Finish the word on the line and start the next one.
+ */
+static void TxComplete(SIM_DEV *dev)
+{
+	u_int8 lcr = dev->reg[Z246_TX_LCR_OFFSET];
+	u_int32 word = TxWord(dev, dev->fifo[dev->fifoHead]);
+	u_int32 i = 0;
+
+	dev->fifoHead = (dev->fifoHead + 1) % SIM_FIFO_SIZE;
+	dev->fifoCnt--;
+	dev->stats.txWords++;
+
+	for (i = 0; i < dev->peerNum; i++)
+		RxReceive(dev->peer[i], word, lcr);
+
+	if (dev->fifoCnt != 0)
+		dev->txDoneUs += SIM_WORD_BITS * BitUs(lcr);
+	else
+		dev->txDoneUs = 0;
+}
+
+/**********************************************************************/
+/** Build the ARINC 429 word from a FIFO word.
+ *
+ *  Label in bits 7..0, SDI in bits 9..8 if enabled, data up to bit 30 and
+ *  parity in bit 31 if enabled.
+ */
+static u_int32 TxWord(SIM_DEV *dev, u_int32 data)
+{
+	u_int8 lcr = dev->reg[Z246_TX_LCR_OFFSET];
+	u_int32 word = dev->reg[Z246_TX_LA_OFFSET];
+	u_int32 sdi = (lcr & Z246_TX_SDI_MASK) >> Z246_TX_SDI_OFFSET;
+
+	if (lcr & Z246_TX_SDI_EN_MASK)
+		word |= (sdi << 8) | (data << 10);
+	else
+		word |= (data << 8);
+
+	if (lcr & Z246_TX_PAR_EN_MASK) {
+		word &= 0x7FFFFFFF;
+		/* type 0: odd number of ones incl. parity bit */
+		if (((Ones(word) & 1) == 0) == !(lcr & Z246_TX_PAR_TYP_MASK))
+			word |= 0x80000000;
+	}
+	return word;
+}
+
+/**********************************************************************/
+/** Receive a word from the bus.
+ */
+static void RxReceive(SIM_DEV *dev, u_int32 word, u_int8 txLcr)
+{
+	u_int8 lcr = dev->reg[Z146_RX_LCR_OFFSET];
+	u_int32 num = 0;
+	u_int32 i = 0;
+	int odd = 0;
+
+	if ((lcr & Z146_RX_SPEED_MASK) != (txLcr & Z246_TX_SPEED_MASK)) {
+		dev->lsr |= SIM_LSR_FRAMING;
+		dev->stats.rxFramingErr++;
+		return;
+	}
+	if (lcr & Z146_RX_PAR_EN_MASK) {
+		odd = Ones(word) & 1;
+		if (odd == ((lcr & Z146_RX_PAR_TYP_MASK) ? 1 : 0)) {
+			dev->lsr |= SIM_LSR_PARITY;
+			dev->stats.rxParityErr++;
+			if (!(lcr & Z146_RX_ERR_WE_MASK))
+				return;
+		}
+	}
+	if (lcr & Z146_RX_LAB_EN_MASK) {
+		num = dev->reg[Z146_RX_LA_NUM_OFFSET] & Z146_RX_LA_NUM_MASK;
+		if (num > Z146_RX_LA_SIZE)
+			num = Z146_RX_LA_SIZE;
+		for (i = 0; i < num; i++) {
+			if (dev->reg[Z146_RX_LA_OFFSET + i] == (word & 0xFF))
+				break;
+		}
+		if (i == num) {
+			dev->stats.rxLabelDrop++;
+			return;
+		}
+	}
+	if ((lcr & Z146_RX_SDI_EN_MASK) &&
+		((word >> 8) & 0x3) != ((lcr & Z146_RX_SDI_MASK) >> Z146_RX_SDI_OFFSET)) {
+		dev->stats.rxSdiDrop++;
+		return;
+	}
+	if (dev->fifoCnt == SIM_FIFO_SIZE) {
+		dev->lsr |= SIM_LSR_OVERRUN;
+		dev->stats.rxOverrun++;
+		return;
+	}
+	dev->fifo[(dev->fifoHead + dev->fifoCnt) % SIM_FIFO_SIZE] = word;
+	dev->fifoCnt++;
+	dev->rxLastUs  = G_nowUs;
+	dev->rxTimeout = 0;
+	dev->stats.rxWords++;
+}
+
+/**********************************************************************/
+/** Count the bits set in a word.
+ */
+static u_int32 Ones(u_int32 word)
+{
+	u_int32 n = 0;
+
+	for (; word != 0; word &= word - 1)
+		n++;
+	return n;
+}
+
+/**********************************************************************/
+/** Dispatch the pending interrupts and alarms.
+ *
+ *  The time of new requests is noted also while the interrupts are
+ *  masked or a handler runs, but nothing is dispatched then. The
+ *  requests are level triggered, a handler is called again as long as
+ *  its device requests an interrupt, after the interrupt latency.
+ */
+static void IrqCheck(void)
+{
+	SIM_DEV *dev = NULL;
+	u_int32 loop = 0;
+	u_int32 i = 0;
+	int any = 0;
+
+	for (i = 0; i < G_devNum; i++) {
+		dev = G_dev[i];
+		if (!IrqPending(dev))
+			dev->irqReq = 0;
+		else if (!dev->irqReq) {
+			dev->irqReq   = 1;
+			dev->irqReqUs = G_nowUs;
+		}
+	}
+	if (G_irqMask || G_inIrq)
+		return;
+
+	G_inIrq = 1;
+	for (loop = 0; loop < SIM_IRQ_LOOPS; loop++) {
+		any = 0;
+		SIM_AlarmFire(G_nowUs);
+		for (i = 0; i < G_devNum; i++) {
+			dev = G_dev[i];
+			if (!IrqPending(dev)) {
+				dev->irqReq = 0;
+				continue;
+			}
+			if (!dev->irqReq) {
+				dev->irqReq   = 1;
+				dev->irqReqUs = G_nowUs;
+			}
+			if (G_nowUs - dev->irqReqUs >= G_irqLatUs) {
+				dev->stats.irqs++;
+				dev->isr(dev->isrArg);
+				dev->irqReq = 0;
+				any = 1;
+			}
+		}
+		if (!any)
+			break;
+	}
+	G_inIrq = 0;
+}
@@ -0,0 +1,25 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  sim_int.h
+ *
+ *       \brief  Host simulator: functions shared by the device model and
+ *               the OSS functions
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _SIM_INT_H
+#define _SIM_INT_H
+
+/* sim_dev.c */
+extern u_int32 SIM_IrqMask(void);
+extern void SIM_IrqUnmask(u_int32 oldState);
+
+/* sim_oss.c */
+extern u_int64 SIM_AlarmNext(void);
+extern void SIM_AlarmFire(u_int64 nowUs);
+
+#endif /* _SIM_INT_H */
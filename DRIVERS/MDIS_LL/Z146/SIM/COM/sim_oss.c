@@ -0,0 +1,365 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************/
+/*!
+ *        \file  sim_oss.c
+ *
+ *      \brief   OSS, DESC and DBG functions of the host simulator
+ *
+ *               Only the functions used by the Z146 and Z246 drivers are
+ *               implemented. Ticks and alarms run on the simulated time,
+ *               signals are counted only.
+ *
+ *     Required: -
+ *     \switches (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/dbg.h>
+#include <MEN/mdis_err.h>
+#include <MEN/maccess.h>
+#include <MEN/z146_sim.h>
+#include "sim_int.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define SIM_TICK_RATE		10000		/**< ticks per second, max. for the Z246 rate limits */
+#define SIM_MAX_ALARMS		16
+#define SIM_KEY_LEN			64
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+struct OSS_SIG_HANDLE {
+	int32	signal;
+};
+
+struct OSS_ALARM_HANDLE {
+	void	(*funct)(void *arg);
+	void	*arg;
+	u_int64	dueUs;				/**< 0 = inactive */
+	u_int64	periodUs;			/**< 0 = single shot */
+};
+
+struct DESC_HANDLE {
+	DESC_SPEC	*spec;
+};
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+u_int32 SIM_dbgLevel;
+
+static OSS_ALARM_HANDLE	*G_alarm[SIM_MAX_ALARMS];
+static u_int32			G_sigCount;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static DESC_SPEC *DescFind(DESC_HANDLE *descHdl, char *keyFmt, va_list ap);
+
+/**********************************************************************/
+/** Set the debug level of the drivers.
+ *
+ *  \param level      \IN  0 = errors only, 1..3 = DBGWRT_1..3
+ */
+void SIM_DbgLevelSet(u_int32 level)
+{
+	SIM_dbgLevel = level;
+}
+
+/**********************************************************************/
+/** Number of signals sent by the drivers.
+ */
+u_int32 SIM_SigCount(void)
+{
+	return G_sigCount;
+}
+
+/**********************************************************************/
+/** Time of the next active alarm.
+ *
+ *  \return           time [us], ~0 if no alarm is active
+ */
+u_int64 SIM_AlarmNext(void)
+{
+	u_int64 next = ~(u_int64)0;
+	u_int32 i = 0;
+
+	for (i = 0; i < SIM_MAX_ALARMS; i++) {
+		if (G_alarm[i] && G_alarm[i]->dueUs != 0 && G_alarm[i]->dueUs < next)
+			next = G_alarm[i]->dueUs;
+	}
+	return next;
+}
+
+/**********************************************************************/
+/** Call the handlers of the expired alarms.
+ *
+ *  \param nowUs      \IN  simulated time [us]
+ */
+void SIM_AlarmFire(u_int64 nowUs)
+{
+	OSS_ALARM_HANDLE *alm = NULL;
+	u_int32 i = 0;
+
+	for (i = 0; i < SIM_MAX_ALARMS; i++) {
+		alm = G_alarm[i];
+		if (alm == NULL || alm->dueUs == 0 || alm->dueUs > nowUs)
+			continue;
+		if (alm->periodUs)
+			alm->dueUs += alm->periodUs;
+		else
+			alm->dueUs = 0;
+		alm->funct(alm->arg);
+	}
+}
+
+/*------------------------------- OSS --------------------------------*/
+
+char *OSS_Ident(void)
+{
+	return "OSS - host simulator";
+}
+
+void *OSS_MemGet(OSS_HANDLE *osHdl, u_int32 size, u_int32 *gotsizeP)
+{
+	void *mem = malloc(size);
+
+	*gotsizeP = mem ? size : 0;
+	return mem;
+}
+
+int32 OSS_MemFree(OSS_HANDLE *osHdl, int8 *addr, u_int32 size)
+{
+	free(addr);
+	return 0;
+}
+
+void OSS_MemFill(OSS_HANDLE *osHdl, u_int32 size, char *adr, int8 value)
+{
+	memset(adr, value, size);
+}
+
+void OSS_MemCopy(OSS_HANDLE *osHdl, u_int32 size, char *src, char *dest)
+{
+	memcpy(dest, src, size);
+}
+
+OSS_IRQ_STATE OSS_IrqMaskR(OSS_HANDLE *osHdl, OSS_IRQ_HANDLE *irqHdl)
+{
+	return SIM_IrqMask();
+}
+
+void OSS_IrqRestore(OSS_HANDLE *osHdl, OSS_IRQ_HANDLE *irqHdl,
+					OSS_IRQ_STATE oldState)
+{
+	SIM_IrqUnmask(oldState);
+}
+
+int32 OSS_SigCreate(OSS_HANDLE *osHdl, int32 signal, OSS_SIG_HANDLE **sigHdlP)
+{
+	if ((*sigHdlP = malloc(sizeof(OSS_SIG_HANDLE))) == NULL)
+		return ERR_OSS_MEM_ALLOC;
+	(*sigHdlP)->signal = signal;
+	return 0;
+}
+
+int32 OSS_SigRemove(OSS_HANDLE *osHdl, OSS_SIG_HANDLE **sigHdlP)
+{
+	free(*sigHdlP);
+	*sigHdlP = NULL;
+	return 0;
+}
+
+int32 OSS_SigSend(OSS_HANDLE *osHdl, OSS_SIG_HANDLE *sigHdl)
+{
+	G_sigCount++;
+	return 0;
+}
+
+int32 OSS_TickRateGet(OSS_HANDLE *osHdl)
+{
+	return SIM_TICK_RATE;
+}
+
+u_int32 OSS_TickGet(OSS_HANDLE *osHdl)
+{
+	return (u_int32)(SIM_TimeUs() / (1000000 / SIM_TICK_RATE));
+}
+
+/**********************************************************************/
+/** Time stamp of the driver measurements.
+ *
+ *  \return           simulated time [us]
+ */
+u_int32 SIM_TimestampUs(void)
+{
+	return (u_int32)SIM_TimeUs();
+}
+
+int32 OSS_Delay(OSS_HANDLE *osHdl, int32 msec)
+{
+	SIM_Run(SIM_TimeUs() + (u_int64)msec * 1000);
+	return msec;
+}
+
+int32 OSS_AlarmCreate(OSS_HANDLE *osHdl, void (*funct)(void *arg),
+					  void *arg, OSS_ALARM_HANDLE **alarmP)
+{
+	OSS_ALARM_HANDLE *alm = NULL;
+	u_int32 i = 0;
+
+	for (i = 0; i < SIM_MAX_ALARMS && G_alarm[i]; i++)
+		;
+	if (i == SIM_MAX_ALARMS || (alm = calloc(1, sizeof(*alm))) == NULL)
+		return ERR_OSS_MEM_ALLOC;
+
+	alm->funct = funct;
+	alm->arg   = arg;
+	G_alarm[i] = alm;
+	*alarmP = alm;
+	return 0;
+}
+
+int32 OSS_AlarmRemove(OSS_HANDLE *osHdl, OSS_ALARM_HANDLE **alarmP)
+{
+	u_int32 i = 0;
+
+	for (i = 0; i < SIM_MAX_ALARMS; i++) {
+		if (G_alarm[i] == *alarmP)
+			G_alarm[i] = NULL;
+	}
+	free(*alarmP);
+	*alarmP = NULL;
+	return 0;
+}
+
+int32 OSS_AlarmSet(OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alarm,
+				   u_int32 msec, u_int32 cyclic, u_int32 *realMsecP)
+{
+	if (msec == 0)
+		msec = 1;
+	alarm->periodUs = cyclic ? (u_int64)msec * 1000 : 0;
+	alarm->dueUs    = SIM_TimeUs() + (u_int64)msec * 1000;
+	if (realMsecP)
+		*realMsecP = msec;
+	return 0;
+}
+
+int32 OSS_AlarmClear(OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alarm)
+{
+	alarm->dueUs = 0;
+	return 0;
+}
+
+/*------------------------------- DESC -------------------------------*/
+
+char *DESC_Ident(void)
+{
+	return "DESC - host simulator";
+}
+
+int32 DESC_Init(DESC_SPEC *descSpec, OSS_HANDLE *osHdl, DESC_HANDLE **descHdlP)
+{
+	if ((*descHdlP = malloc(sizeof(DESC_HANDLE))) == NULL)
+		return ERR_OSS_MEM_ALLOC;
+	(*descHdlP)->spec = descSpec;
+	return 0;
+}
+
+int32 DESC_Exit(DESC_HANDLE **descHdlP)
+{
+	free(*descHdlP);
+	*descHdlP = NULL;
+	return 0;
+}
+
+int32 DESC_DbgLevelSet(DESC_HANDLE *descHdl, u_int32 dbgLevel)
+{
+	return 0;
+}
+
+int32 DESC_GetUInt32(DESC_HANDLE *descHdl, u_int32 defVal,
+					 u_int32 *valueP, char *keyFmt, ...)
+{
+	DESC_SPEC *key = NULL;
+	va_list ap;
+
+	va_start(ap, keyFmt);
+	key = DescFind(descHdl, keyFmt, ap);
+	va_end(ap);
+
+	if (key == NULL || key->bin != NULL) {
+		*valueP = defVal;
+		return ERR_DESC_KEY_NOTFOUND;
+	}
+	*valueP = key->value;
+	return 0;
+}
+
+int32 DESC_GetBinary(DESC_HANDLE *descHdl, u_int8 *defVal,
+					 u_int32 defLen, u_int8 *buf, u_int32 *lenP,
+					 char *keyFmt, ...)
+{
+	DESC_SPEC *key = NULL;
+	const u_int8 *src = defVal;
+	u_int32 len = defLen;
+	int32 error = 0;
+	va_list ap;
+
+	va_start(ap, keyFmt);
+	key = DescFind(descHdl, keyFmt, ap);
+	va_end(ap);
+
+	if (key != NULL && key->bin != NULL) {
+		src = key->bin;
+		len = key->binLen;
+	} else {
+		error = ERR_DESC_KEY_NOTFOUND;
+	}
+	if (len > *lenP) {
+		*lenP = 0;
+		return ERR_DESC_BUF_TOOSMALL;
+	}
+	if (len)
+		memcpy(buf, src, len);
+	*lenP = len;
+	return error;
+}
+
+/**********************************************************************/
+/** Find a descriptor key.
+ */
+static DESC_SPEC *DescFind(DESC_HANDLE *descHdl, char *keyFmt, va_list ap)
+{
+	DESC_SPEC *key = NULL;
+	char name[SIM_KEY_LEN];
+
+	vsnprintf(name, sizeof(name), keyFmt, ap);
+	for (key = descHdl->spec; key && key->key; key++) {
+		if (strcmp(key->key, name) == 0)
+			return key;
+	}
+	return NULL;
+}
+
+/*------------------------------- DBG --------------------------------*/
+
+int32 DBG_Write(DBG_HANDLE *dbh, char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	return 0;
+}
@@ -0,0 +1,335 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                      Z146_SIM                      ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_sim.c
+ *
+ *       \brief  Runs the unmodified Z146 and Z246 drivers against the
+ *               register level simulator
+ *
+ *               One simulated transmitter is connected to one simulated
+ *               receiver. The drivers are called through their LL_ENTRY
+ *               jump tables, the interrupts are dispatched by the
+ *               simulator. The program sends a sequence of words with
+ *               bursts of M_setblock() size, reads them back and reports
+ *               throughput, lost words and the single word latency in
+ *               simulated time and the host CPU time spent in the drivers.
+ *
+ *     Required: -
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/maccess.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/z146_regs.h>
+#include <MEN/z146_sim.h>
+
+typedef void LL_HANDLE;
+#include <MEN/ll_entry.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z246_drv.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define LABEL			1
+#define RX_BUF_LEN		4096
+#define WORD_US(speed)	((speed) ? 360 : 2880)	/* 36 bit times */
+#define LAT_STEP_US		10
+#define LAT_TIMEOUT_US	100000
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static u_int8 G_rxLabel[] = { LABEL };
+
+static u_int32 G_rxBuf[RX_BUF_LEN];
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static u_int64 CpuUs(void);
+static int32 Receive(LL_ENTRY *rx, LL_HANDLE *rxHdl, u_int32 *expect,
+					 u_int32 *errors);
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	SIM_DEV rxDev;
+	SIM_DEV txDev;
+	MACCESS rxMa = &rxDev;
+	MACCESS txMa = &txDev;
+	LL_ENTRY rx;
+	LL_ENTRY tx;
+	LL_HANDLE *rxHdl = NULL;
+	LL_HANDLE *txHdl = NULL;
+	M_SG_BLOCK blk;
+	Z146_IRQLAT rxLat;
+	Z246_IRQLAT txLat;
+	u_int32 *txBuf = NULL;
+	u_int32 speed = 1;
+	u_int32 count = 10000;
+	u_int32 burst = 64;
+	u_int32 latCount = 100;
+	u_int32 sent = 0;
+	u_int32 got = 0;
+	u_int32 expect = 0;
+	u_int32 errors = 0;
+	u_int32 latMax = 0;
+	u_int32 i = 0;
+	u_int64 latSum = 0;
+	u_int64 t0 = 0;
+	u_int64 simUs = 0;
+	u_int64 cpu = 0;
+	int32 nbr = 0;
+	int32 error = 0;
+	int32 n = 0;
+	int argi = 0;
+
+	for (argi = 1; argi < argc; argi++) {
+		if (strcmp(argv[argi], "-?") == 0) {
+			Usage();
+			return(1);
+		} else if (argi + 1 < argc && strcmp(argv[argi], "-s") == 0) {
+			speed = strtoul(argv[++argi], NULL, 0) ? 1 : 0;
+		} else if (argi + 1 < argc && strcmp(argv[argi], "-n") == 0) {
+			count = strtoul(argv[++argi], NULL, 0);
+		} else if (argi + 1 < argc && strcmp(argv[argi], "-b") == 0) {
+			burst = strtoul(argv[++argi], NULL, 0);
+		} else if (argi + 1 < argc && strcmp(argv[argi], "-l") == 0) {
+			latCount = strtoul(argv[++argi], NULL, 0);
+		} else if (argi + 1 < argc && strcmp(argv[argi], "-d") == 0) {
+			SIM_DbgLevelSet(strtoul(argv[++argi], NULL, 0));
+		} else {
+			Usage();
+			return(1);
+		}
+	}
+	if (burst == 0)
+		burst = 1;
+
+	{
+		DESC_SPEC rxDesc[] = {
+			{ "RX_SPEED", 0, NULL, 0 },
+			{ "RX_LABEL", 0, G_rxLabel, sizeof(G_rxLabel) },
+			{ NULL, 0, NULL, 0 }
+		};
+		DESC_SPEC txDesc[] = {
+			{ "TX_SPEED", 0, NULL, 0 },
+			{ "TX_LABEL", LABEL, NULL, 0 },
+			{ NULL, 0, NULL, 0 }
+		};
+
+		rxDesc[0].value = speed;
+		txDesc[0].value = speed;
+
+		/*--------------------+
+		|  init               |
+		+--------------------*/
+		SIM_DevInit(&rxDev, SIM_TYPE_RX);
+		SIM_DevInit(&txDev, SIM_TYPE_TX);
+		SIM_Connect(&txDev, &rxDev);
+
+		__Z146_GetEntry(&rx);
+		__Z246_GetEntry(&tx);
+
+		if ((error = rx.init(rxDesc, NULL, &rxMa, NULL, NULL, &rxHdl)) ||
+			(error = tx.init(txDesc, NULL, &txMa, NULL, NULL, &txHdl))) {
+			printf("*** init failed: 0x%lx\n", (unsigned long)error);
+			return(1);
+		}
+	}
+	SIM_IrqAttach(&rxDev, (int32 (*)(void*))rx.irq, rxHdl);
+	SIM_IrqAttach(&txDev, (int32 (*)(void*))tx.irq, txHdl);
+	rx.setStat(rxHdl, M_MK_IRQ_ENABLE, 0, 1);
+	tx.setStat(txHdl, M_MK_IRQ_ENABLE, 0, 1);
+	SIM_IrqEnable(&rxDev, 1);
+	SIM_IrqEnable(&txDev, 1);
+
+	if ((txBuf = malloc(burst * sizeof(u_int32))) == NULL) {
+		printf("*** can't alloc buffer\n");
+		return(1);
+	}
+
+	/*--------------------+
+	|  throughput         |
+	+--------------------*/
+	t0 = SIM_TimeUs();
+	cpu = CpuUs();
+	while (got < count) {
+		if (sent < count) {
+			n = (count - sent < burst) ? count - sent : burst;
+			for (i = 0; i < (u_int32)n; i++)
+				txBuf[i] = (sent + i) & Z246_23_BIT_MASK;
+			error = tx.blockWrite(txHdl, 0, txBuf, n * 4, &nbr);
+			if (error == 0)
+				sent += n;
+			else if (error != ERR_MBUF_OVERFLOW) {
+				printf("*** blockWrite failed: 0x%lx\n", (unsigned long)error);
+				break;
+			}
+		}
+		SIM_Run(SIM_TimeUs() + (u_int64)WORD_US(speed) * ((burst + 1) / 2));
+		if ((n = Receive(&rx, rxHdl, &expect, &errors)) < 0)
+			break;
+		got += n;
+		/* everything sent: stop when the line stays idle */
+		if (sent == count && n == 0 && txDev.fifoCnt == 0 &&
+			SIM_TimeUs() - rxDev.rxLastUs > 100 * (u_int64)WORD_US(speed))
+			break;
+	}
+	simUs = SIM_TimeUs() - t0;
+	cpu = CpuUs() - cpu;
+
+	/*--------------------+
+	|  latency            |
+	+--------------------*/
+	for (i = 0; i < latCount; i++) {
+		t0 = SIM_TimeUs();
+		if ((error = tx.write(txHdl, 0, (int32)(expect & Z246_23_BIT_MASK)))) {
+			printf("*** write failed: 0x%lx\n", (unsigned long)error);
+			break;
+		}
+		do {
+			SIM_Run(SIM_TimeUs() + LAT_STEP_US);
+			n = Receive(&rx, rxHdl, &expect, &errors);
+		} while (n == 0 && SIM_TimeUs() - t0 < LAT_TIMEOUT_US);
+		if (n <= 0)
+			break;
+		latSum += SIM_TimeUs() - t0;
+		if (SIM_TimeUs() - t0 > latMax)
+			latMax = (u_int32)(SIM_TimeUs() - t0);
+	}
+
+	/*--------------------+
+	|  result             |
+	+--------------------*/
+	printf("speed            : %s\n", speed ? "100 kHz" : "12.5 kHz");
+	printf("words            : %lu sent, %lu received, %lu lost, %lu errors\n",
+		   (unsigned long)sent, (unsigned long)got,
+		   (unsigned long)(sent - got), (unsigned long)errors);
+	if (simUs != 0)
+		printf("throughput       : %lu words/s, bus %lu%%\n",
+			   (unsigned long)((u_int64)got * 1000000 / simUs),
+			   (unsigned long)((u_int64)got * WORD_US(speed) * 100 / simUs));
+	if (got != 0)
+		printf("host CPU         : %lu ns/word\n",
+			   (unsigned long)(cpu * 1000 / got));
+	if (i != 0)
+		printf("latency [us]     : avg %lu  max %lu (%lu words)\n",
+			   (unsigned long)(latSum / i), (unsigned long)latMax,
+			   (unsigned long)i);
+	printf("RX irqs/overrun  : %lu / %lu\n", (unsigned long)rxDev.stats.irqs,
+		   (unsigned long)rxDev.stats.rxOverrun);
+	printf("TX irqs/overflow : %lu / %lu\n", (unsigned long)txDev.stats.irqs,
+		   (unsigned long)txDev.stats.txFifoOverflow);
+
+	/* driver instrumentation, the ISRs take no simulated time */
+	blk.size = sizeof(rxLat);
+	blk.data = (void*)&rxLat;
+	if (rx.getStat(rxHdl, Z146_BLK_IRQLAT, 0, (INT32_OR_64*)&blk) == 0)
+		printf("RX ISR           : %lu irqs, max %lu words, threshold "
+			   "latency max %lu us\n", (unsigned long)rxLat.irqs,
+			   (unsigned long)rxLat.maxWords, (unsigned long)rxLat.latMaxUs);
+	blk.size = sizeof(txLat);
+	blk.data = (void*)&txLat;
+	if (tx.getStat(txHdl, Z246_BLK_IRQLAT, 0, (INT32_OR_64*)&blk) == 0)
+		printf("TX ISR           : %lu irqs, max %lu words, threshold "
+			   "latency max %lu us\n", (unsigned long)txLat.irqs,
+			   (unsigned long)txLat.maxWords, (unsigned long)txLat.latMaxUs);
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+	free(txBuf);
+	rx.exit(&rxHdl);
+	tx.exit(&txHdl);
+	return((sent == got && errors == 0) ? 0 : 1);
+}
+
+/********************************* Receive *********************************/
+/** Read all received words and check the sequence
+ *
+ *  \param rx         \IN  receiver jump table
+ *  \param rxHdl      \IN  receiver handle
+ *  \param expect     \IN  expected data, \OUT next expected data
+ *  \param errors     \OUT incremented for each unexpected word
+ *
+ *  \return	          number of words or negative error code
+ */
+static int32 Receive(LL_ENTRY *rx, LL_HANDLE *rxHdl, u_int32 *expect,
+					 u_int32 *errors)
+{
+	u_int32 data = 0;
+	int32 nbr = 0;
+	int32 error = 0;
+	int32 i = 0;
+
+	if ((error = rx->blockRead(rxHdl, 0, G_rxBuf, sizeof(G_rxBuf), &nbr))) {
+		printf("*** blockRead failed: 0x%lx\n", (unsigned long)error);
+		return -1;
+	}
+	for (i = 0; i < nbr / 4; i++) {
+		data = (G_rxBuf[i] >> 8) & Z246_23_BIT_MASK;
+		if ((G_rxBuf[i] & 0xFF) != LABEL || data != *expect) {
+			(*errors)++;
+			*expect = data;
+		}
+		*expect = (*expect + 1) & Z246_23_BIT_MASK;
+	}
+	return nbr / 4;
+}
+
+/********************************* CpuUs ***********************************/
+/** Host CPU time of the process
+ *
+ *  \return	          time [us]
+ */
+static u_int64 CpuUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (u_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_sim [-s <speed>] [-n <count>] [-b <burst>] "
+		   "[-l <count>] [-d <level>]\n");
+	printf("Function: run the Z146/Z246 drivers on the host against the\n");
+	printf("          register level simulator of the cores\n");
+	printf("Options:\n");
+	printf("    -s speed   1 = 100 kHz (default), 0 = 12.5 kHz\n");
+	printf("    -n count   words to send (default 10000)\n");
+	printf("    -b burst   words per M_setblock() (default 64)\n");
+	printf("    -l count   single words for the latency (default 100)\n");
+	printf("    -d level   driver debug level (default 0)\n");
+	printf("\n");
+}
@@ -0,0 +1,815 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                    Z146_SIMTEST                    ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_simtest.c
+ *
+ *       \brief  Checked scenarios against the register level simulator
+ *
+ *               Each scenario sets up its own simulated devices, runs
+ *               and checks the result. The program prints one line per
+ *               scenario and exits with 0 if all scenarios passed and 1
+ *               otherwise, so it can be used as a build gate.
+ *
+ *               Scenarios:
+ *               - uio: z146_uio library, Z146_UioTxWrite() to a simulated
+ *                 transmitter, Z146_UioRxPoll() from a connected receiver,
+ *                 the received words are compared with the sent ones
+ *
+ *               The other scenarios run the Z146 and Z246 drivers through
+ *               their LL_ENTRY jump tables with the interrupts enabled:
+ *               - label: words of a label not in the receive list are
+ *                 dropped, the others are received in order
+ *               - sdi: words with a different SDI are dropped
+ *               - parity: words with the wrong parity are dropped and
+ *                 reported by the line status interrupt, the line works
+ *                 again with the right parity
+ *               - timeout: words below the FIFO threshold are delivered
+ *                 by the character timeout, not before
+ *               - linestat: framing errors (speed mismatch) and a receive
+ *                 FIFO overrun raise the line status interrupt, the driver
+ *                 discards the FIFO and counts the words
+ *               - slow: a burst at 12.5 kHz arrives complete and takes
+ *                 the word time of 12.5 kHz
+ *               - irqlat: with an interrupt latency of the simulator the
+ *                 drivers report a threshold latency of the same size
+ *               - writer: with two writer channels a limited writer is
+ *                 rejected above its burst while the other one is not
+ *                 limited, after the refill time it is accepted again
+ *
+ *     Required: -
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <MEN/men_typs.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/maccess.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/z146_regs.h>
+#include <MEN/z146_uio.h>
+#include <MEN/z146_sim.h>
+
+typedef void LL_HANDLE;
+#include <MEN/ll_entry.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z246_drv.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define LABEL			1
+#define WORD_US(speed)	((speed) ? 360 : 2880)	/* 36 bit times */
+#define UIO_WORDS		1000	/* more than both FIFOs */
+#define UIO_STEP_WORDS	32		/* words on the bus between two polls */
+#define BUF_WORDS		512
+#define BIT_US(speed)	((speed) ? 10 : 80)
+#define IRQ_LAT_US		1000	/* simulated interrupt latency */
+#define WR_RATE			1000	/* rate limit of the limited writer [words/s] */
+
+/** check a condition of a scenario, fail the scenario if not met */
+#define CHECK(cond, msg) \
+	do { \
+		if (!(cond)) { \
+			printf("FAIL, %s (line %d)\n", (msg), __LINE__); \
+			return 1; \
+		} \
+	} while (0)
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+typedef struct {
+	const char	*name;
+	int			(*run)(void);
+} SCENARIO;
+
+/** transmitter and receiver driven by the drivers */
+typedef struct {
+	MACCESS		rxMa;
+	MACCESS		txMa;
+	LL_ENTRY	rx;
+	LL_ENTRY	tx;
+	LL_HANDLE	*rxHdl;
+	LL_HANDLE	*txHdl;
+} PAIR;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static int UioLoop(void);
+static int UioCheck(SIM_DEV *rxDev, SIM_DEV *txDev);
+static int Label(void);
+static int Sdi(void);
+static int Parity(void);
+static int Timeout(void);
+static int LineStat(void);
+static int Slow(void);
+static int IrqLat(void);
+static int Writer(void);
+static int PairOpen(PAIR *p, DESC_SPEC *rxDesc, DESC_SPEC *txDesc);
+static void PairClose(PAIR *p);
+static int32 Send(PAIR *p, u_int32 first, u_int32 num, u_int32 speed);
+static int32 Receive(PAIR *p, u_int32 *buf);
+static int32 RxStats(PAIR *p, Z146_RX_STATS *stats);
+static u_int32 Ones(u_int32 word);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static const SCENARIO G_scenario[] = {
+	{ "uio",		UioLoop },
+	{ "label",		Label },
+	{ "sdi",		Sdi },
+	{ "parity",		Parity },
+	{ "timeout",	Timeout },
+	{ "linestat",	LineStat },
+	{ "slow",		Slow },
+	{ "irqlat",		IrqLat },
+	{ "writer",		Writer },
+	{ NULL,			NULL }
+};
+
+static u_int32 G_txBuf[UIO_WORDS];
+static u_int32 G_rxBuf[UIO_WORDS];
+
+static u_int8 G_label[] = { LABEL };
+
+static SIM_DEV G_rxDev;
+static SIM_DEV G_txDev;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  names of the scenarios to run, default all
+ *
+ *  \return	          all passed (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+	const SCENARIO *sc = NULL;
+	u_int32 failed = 0;
+	u_int32 run = 0;
+	int argi = 0;
+
+	for (sc = G_scenario; sc->name != NULL; sc++) {
+		if (argc > 1) {
+			for (argi = 1; argi < argc; argi++) {
+				if (strcmp(argv[argi], sc->name) == 0)
+					break;
+			}
+			if (argi == argc)
+				continue;
+		}
+		printf("%-16s : ", sc->name);
+		fflush(stdout);
+		if (sc->run() == 0)
+			printf("PASS\n");
+		else
+			failed++;
+		run++;
+	}
+	printf("%lu scenarios, %lu failed\n", (unsigned long)run,
+		   (unsigned long)failed);
+	return((run != 0 && failed == 0) ? 0 : 1);
+}
+
+/********************************* UioLoop *********************************/
+/** z146_uio library against a simulated transmitter and receiver
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int UioLoop(void)
+{
+	SIM_DEV rxDev;
+	SIM_DEV txDev;
+	int result = 0;
+
+	SIM_DevInit(&rxDev, SIM_TYPE_RX);
+	SIM_DevInit(&txDev, SIM_TYPE_TX);
+	SIM_Connect(&txDev, &rxDev);
+
+	result = UioCheck(&rxDev, &txDev);
+
+	SIM_DevExit(&txDev);
+	SIM_DevExit(&rxDev);
+	return result;
+}
+
+/********************************* UioCheck ********************************/
+/** Send words with Z146_UioTxWrite(), poll and check them
+ *
+ *  Both cores run at 100 kHz with odd parity, the receiver filters the
+ *  sent label. The data words use all 23 data bits.
+ *
+ *  \param rxDev      \IN  receiver
+ *  \param txDev      \IN  transmitter connected to rxDev
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int UioCheck(SIM_DEV *rxDev, SIM_DEV *txDev)
+{
+	Z146_UIO rxUio;
+	Z146_UIO txUio;
+	u_int8 label = LABEL;
+	u_int32 sent = 0;
+	u_int32 got = 0;
+	u_int32 loops = 0;
+	u_int32 i = 0;
+	int32 n = 0;
+
+	Z146_UioAttach(&rxUio, rxDev);
+	Z146_UioAttach(&txUio, txDev);
+	Z146_UioRxInit(&rxUio, Z146_RX_SPEED_MASK | Z146_RX_PAR_EN_MASK |
+				   Z146_RX_LAB_EN_MASK, 0, &label, 1);
+	Z146_UioTxInit(&txUio, Z246_TX_SPEED_MASK | Z246_TX_PAR_EN_MASK, LABEL);
+
+	for (i = 0; i < UIO_WORDS; i++)
+		G_txBuf[i] = (i * 2654435761u) >> 9;
+
+	/* a full FIFO takes only its free space */
+	CHECK(Z146_UioTxFree(&txUio) == Z246_TX_FIFO_MAX, "TX FIFO not empty");
+	sent = Z146_UioTxWrite(&txUio, G_txBuf, UIO_WORDS);
+	CHECK(sent == Z246_TX_FIFO_MAX, "first write not limited to the FIFO");
+	CHECK(Z146_UioTxWrite(&txUio, G_txBuf + sent, UIO_WORDS - sent) == 0,
+		  "write to a full FIFO accepted");
+
+	while (got < UIO_WORDS && loops++ < 2 * UIO_WORDS / UIO_STEP_WORDS) {
+		sent += Z146_UioTxWrite(&txUio, G_txBuf + sent, UIO_WORDS - sent);
+		SIM_Run(SIM_TimeUs() + (u_int64)UIO_STEP_WORDS * WORD_US(1));
+		n = Z146_UioRxPoll(&rxUio, G_rxBuf + got, UIO_WORDS - got);
+		CHECK(n >= 0, "RX poll failed");
+		got += (u_int32)n;
+	}
+	CHECK(got == UIO_WORDS, "words missing");
+	CHECK(Z146_UioRxPoll(&rxUio, G_rxBuf, UIO_WORDS) == 0, "extra words");
+
+	for (i = 0; i < UIO_WORDS; i++) {
+		CHECK((G_rxBuf[i] & 0xFF) == LABEL, "wrong label");
+		CHECK(((G_rxBuf[i] >> 8) & Z246_23_BIT_MASK) == G_txBuf[i],
+			  "wrong data");
+		CHECK((Ones(G_rxBuf[i]) & 1) == 1, "wrong parity");
+	}
+	CHECK(rxUio.rxLsrErrors == 0, "line status errors");
+	CHECK(rxDev->stats.rxOverrun == 0, "RX FIFO overrun");
+	CHECK(txDev->stats.txFifoOverflow == 0, "TX FIFO overflow");
+	return 0;
+}
+
+/********************************* Label ***********************************/
+/** Receive label filter
+ *
+ *  The receiver accepts labels 1 and 2, the transmitter sends ten words
+ *  each with label 1, 3 and 2.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int Label(void)
+{
+	static const u_int8 labels[] = { 1, 2 };
+	static const u_int32 txLabel[] = { 1, 3, 2 };
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, labels, sizeof(labels) },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	PAIR p;
+	INT32_OR_64 level = 0;
+	u_int32 i = 0;
+	int32 n = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	for (i = 0; i < 3; i++) {
+		p.tx.getStat(p.txHdl, Z246_TX_LEVEL, 0, &level);
+		CHECK(level == 0, "words left before the label change");
+		CHECK(p.tx.setStat(p.txHdl, Z246_TX_LABEL, 0, txLabel[i]) == 0,
+			  "TX label not set");
+		CHECK(Send(&p, i * 10, 10, 1) == 0, "send failed");
+	}
+	n = Receive(&p, G_rxBuf);
+	PairClose(&p);
+
+	CHECK(n == 20, "wrong number of words");
+	for (i = 0; i < 20; i++) {
+		CHECK((G_rxBuf[i] & 0xFF) == (i < 10 ? 1 : 2), "wrong label");
+		CHECK(((G_rxBuf[i] >> 8) & Z246_23_BIT_MASK) == (i < 10 ? i : i + 10),
+			  "wrong data");
+	}
+	CHECK(G_rxDev.stats.rxLabelDrop == 10, "label 3 not dropped");
+	return 0;
+}
+
+/********************************* Sdi *************************************/
+/** Receive SDI filter
+ *
+ *  The receiver accepts SDI 2, the transmitter sends ten words each with
+ *  SDI 2, 1 and 2.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int Sdi(void)
+{
+	static const u_int32 txSdi[] = { 2, 1, 2 };
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ "RX_SDI_EN", 1, NULL, 0 },
+		{ "RX_SDI", 2, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ "TX_SDI_EN", 1, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	PAIR p;
+	u_int32 i = 0;
+	int32 n = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	for (i = 0; i < 3; i++) {
+		CHECK(p.tx.setStat(p.txHdl, Z246_SDI, 0, txSdi[i]) == 0,
+			  "TX SDI not set");
+		CHECK(Send(&p, i * 10, 10, 1) == 0, "send failed");
+	}
+	n = Receive(&p, G_rxBuf);
+	PairClose(&p);
+
+	CHECK(n == 20, "wrong number of words");
+	for (i = 0; i < 20; i++) {
+		CHECK(((G_rxBuf[i] >> 8) & 0x3) == 2, "wrong SDI");
+		CHECK(((G_rxBuf[i] >> 10) & Z246_21_BIT_MASK) == (i < 10 ? i : i + 10),
+			  "wrong data");
+	}
+	CHECK(G_rxDev.stats.rxSdiDrop == 10, "SDI 1 not dropped");
+	return 0;
+}
+
+/********************************* Parity **********************************/
+/** Parity errors
+ *
+ *  The transmitter sends even parity to an odd parity receiver, then
+ *  switches to odd parity.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int Parity(void)
+{
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ "TX_PAR_TYP", 1, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	Z146_RX_STATS stats;
+	PAIR p;
+	u_int32 i = 0;
+	int32 n = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	CHECK(Send(&p, 0, 10, 1) == 0, "send failed");
+	CHECK(Receive(&p, G_rxBuf) == 0, "words with parity error received");
+	CHECK(RxStats(&p, &stats) == 0, "no RX statistics");
+
+	CHECK(p.tx.setStat(p.txHdl, Z246_PAR_TYPE, 0, 0) == 0, "TX parity not set");
+	CHECK(Send(&p, 10, 10, 1) == 0, "send failed");
+	n = Receive(&p, G_rxBuf);
+	PairClose(&p);
+
+	CHECK(G_rxDev.stats.rxParityErr == 10, "parity errors not detected");
+	CHECK(stats.lineErrIrqs != 0, "no line status interrupt");
+	CHECK(stats.lineErrLsr & SIM_LSR_PARITY, "parity error not reported");
+	CHECK(n == 10, "line does not recover");
+	for (i = 0; i < 10; i++) {
+		CHECK(((G_rxBuf[i] >> 8) & Z246_23_BIT_MASK) == i + 10, "wrong data");
+		CHECK((Ones(G_rxBuf[i]) & 1) == 1, "wrong parity");
+	}
+	return 0;
+}
+
+/********************************* Timeout *********************************/
+/** Character timeout
+ *
+ *  Five words stay below the FIFO threshold of 32 words. They are only
+ *  delivered after RX_TIMEOUT bit times without a new word.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int Timeout(void)
+{
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ "RX_THR_LEV", 5, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	PAIR p;
+	INT32_OR_64 level = 0;
+	INT32_OR_64 avail = 0;
+	u_int64 lastUs = 0;
+	u_int32 timeoutUs = Z146_RX_TIMEOUT_DEFAULT * BIT_US(1);
+	int32 nbr = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	CHECK(p.tx.blockWrite(p.txHdl, 0, G_txBuf, 5 * 4, &nbr) == 0, "send failed");
+	p.tx.getStat(p.txHdl, Z246_TX_LEVEL, 0, &level);
+	CHECK(level == 5, "wrong TX level");
+
+	/* all words on the line, timeout not yet reached */
+	SIM_Run(SIM_TimeUs() + 5 * WORD_US(1) + timeoutUs / 2);
+	lastUs = G_rxDev.rxLastUs;
+	p.rx.getStat(p.rxHdl, Z146_RX_DATA_LEN, 0, &avail);
+	CHECK(G_rxDev.stats.rxWords == 5, "words not on the line");
+	CHECK(avail == 0, "words delivered before the timeout");
+
+	SIM_Run(lastUs + timeoutUs);
+	p.rx.getStat(p.rxHdl, Z146_RX_DATA_LEN, 0, &avail);
+	PairClose(&p);
+
+	CHECK(avail == 5, "words not delivered by the timeout");
+	CHECK(G_rxDev.fifoCnt == 0, "FIFO not read");
+	return 0;
+}
+
+/********************************* LineStat ********************************/
+/** Line status interrupts for framing errors and overruns
+ *
+ *  First a 12.5 kHz transmitter sends to a 100 kHz receiver. Then the
+ *  receive data interrupt is disabled and more words are sent than the
+ *  FIFO holds.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int LineStat(void)
+{
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ "RX_IRQ_ENABLE", Z146_RX_RLSIEN_MASK, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ "TX_SPEED", 0, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	Z146_RX_STATS framing;
+	Z146_RX_STATS overrun;
+	PAIR p;
+	u_int32 i = 0;
+	int32 n = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	CHECK(Send(&p, 0, 5, 0) == 0, "send failed");
+	CHECK(RxStats(&p, &framing) == 0, "no RX statistics");
+
+	/* the FIFO is not read: 255 words fill it, word 256 is lost */
+	CHECK(p.tx.setStat(p.txHdl, Z246_TX_SPEED, 0, 1) == 0, "TX speed not set");
+	CHECK(Send(&p, 0, 300, 1) == 0, "send failed");
+	CHECK(RxStats(&p, &overrun) == 0, "no RX statistics");
+	n = Receive(&p, G_rxBuf);
+	PairClose(&p);
+
+	CHECK(G_rxDev.stats.rxFramingErr == 5, "framing errors not detected");
+	CHECK(framing.lineErrIrqs != 0, "no line status interrupt (framing)");
+	CHECK(framing.lineErrLsr & SIM_LSR_FRAMING, "framing error not reported");
+
+	CHECK(G_rxDev.stats.rxOverrun == 1, "overrun not detected");
+	CHECK(overrun.lineErrIrqs == 1, "no line status interrupt (overrun)");
+	CHECK(overrun.lineErrLsr & SIM_LSR_OVERRUN, "overrun not reported");
+	CHECK(overrun.lineErrWords == SIM_FIFO_SIZE, "discarded words not counted");
+
+	/* the words after the overrun are in the FIFO */
+	CHECK(n == 300 - SIM_FIFO_SIZE - 1, "wrong number of words");
+	for (i = 0; i < (u_int32)n; i++) {
+		CHECK(((G_rxBuf[i] >> 8) & Z246_23_BIT_MASK) == SIM_FIFO_SIZE + 1 + i,
+			  "wrong data");
+	}
+	return 0;
+}
+
+/********************************* Slow ************************************/
+/** Transmission at 12.5 kHz
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int Slow(void)
+{
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ "RX_SPEED", 0, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ "TX_SPEED", 0, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	PAIR p;
+	u_int64 t0 = SIM_TimeUs();
+	u_int32 i = 0;
+	int32 n = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	t0 = SIM_TimeUs();
+	CHECK(Send(&p, 0, 200, 0) == 0, "send failed");
+	n = Receive(&p, G_rxBuf);
+	PairClose(&p);
+
+	CHECK(n == 200, "wrong number of words");
+	for (i = 0; i < 200; i++)
+		CHECK(((G_rxBuf[i] >> 8) & Z246_23_BIT_MASK) == i, "wrong data");
+	CHECK(G_rxDev.stats.rxFramingErr == 0, "framing errors");
+	CHECK(G_rxDev.rxLastUs - t0 == 200 * (u_int64)WORD_US(0),
+		  "wrong word time");
+	return 0;
+}
+
+/********************************* IrqLat **********************************/
+/** Threshold latency of the drivers with a simulated interrupt latency
+ *
+ *  The drivers take the FIFO threshold in words from the FIFO levels
+ *  seen at their interrupts, so a first run without latency shows them
+ *  the threshold. Then the receive data interrupt, raised at 32 words, is
+ *  handled IRQ_LAT_US later, when 2 or 3 more words were received. The
+ *  transmitter refills its FIFO from the bulk queue after the same
+ *  latency.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int IrqLat(void)
+{
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	Z146_IRQLAT rxLat;
+	Z246_IRQLAT txLat;
+	M_SG_BLOCK blk;
+	PAIR p;
+	int32 n = 0;
+	int32 rxErr = 0;
+	int32 txErr = 0;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	n = (Send(&p, 0, BUF_WORDS, 1) == 0) ? Receive(&p, G_rxBuf) : -1;
+	if (n == BUF_WORDS) {
+		SIM_IrqLatencySet(IRQ_LAT_US);
+		n = (Send(&p, 0, BUF_WORDS, 1) == 0) ? Receive(&p, G_rxBuf) : -1;
+		SIM_IrqLatencySet(0);
+	}
+
+	blk.size = sizeof(rxLat);
+	blk.data = (void*)&rxLat;
+	rxErr = p.rx.getStat(p.rxHdl, Z146_BLK_IRQLAT, 0, (INT32_OR_64*)&blk);
+	blk.size = sizeof(txLat);
+	blk.data = (void*)&txLat;
+	txErr = p.tx.getStat(p.txHdl, Z246_BLK_IRQLAT, 0, (INT32_OR_64*)&blk);
+	PairClose(&p);
+
+	CHECK(n == BUF_WORDS, "wrong number of words");
+	CHECK(rxErr == 0 && txErr == 0, "no interrupt instrumentation");
+	CHECK(rxLat.latNum != 0, "no RX threshold latency");
+	CHECK(rxLat.latMaxUs >= (IRQ_LAT_US / WORD_US(1)) * WORD_US(1) &&
+		  rxLat.latMaxUs <= (IRQ_LAT_US / WORD_US(1) + 1) * WORD_US(1),
+		  "wrong RX threshold latency");
+	CHECK(txLat.latNum != 0, "no TX threshold latency");
+	CHECK(txLat.latMaxUs >= (IRQ_LAT_US / WORD_US(1)) * WORD_US(1) &&
+		  txLat.latMaxUs <= (IRQ_LAT_US / WORD_US(1) + 1) * WORD_US(1),
+		  "wrong TX threshold latency");
+	return 0;
+}
+
+/********************************* Writer **********************************/
+/** Rate limit of a writer channel
+ *
+ *  Writer 1 is limited to WR_RATE words/s with the default burst of 32
+ *  words, writer 0 is not limited. Writer 1 gets one burst, the next
+ *  write is rejected, writer 0 still writes. After the time of one
+ *  burst writer 1 is accepted again. All accepted words are received.
+ *
+ *  \return	          passed (0) or failed (1)
+ */
+static int Writer(void)
+{
+	DESC_SPEC rxDesc[] = {
+		{ "RX_LABEL", 0, G_label, sizeof(G_label) },
+		{ NULL, 0, NULL, 0 }
+	};
+	DESC_SPEC txDesc[] = {
+		{ "TX_LABEL", LABEL, NULL, 0 },
+		{ "TX_WRITERS", 2, NULL, 0 },
+		{ NULL, 0, NULL, 0 }
+	};
+	Z246_TX_STATS stats;
+	M_SG_BLOCK blk;
+	PAIR p;
+	u_int32 buf[BUF_WORDS];
+	INT32_OR_64 chNum = 0;
+	INT32_OR_64 rate = 0;
+	int32 nbr = 0;
+	int32 first = 0;
+	int32 over = 0;
+	int32 other = 0;
+	int32 again = 0;
+	int32 n = 0;
+	u_int32 i = 0;
+
+	for (i = 0; i < BUF_WORDS; i++)
+		buf[i] = i;
+
+	CHECK(PairOpen(&p, rxDesc, txDesc) == 0, "init failed");
+	p.tx.getStat(p.txHdl, M_LL_CH_NUMBER, 0, &chNum);
+	p.tx.setStat(p.txHdl, Z246_TX_RATE_WRITER, 1, WR_RATE);
+	p.tx.getStat(p.txHdl, Z246_TX_RATE_WRITER, 1, &rate);
+
+	first = p.tx.blockWrite(p.txHdl, 1, buf, 32 * 4, &nbr);
+	over  = p.tx.write(p.txHdl, 1, 32);
+	other = p.tx.blockWrite(p.txHdl, 0, buf + 33, 64 * 4, &nbr);
+	SIM_Run(SIM_TimeUs() + 32 * 1000000 / WR_RATE);
+	again = p.tx.write(p.txHdl, 1, 32);
+	SIM_Run(SIM_TimeUs() + (u_int64)100 * WORD_US(1) +
+			2 * Z146_RX_TIMEOUT_DEFAULT * BIT_US(1));
+	n = Receive(&p, G_rxBuf);
+
+	blk.size = sizeof(stats);
+	blk.data = (void*)&stats;
+	p.tx.getStat(p.txHdl, Z246_BLK_TX_STATS, 0, (INT32_OR_64*)&blk);
+	PairClose(&p);
+
+	CHECK(chNum == 2, "wrong number of channels");
+	CHECK(rate == WR_RATE, "writer rate not set");
+	CHECK(first == 0, "burst of the limited writer rejected");
+	CHECK(over == ERR_MBUF_OVERFLOW, "limited writer not rejected");
+	CHECK(other == 0, "unlimited writer rejected");
+	CHECK(again == 0, "limited writer not refilled");
+	CHECK(stats.throttledWords == 1, "rejected words not counted");
+	CHECK(n == 32 + 64 + 1, "wrong number of words");
+	CHECK(((G_rxBuf[n - 1] >> 8) & Z246_23_BIT_MASK) == 32, "wrong data");
+	return 0;
+}
+
+/********************************* PairOpen ********************************/
+/** Set up a transmitter and a receiver with their drivers
+ *
+ *  The devices are G_txDev and G_rxDev. Keys which are not given in the
+ *  descriptors take the driver defaults: 100 kHz, odd parity, label
+ *  filter enabled.
+ *
+ *  \param p          \OUT pair
+ *  \param rxDesc     \IN  receiver descriptor
+ *  \param txDesc     \IN  transmitter descriptor
+ *
+ *  \return	          success (0) or error code
+ */
+static int PairOpen(PAIR *p, DESC_SPEC *rxDesc, DESC_SPEC *txDesc)
+{
+	int32 error = 0;
+
+	SIM_DevInit(&G_rxDev, SIM_TYPE_RX);
+	SIM_DevInit(&G_txDev, SIM_TYPE_TX);
+	SIM_Connect(&G_txDev, &G_rxDev);
+	p->rxMa = &G_rxDev;
+	p->txMa = &G_txDev;
+
+	__Z146_GetEntry(&p->rx);
+	__Z246_GetEntry(&p->tx);
+	if ((error = p->rx.init(rxDesc, NULL, &p->rxMa, NULL, NULL, &p->rxHdl)))
+		goto ERR_RX;
+	if ((error = p->tx.init(txDesc, NULL, &p->txMa, NULL, NULL, &p->txHdl)))
+		goto ERR_TX;
+
+	SIM_IrqAttach(&G_rxDev, (int32 (*)(void*))p->rx.irq, p->rxHdl);
+	SIM_IrqAttach(&G_txDev, (int32 (*)(void*))p->tx.irq, p->txHdl);
+	p->rx.setStat(p->rxHdl, M_MK_IRQ_ENABLE, 0, 1);
+	p->tx.setStat(p->txHdl, M_MK_IRQ_ENABLE, 0, 1);
+	SIM_IrqEnable(&G_rxDev, 1);
+	SIM_IrqEnable(&G_txDev, 1);
+	return 0;
+
+ERR_TX:
+	p->rx.exit(&p->rxHdl);
+ERR_RX:
+	SIM_DevExit(&G_txDev);
+	SIM_DevExit(&G_rxDev);
+	return error;
+}
+
+/********************************* PairClose *******************************/
+/** Release the drivers and the devices of a pair
+ *
+ *  The device statistics stay readable in G_txDev and G_rxDev.
+ *
+ *  \param p          \IN  pair
+ */
+static void PairClose(PAIR *p)
+{
+	SIM_IrqEnable(&G_rxDev, 0);
+	SIM_IrqEnable(&G_txDev, 0);
+	p->rx.exit(&p->rxHdl);
+	p->tx.exit(&p->txHdl);
+	SIM_DevExit(&G_txDev);
+	SIM_DevExit(&G_rxDev);
+}
+
+/********************************* Send ************************************/
+/** Send a data sequence and wait until it is on the line
+ *
+ *  The data words are first..first+num-1. After the last word the line
+ *  stays idle for more than the character timeout.
+ *
+ *  \param p          \IN  pair
+ *  \param first      \IN  first data word
+ *  \param num        \IN  number of words, up to BUF_WORDS
+ *  \param speed      \IN  speed of the transmitter, 1 = 100 kHz
+ *
+ *  \return	          success (0) or error code
+ */
+static int32 Send(PAIR *p, u_int32 first, u_int32 num, u_int32 speed)
+{
+	u_int32 buf[BUF_WORDS];
+	u_int32 i = 0;
+	int32 nbr = 0;
+	int32 error = 0;
+
+	for (i = 0; i < num; i++)
+		buf[i] = first + i;
+	if ((error = p->tx.blockWrite(p->txHdl, 0, buf, num * 4, &nbr)))
+		return error;
+	/* all words, then the character timeout at both speeds */
+	SIM_Run(SIM_TimeUs() + (u_int64)(num + 2) * WORD_US(speed) +
+			2 * Z146_RX_TIMEOUT_DEFAULT * BIT_US(0));
+	return (G_txDev.fifoCnt == 0) ? 0 : ERR_MBUF_OVERFLOW;
+}
+
+/********************************* Receive *********************************/
+/** Read all received words
+ *
+ *  \param p          \IN  pair
+ *  \param buf        \OUT words, UIO_WORDS
+ *
+ *  \return	          number of words or -1 on error
+ */
+static int32 Receive(PAIR *p, u_int32 *buf)
+{
+	int32 nbr = 0;
+
+	if (p->rx.blockRead(p->rxHdl, 0, buf, UIO_WORDS * 4, &nbr))
+		return -1;
+	return nbr / 4;
+}
+
+/********************************* RxStats *********************************/
+/** Get and reset the receive statistics of the driver
+ *
+ *  \param p          \IN  pair
+ *  \param stats      \OUT statistics
+ *
+ *  \return	          success (0) or error code
+ */
+static int32 RxStats(PAIR *p, Z146_RX_STATS *stats)
+{
+	M_SG_BLOCK blk;
+
+	blk.size = sizeof(*stats);
+	blk.data = (void*)stats;
+	return p->rx.getStat(p->rxHdl, Z146_BLK_RX_STATS, 0, (INT32_OR_64*)&blk);
+}
+
+/********************************* Ones ************************************/
+/** Count the bits set in a word
+ *
+ *  \param word       \IN  word
+ *
+ *  \return	          number of bits set
+ */
+static u_int32 Ones(u_int32 word)
+{
+	u_int32 n = 0;
+
+	for (; word != 0; word &= word - 1)
+		n++;
+	return n;
+}
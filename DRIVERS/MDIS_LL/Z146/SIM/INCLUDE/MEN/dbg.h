@@ -0,0 +1,37 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  dbg.h
+ *
+ *       \brief  Host simulator: debug output to stdout
+ *
+ *               The output is enabled with SIM_DbgLevelSet(), the driver
+ *               debug levels are not evaluated.
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _DBG_H
+#define _DBG_H
+
+typedef struct DBG_HANDLE DBG_HANDLE;
+
+extern u_int32 SIM_dbgLevel;
+extern int32 DBG_Write(DBG_HANDLE *dbh, char *fmt, ...);
+
+#define DBG_OUT(lev, _x_)	do { if (SIM_dbgLevel >= (lev)) DBG_Write _x_; } while (0)
+
+#define DBGINIT(_x_)
+#define DBGEXIT(_x_)
+#define DBGWRT_1(_x_)		DBG_OUT(1, _x_)
+#define DBGWRT_2(_x_)		DBG_OUT(2, _x_)
+#define DBGWRT_3(_x_)		DBG_OUT(3, _x_)
+#define DBGWRT_ERR(_x_)		DBG_OUT(0, _x_)
+#define IDBGWRT_1(_x_)		DBG_OUT(1, _x_)
+#define IDBGWRT_2(_x_)		DBG_OUT(2, _x_)
+#define IDBGWRT_3(_x_)		DBG_OUT(3, _x_)
+#define IDBGWRT_ERR(_x_)	DBG_OUT(0, _x_)
+
+#endif /* _DBG_H */
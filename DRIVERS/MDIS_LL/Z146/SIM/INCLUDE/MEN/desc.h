@@ -0,0 +1,40 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  desc.h
+ *
+ *       \brief  Host simulator: descriptor access
+ *
+ *               A descriptor is an array of SIM_DESC_KEY entries, ended by
+ *               an entry with key NULL.
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _DESC_H
+#define _DESC_H
+
+/** one descriptor key */
+typedef struct {
+	const char		*key;		/**< key name, NULL ends the descriptor */
+	u_int32			value;		/**< U_INT32 value */
+	const u_int8	*bin;		/**< BINARY value, NULL for U_INT32 keys */
+	u_int32			binLen;		/**< length of bin */
+} SIM_DESC_KEY;
+
+typedef SIM_DESC_KEY			DESC_SPEC;
+typedef struct DESC_HANDLE		DESC_HANDLE;
+
+extern char *DESC_Ident(void);
+extern int32 DESC_Init(DESC_SPEC *descSpec, OSS_HANDLE *osHdl, DESC_HANDLE **descHdlP);
+extern int32 DESC_Exit(DESC_HANDLE **descHdlP);
+extern int32 DESC_DbgLevelSet(DESC_HANDLE *descHdl, u_int32 dbgLevel);
+extern int32 DESC_GetUInt32(DESC_HANDLE *descHdl, u_int32 defVal,
+							u_int32 *valueP, char *keyFmt, ...);
+extern int32 DESC_GetBinary(DESC_HANDLE *descHdl, u_int8 *defVal,
+							u_int32 defLen, u_int8 *buf, u_int32 *lenP,
+							char *keyFmt, ...);
+
+#endif /* _DESC_H */
@@ -0,0 +1,39 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  ll_defs.h
+ *
+ *       \brief  Host simulator: low-level driver definitions
+ *
+ *    \switches  _NO_LL_HANDLE
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _LL_DEFS_H
+#define _LL_DEFS_H
+
+#include <stdarg.h>
+
+#ifndef _NO_LL_HANDLE
+typedef void LL_HANDLE;
+#endif
+
+/* Irq() return values */
+#define LL_IRQ_DEVICE		0
+#define LL_IRQ_DEV_NOT		1
+#define LL_IRQ_UNKNOWN		2
+
+/* Info() codes */
+#define LL_INFO_HW_CHARACTER	0x01
+#define LL_INFO_ADDRSPACE_COUNT	0x02
+#define LL_INFO_ADDRSPACE		0x03
+#define LL_INFO_IRQ				0x04
+#define LL_INFO_LOCKMODE		0x05
+
+/* lock modes */
+#define LL_LOCK_NONE		0
+#define LL_LOCK_CALL		1
+#define LL_LOCK_CHAN		2
+
+#endif /* _LL_DEFS_H */
@@ -0,0 +1,35 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  maccess.h
+ *
+ *       \brief  Host simulator: register access macros
+ *
+ *               MACCESS is a simulated device, every access is passed to
+ *               the register model of z146_sim.h.
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _MACCESS_H
+#define _MACCESS_H
+
+typedef struct SIM_DEV *MACCESS;
+
+extern u_int8  SIM_Read8(MACCESS ma, u_int32 offs);
+extern u_int16 SIM_Read16(MACCESS ma, u_int32 offs);
+extern u_int32 SIM_Read32(MACCESS ma, u_int32 offs);
+extern void SIM_Write8(MACCESS ma, u_int32 offs, u_int8 val);
+extern void SIM_Write16(MACCESS ma, u_int32 offs, u_int16 val);
+extern void SIM_Write32(MACCESS ma, u_int32 offs, u_int32 val);
+
+#define MREAD_D8(ma, offs)			SIM_Read8((ma), (u_int32)(offs))
+#define MREAD_D16(ma, offs)			SIM_Read16((ma), (u_int32)(offs))
+#define MREAD_D32(ma, offs)			SIM_Read32((ma), (u_int32)(offs))
+#define MWRITE_D8(ma, offs, val)	SIM_Write8((ma), (u_int32)(offs), (u_int8)(val))
+#define MWRITE_D16(ma, offs, val)	SIM_Write16((ma), (u_int32)(offs), (u_int16)(val))
+#define MWRITE_D32(ma, offs, val)	SIM_Write32((ma), (u_int32)(offs), (u_int32)(val))
+
+#endif /* _MACCESS_H */
@@ -0,0 +1,48 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  mdis_api.h
+ *
+ *       \brief  Host simulator: MDIS status codes and types used by the
+ *               drivers
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _MDIS_API_H
+#define _MDIS_API_H
+
+/* status code ranges */
+#define M_MK_OF				0x00
+#define M_LL_OF				0x100
+#define M_DEV_OF			0x200
+#define M_MK_BLK_OF			0x80000000
+#define M_LL_BLK_OF			0x80000100
+#define M_DEV_BLK_OF		0x80000200
+
+/* standard codes used by the drivers */
+#define M_MK_CH_CURRENT		(M_MK_OF+0x02)
+#define M_MK_IRQ_ENABLE		(M_MK_OF+0x0C)
+#define M_LL_DEBUG_LEVEL	(M_LL_OF+0x00)
+#define M_LL_CH_NUMBER		(M_LL_OF+0x01)
+#define M_LL_CH_DIR			(M_LL_OF+0x02)
+#define M_LL_CH_LEN			(M_LL_OF+0x03)
+#define M_LL_CH_TYP			(M_LL_OF+0x04)
+#define M_LL_ID_CHECK		(M_LL_OF+0x08)
+#define M_MK_BLK_REV_ID		(M_MK_BLK_OF+0x02)
+
+/* channel direction and type */
+#define M_CH_IN				0
+#define M_CH_OUT			1
+#define M_CH_INOUT			2
+#define M_CH_BINARY			1
+
+/** block getstat/setstat data */
+typedef struct {
+	int32	size;		/**< size of data [bytes] */
+	void	*data;		/**< data */
+} M_SG_BLOCK;
+
+#endif /* _MDIS_API_H */
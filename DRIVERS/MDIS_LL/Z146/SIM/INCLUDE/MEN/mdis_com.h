@@ -0,0 +1,33 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  mdis_com.h
+ *
+ *       \brief  Host simulator: MDIS common definitions used by the drivers
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _MDIS_COM_H
+#define _MDIS_COM_H
+
+#define MDIS_MAX_IDENT_CALLS	8
+
+/** ident function table */
+typedef struct {
+	struct {
+		char *(*identCall)(void);
+	} idCall[MDIS_MAX_IDENT_CALLS];
+} MDIS_IDENT_FUNCT_TBL;
+
+/* address and data modes */
+#define MDIS_MA08		0x01
+#define MDIS_MA24		0x02
+#define MDIS_MA32		0x04
+#define MDIS_MD08		0x01
+#define MDIS_MD16		0x02
+#define MDIS_MD32		0x04
+
+#endif /* _MDIS_COM_H */
@@ -0,0 +1,47 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  mdis_err.h
+ *
+ *       \brief  Host simulator: MDIS error codes used by the drivers
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _MDIS_ERR_H
+#define _MDIS_ERR_H
+
+#define ERR_SUCCESS				0
+
+#define ERR_OSS					0x0600
+#define ERR_OSS_MEM_ALLOC		(ERR_OSS+0x01)
+#define ERR_OSS_SIG_SET			(ERR_OSS+0x0A)
+#define ERR_OSS_SIG_CLR			(ERR_OSS+0x0B)
+#define ERR_OSS_ALARM_CREATE	(ERR_OSS+0x11)
+#define ERR_OSS_ALARM_SET		(ERR_OSS+0x12)
+#define ERR_OSS_ALARM_CLR		(ERR_OSS+0x13)
+
+#define ERR_DESC				0x0700
+#define ERR_DESC_KEY_NOTFOUND	(ERR_DESC+0x01)
+#define ERR_DESC_CORRUPTED		(ERR_DESC+0x02)
+#define ERR_DESC_BUF_TOOSMALL	(ERR_DESC+0x03)
+
+#define ERR_LL					0x0900
+#define ERR_LL_ILL_FUNC			(ERR_LL+0x01)
+#define ERR_LL_ILL_DIR			(ERR_LL+0x02)
+#define ERR_LL_ILL_PARAM		(ERR_LL+0x03)
+#define ERR_LL_UNK_CODE			(ERR_LL+0x04)
+#define ERR_LL_WRITE			(ERR_LL+0x05)
+#define ERR_LL_USERBUF			(ERR_LL+0x06)
+#define ERR_LL_ILL_CHAN			(ERR_LL+0x07)
+#define ERR_LL_DESC_PARAM		(ERR_LL+0x0B)
+
+#define ERR_MBUF				0x0A00
+#define ERR_MBUF_OVERFLOW		(ERR_MBUF+0x01)
+#define ERR_MBUF_ILL_SIZE		(ERR_MBUF+0x02)
+#define ERR_MBUF_UNDERRUN		(ERR_MBUF+0x03)
+#define ERR_MBUF_USERBUF		(ERR_MBUF+0x04)
+
+#endif /* _MDIS_ERR_H */
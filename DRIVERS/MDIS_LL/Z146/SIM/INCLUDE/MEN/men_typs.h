@@ -0,0 +1,37 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  men_typs.h
+ *
+ *       \brief  Host simulator: basic types (replaces the MDIS header)
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _MEN_TYPS_H
+#define _MEN_TYPS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int8_t		int8;
+typedef uint8_t		u_int8;
+typedef int16_t		int16;
+typedef uint16_t	u_int16;
+typedef int32_t		int32;
+typedef uint32_t	u_int32;
+typedef int64_t		int64;
+typedef uint64_t	u_int64;
+
+typedef intptr_t	INT32_OR_64;
+typedef uintptr_t	U_INT32_OR_64;
+#define U_INT32_OR_64	U_INT32_OR_64
+
+#ifndef TRUE
+# define TRUE	1
+# define FALSE	0
+#endif
+
+#endif /* _MEN_TYPS_H */
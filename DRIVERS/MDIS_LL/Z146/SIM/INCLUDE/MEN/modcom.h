@@ -0,0 +1,16 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  modcom.h
+ *
+ *       \brief  Host simulator: ID PROM functions (not used by the cores)
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _MODCOM_H
+#define _MODCOM_H
+
+#endif /* _MODCOM_H */
@@ -0,0 +1,103 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  z146_sim.h
+ *
+ *       \brief  Register level simulator of the 16Z146 receiver and the
+ *               16Z246 transmitter
+ *
+ *               A simulated device implements the register map of
+ *               z146_regs.h. Transmitters are connected to receivers,
+ *               a word leaves the transmit FIFO after the word time of the
+ *               configured speed (36 bit times incl. gap) and is checked
+ *               by each connected receiver for speed, parity, label and
+ *               SDI. Time is simulated, it advances only in SIM_Run() and
+ *               OSS_Delay(). The interrupt of a device is dispatched to its
+ *               handler when the device requests it, the interrupt is
+ *               enabled and not masked by OSS_IrqMaskR(), after an
+ *               optional interrupt latency.
+ *
+ *    \switches  (none)
+ */
+/*---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _Z146_SIM_H
+#define _Z146_SIM_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define SIM_TYPE_RX			0		/**< 16Z146 receiver */
+#define SIM_TYPE_TX			1		/**< 16Z246 transmitter */
+
+#define SIM_MAX_PEERS		8		/**< receivers per transmitter */
+#define SIM_FIFO_SIZE		255		/**< FIFO size in words */
+#define SIM_WIN_SIZE		0x800	/**< register window */
+
+/* RX_LSR bits of the simulator, cleared by writing 1 */
+#define SIM_LSR_OVERRUN		0x02	/**< word lost, FIFO full */
+#define SIM_LSR_PARITY		0x04	/**< parity error */
+#define SIM_LSR_FRAMING		0x08	/**< word with the wrong speed */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** statistics of a simulated device */
+typedef struct {
+	u_int32	txWords;		/**< TX: words sent on the bus */
+	u_int32	txFifoOverflow;	/**< TX: words acknowledged without FIFO space */
+	u_int32	rxWords;		/**< RX: words stored in the FIFO */
+	u_int32	rxLabelDrop;	/**< RX: words dropped by the label filter */
+	u_int32	rxSdiDrop;		/**< RX: words dropped by the SDI filter */
+	u_int32	rxParityErr;	/**< RX: words with parity error */
+	u_int32	rxFramingErr;	/**< RX: words with the wrong speed */
+	u_int32	rxOverrun;		/**< RX: words lost, FIFO full */
+	u_int32	irqs;			/**< interrupts dispatched */
+} SIM_STATS;
+
+/** simulated 16Z146 or 16Z246 core */
+typedef struct SIM_DEV {
+	u_int32		type;					/**< SIM_TYPE_xxx */
+	u_int8		reg[SIM_WIN_SIZE];		/**< plain registers */
+	u_int32		fifo[SIM_FIFO_SIZE];	/**< RX or TX FIFO */
+	u_int32		fifoHead;				/**< oldest word */
+	u_int32		fifoCnt;				/**< words in the FIFO */
+	u_int32		stage[SIM_FIFO_SIZE];	/**< TX: words written, not yet acknowledged */
+	u_int8		lsr;					/**< RX: line status */
+	int			rxTimeout;				/**< RX: character timeout reached */
+	u_int64		rxLastUs;				/**< RX: time of the last word */
+	u_int64		txDoneUs;				/**< TX: end of the current word, 0 = idle */
+	struct SIM_DEV *peer[SIM_MAX_PEERS];	/**< TX: connected receivers */
+	u_int32		peerNum;				/**< TX: number of receivers */
+	int32		(*isr)(void *arg);		/**< interrupt handler */
+	void		*isrArg;				/**< argument of the handler */
+	int			irqEnabled;				/**< interrupt enabled */
+	int			irqReq;					/**< interrupt requested */
+	u_int64		irqReqUs;				/**< time of the interrupt request */
+	SIM_STATS	stats;					/**< statistics */
+} SIM_DEV;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern void SIM_DevInit(SIM_DEV *dev, u_int32 type);
+extern void SIM_DevExit(SIM_DEV *dev);
+extern int32 SIM_Connect(SIM_DEV *tx, SIM_DEV *rx);
+extern void SIM_IrqAttach(SIM_DEV *dev, int32 (*isr)(void *arg), void *arg);
+extern void SIM_IrqEnable(SIM_DEV *dev, int enable);
+extern void SIM_IrqLatencySet(u_int32 us);
+extern u_int64 SIM_TimeUs(void);
+extern void SIM_Run(u_int64 untilUs);
+extern void SIM_DbgLevelSet(u_int32 level);
+extern u_int32 SIM_SigCount(void);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _Z146_SIM_H */
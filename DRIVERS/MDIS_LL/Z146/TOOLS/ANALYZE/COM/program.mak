@@ -0,0 +1,22 @@
+#***************************  M a k e f i l e  *******************************
+#
+#    Description: Makefile definitions for the Z146 capture analyzer
+#
+#---------------------------------[ History ]---------------------------------
+#
+#-----------------------------------------------------------------------------
+#   (c) Copyright 2000 by MEN mikro elektronik GmbH, Nuernberg, Germany
+#*****************************************************************************
+
+MAK_NAME=z146_analyze
+
+MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/z146_cap$(LIB_SUFFIX)	\
+			-lpthread	\
+			-lm	\
+
+MAK_INCL=$(MEN_INC_DIR)/z146_cap.h	\
+         $(MEN_INC_DIR)/men_typs.h	\
+
+MAK_INP1=z146_analyze$(INP_SUFFIX)
+
+MAK_INP=$(MAK_INP1)
@@ -0,0 +1,625 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                    Z146_ANALYZE                    ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_analyze.c
+ *
+ *       \brief  Parallel offline analysis of captures of z146_capture
+ *
+ *               The records of the capture files are split into equal
+ *               ranges, one per thread. Each thread reads its range with
+ *               an own stream of the z146_cap library and computes
+ *               partial results per channel and label, which are merged
+ *               in file order at the end. The interval between the last
+ *               word of a range and the first word of the next range is
+ *               added by the merge, so the results do not depend on the
+ *               number of threads.
+ *
+ *               Per channel and label:
+ *               - words and rate
+ *               - interval between words: mean, min, max and jitter
+ *                 (standard deviation)
+ *               - gaps: intervals longer than -g ms, default 2.5 times
+ *                 the mean interval (then counted from a histogram with
+ *                 four bins per octave, i.e. to about 20%)
+ *               - SSM distribution (ARINC bits 30..31)
+ *               - parity errors: words whose number of ones in the 32
+ *                 bit frame does not match the parity. Only checked on
+ *                 channels whose receiver had Z146_PAR_EN 0 (see the
+ *                 capture header), otherwise bit 32 is not received and
+ *                 words dropped by the receiver because of a parity
+ *                 error are counted as line losses of the channel. The
+ *                 parity is the Z146_PAR_TYP of the receiver unless -p
+ *                 is given.
+ *               - value range of ARINC bits 11..29, raw and as BNR with
+ *                 sign bit 29
+ *
+ *               Per channel the loss records of the capture are summed.
+ *
+ *     Required: libraries: z146_cap, pthread, m
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <MEN/men_typs.h>
+#include <MEN/z146_cap.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_FILES		256
+#define MAX_THREADS		256
+#define READ_RECS		65536		/* records per Z146_CapRead() */
+#define MIN_RECS		(4 * READ_RECS)	/* min. records per thread */
+#define HIST_NUM		160			/* interval histogram, 4 bins per octave */
+#define GAP_AUTO		2.5			/* default gap: times the mean interval */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** results of a label */
+typedef struct {
+	u_int64	words;
+	u_int64	tFirst;
+	u_int64	tLast;
+	u_int64	ivNum;			/* intervals */
+	double	ivSum;
+	double	ivSq;
+	u_int64	ivMin;
+	u_int64	ivMax;
+	u_int64	ivMaxAt;		/* time of the word after the max. interval */
+	u_int64	gaps;			/* intervals > -g */
+	u_int64	ssm[4];
+	u_int64	parErr;
+	u_int32	rawMin;
+	u_int32	rawMax;
+	int32	bnrMin;
+	int32	bnrMax;
+	u_int32	hist[HIST_NUM];
+} AN_LABEL;
+
+/** results of a channel */
+typedef struct {
+	u_int64		words;
+	u_int64		loss[3];	/* driver, line, capture */
+	AN_LABEL	lab[256];
+} AN_CHAN;
+
+/** work of a thread */
+typedef struct {
+	pthread_t	thread;
+	u_int64		from;		/* first record, over all files */
+	u_int64		to;			/* behind the last record */
+	AN_CHAN		*ch;		/* Z146_CAP_CH_MAX channels */
+	int			error;		/* errno */
+	char		*errFile;
+} AN_PART;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static void *Worker(void *arg);
+static void Record(AN_CHAN *ch, const Z146_CAP_REC *r);
+static void Interval(AN_LABEL *l, u_int64 dt, u_int64 t);
+static void Merge(AN_CHAN *acc, AN_CHAN *part);
+static u_int64 AutoGaps(AN_LABEL *l);
+static u_int32 HistBin(u_int64 dt);
+static u_int64 HistLow(u_int32 bin);
+static void Print(void);
+static u_int64 TimeUs(void);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static char *G_file[MAX_FILES];
+static u_int64 G_fileRecs[MAX_FILES];
+static u_int32 G_fileNum;
+static Z146_CAP_HDR G_hdr;
+static u_int64 G_gapUs;			/* 0 = auto */
+static int G_parity = -2;		/* 1 = odd, 0 = even, -1 = no check, -2 = auto */
+static int G_chPar[Z146_CAP_CH_MAX];	/* per channel, as G_parity */
+static AN_PART G_part[MAX_THREADS];
+static u_int32 G_partNum;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	Z146_CAP_FILE cf;
+	u_int64 total = 0;
+	u_int64 start = 0;
+	u_int64 us = 0;
+	u_int32 threads = 0;
+	u_int32 i = 0;
+	long cpus = 0;
+	int error = 0;
+	int ret = 1;
+	int argi = 1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0 || argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 'j': threads = strtoul(argv[argi], NULL, 0);						break;
+		case 'g': G_gapUs = (u_int64)(strtod(argv[argi], NULL) * 1000.0);		break;
+		case 'p':
+			if (strcmp(argv[argi], "odd") == 0)
+				G_parity = 1;
+			else if (strcmp(argv[argi], "even") == 0)
+				G_parity = 0;
+			else if (strcmp(argv[argi], "none") == 0)
+				G_parity = -1;
+			else if (strcmp(argv[argi], "auto") == 0)
+				G_parity = -2;
+			else
+				error = 1;
+			break;
+		default:
+			error = 1;
+		}
+		if (error) {
+			Usage();
+			return(1);
+		}
+	}
+	for (; argi < argc && G_fileNum < MAX_FILES; argi++)
+		G_file[G_fileNum++] = argv[argi];
+	if (G_fileNum == 0 || argi != argc || threads > MAX_THREADS) {
+		Usage();
+		return(1);
+	}
+
+	/* files of one capture, in order */
+	for (i = 0; i < G_fileNum; i++) {
+		if (Z146_CapOpen(&cf, G_file[i]) < 0) {
+			printf("*** can't open %s: %s\n", G_file[i],
+				   errno == EINVAL ? "no capture file" : strerror(errno));
+			return(1);
+		}
+		if (i == 0)
+			G_hdr = cf.hdr;
+		else if (cf.hdr.startUs != G_hdr.startUs || cf.hdr.chNum != G_hdr.chNum) {
+			printf("*** %s is not part of the capture of %s\n", G_file[i],
+				   G_file[0]);
+			Z146_CapClose(&cf);
+			return(1);
+		}
+		G_fileRecs[i] = cf.recNum;
+		total += cf.recNum;
+		Z146_CapClose(&cf);
+	}
+
+	/* parity per channel, none if the receiver checked it */
+	for (i = 0; i < G_hdr.chNum; i++) {
+		if ((G_hdr.parEn >> i) & 1)
+			G_chPar[i] = -1;
+		else if (G_parity != -2)
+			G_chPar[i] = G_parity;
+		else
+			G_chPar[i] = ((G_hdr.parTyp >> i) & 1) ? 0 : 1;
+	}
+
+	/* one range per thread, not too small */
+	if (threads == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (u_int32)cpus : 1;
+	}
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+	if ((u_int64)threads * MIN_RECS > total)
+		threads = (u_int32)(total / MIN_RECS);
+	if (threads == 0)
+		threads = 1;
+
+	start = TimeUs();
+	for (i = 0; i < threads; i++) {
+		AN_PART *p = &G_part[i];
+
+		p->from = total * i / threads;
+		p->to   = total * (i + 1) / threads;
+		if ((p->ch = calloc(Z146_CAP_CH_MAX, sizeof(AN_CHAN))) == NULL) {
+			printf("*** can't allocate results\n");
+			goto CLEANUP;
+		}
+		if ((errno = pthread_create(&p->thread, NULL, Worker, p)) != 0) {
+			printf("*** can't create thread: %s\n", strerror(errno));
+			goto CLEANUP;
+		}
+		G_partNum++;
+	}
+
+	ret = 0;
+	for (i = 0; i < G_partNum; i++) {
+		pthread_join(G_part[i].thread, NULL);
+		if (G_part[i].error) {
+			printf("*** can't read %s: %s\n", G_part[i].errFile,
+				   G_part[i].error == EINVAL ? "invalid file" :
+				   strerror(G_part[i].error));
+			ret = 1;
+		}
+	}
+	G_partNum = 0;
+	if (ret)
+		goto CLEANUP;
+
+	/* in file order */
+	for (i = 1; i < threads; i++)
+		Merge(G_part[0].ch, G_part[i].ch);
+	us = TimeUs() - start;
+
+	Print();
+	printf("%llu records, %u thread(s), %llu.%03llu s, %llu MB/s\n",
+		   (unsigned long long)total, (unsigned)threads,
+		   (unsigned long long)(us / 1000000),
+		   (unsigned long long)(us % 1000000 / 1000),
+		   (unsigned long long)(us ? total * sizeof(Z146_CAP_REC) / us : 0));
+
+CLEANUP:
+	for (i = 0; i < G_partNum; i++)
+		pthread_join(G_part[i].thread, NULL);
+	for (i = 0; i < threads; i++)
+		free(G_part[i].ch);
+	return(ret);
+}
+
+/********************************* Worker **********************************/
+/** Thread, analyzes one range of records
+ *
+ *  \param arg        \IN  AN_PART
+ *
+ *  \return	          NULL
+ */
+static void *Worker(void *arg)
+{
+	AN_PART *p = (AN_PART*)arg;
+	Z146_CAP_FILE cf;
+	Z146_CAP_REC *rec = NULL;
+	u_int64 base = 0;
+	u_int64 pos = p->from;
+	u_int64 left = 0;
+	u_int32 f = 0;
+	int32 n = 0;
+	int32 i = 0;
+
+	if ((rec = malloc(READ_RECS * sizeof(Z146_CAP_REC))) == NULL) {
+		p->error = ENOMEM;
+		p->errFile = G_file[0];
+		return NULL;
+	}
+
+	for (f = 0; f < G_fileNum && pos < p->to; base += G_fileRecs[f++]) {
+		if (pos >= base + G_fileRecs[f])
+			continue;
+		if (Z146_CapOpen(&cf, G_file[f]) < 0 ||
+			Z146_CapSeek(&cf, pos - base) < 0) {
+			p->error = errno;
+			p->errFile = G_file[f];
+			break;
+		}
+		left = ((p->to < base + G_fileRecs[f]) ? p->to : base + G_fileRecs[f]) - pos;
+		while (left) {
+			n = Z146_CapRead(&cf, rec, (left < READ_RECS) ? (u_int32)left : READ_RECS);
+			if (n <= 0) {
+				p->error = n ? errno : EINVAL;
+				p->errFile = G_file[f];
+				break;
+			}
+			for (i = 0; i < n; i++)
+				Record(p->ch, &rec[i]);
+			left -= n;
+			pos += n;
+		}
+		Z146_CapClose(&cf);
+		if (p->error)
+			break;
+	}
+	free(rec);
+	return NULL;
+}
+
+/********************************* Record **********************************/
+/** Add a record to the results
+ *
+ *  \param ch         \IN  results of the channels
+ *  \param r          \IN  record
+ */
+static void Record(AN_CHAN *ch, const Z146_CAP_REC *r)
+{
+	AN_LABEL *l = NULL;
+	u_int32 w = r->word;
+	u_int32 raw = 0;
+	u_int32 ones = 0;
+	int32 bnr = 0;
+
+	if (r->chan >= G_hdr.chNum)
+		return;
+	if (r->flags & Z146_CAP_F_LOSS) {
+		if (r->flags & Z146_CAP_F_LOSS_DRV)
+			ch[r->chan].loss[0] += r->word;
+		else if (r->flags & Z146_CAP_F_LOSS_LINE)
+			ch[r->chan].loss[1] += r->word;
+		else
+			ch[r->chan].loss[2] += r->word;
+		return;
+	}
+	ch[r->chan].words++;
+	l = &ch[r->chan].lab[w & 0xFF];
+
+	if (l->words == 0) {
+		l->tFirst = r->timeUs;
+		l->ivMin  = ~(u_int64)0;
+		l->rawMin = 0xFFFFFFFF;
+		l->bnrMin = 0x7FFFFFFF;
+		l->bnrMax = -0x7FFFFFFF - 1;
+	}
+	else
+		Interval(l, (r->timeUs > l->tLast) ? r->timeUs - l->tLast : 0, r->timeUs);
+	l->tLast = r->timeUs;
+	l->words++;
+
+	l->ssm[(w >> 29) & 3]++;
+	if (G_chPar[r->chan] >= 0) {
+		/* number of ones, odd parity: odd */
+		for (ones = 0, raw = w; raw; raw &= raw - 1)
+			ones++;
+		if ((ones & 1) != (u_int32)G_chPar[r->chan])
+			l->parErr++;
+	}
+
+	raw = (w >> 10) & 0x7FFFF;
+	bnr = (raw & 0x40000) ? (int32)raw - 0x80000 : (int32)raw;
+	if (raw < l->rawMin)
+		l->rawMin = raw;
+	if (raw > l->rawMax)
+		l->rawMax = raw;
+	if (bnr < l->bnrMin)
+		l->bnrMin = bnr;
+	if (bnr > l->bnrMax)
+		l->bnrMax = bnr;
+}
+
+/********************************* Interval ********************************/
+/** Add an interval between two words of a label
+ *
+ *  \param l          \IN  label
+ *  \param dt         \IN  interval [us]
+ *  \param t          \IN  time of the second word
+ */
+static void Interval(AN_LABEL *l, u_int64 dt, u_int64 t)
+{
+	l->ivNum++;
+	l->ivSum += (double)dt;
+	l->ivSq  += (double)dt * (double)dt;
+	if (dt < l->ivMin)
+		l->ivMin = dt;
+	if (dt > l->ivMax) {
+		l->ivMax = dt;
+		l->ivMaxAt = t;
+	}
+	if (G_gapUs && dt > G_gapUs)
+		l->gaps++;
+	l->hist[HistBin(dt)]++;
+}
+
+/********************************* Merge ***********************************/
+/** Add the results of the following range
+ *
+ *  \param acc        \IN  results up to the range, \OUT incl. the range
+ *  \param part       \IN  results of the range
+ */
+static void Merge(AN_CHAN *acc, AN_CHAN *part)
+{
+	AN_LABEL *a = NULL;
+	AN_LABEL *p = NULL;
+	u_int32 c = 0;
+	u_int32 k = 0;
+	u_int32 i = 0;
+
+	for (c = 0; c < G_hdr.chNum; c++) {
+		acc[c].words += part[c].words;
+		for (k = 0; k < 3; k++)
+			acc[c].loss[k] += part[c].loss[k];
+
+		for (k = 0; k < 256; k++) {
+			a = &acc[c].lab[k];
+			p = &part[c].lab[k];
+			if (p->words == 0)
+				continue;
+			if (a->words == 0) {
+				*a = *p;
+				continue;
+			}
+
+			/* interval across the boundary of the ranges */
+			Interval(a, (p->tFirst > a->tLast) ? p->tFirst - a->tLast : 0,
+					 p->tFirst);
+			a->ivNum += p->ivNum;
+			a->ivSum += p->ivSum;
+			a->ivSq  += p->ivSq;
+			if (p->ivNum && p->ivMin < a->ivMin)
+				a->ivMin = p->ivMin;
+			if (p->ivMax > a->ivMax) {
+				a->ivMax = p->ivMax;
+				a->ivMaxAt = p->ivMaxAt;
+			}
+			a->gaps   += p->gaps;
+			a->parErr += p->parErr;
+			a->words  += p->words;
+			a->tLast   = p->tLast;
+			a->rawMin  = (p->rawMin < a->rawMin) ? p->rawMin : a->rawMin;
+			a->rawMax  = (p->rawMax > a->rawMax) ? p->rawMax : a->rawMax;
+			a->bnrMin  = (p->bnrMin < a->bnrMin) ? p->bnrMin : a->bnrMin;
+			a->bnrMax  = (p->bnrMax > a->bnrMax) ? p->bnrMax : a->bnrMax;
+			for (i = 0; i < 4; i++)
+				a->ssm[i] += p->ssm[i];
+			for (i = 0; i < HIST_NUM; i++)
+				a->hist[i] += p->hist[i];
+		}
+	}
+}
+
+/********************************* AutoGaps ********************************/
+/** Count the intervals longer than GAP_AUTO times the mean interval
+ *
+ *  \param l          \IN  label
+ *
+ *  \return	          intervals in the histogram bins starting at or above
+ *                    the limit
+ */
+static u_int64 AutoGaps(AN_LABEL *l)
+{
+	u_int64 limit = 0;
+	u_int64 gaps = 0;
+	u_int32 k = 0;
+
+	if (l->ivNum == 0)
+		return 0;
+	limit = (u_int64)(GAP_AUTO * l->ivSum / l->ivNum);
+	for (k = 0; k < HIST_NUM; k++)
+		if (HistLow(k) >= limit)
+			gaps += l->hist[k];
+	return gaps;
+}
+
+/********************************* HistBin *********************************/
+/** Histogram bin of an interval, four bins per octave
+ *
+ *  \param dt         \IN  interval [us]
+ *
+ *  \return	          bin
+ */
+static u_int32 HistBin(u_int64 dt)
+{
+	u_int32 oct = 0;
+
+	if (dt < 4)
+		return (u_int32)dt;
+	for (oct = 2; oct < 63 && (dt >> (oct + 1)); oct++)
+		;
+	oct = oct * 4 + (u_int32)((dt >> (oct - 2)) & 3);
+	return (oct < HIST_NUM) ? oct : HIST_NUM - 1;
+}
+
+/********************************* HistLow *********************************/
+/** Lower limit of a histogram bin
+ *
+ *  \param bin        \IN  bin
+ *
+ *  \return	          interval [us]
+ */
+static u_int64 HistLow(u_int32 bin)
+{
+	if (bin < 4)
+		return bin;
+	return (u_int64)(4 + bin % 4) << (bin / 4 - 2);
+}
+
+/********************************* Print ***********************************/
+/** Print the merged results
+ */
+static void Print(void)
+{
+	AN_CHAN *ch = G_part[0].ch;
+	static const char *parName[3] = { "none", "even", "odd" };
+	AN_LABEL *l = NULL;
+	const char *par = NULL;
+	double mean = 0;
+	double jitter = 0;
+	double s = 0;
+	u_int32 c = 0;
+	u_int32 k = 0;
+
+	for (c = 0; c < G_hdr.chNum; c++) {
+		par = ((G_hdr.parEn >> c) & 1) ? "receiver" : parName[G_chPar[c] + 1];
+		printf("ch %lu %s at %s kHz, parity %s: %llu words, lost driver %llu "
+			   "line %llu capture %llu\n", (unsigned long)c, G_hdr.chName[c],
+			   (G_hdr.speed >> c) & 1 ? "100" : "12.5", par,
+			   (unsigned long long)ch[c].words,
+			   (unsigned long long)ch[c].loss[0],
+			   (unsigned long long)ch[c].loss[1],
+			   (unsigned long long)ch[c].loss[2]);
+		if (ch[c].words == 0)
+			continue;
+		printf("ch label     words   rate/s  mean ms   min ms   max ms "
+			   "jitter ms  gaps  ssm0/1/2/3  parErr  raw min..max  "
+			   "bnr min..max\n");
+
+		for (k = 0; k < 256; k++) {
+			l = &ch[c].lab[k];
+			if (l->words == 0)
+				continue;
+			s = (double)(l->tLast - l->tFirst) / 1e6;
+			mean = l->ivNum ? l->ivSum / l->ivNum : 0;
+			jitter = l->ivNum ? l->ivSq / l->ivNum - mean * mean : 0;
+			jitter = (jitter > 0) ? sqrt(jitter) : 0;
+			printf("%2lu %04o %10llu %8.2f %8.3f %8.3f %8.3f %9.3f %5llu  "
+				   "%llu/%llu/%llu/%llu %7llu  %05lx..%05lx  %ld..%ld\n",
+				   (unsigned long)c, k, (unsigned long long)l->words,
+				   s > 0 ? (l->words - 1) / s : 0.0,
+				   mean / 1000, l->ivNum ? l->ivMin / 1000.0 : 0.0,
+				   l->ivMax / 1000.0, jitter / 1000,
+				   (unsigned long long)(G_gapUs ? l->gaps : AutoGaps(l)),
+				   (unsigned long long)l->ssm[0], (unsigned long long)l->ssm[1],
+				   (unsigned long long)l->ssm[2], (unsigned long long)l->ssm[3],
+				   (unsigned long long)l->parErr,
+				   (unsigned long)l->rawMin, (unsigned long)l->rawMax,
+				   (long)l->bnrMin, (long)l->bnrMax);
+		}
+	}
+}
+
+/********************************* TimeUs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [us]
+ */
+static u_int64 TimeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_analyze [<opts>] <capture> [<capture>...]\n");
+	printf("Function: per label statistics of a capture of z146_capture,\n");
+	printf("          the files of a split capture are given in order\n");
+	printf("Options:\n");
+	printf("    -j num     threads              (default: online CPUs)\n");
+	printf("    -g ms      count intervals above as gaps\n");
+	printf("               (default %.1f times the mean interval)\n", GAP_AUTO);
+	printf("    -p par     parity odd, even, none or auto   (default auto)\n");
+	printf("               auto: as configured in the receiver, channels\n");
+	printf("               with parity checking in the receiver are not\n");
+	printf("               checked with any -p\n");
+	printf("\n");
+}
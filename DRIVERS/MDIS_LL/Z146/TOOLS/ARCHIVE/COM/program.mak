@@ -0,0 +1,21 @@
+#***************************  M a k e f i l e  *******************************
+#
+#    Description: Makefile definitions for the Z146 capture archive tool
+#
+#---------------------------------[ History ]---------------------------------
+#
+#-----------------------------------------------------------------------------
+#   (c) Copyright 2000 by MEN mikro elektronik GmbH, Nuernberg, Germany
+#*****************************************************************************
+
+MAK_NAME=z146_archive
+
+MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/z146_cap$(LIB_SUFFIX)	\
+
+MAK_INCL=$(MEN_INC_DIR)/z146_cap.h	\
+         $(MEN_INC_DIR)/z146_arc.h	\
+         $(MEN_INC_DIR)/men_typs.h	\
+
+MAK_INP1=z146_archive$(INP_SUFFIX)
+
+MAK_INP=$(MAK_INP1)
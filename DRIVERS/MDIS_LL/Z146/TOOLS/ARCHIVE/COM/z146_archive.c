@@ -0,0 +1,412 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                    Z146_ARCHIVE                    ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_archive.c
+ *
+ *       \brief  Converts captures of z146_capture to indexed archives
+ *               (see z146_arc.h) and queries them
+ *
+ *               Convert: the capture files are read in order, e.g. all
+ *               files of a split capture, and stored in one archive.
+ *
+ *               Query (-q): prints the words of a channel and label in a
+ *               time range. Only the chunks of the series which overlap
+ *               the time range are read; the number of chunks read is
+ *               reported.
+ *
+ *               List (-i): prints the series of an archive with words,
+ *               chunks, bytes per word and time range.
+ *
+ *               Times are given in seconds since the start of the
+ *               capture.
+ *
+ *     Required: libraries: z146_cap
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <MEN/men_typs.h>
+#include <MEN/z146_cap.h>
+#include <MEN/z146_arc.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define READ_RECS		4096
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int Convert(char *arcName, char **capName, int capNum,
+				   u_int32 chunkWords);
+static int Query(char *arcName, int32 chan, int32 label, double fromS,
+				 double toS, int count);
+static int List(char *arcName);
+static u_int64 FileSize(char *name);
+static char *ErrString(void);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static Z146_CAP_REC G_rec[READ_RECS];
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	char *out = NULL;
+	char *end = NULL;
+	u_int32 chunkWords = 0;
+	int32 chan = Z146_ARC_ANY;
+	int32 label = Z146_ARC_ANY;
+	double fromS = 0;
+	double toS = -1;
+	int query = 0;
+	int list = 0;
+	int count = 0;
+	int error = 0;
+	int argi = 1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-q") == 0) {
+			query = 1;
+			continue;
+		}
+		if (strcmp(argv[argi], "-i") == 0) {
+			list = 1;
+			continue;
+		}
+		if (strcmp(argv[argi], "-n") == 0) {
+			count = 1;
+			continue;
+		}
+		if (strcmp(argv[argi], "-?") == 0 || argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 'o': out        = argv[argi];							break;
+		case 'w': chunkWords = strtoul(argv[argi], &end, 0);		break;
+		case 'c': chan       = (int32)strtoul(argv[argi], &end, 0);	break;
+		case 'l': label      = (int32)strtoul(argv[argi], &end, 0);	break;
+		case 'f': fromS      = strtod(argv[argi], &end);			break;
+		case 't': toS        = strtod(argv[argi], &end);			break;
+		default:
+			error = 1;
+		}
+		if (error || (end && *end)) {
+			Usage();
+			return(1);
+		}
+	}
+
+	if (query || list) {
+		if (argi + 1 != argc || (query && list) ||
+			(chan != Z146_ARC_ANY && chan >= Z146_CAP_CH_MAX) ||
+			(label != Z146_ARC_ANY && label >= Z146_ARC_LABELS)) {
+			Usage();
+			return(1);
+		}
+		if (list)
+			return List(argv[argi]);
+		return Query(argv[argi], chan, label, fromS, toS, count);
+	}
+
+	if (out == NULL || argi == argc) {
+		Usage();
+		return(1);
+	}
+	return Convert(out, &argv[argi], argc - argi, chunkWords);
+}
+
+/********************************* Convert *********************************/
+/** Store capture files in an archive
+ *
+ *  \param arcName    \IN  archive
+ *  \param capName    \IN  capture files
+ *  \param capNum     \IN  number of capture files
+ *  \param chunkWords \IN  max. words per chunk, 0 = default
+ *
+ *  \return	          success (0) or error (1)
+ */
+static int Convert(char *arcName, char **capName, int capNum,
+				   u_int32 chunkWords)
+{
+	Z146_CAP_FILE cf;
+	Z146_ARC_WRITER aw;
+	u_int64 capBytes = 0;
+	u_int64 arcBytes = 0;
+	u_int64 recs = 0;
+	int32 n = 0;
+	int32 i = 0;
+	int f = 0;
+
+	for (f = 0; f < capNum; f++) {
+		if (Z146_CapOpen(&cf, capName[f]) < 0) {
+			printf("*** can't open %s: %s\n", capName[f], ErrString());
+			if (f)
+				Z146_ArcFinish(&aw);
+			return(1);
+		}
+		if (f == 0) {
+			if (Z146_ArcCreate(&aw, arcName, &cf.hdr, chunkWords) < 0) {
+				printf("*** can't create %s: %s\n", arcName, ErrString());
+				Z146_CapClose(&cf);
+				return(1);
+			}
+		}
+		else if (cf.hdr.startUs != aw.hdr.startUs ||
+				 cf.hdr.chNum != aw.hdr.chNum) {
+			printf("*** %s is not part of the capture of %s\n", capName[f],
+				   capName[0]);
+			Z146_CapClose(&cf);
+			Z146_ArcFinish(&aw);
+			return(1);
+		}
+
+		while ((n = Z146_CapRead(&cf, G_rec, READ_RECS)) > 0) {
+			for (i = 0; i < n; i++) {
+				if (Z146_ArcPut(&aw, &G_rec[i]) < 0) {
+					printf("*** can't write %s: %s\n", arcName, ErrString());
+					Z146_CapClose(&cf);
+					Z146_ArcFinish(&aw);
+					return(1);
+				}
+			}
+			recs += n;
+		}
+		Z146_CapClose(&cf);
+		if (n < 0) {
+			printf("*** can't read %s: %s\n", capName[f], ErrString());
+			Z146_ArcFinish(&aw);
+			return(1);
+		}
+		capBytes += FileSize(capName[f]);
+	}
+
+	if (Z146_ArcFinish(&aw) < 0) {
+		printf("*** can't write %s: %s\n", arcName, ErrString());
+		return(1);
+	}
+	arcBytes = FileSize(arcName);
+	printf("%s: %llu records in %lu chunks, %llu bytes (%.2f bytes/record, "
+		   "%.1f%% of the capture)\n", arcName, (unsigned long long)recs,
+		   (unsigned long)aw.hdr.idxNum, (unsigned long long)arcBytes,
+		   recs ? (double)arcBytes / recs : 0.0,
+		   capBytes ? 100.0 * arcBytes / capBytes : 0.0);
+	return(0);
+}
+
+/********************************* Query ***********************************/
+/** Print the words of a query
+ *
+ *  \param arcName    \IN  archive
+ *  \param chan       \IN  channel or Z146_ARC_ANY
+ *  \param label      \IN  label or Z146_ARC_ANY
+ *  \param fromS      \IN  first time [s since capture start]
+ *  \param toS        \IN  last time, < 0 = end
+ *  \param count      \IN  print the number of words only
+ *
+ *  \return	          success (0) or error (1)
+ */
+static int Query(char *arcName, int32 chan, int32 label, double fromS,
+				 double toS, int count)
+{
+	static Z146_ARC_QUERY q;
+	Z146_ARC_FILE af;
+	Z146_CAP_REC *r = NULL;
+	u_int64 fromUs = 0;
+	u_int64 toUs = ~(u_int64)0;
+	u_int64 words = 0;
+	u_int64 lost = 0;
+	u_int64 t = 0;
+	u_int32 i = 0;
+	int32 n = 0;
+
+	if (Z146_ArcOpen(&af, arcName) < 0) {
+		printf("*** can't open %s: %s\n", arcName, ErrString());
+		return(1);
+	}
+	if (fromS > 0)
+		fromUs = af.hdr.startUs + (u_int64)(fromS * 1000000.0);
+	if (toS >= 0)
+		toUs = af.hdr.startUs + (u_int64)(toS * 1000000.0);
+
+	Z146_ArcQueryInit(&q, &af, chan, label, fromUs, toUs);
+	while ((n = Z146_ArcQueryRead(&q, G_rec, READ_RECS)) > 0) {
+		for (i = 0; i < (u_int32)n; i++) {
+			r = &G_rec[i];
+			if (r->flags & Z146_CAP_F_LOSS)
+				lost += r->word;
+			else
+				words++;
+			if (count)
+				continue;
+
+			t = r->timeUs - af.hdr.startUs;
+			if (r->flags & Z146_CAP_F_LOSS) {
+				printf("%llu.%06llu ch %u lost %lu (%s)\n",
+					   (unsigned long long)(t / 1000000),
+					   (unsigned long long)(t % 1000000), r->chan,
+					   (unsigned long)r->word,
+					   (r->flags & Z146_CAP_F_LOSS_DRV) ? "driver" :
+					   (r->flags & Z146_CAP_F_LOSS_LINE) ? "line" : "capture");
+				continue;
+			}
+			printf("%llu.%06llu ch %u label %04o data 0x%06lx ssm %lu sdi %lu\n",
+				   (unsigned long long)(t / 1000000),
+				   (unsigned long long)(t % 1000000), r->chan,
+				   (unsigned)(r->word & 0xFF),
+				   (unsigned long)((r->word >> 8) & 0x7FFFFF),
+				   (unsigned long)((r->word >> 29) & 3),
+				   (unsigned long)((r->word >> 8) & 3));
+		}
+	}
+	if (n < 0) {
+		printf("*** can't read %s: %s\n", arcName, ErrString());
+		Z146_ArcClose(&af);
+		return(1);
+	}
+
+	printf("%llu words, %llu lost, %lu of %lu chunks read\n",
+		   (unsigned long long)words, (unsigned long long)lost,
+		   (unsigned long)q.chunksRead, (unsigned long)af.hdr.idxNum);
+	Z146_ArcClose(&af);
+	return(0);
+}
+
+/********************************* List ************************************/
+/** Print the series of an archive
+ *
+ *  \param arcName    \IN  archive
+ *
+ *  \return	          success (0) or error (1)
+ */
+static int List(char *arcName)
+{
+	static const char *loss[3] = { "lost/drv", "lost/line", "lost/cap" };
+	Z146_ARC_FILE af;
+	Z146_ARC_IDX *e = NULL;
+	u_int64 words = 0;
+	u_int64 bytes = 0;
+	u_int64 t0 = 0;
+	u_int64 t1 = 0;
+	u_int32 chunks = 0;
+	u_int32 i = 0;
+	u_int32 ch = 0;
+	char lab[16];
+
+	if (Z146_ArcOpen(&af, arcName) < 0) {
+		printf("*** can't open %s: %s\n", arcName, ErrString());
+		return(1);
+	}
+	printf("%s: %lu channels, %llu records, %lu chunks of max. %lu words, "
+		   "%.3f..%.3f s\n", arcName, (unsigned long)af.hdr.chNum,
+		   (unsigned long long)af.hdr.words, (unsigned long)af.hdr.idxNum,
+		   (unsigned long)af.hdr.chunkWords,
+		   af.hdr.words ? (af.hdr.tFirst - af.hdr.startUs) / 1e6 : 0.0,
+		   af.hdr.words ? (af.hdr.tLast - af.hdr.startUs) / 1e6 : 0.0);
+	for (ch = 0; ch < af.hdr.chNum; ch++)
+		printf("ch %lu: %s at %s kHz\n", (unsigned long)ch, af.hdr.chName[ch],
+			   (af.hdr.speed >> ch) & 1 ? "100" : "12.5");
+	printf("ch label      words   chunks  bytes/word  first [s]   last [s]\n");
+
+	/* the index is sorted by channel, label and time */
+	for (i = 0; i < af.hdr.idxNum; i++) {
+		e = &af.idx[i];
+		if (chunks == 0)
+			t0 = e->tFirst;
+		words += e->words;
+		bytes += e->size;
+		t1 = e->tLast;
+		chunks++;
+		if (i + 1 < af.hdr.idxNum && af.idx[i + 1].chan == e->chan &&
+			af.idx[i + 1].label == e->label)
+			continue;
+
+		if (e->label < 0x100)
+			sprintf(lab, "%04o", e->label);
+		else
+			sprintf(lab, "%s", loss[e->label - Z146_ARC_LOSS_DRV]);
+		printf("%2u %-9s %9llu %8lu %11.2f %10.3f %10.3f\n", e->chan, lab,
+			   (unsigned long long)words, (unsigned long)chunks,
+			   words ? (double)bytes / words : 0.0,
+			   (t0 - af.hdr.startUs) / 1e6, (t1 - af.hdr.startUs) / 1e6);
+		words = bytes = 0;
+		chunks = 0;
+	}
+	Z146_ArcClose(&af);
+	return(0);
+}
+
+/********************************* FileSize ********************************/
+/** Get the size of a file
+ *
+ *  \param name       \IN  file name
+ *
+ *  \return	          size or 0
+ */
+static u_int64 FileSize(char *name)
+{
+	struct stat st;
+
+	if (stat(name, &st) < 0)
+		return 0;
+	return (u_int64)st.st_size;
+}
+
+/********************************* ErrString *******************************/
+/** Get the message of errno
+ *
+ *  \return	          message
+ */
+static char *ErrString(void)
+{
+	return (errno == EINVAL) ? "invalid file" : strerror(errno);
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_archive [-w words] -o <archive> <capture> [<capture>...]\n");
+	printf("        z146_archive -q [<opts>] <archive>\n");
+	printf("        z146_archive -i <archive>\n");
+	printf("Function: convert captures of z146_capture to an indexed archive,\n");
+	printf("          query or list the archive\n");
+	printf("Options:\n");
+	printf("    -o file    archive to create from the capture files\n");
+	printf("    -w words   max. words per chunk             (default %d)\n",
+		   Z146_ARC_CHUNK_WORDS);
+	printf("    -q         print the words of a query:\n");
+	printf("    -c ch      channel                          (default all)\n");
+	printf("    -l label   label, octal with leading 0, 0x100..0x102 =\n");
+	printf("               losses driver/line/capture       (default all)\n");
+	printf("    -f s       from time since capture start    (default start)\n");
+	printf("    -t s       to time since capture start      (default end)\n");
+	printf("    -n         print the number of words only\n");
+	printf("    -i         list the series of the archive\n");
+	printf("\n");
+}
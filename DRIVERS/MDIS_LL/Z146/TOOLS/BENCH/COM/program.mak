@@ -0,0 +1,26 @@
+#***************************  M a k e f i l e  *******************************
+#
+#    Description: Makefile definitions for the Z146 throughput benchmark
+#
+#---------------------------------[ History ]---------------------------------
+#
+#-----------------------------------------------------------------------------
+#   (c) Copyright 2000 by MEN mikro elektronik GmbH, Nuernberg, Germany
+#*****************************************************************************
+
+MAK_NAME=z146_bench
+
+MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)	\
+			$(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)	\
+
+MAK_INCL=$(MEN_INC_DIR)/z146_drv.h	\
+         $(MEN_INC_DIR)/z246_drv.h	\
+         $(MEN_INC_DIR)/z146_regs.h	\
+         $(MEN_INC_DIR)/men_typs.h	\
+         $(MEN_INC_DIR)/mdis_api.h	\
+         $(MEN_INC_DIR)/mdis_err.h	\
+         $(MEN_INC_DIR)/usr_oss.h	\
+
+MAK_INP1=z146_bench$(INP_SUFFIX)
+
+MAK_INP=$(MAK_INP1)
@@ -0,0 +1,509 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                      Z146_BENCH                    ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_bench.c
+ *
+ *       \brief  Throughput benchmark of the Z146/Z246 drivers
+ *
+ *               Sends a continuous sequence of words on the transmitter
+ *               and reads it from the receiver for each combination of
+ *               speed, M_setblock() burst size, M_getblock() buffer size,
+ *               RX and TX FIFO threshold and RX interrupt or polled mode.
+ *               The receiver must get the transmitter data (wired or TX
+ *               loop mode). One CSV line is printed per combination, so
+ *               runs of different driver versions can be compared.
+ *
+ *               CSV columns:
+ *               - tag: text of option -n
+ *               - speed: 0 = 12.5 kHz, 1 = 100 kHz
+ *               - burst: words per M_setblock()
+ *               - bufWords: M_getblock() buffer size in words
+ *               - rxThr, txThr: Z146_RX_THR_LEV, Z246_TX_THR_LEV
+ *               - mode: irq or poll (Z146_RX_RXC_IRQ_STAT)
+ *               - sent, received: words
+ *               - wordsPerSec: received words per second
+ *               - busUtil: bus utilization [permille]
+ *               - cpuNsPerWord: user and system CPU time per word [ns]
+ *               - lost: sent - received
+ *               - seqErrors: received words out of sequence
+ *               - txBusy: M_setblock() rejected with ERR_MBUF_OVERFLOW
+ *               - userBufErrors: M_getblock() rejected with ERR_MBUF_USERBUF
+ *               - txUnderruns, txIdleGaps: from Z246_BLK_TX_STATS
+ *               - rxDropped, rxRejected, rxLineErrWords: words lost in
+ *                 the receive ring buffer (drop old, reject new) and
+ *                 words discarded by line errors, from Z146_BLK_RX_STATS
+ *
+ *     Required: libraries: mdis_api, usr_oss
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z246_drv.h>
+#include <MEN/z146_regs.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_LIST		16			/* values per swept parameter */
+#define MAX_BUF_WORDS	16384		/* max. M_getblock() buffer size */
+#define MAX_BURST		4096		/* max. M_setblock() size */
+#define DATA_MASK		0x7FFFFF
+#define WORD_US(speed)	((speed) ? 360 : 2880)	/* incl. 4 bit gap */
+#define DRAIN_MS		500			/* max. wait for the last words */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** parameter list of the sweep */
+typedef struct {
+	u_int32 val[MAX_LIST];
+	u_int32 num;
+} LIST;
+
+/** result of one combination */
+typedef struct {
+	u_int32 sent;
+	u_int32 received;
+	u_int32 seqErrors;
+	u_int32 txBusy;
+	u_int32 userBufErrors;
+	u_int32 elapsedUs;
+	u_int32 cpuUs;
+	Z246_TX_STATS txStats;
+	Z146_RX_STATS rxStats;
+} RESULT;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int ListParse(char *str, LIST *list);
+static int32 RunPoint(MDIS_PATH rxPath, MDIS_PATH txPath, u_int32 burst,
+					  u_int32 bufWords, u_int32 durMs, RESULT *res);
+static int32 Receive(MDIS_PATH rxPath, u_int32 bufWords, u_int32 *expect,
+					 RESULT *res);
+static int32 TxStatsGet(MDIS_PATH txPath, Z246_TX_STATS *stats);
+static int32 RxStatsGet(MDIS_PATH rxPath, Z146_RX_STATS *stats);
+static u_int32 TimeUs(void);
+static u_int32 CpuUs(void);
+static void PrintError(char *info);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static u_int32 G_txBuf[MAX_BURST];
+static u_int32 G_rxBuf[MAX_BUF_WORDS];
+static u_int32 G_seq;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	MDIS_PATH rxPath = -1;
+	MDIS_PATH txPath = -1;
+	LIST speed  = { {0, 1}, 2 };
+	LIST burst  = { {1, 16, 64, 255}, 4 };
+	LIST bufW   = { {256, 4096}, 2 };
+	LIST rxThr  = { {Z146_RX_FCR_DEFAULT}, 1 };
+	LIST txThr  = { {Z246_TX_FCR_DEFAULT}, 1 };
+	LIST mode   = { {1, 0}, 2 };
+	RESULT res;
+	char *tag = "-";
+	u_int32 durMs = 2000;
+	u_int32 label = 1;
+	u_int32 s, b, u, r, x, m;
+	int32 error = 0;
+	int ret = 1;
+	int argi = 1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0 || argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 's': error = ListParse(argv[argi], &speed);	break;
+		case 'b': error = ListParse(argv[argi], &burst);	break;
+		case 'u': error = ListParse(argv[argi], &bufW);		break;
+		case 'r': error = ListParse(argv[argi], &rxThr);	break;
+		case 'x': error = ListParse(argv[argi], &txThr);	break;
+		case 't': durMs = strtoul(argv[argi], NULL, 0);		break;
+		case 'l': label = strtoul(argv[argi], NULL, 0);		break;
+		case 'n': tag = argv[argi];							break;
+		case 'm':
+			mode.num = 0;
+			if (strstr(argv[argi], "irq"))
+				mode.val[mode.num++] = 1;
+			if (strstr(argv[argi], "poll"))
+				mode.val[mode.num++] = 0;
+			error = (mode.num == 0);
+			break;
+		default:
+			error = 1;
+		}
+		if (error) {
+			Usage();
+			return(1);
+		}
+	}
+	if (argc != argi + 2) {
+		Usage();
+		return(1);
+	}
+	for (b = 0; b < burst.num; b++)
+		if (burst.val[b] == 0 || burst.val[b] > MAX_BURST) {
+			printf("*** burst must be 1..%d\n", MAX_BURST);
+			return(1);
+		}
+	for (u = 0; u < bufW.num; u++)
+		if (bufW.val[u] == 0 || bufW.val[u] > MAX_BUF_WORDS) {
+			printf("*** buffer size must be 1..%d words\n", MAX_BUF_WORDS);
+			return(1);
+		}
+
+	/*--------------------+
+	|  open               |
+	+--------------------*/
+	if ((rxPath = M_open(argv[argi])) < 0) {
+		PrintError("open");
+		return(1);
+	}
+	if ((txPath = M_open(argv[argi + 1])) < 0) {
+		PrintError("open");
+		M_close(rxPath);
+		return(1);
+	}
+	M_setstat(rxPath, Z146_RX_SET_LABEL, label);
+	M_setstat(txPath, Z246_TX_LABEL, label);
+
+	/*--------------------+
+	|  sweep              |
+	+--------------------*/
+	printf("tag,speed,burst,bufWords,rxThr,txThr,mode,sent,received,"
+		   "wordsPerSec,busUtil,cpuNsPerWord,lost,seqErrors,txBusy,"
+		   "userBufErrors,txUnderruns,txIdleGaps,rxDropped,rxRejected,"
+		   "rxLineErrWords\n");
+
+	for (s = 0; s < speed.num; s++)
+	for (r = 0; r < rxThr.num; r++)
+	for (x = 0; x < txThr.num; x++)
+	for (m = 0; m < mode.num; m++)
+	for (b = 0; b < burst.num; b++)
+	for (u = 0; u < bufW.num; u++) {
+		if (M_setstat(rxPath, Z146_RX_SPEED, speed.val[s]) < 0 ||
+			M_setstat(txPath, Z246_TX_SPEED, speed.val[s]) < 0 ||
+			M_setstat(rxPath, Z146_RX_THR_LEV, rxThr.val[r]) < 0 ||
+			M_setstat(txPath, Z246_TX_THR_LEV, txThr.val[x]) < 0 ||
+			M_setstat(rxPath, Z146_RX_RXC_IRQ_STAT, mode.val[m]) < 0) {
+			PrintError("setstat");
+			goto CLEANUP;
+		}
+		if (RunPoint(rxPath, txPath, burst.val[b], bufW.val[u], durMs,
+					 &res) < 0)
+			goto CLEANUP;
+
+		printf("%s,%lu,%lu,%lu,%lu,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,"
+			   "%lu,%lu,%lu,%lu,%lu\n",
+			   tag, (unsigned long)speed.val[s], (unsigned long)burst.val[b],
+			   (unsigned long)bufW.val[u], (unsigned long)rxThr.val[r],
+			   (unsigned long)txThr.val[x], mode.val[m] ? "irq" : "poll",
+			   (unsigned long)res.sent, (unsigned long)res.received,
+			   (unsigned long)(res.elapsedUs ?
+				   (u_int64)res.received * 1000000 / res.elapsedUs : 0),
+			   (unsigned long)(res.elapsedUs ? (u_int64)res.received *
+				   WORD_US(speed.val[s]) * 1000 / res.elapsedUs : 0),
+			   (unsigned long)(res.received ?
+				   (u_int64)res.cpuUs * 1000 / res.received : 0),
+			   (unsigned long)(res.sent - res.received),
+			   (unsigned long)res.seqErrors, (unsigned long)res.txBusy,
+			   (unsigned long)res.userBufErrors,
+			   (unsigned long)res.txStats.underruns,
+			   (unsigned long)res.txStats.idleGaps,
+			   (unsigned long)res.rxStats.ringDropped,
+			   (unsigned long)res.rxStats.ringRejected,
+			   (unsigned long)res.rxStats.lineErrWords);
+		fflush(stdout);
+	}
+	ret = 0;
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+CLEANUP:
+	/* leave the receiver in interrupt mode */
+	M_setstat(rxPath, Z146_RX_RXC_IRQ_STAT, 1);
+	if (M_close(rxPath) < 0)
+		PrintError("close");
+	if (M_close(txPath) < 0)
+		PrintError("close");
+	return(ret);
+}
+
+/********************************* RunPoint ********************************/
+/** Measure one combination
+ *
+ *  Sends bursts for \a durMs, then waits until the last word is received
+ *  or DRAIN_MS passed without a new word.
+ *
+ *  \param rxPath     \IN  receiver path
+ *  \param txPath     \IN  transmitter path
+ *  \param burst      \IN  words per M_setblock()
+ *  \param bufWords   \IN  M_getblock() buffer size in words
+ *  \param durMs      \IN  send duration [ms]
+ *  \param res        \OUT result
+ *
+ *  \return	          0 or -1 on error
+ */
+static int32 RunPoint(MDIS_PATH rxPath, MDIS_PATH txPath, u_int32 burst,
+					  u_int32 bufWords, u_int32 durMs, RESULT *res)
+{
+	u_int32 expect = 0;
+	u_int32 start = 0;
+	u_int32 last = 0;
+	u_int32 cpu = 0;
+	u_int32 i = 0;
+	int32 got = 0;
+	int32 rc = 0;
+	int progress = 0;
+
+	memset(res, 0, sizeof(*res));
+
+	/* discard old data, reset the statistics */
+	UOS_Delay(DRAIN_MS);
+	while ((got = M_getblock(rxPath, (u_int8*)G_rxBuf, sizeof(G_rxBuf))) > 0)
+		;
+	if (TxStatsGet(txPath, &res->txStats) < 0 ||
+		RxStatsGet(rxPath, &res->rxStats) < 0)
+		return -1;
+
+	expect = G_seq;
+	start = TimeUs();
+	last = start;
+	cpu = CpuUs();
+
+	while ((TimeUs() - start) < durMs * 1000) {
+		progress = 0;
+
+		for (i = 0; i < burst; i++)
+			G_txBuf[i] = (G_seq + i) & DATA_MASK;
+		rc = M_setblock(txPath, (u_int8*)G_txBuf, burst * 4);
+		if (rc > 0) {
+			G_seq += burst;
+			res->sent += burst;
+			progress = 1;
+		} else if (UOS_ErrnoGet() == ERR_MBUF_OVERFLOW) {
+			res->txBusy++;
+		} else {
+			PrintError("setblock");
+			return -1;
+		}
+
+		if ((got = Receive(rxPath, bufWords, &expect, res)) < 0)
+			return -1;
+		if (got > 0) {
+			last = TimeUs();
+			progress = 1;
+		}
+		if (!progress)
+			UOS_Delay(1);
+	}
+
+	/* receive the remaining words */
+	while (res->received < res->sent && (TimeUs() - last) < DRAIN_MS * 1000) {
+		if ((got = Receive(rxPath, bufWords, &expect, res)) < 0)
+			return -1;
+		if (got > 0)
+			last = TimeUs();
+		else
+			UOS_Delay(1);
+	}
+
+	res->elapsedUs = last - start;
+	res->cpuUs = CpuUs() - cpu;
+	if (RxStatsGet(rxPath, &res->rxStats) < 0)
+		return -1;
+	return TxStatsGet(txPath, &res->txStats);
+}
+
+/********************************* Receive *********************************/
+/** Read the received words and check the sequence
+ *
+ *  \param rxPath     \IN  receiver path
+ *  \param bufWords   \IN  buffer size in words
+ *  \param expect     \IN  expected data, \OUT next expected data
+ *  \param res        \OUT received words and errors are counted
+ *
+ *  \return	          number of words or -1 on error
+ */
+static int32 Receive(MDIS_PATH rxPath, u_int32 bufWords, u_int32 *expect,
+					 RESULT *res)
+{
+	u_int32 data = 0;
+	int32 got = 0;
+	int32 i = 0;
+
+	got = M_getblock(rxPath, (u_int8*)G_rxBuf, bufWords * 4);
+	if (got < 0) {
+		if (UOS_ErrnoGet() == ERR_MBUF_USERBUF) {
+			res->userBufErrors++;
+			return 0;
+		}
+		PrintError("getblock");
+		return -1;
+	}
+	for (i = 0; i < got / 4; i++) {
+		data = (G_rxBuf[i] >> 8) & DATA_MASK;
+		if (data != *expect)
+			res->seqErrors++;
+		*expect = (data + 1) & DATA_MASK;
+	}
+	res->received += got / 4;
+	return got / 4;
+}
+
+/********************************* TxStatsGet ******************************/
+/** Get and reset the transmitter statistics
+ *
+ *  \param txPath     \IN  transmitter path
+ *  \param stats      \OUT statistics
+ *
+ *  \return	          0 or -1 on error
+ */
+static int32 TxStatsGet(MDIS_PATH txPath, Z246_TX_STATS *stats)
+{
+	M_SG_BLOCK blk;
+
+	blk.size = sizeof(*stats);
+	blk.data = (void*)stats;
+	if (M_getstat(txPath, Z246_BLK_TX_STATS, (int32*)&blk) < 0) {
+		PrintError("getstat Z246_BLK_TX_STATS");
+		return -1;
+	}
+	return 0;
+}
+
+/********************************* RxStatsGet ******************************/
+/** Get and reset the receiver statistics
+ *
+ *  \param rxPath     \IN  receiver path
+ *  \param stats      \OUT statistics
+ *
+ *  \return	          0 or -1 on error
+ */
+static int32 RxStatsGet(MDIS_PATH rxPath, Z146_RX_STATS *stats)
+{
+	M_SG_BLOCK blk;
+
+	blk.size = sizeof(*stats);
+	blk.data = (void*)stats;
+	if (M_getstat(rxPath, Z146_BLK_RX_STATS, (int32*)&blk) < 0) {
+		PrintError("getstat Z146_BLK_RX_STATS");
+		return -1;
+	}
+	return 0;
+}
+
+/********************************* ListParse *******************************/
+/** Parse a comma separated list of numbers
+ *
+ *  \param str        \IN  list, e.g. "1,16,64"
+ *  \param list       \OUT values
+ *
+ *  \return	          0 or 1 on error
+ */
+static int ListParse(char *str, LIST *list)
+{
+	char *end = NULL;
+
+	list->num = 0;
+	while (*str && list->num < MAX_LIST) {
+		list->val[list->num++] = strtoul(str, &end, 0);
+		if (end == str)
+			return 1;
+		str = (*end == ',') ? end + 1 : end;
+	}
+	return (list->num == 0 || *str != '\0');
+}
+
+/********************************* TimeUs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [us]
+ */
+static u_int32 TimeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int32)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/********************************* CpuUs ***********************************/
+/** Get the user and system CPU time of the process
+ *
+ *  \return	          time [us]
+ */
+static u_int32 CpuUs(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+	return (u_int32)((ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+					 ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_bench [<opts>] <rxDevice> <txDevice>\n");
+	printf("Function: throughput benchmark of the Z146/Z246 drivers, one CSV\n");
+	printf("          line per combination of the swept parameters\n");
+	printf("Options (lists are comma separated):\n");
+	printf("    -s list    speeds, 0 = 12.5 kHz, 1 = 100 kHz   (default 0,1)\n");
+	printf("    -b list    words per M_setblock()             (default 1,16,64,255)\n");
+	printf("    -u list    M_getblock() buffer size in words  (default 256,4096)\n");
+	printf("    -r list    RX FIFO threshold levels 0..7      (default %d)\n",
+		   Z146_RX_FCR_DEFAULT);
+	printf("    -x list    TX FIFO threshold levels 0..7      (default %d)\n",
+		   Z246_TX_FCR_DEFAULT);
+	printf("    -m modes   irq, poll or irq,poll              (default irq,poll)\n");
+	printf("    -t ms      send duration per combination      (default 2000)\n");
+	printf("    -l label   label of the words                 (default 1)\n");
+	printf("    -n tag     text in the first column, e.g. the driver version\n");
+	printf("\n");
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ */
+static void PrintError(char *info)
+{
+	printf("*** can't %s: %s\n", info, M_errstring(UOS_ErrnoGet()));
+}
@@ -0,0 +1,768 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                    Z146_CAPTURE                    ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_capture.c
+ *
+ *       \brief  Records the traffic of several Z146 receivers to a binary
+ *               capture file (see z146_cap.h)
+ *
+ *               The main thread reads all receivers in a fixed interval
+ *               with M_getblock() into a write buffer. Full buffers are
+ *               written by a writer thread, so a slow disk never stalls
+ *               the reading and the driver buffer does not fill up. When
+ *               all write buffers are waiting for the disk, the words are
+ *               dropped and a Z146_CAP_F_LOSS_CAP record is stored as soon
+ *               as a buffer is free again.
+ *
+ *               After each read the receive statistics of the driver
+ *               (Z146_BLK_RX_STATS, in broadcast mode Z146_RX_OVERRUN) are
+ *               read. Words lost in the driver buffer or discarded with a
+ *               line error are stored as loss records behind the batch, so
+ *               every gap in the capture is marked with its cause. All
+ *               losses are reported periodically and at the end.
+ *
+ *               Unless -k is given the label filter of the receivers is
+ *               disabled (Z146_LAB_EN) to record all labels. The parity
+ *               configuration of the receivers (Z146_PAR_EN,
+ *               Z146_PAR_TYP) is stored in the header for z146_analyze.
+ *
+ *               The driver has no receive time per word, the times of
+ *               the words are estimated from the read time and flagged
+ *               with Z146_CAP_F_TIME_EST. The file is written little
+ *               endian (Z146_CapHdrLe(), Z146_CapRecLe()).
+ *
+ *     Required: libraries: mdis_api, usr_oss, pthread
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z146_cap.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define RX_BUF_WORDS	65536		/* max. RX_RING_SIZE */
+#define MAX_WBUF		16			/* write buffers */
+#define FLUSH_MS		1000		/* max. age of a buffer before it is written */
+#define WORD_US(speed)	((speed) ? 360 : 2880)	/* incl. 4 bit gap */
+#define NAME_LEN		512
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** write buffer */
+typedef struct {
+	Z146_CAP_REC	*rec;
+	u_int32			num;		/* records stored */
+	int				full;		/* handed to the writer */
+} WBUF;
+
+/** receiver */
+typedef struct {
+	char		*dev;
+	MDIS_PATH	path;
+	u_int32		wordUs;
+	u_int64		lastUs;		/* time of the last word */
+	int			bcast;		/* Z146_RX_OVERRUN supported */
+	u_int32		pend[3];	/* losses without record yet: driver, line, capture */
+	u_int64		words;		/* words captured */
+	u_int64		ivWords;
+	u_int64		lossDrv;	/* words lost in the driver */
+	u_int64		lossLine;	/* words discarded with line errors */
+	u_int64		lossCap;	/* words dropped by the capture */
+} CAP_CH;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int32 ChannelRead(u_int32 ch, u_int64 nowUs);
+static void RecPut(u_int32 ch, u_int64 timeUs, u_int32 word, u_int8 flags);
+static int BufGet(u_int64 timeUs, int wait);
+static void BufSubmit(void);
+static void *Writer(void *arg);
+static int FileNext(void);
+static int WrError(void);
+static void Report(char *what, u_int64 ms);
+static u_int64 TimeUs(void);
+static void SigHandler(int sig);
+static void PrintError(char *info, char *dev);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static CAP_CH G_ch[Z146_CAP_CH_MAX];
+static u_int32 G_chNum;
+static u_int32 G_rxBuf[RX_BUF_WORDS];
+
+/* write buffers, G_fill is used by the main thread, G_drain by the writer */
+static WBUF G_wbuf[MAX_WBUF];
+static u_int32 G_wbufNum = 2;
+static u_int32 G_wbufRecs;
+static u_int32 G_fill;
+static u_int32 G_drain;
+static u_int64 G_fillUs;		/* time the fill buffer got its first record */
+static int G_noBuf;				/* no free write buffer */
+static int G_done;				/* no more buffers for the writer */
+static pthread_mutex_t G_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t G_cond = PTHREAD_COND_INITIALIZER;
+
+/* output file, used by the writer thread; G_fileNo, G_wrError, G_written
+   and G_wrMaxMs are changed by the writer and read by the main thread
+   under G_lock */
+static char *G_outName;
+static int G_fd = -1;
+static u_int32 G_fileNo;
+static u_int64 G_fileBytes;
+static u_int64 G_fileMax;		/* 0 = no split */
+static Z146_CAP_HDR G_hdr;
+static int G_wrError;			/* errno of a failed write */
+static u_int64 G_written;		/* bytes written */
+static u_int32 G_wrMaxMs;		/* longest write */
+static u_int32 G_bufMaxUsed;	/* max. buffers waiting for the writer */
+
+static u_int64 G_startMono;
+static volatile int G_stop;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          0 = no loss, 1 = error, 2 = words lost
+ */
+int main(int argc, char *argv[])
+{
+	pthread_t writer;
+	struct timespec ts;
+	u_int32 durS = 0;
+	u_int32 repS = 10;
+	u_int32 pollMs = 5;
+	u_int32 bufKb = 4096;
+	u_int32 keep = 0;
+	u_int32 speed = 0;
+	u_int32 parEn = 0;
+	u_int32 parTyp = 0;
+	u_int32 i = 0;
+	u_int64 now = 0;
+	u_int64 ivStart = 0;
+	u_int64 lost = 0;
+	int32 got = 0;
+	int error = 0;
+	int ret = 1;
+	int started = 0;
+	int argi = 1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0) {
+			Usage();
+			return(1);
+		}
+		if (strcmp(argv[argi], "-k") == 0) {
+			keep = 1;
+			continue;
+		}
+		if (argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 'o': G_outName = argv[argi];								break;
+		case 't': durS     = strtoul(argv[argi], NULL, 0);				break;
+		case 'r': repS     = strtoul(argv[argi], NULL, 0);				break;
+		case 'i': pollMs   = strtoul(argv[argi], NULL, 0);				break;
+		case 'b': bufKb    = strtoul(argv[argi], NULL, 0);				break;
+		case 'n': G_wbufNum = strtoul(argv[argi], NULL, 0);				break;
+		case 'm': G_fileMax = (u_int64)strtoul(argv[argi], NULL, 0) << 20;	break;
+		default:
+			error = 1;
+		}
+		if (error) {
+			Usage();
+			return(1);
+		}
+	}
+	for (; argi < argc && G_chNum < Z146_CAP_CH_MAX; argi++) {
+		G_ch[G_chNum].dev  = argv[argi];
+		G_ch[G_chNum].path = -1;
+		G_chNum++;
+	}
+	if (G_outName == NULL || G_chNum == 0 || argi != argc || repS == 0 ||
+		pollMs == 0 || G_wbufNum < 2 || G_wbufNum > MAX_WBUF || bufKb < 64) {
+		Usage();
+		return(1);
+	}
+
+	G_wbufRecs = (bufKb << 10) / sizeof(Z146_CAP_REC);
+	for (i = 0; i < G_wbufNum; i++) {
+		if ((G_wbuf[i].rec = malloc(G_wbufRecs * sizeof(Z146_CAP_REC))) == NULL) {
+			printf("*** can't allocate write buffers\n");
+			goto CLEANUP;
+		}
+	}
+
+	/*--------------------+
+	|  open, configure    |
+	+--------------------*/
+	Z146_CapHdrInit(&G_hdr);
+	G_hdr.chNum = (u_int16)G_chNum;
+	for (i = 0; i < G_chNum; i++) {
+		CAP_CH *ch = &G_ch[i];
+
+		if ((ch->path = M_open(ch->dev)) < 0) {
+			PrintError("open", ch->dev);
+			goto CLEANUP;
+		}
+		if ((!keep && M_setstat(ch->path, Z146_LAB_EN, 0) < 0) ||
+			M_setstat(ch->path, Z146_RX_RXC_IRQ_STAT, 1) < 0 ||
+			M_getstat(ch->path, Z146_RX_SPEED, (int32*)&speed) < 0 ||
+			M_getstat(ch->path, Z146_PAR_EN, (int32*)&parEn) < 0 ||
+			M_getstat(ch->path, Z146_PAR_TYP, (int32*)&parTyp) < 0) {
+			PrintError("configure", ch->dev);
+			goto CLEANUP;
+		}
+		ch->wordUs = WORD_US(speed);
+		ch->bcast  = 1;
+		if (speed)
+			G_hdr.speed |= 1 << i;
+		if (parEn)
+			G_hdr.parEn |= 1 << i;
+		if (parTyp)
+			G_hdr.parTyp |= 1 << i;
+		strncpy(G_hdr.chName[i], ch->dev, Z146_CAP_NAME_LEN - 1);
+	}
+
+	/* discard old data, reset the driver counters */
+	for (i = 0; i < G_chNum; i++) {
+		while ((got = M_getblock(G_ch[i].path, (u_int8*)G_rxBuf,
+								 sizeof(G_rxBuf))) > 0)
+			;
+		if (ChannelRead(i, 0) < 0)
+			goto CLEANUP;
+		G_ch[i].words = G_ch[i].ivWords = G_ch[i].lastUs = 0;
+		G_ch[i].lossDrv = G_ch[i].lossLine = 0;
+	}
+	G_wbuf[0].num = 0;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	G_startMono = TimeUs();
+	G_hdr.startUs = (u_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	if (FileNext())
+		goto CLEANUP;
+
+	if ((errno = pthread_create(&writer, NULL, Writer, NULL)) != 0) {
+		printf("*** can't create writer thread: %s\n", strerror(errno));
+		goto CLEANUP;
+	}
+	started = 1;
+
+	signal(SIGINT, SigHandler);
+	signal(SIGTERM, SigHandler);
+
+	printf("capture: %lu receiver(s) to %s, %lu x %lu KB write buffers, "
+		   "poll %lu ms\n", (unsigned long)G_chNum, G_outName,
+		   (unsigned long)G_wbufNum, (unsigned long)bufKb,
+		   (unsigned long)pollMs);
+	fflush(stdout);
+
+	/*--------------------+
+	|  capture            |
+	+--------------------*/
+	ivStart = 0;
+	while (!G_stop && (durS == 0 || TimeUs() - G_startMono < (u_int64)durS * 1000000)) {
+		now = TimeUs() - G_startMono;
+		for (i = 0; i < G_chNum; i++) {
+			if (ChannelRead(i, now) < 0)
+				goto STOP;
+		}
+		if (G_wbuf[G_fill].num && now - G_fillUs >= FLUSH_MS * 1000)
+			BufSubmit();
+		if ((error = WrError()) != 0) {
+			printf("*** can't write %s: %s\n", G_outName, strerror(error));
+			goto STOP;
+		}
+		if (now - ivStart >= (u_int64)repS * 1000000) {
+			Report("interval", (now - ivStart) / 1000);
+			ivStart = now;
+		}
+		UOS_Delay(pollMs);
+	}
+	ret = 0;
+
+STOP:
+	/* store the pending losses, write the rest and let the writer finish */
+	BufGet(TimeUs() - G_startMono, 1);
+	BufSubmit();
+	pthread_mutex_lock(&G_lock);
+	G_done = 1;
+	pthread_cond_broadcast(&G_cond);
+	pthread_mutex_unlock(&G_lock);
+	pthread_join(writer, NULL);
+	started = 0;
+	if ((error = WrError()) != 0) {
+		printf("*** can't write %s: %s\n", G_outName, strerror(error));
+		ret = 1;
+	}
+
+	now = TimeUs() - G_startMono;
+	Report("total", now / 1000);
+	for (i = 0; i < G_chNum; i++)
+		lost += G_ch[i].lossDrv + G_ch[i].lossLine + G_ch[i].lossCap;
+	printf("capture: %llu words lost\n", (unsigned long long)lost);
+	if (ret == 0 && lost)
+		ret = 2;
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+CLEANUP:
+	if (started) {
+		pthread_mutex_lock(&G_lock);
+		G_done = 1;
+		pthread_cond_broadcast(&G_cond);
+		pthread_mutex_unlock(&G_lock);
+		pthread_join(writer, NULL);
+	}
+	if (G_fd >= 0)
+		close(G_fd);
+	for (i = 0; i < G_chNum; i++) {
+		if (G_ch[i].path >= 0 && M_close(G_ch[i].path) < 0)
+			PrintError("close", G_ch[i].dev);
+	}
+	for (i = 0; i < G_wbufNum; i++)
+		free(G_wbuf[i].rec);
+	return(ret);
+}
+
+/********************************* ChannelRead *****************************/
+/** Read the received words and the losses of a receiver
+ *
+ *  The driver has no receive time per word, so the words get the read
+ *  time minus the word time of the words behind them, but not before
+ *  the last word of the previous batch, and Z146_CAP_F_TIME_EST.
+ *
+ *  \param ch         \IN  channel
+ *  \param nowUs      \IN  read time [us since start]
+ *
+ *  \return	          words or -1 on error
+ */
+static int32 ChannelRead(u_int32 ch, u_int64 nowUs)
+{
+	CAP_CH *c = &G_ch[ch];
+	Z146_RX_STATS stats;
+	M_SG_BLOCK blk;
+	u_int64 t = 0;
+	int32 overrun = 0;
+	int32 got = 0;
+	int32 n = 0;
+	int32 i = 0;
+
+	if ((got = M_getblock(c->path, (u_int8*)G_rxBuf, sizeof(G_rxBuf))) < 0) {
+		PrintError("getblock", c->dev);
+		return -1;
+	}
+	n = got / 4;
+	for (i = 0; i < n; i++) {
+		t = nowUs - (u_int64)(n - 1 - i) * c->wordUs;
+		if (nowUs < (u_int64)(n - 1 - i) * c->wordUs || t <= c->lastUs)
+			t = c->lastUs + c->wordUs;
+		if (t > nowUs)
+			t = nowUs;
+		c->lastUs = t;
+		RecPut(ch, t, G_rxBuf[i],
+			   Z146_CAP_F_TIME_EST | (i ? 0 : Z146_CAP_F_BATCH));
+	}
+	c->words += n;
+	c->ivWords += n;
+
+	/* losses since the last read */
+	memset(&stats, 0, sizeof(stats));
+	blk.size = sizeof(stats);
+	blk.data = (void*)&stats;
+	if (M_getstat(c->path, Z146_BLK_RX_STATS, (int32*)&blk) < 0) {
+		PrintError("getstat Z146_BLK_RX_STATS", c->dev);
+		return -1;
+	}
+	if (c->bcast) {
+		if (M_getstat(c->path, Z146_RX_OVERRUN, &overrun) < 0)
+			c->bcast = 0;
+		else
+			stats.ringDropped += overrun;
+	}
+	if (stats.ringDropped + stats.ringRejected) {
+		c->lossDrv += stats.ringDropped + stats.ringRejected;
+		RecPut(ch, nowUs, stats.ringDropped + stats.ringRejected,
+			   Z146_CAP_F_LOSS_DRV);
+	}
+	if (stats.lineErrWords) {
+		c->lossLine += stats.lineErrWords;
+		RecPut(ch, nowUs, stats.lineErrWords, Z146_CAP_F_LOSS_LINE);
+	}
+	return n;
+}
+
+/********************************* RecPut **********************************/
+/** Store a record in the fill buffer
+ *
+ *  A full buffer is handed to the writer. Without a free buffer the
+ *  words are counted as capture loss of the channel and the losses are
+ *  stored when a buffer is free again.
+ *
+ *  \param ch         \IN  channel
+ *  \param timeUs     \IN  time [us since start]
+ *  \param word       \IN  received word or lost words
+ *  \param flags      \IN  Z146_CAP_F_xxx
+ */
+static void RecPut(u_int32 ch, u_int64 timeUs, u_int32 word, u_int8 flags)
+{
+	WBUF *b = NULL;
+	Z146_CAP_REC *r = NULL;
+
+	if (!BufGet(timeUs, 0)) {
+		if (flags & Z146_CAP_F_LOSS_DRV)
+			G_ch[ch].pend[0] += word;
+		else if (flags & Z146_CAP_F_LOSS_LINE)
+			G_ch[ch].pend[1] += word;
+		else {
+			G_ch[ch].pend[2]++;
+			G_ch[ch].lossCap++;
+		}
+		return;
+	}
+
+	b = &G_wbuf[G_fill];
+	if (b->num == 0)
+		G_fillUs = timeUs;
+	r = &b->rec[b->num++];
+	r->timeUs   = G_hdr.startUs + timeUs;
+	r->word     = word;
+	r->chan     = (u_int8)ch;
+	r->flags    = flags;
+	r->reserved = 0;
+
+	if (b->num == G_wbufRecs)
+		BufSubmit();
+}
+
+/********************************* BufGet **********************************/
+/** Check for a free fill buffer
+ *
+ *  When a buffer is free again after all buffers were full, the losses
+ *  of this time are stored first.
+ *
+ *  \param timeUs     \IN  time [us since start]
+ *  \param wait       \IN  wait until the writer frees a buffer
+ *
+ *  \return	          1 = buffer free, 0 = all buffers full
+ */
+static int BufGet(u_int64 timeUs, int wait)
+{
+	static const u_int8 flags[3] = {
+		Z146_CAP_F_LOSS_DRV, Z146_CAP_F_LOSS_LINE, Z146_CAP_F_LOSS_CAP };
+	WBUF *b = &G_wbuf[G_fill];
+	Z146_CAP_REC *r = NULL;
+	u_int32 i = 0;
+	u_int32 k = 0;
+
+	if (!G_noBuf)
+		return 1;
+
+	pthread_mutex_lock(&G_lock);
+	while (wait && b->full && !G_wrError)
+		pthread_cond_wait(&G_cond, &G_lock);
+	G_noBuf = b->full;
+	pthread_mutex_unlock(&G_lock);
+	if (G_noBuf)
+		return 0;
+
+	/* mark the gap, a buffer holds more than 3 records per channel */
+	b->num = 0;
+	G_fillUs = timeUs;
+	for (i = 0; i < G_chNum; i++) {
+		for (k = 0; k < 3; k++) {
+			if (G_ch[i].pend[k] == 0)
+				continue;
+			r = &b->rec[b->num++];
+			r->timeUs   = G_hdr.startUs + timeUs;
+			r->word     = G_ch[i].pend[k];
+			r->chan     = (u_int8)i;
+			r->flags    = flags[k];
+			r->reserved = 0;
+			G_ch[i].pend[k] = 0;
+		}
+	}
+	return 1;
+}
+
+/********************************* BufSubmit *******************************/
+/** Hand the fill buffer to the writer and switch to the next one
+ */
+static void BufSubmit(void)
+{
+	u_int32 used = 0;
+
+	if (G_noBuf || G_wbuf[G_fill].num == 0)
+		return;
+
+	pthread_mutex_lock(&G_lock);
+	G_wbuf[G_fill].full = 1;
+	G_fill = (G_fill + 1) % G_wbufNum;
+	G_noBuf = G_wbuf[G_fill].full;
+	used = (G_fill + G_wbufNum - G_drain) % G_wbufNum;
+	if (G_noBuf)
+		used = G_wbufNum;
+	if (used > G_bufMaxUsed)
+		G_bufMaxUsed = used;
+	pthread_cond_broadcast(&G_cond);
+	pthread_mutex_unlock(&G_lock);
+
+	if (!G_noBuf)
+		G_wbuf[G_fill].num = 0;
+}
+
+/********************************* Writer **********************************/
+/** Writer thread, writes the full buffers in order
+ *
+ *  The records are converted to the file byte order in the buffer, the
+ *  main thread fills it again after it is handed back.
+ *
+ *  \param arg        \IN  unused
+ *
+ *  \return	          NULL
+ */
+static void *Writer(void *arg)
+{
+	WBUF *b = NULL;
+	u_int64 t0 = 0;
+	u_int32 ms = 0;
+	int error = 0;
+	size_t len = 0;
+	size_t done = 0;
+	ssize_t rc = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&G_lock);
+		while (!G_wbuf[G_drain].full && !G_done)
+			pthread_cond_wait(&G_cond, &G_lock);
+		b = G_wbuf[G_drain].full ? &G_wbuf[G_drain] : NULL;
+		pthread_mutex_unlock(&G_lock);
+		if (b == NULL)
+			break;
+
+		/* G_wrError is only changed by this thread */
+		len = b->num * sizeof(Z146_CAP_REC);
+		error = G_wrError;
+		if (!error && G_fileMax &&
+			G_fileBytes + len > G_fileMax && G_fileBytes > sizeof(G_hdr)) {
+			pthread_mutex_lock(&G_lock);
+			G_fileNo++;
+			pthread_mutex_unlock(&G_lock);
+			if (FileNext())
+				error = errno ? errno : EIO;
+		}
+
+		Z146_CapRecLe(b->rec, b->num);
+		t0 = TimeUs();
+		for (done = 0; !error && done < len; done += rc) {
+			rc = write(G_fd, (u_int8*)b->rec + done, len - done);
+			if (rc < 0) {
+				if (errno == EINTR) {
+					rc = 0;
+					continue;
+				}
+				error = errno;
+			}
+		}
+		ms = (u_int32)((TimeUs() - t0) / 1000);
+		G_fileBytes += len;
+
+		pthread_mutex_lock(&G_lock);
+		G_wrError = error;
+		if (ms > G_wrMaxMs)
+			G_wrMaxMs = ms;
+		G_written += len;
+		b->full = 0;
+		G_drain = (G_drain + 1) % G_wbufNum;
+		pthread_cond_broadcast(&G_cond);
+		pthread_mutex_unlock(&G_lock);
+	}
+	return NULL;
+}
+
+/********************************* FileNext ********************************/
+/** Open the next output file and write the header
+ *
+ *  Without split the file has the name of -o, otherwise the number of
+ *  the file is appended (".000", ".001", ...).
+ *
+ *  \return	          0 or 1 on error (see errno)
+ */
+static int FileNext(void)
+{
+	char name[NAME_LEN];
+	Z146_CAP_HDR hdr;
+
+	if (G_fd >= 0)
+		close(G_fd);
+	if (G_fileMax)
+		snprintf(name, sizeof(name), "%s.%03lu", G_outName,
+				 (unsigned long)G_fileNo);
+	else
+		snprintf(name, sizeof(name), "%s", G_outName);
+
+	if ((G_fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+		printf("*** can't create %s: %s\n", name, strerror(errno));
+		return 1;
+	}
+	G_hdr.fileNo = G_fileNo;
+	hdr = G_hdr;
+	Z146_CapHdrLe(&hdr);
+	if (write(G_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+		printf("*** can't write %s: %s\n", name, strerror(errno));
+		return 1;
+	}
+	G_fileBytes = sizeof(G_hdr);
+	pthread_mutex_lock(&G_lock);
+	G_written += sizeof(G_hdr);
+	pthread_mutex_unlock(&G_lock);
+	return 0;
+}
+
+/********************************* WrError *********************************/
+/** Get the error of the writer thread
+ *
+ *  \return	          errno of a failed write or 0
+ */
+static int WrError(void)
+{
+	int error = 0;
+
+	pthread_mutex_lock(&G_lock);
+	error = G_wrError;
+	pthread_mutex_unlock(&G_lock);
+	return error;
+}
+
+/********************************* Report **********************************/
+/** Print the captured words and losses of all channels
+ *
+ *  \param what       \IN  "interval" or "total"
+ *  \param ms         \IN  duration of the interval or the capture [ms]
+ */
+static void Report(char *what, u_int64 ms)
+{
+	u_int64 t = (TimeUs() - G_startMono) / 1000000;
+	u_int64 words = 0;
+	u_int64 written = 0;
+	u_int32 fileNo = 0;
+	u_int32 wrMaxMs = 0;
+	u_int32 bufMaxUsed = 0;
+	CAP_CH *c = NULL;
+	u_int32 i = 0;
+	int total = (strcmp(what, "total") == 0);
+
+	if (ms == 0)
+		ms = 1;
+	for (i = 0; i < G_chNum; i++) {
+		c = &G_ch[i];
+		words = total ? c->words : c->ivWords;
+		printf("t=%llus %s ch %lu %s: words %llu rate %llu/s | lost driver %llu "
+			   "line %llu capture %llu\n",
+			   (unsigned long long)t, what, (unsigned long)i, c->dev,
+			   (unsigned long long)words,
+			   (unsigned long long)(words * 1000 / ms),
+			   (unsigned long long)c->lossDrv, (unsigned long long)c->lossLine,
+			   (unsigned long long)c->lossCap);
+		c->ivWords = 0;
+	}
+
+	pthread_mutex_lock(&G_lock);
+	written    = G_written;
+	fileNo     = G_fileNo;
+	wrMaxMs    = G_wrMaxMs;
+	bufMaxUsed = G_bufMaxUsed;
+	pthread_mutex_unlock(&G_lock);
+	printf("t=%llus %s writer: %llu MB in %lu file(s), max. write %lu ms, "
+		   "max. %lu of %lu buffers used\n",
+		   (unsigned long long)t, what,
+		   (unsigned long long)(written >> 20), (unsigned long)fileNo + 1,
+		   (unsigned long)wrMaxMs, (unsigned long)bufMaxUsed,
+		   (unsigned long)G_wbufNum);
+	fflush(stdout);
+}
+
+/********************************* TimeUs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [us]
+ */
+static u_int64 TimeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/********************************* SigHandler ******************************/
+/** Stop the capture on SIGINT/SIGTERM
+ */
+static void SigHandler(int sig)
+{
+	G_stop = 1;
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_capture [<opts>] -o <file> <rxDevice> [<rxDevice>...]\n");
+	printf("Function: record the traffic of up to %d receivers to a capture file\n",
+		   Z146_CAP_CH_MAX);
+	printf("Options:\n");
+	printf("    -o file    capture file\n");
+	printf("    -t s       duration, 0 = until Ctrl-C       (default 0)\n");
+	printf("    -r s       report interval                  (default 10)\n");
+	printf("    -i ms      read interval                    (default 5)\n");
+	printf("    -b KB      size of a write buffer           (default 4096)\n");
+	printf("    -n num     write buffers 2..%d              (default 2)\n",
+		   MAX_WBUF);
+	printf("    -m MB      split into files of this size, <file>.000, ...\n");
+	printf("    -k         keep the label filter of the receivers\n");
+	printf("Exit code: 0 = no loss, 1 = error, 2 = words lost\n");
+	printf("\n");
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ *  \param dev        \IN  device name
+ */
+static void PrintError(char *info, char *dev)
+{
+	printf("*** can't %s %s: %s\n", info, dev, M_errstring(UOS_ErrnoGet()));
+}
@@ -0,0 +1,863 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                       Z146_GEN                     ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_gen.c
+ *
+ *       \brief  Synthetic ARINC 429 traffic generator for the Z246 driver
+ *
+ *               Sends the labels of a traffic profile at their rates with
+ *               BNR, BCD or discrete payloads, SSM patterns and bursty
+ *               producers, and reports the achieved rate and the schedule
+ *               lag of every label.
+ *
+ *               Profile, one label per line, '#' starts a comment:
+ *
+ *               <tx> <label> <rate> <type> [<key>=<value> ...]
+ *
+ *               - tx: index of the transmitter on the command line
+ *               - label: 0..0377, octal with leading 0 (e.g. 0205)
+ *               - rate: words per second, 0 = as fast as possible (only
+ *                 for the single label of a transmitter, rejected
+ *                 otherwise)
+ *               - type: bnr, bcd or disc
+ *
+ *               Keys (all types):
+ *               - ssm=<s>[,<s>...]: SSM pattern, one value per word, cycled
+ *                 (default bnr 3, bcd 0 or 3 for negative values, disc 0)
+ *               - sdi=<0..3>: SDI bits (default 0)
+ *               - burst=<n>: the producer releases n words at once every
+ *                 n/rate seconds (default 1)
+ *
+ *               Keys of bnr and bcd, the value is a triangle between min
+ *               and max with the period in seconds (default 0 = constant
+ *               min):
+ *               - min=<v>, max=<v>, period=<s>
+ *               - bnr only: bits=<2..19> significant bits incl. sign
+ *                 (default 18), range=<r> full scale (default 1024)
+ *
+ *               Keys of disc:
+ *               - value=<v>: 19 bit pattern (default 0)
+ *               - pattern=fixed|walk|count: fixed value, walking one or
+ *                 counter (default fixed)
+ *
+ *               Example:
+ *
+ *               0 0205 50  bnr  bits=18 range=4096 min=-1000 max=1000 period=20
+ *               0 0310 25  bcd  min=0 max=9999 period=60 ssm=0,0,0,1
+ *               1 0270 100 disc value=0x5 pattern=walk burst=4
+ *
+ *               The 23 bit data field carries ARINC bits 9..31: SDI, data
+ *               bits 11..29 and SSM. The transmitters are set to odd
+ *               parity without hardware SDI.
+ *
+ *               The 16Z246 has one label register which is used when a
+ *               word is sent. A transmitter with one label in the profile
+ *               is fed continuously and reaches 100% bus utilization. The
+ *               labels of a transmitter with several labels are sent in
+ *               runs: the most overdue label gets all its due words, the
+ *               next label is set when Z246_TX_LEVEL reports that the run
+ *               has left the driver queue and the FIFO. Each label change
+ *               costs bus time, so assign high rate labels to transmitters
+ *               of their own.
+ *
+ *               Reported per transmitter: words queued in the driver, rate
+ *               and bus utilization of the words written to the FIFO
+ *               (Z246_BLK_TX_STATS), label changes and FIFO idle gaps.
+ *               Per label: target and achieved rate and the maximum lag
+ *               of a release behind its due time.
+ *
+ *     Required: libraries: mdis_api, usr_oss
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z246_drv.h>
+#include <MEN/z146_regs.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_TX			4
+#define MAX_LABELS		512			/* profile entries */
+#define MAX_SSM			16			/* length of an SSM pattern */
+#define MAX_RUN			Z246_TX_FIFO_MAX
+#define LINE_LEN		256
+#define WORD_US(speed)	((speed) ? 360 : 2880)	/* incl. 4 bit gap */
+
+#define TYPE_BNR		0
+#define TYPE_BCD		1
+#define TYPE_DISC		2
+
+#define DISC_FIXED		0
+#define DISC_WALK		1
+#define DISC_COUNT		2
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** profile entry and its state */
+typedef struct {
+	u_int32	tx;				/* transmitter index */
+	u_int8	label;
+	double	rate;			/* words/s, 0 = as fast as possible */
+	u_int32	lineNo;			/* profile line */
+	u_int32	type;			/* TYPE_xxx */
+	u_int32	burst;			/* words per release */
+	u_int32	sdi;
+	u_int32	ssm[MAX_SSM];
+	u_int32	ssmNum;			/* 0 = default of the type */
+	double	min;
+	double	max;
+	u_int32	periodS;
+	u_int32	bits;			/* bnr */
+	double	range;			/* bnr */
+	u_int32	value;			/* disc */
+	u_int32	pattern;		/* disc */
+	/* state */
+	u_int32	sent;			/* words sent */
+	u_int32	ivSent;			/* words sent in the report interval */
+	u_int32	maxLagUs;		/* max. time from due to release */
+	u_int32	ivMaxLagUs;
+} GEN_LABEL;
+
+/** transmitter */
+typedef struct {
+	char		*dev;
+	MDIS_PATH	path;
+	u_int32		lab[MAX_LABELS];	/* profile entries */
+	u_int32		labNum;
+	int32		curLabel;			/* label register, -1 = unknown */
+	u_int32		sent;
+	u_int32		ivSent;
+	u_int32		busy;				/* M_setblock() rejected */
+	u_int32		labelChanges;
+	u_int32		written;			/* words written to the FIFO */
+	u_int32		ivWritten;
+	u_int32		idleGaps;			/* FIFO ran empty while data was queued */
+} GEN_TX;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int ProfileRead(char *file);
+static int EntryParse(char *line, u_int32 lineNo);
+static int KeyParse(GEN_LABEL *l, char *key, char *val);
+static u_int32 Due(GEN_LABEL *l, u_int64 nowUs);
+static u_int64 DueUs(GEN_LABEL *l, u_int32 word);
+static int32 SendRun(GEN_TX *tx, GEN_LABEL *l, u_int32 num, u_int64 nowUs);
+static int32 TxService(GEN_TX *tx, u_int64 nowUs);
+static u_int32 WordData(GEN_LABEL *l, u_int64 tUs);
+static double Triangle(GEN_LABEL *l, u_int64 tUs);
+static void Report(char *what, int final);
+static void TxStatsGet(GEN_TX *tx);
+static u_int64 TimeUs(void);
+static void SigHandler(int sig);
+static void PrintError(char *info, char *dev);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static GEN_TX G_tx[MAX_TX];
+static GEN_LABEL G_lab[MAX_LABELS];
+static u_int32 G_txNum;
+static u_int32 G_labNum;
+static u_int32 G_wordUs;
+static u_int32 G_buf[MAX_RUN];
+static u_int64 G_start;
+static u_int64 G_ivStart;
+static volatile int G_stop;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	char *profile = NULL;
+	u_int32 durS = 60;
+	u_int32 repS = 10;
+	u_int32 speed = 1;
+	u_int32 i = 0;
+	u_int32 load = 0;
+	u_int64 now = 0;
+	int32 progress = 0;
+	int32 rc = 0;
+	int error = 0;
+	int ret = 1;
+	int argi = 1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0 || argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 'p': profile = argv[argi];						break;
+		case 't': durS  = strtoul(argv[argi], NULL, 0);		break;
+		case 'r': repS  = strtoul(argv[argi], NULL, 0);		break;
+		case 's': speed = strtoul(argv[argi], NULL, 0);		break;
+		default:
+			error = 1;
+		}
+		if (error) {
+			Usage();
+			return(1);
+		}
+	}
+	for (; argi < argc && G_txNum < MAX_TX; argi++) {
+		G_tx[G_txNum].dev  = argv[argi];
+		G_tx[G_txNum].path = -1;
+		G_txNum++;
+	}
+	if (profile == NULL || G_txNum == 0 || argi != argc || repS == 0) {
+		Usage();
+		return(1);
+	}
+	G_wordUs = WORD_US(speed);
+	if (ProfileRead(profile))
+		return(1);
+
+	/* requested bus load per transmitter */
+	for (i = 0; i < G_txNum; i++) {
+		double words = 0;
+		u_int32 j = 0;
+
+		for (j = 0; j < G_tx[i].labNum; j++)
+			words += G_lab[G_tx[i].lab[j]].rate;
+		load = (u_int32)(words * G_wordUs / 10000);
+		printf("tx %s: %lu labels, requested load %lu%%\n", G_tx[i].dev,
+			   (unsigned long)G_tx[i].labNum, (unsigned long)load);
+		if (load > 100)
+			printf("*** tx %s is oversubscribed, labels will lag\n",
+				   G_tx[i].dev);
+	}
+
+	/*--------------------+
+	|  open, configure    |
+	+--------------------*/
+	for (i = 0; i < G_txNum; i++) {
+		GEN_TX *tx = &G_tx[i];
+
+		if (tx->labNum == 0)
+			continue;
+		if ((tx->path = M_open(tx->dev)) < 0) {
+			PrintError("open", tx->dev);
+			goto CLEANUP;
+		}
+		if (M_setstat(tx->path, Z246_TX_SPEED, speed) < 0 ||
+			M_setstat(tx->path, Z246_PAR_EN, 1) < 0 ||
+			M_setstat(tx->path, Z246_PAR_TYPE, 0) < 0 ||
+			M_setstat(tx->path, Z246_SDI_EN, 0) < 0) {
+			PrintError("setstat", tx->dev);
+			goto CLEANUP;
+		}
+		tx->curLabel = -1;
+	}
+
+	signal(SIGINT, SigHandler);
+	signal(SIGTERM, SigHandler);
+
+	/*--------------------+
+	|  generate           |
+	+--------------------*/
+	G_start = TimeUs();
+	G_ivStart = G_start;
+	while (!G_stop && (durS == 0 || TimeUs() - G_start < (u_int64)durS * 1000000)) {
+		progress = 0;
+		now = TimeUs();
+		for (i = 0; i < G_txNum; i++) {
+			if (G_tx[i].labNum == 0)
+				continue;
+			if ((rc = TxService(&G_tx[i], now)) < 0)
+				goto CLEANUP;
+			progress |= rc;
+		}
+		if (now - G_ivStart >= (u_int64)repS * 1000000) {
+			Report("interval", 0);
+			G_ivStart = now;
+		}
+		if (!progress)
+			UOS_Delay(1);
+	}
+	Report("interval", 0);
+	Report("total", 1);
+	ret = 0;
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+CLEANUP:
+	for (i = 0; i < G_txNum; i++) {
+		if (G_tx[i].path >= 0 && M_close(G_tx[i].path) < 0)
+			PrintError("close", G_tx[i].dev);
+	}
+	return(ret);
+}
+
+/********************************* TxService *******************************/
+/** Send the due words of a transmitter
+ *
+ *  With one label the due words are queued in the driver as long as it
+ *  accepts them. With several labels one run is sent: the label with the
+ *  earliest due word, up to one FIFO of words. Before the label is
+ *  changed, the words of the previous run must have been sent.
+ *
+ *  \param tx         \IN  transmitter
+ *  \param nowUs      \IN  current time [us]
+ *
+ *  \return	          1 = words sent, 0 = nothing to do, -1 on error
+ */
+static int32 TxService(GEN_TX *tx, u_int64 nowUs)
+{
+	GEN_LABEL *l = NULL;
+	GEN_LABEL *best = NULL;
+	u_int64 bestDue = 0;
+	u_int64 due = 0;
+	u_int32 num = 0;
+	u_int32 i = 0;
+	int32 level = 0;
+	int32 rc = 0;
+	int32 sent = 0;
+
+	if (tx->labNum == 1) {
+		l = &G_lab[tx->lab[0]];
+		while ((num = Due(l, nowUs)) != 0) {
+			if ((rc = SendRun(tx, l, num < MAX_RUN ? num : MAX_RUN, nowUs)) <= 0)
+				return rc;
+			sent = 1;
+		}
+		return sent;
+	}
+
+	for (i = 0; i < tx->labNum; i++) {
+		l = &G_lab[tx->lab[i]];
+		if (Due(l, nowUs) == 0)
+			continue;
+		due = DueUs(l, l->sent);
+		if (best == NULL || due < bestDue) {
+			best = l;
+			bestDue = due;
+		}
+	}
+	if (best == NULL)
+		return 0;
+
+	num = Due(best, nowUs);
+	if (num > MAX_RUN)
+		num = MAX_RUN;
+	if (tx->curLabel != best->label) {
+		/* the label register applies to all words not yet sent */
+		if (M_getstat(tx->path, Z246_TX_LEVEL, &level) < 0) {
+			PrintError("getstat Z246_TX_LEVEL", tx->dev);
+			return -1;
+		}
+		if (level != 0)
+			return 0;
+		if (M_setstat(tx->path, Z246_TX_LABEL, best->label) < 0) {
+			PrintError("setstat Z246_TX_LABEL", tx->dev);
+			return -1;
+		}
+		tx->curLabel = best->label;
+		tx->labelChanges++;
+	}
+	return SendRun(tx, best, num, nowUs);
+}
+
+/********************************* SendRun *********************************/
+/** Build and send words of one label
+ *
+ *  \param tx         \IN  transmitter
+ *  \param l          \IN  label
+ *  \param num        \IN  words, max. MAX_RUN
+ *  \param nowUs      \IN  current time [us]
+ *
+ *  \return	          1 = sent, 0 = driver queue full, -1 on error
+ */
+static int32 SendRun(GEN_TX *tx, GEN_LABEL *l, u_int32 num, u_int64 nowUs)
+{
+	u_int64 due = 0;
+	u_int32 lag = 0;
+	u_int32 i = 0;
+
+	if (tx->labNum == 1 && tx->curLabel != l->label) {
+		if (M_setstat(tx->path, Z246_TX_LABEL, l->label) < 0) {
+			PrintError("setstat Z246_TX_LABEL", tx->dev);
+			return -1;
+		}
+		tx->curLabel = l->label;
+	}
+	for (i = 0; i < num; i++)
+		G_buf[i] = WordData(l, nowUs - G_start);
+
+	if (M_setblock(tx->path, (u_int8*)G_buf, num * 4) < 0) {
+		/* the words are built again with the next try */
+		if (UOS_ErrnoGet() == ERR_MBUF_OVERFLOW) {
+			tx->busy++;
+			l->sent -= num;
+			return 0;
+		}
+		PrintError("setblock", tx->dev);
+		return -1;
+	}
+
+	/* lag of the first word of the run, the oldest one */
+	if (l->rate != 0) {
+		due = DueUs(l, l->sent - num) + G_start;
+		lag = (nowUs > due) ? (u_int32)(nowUs - due) : 0;
+		if (lag > l->ivMaxLagUs)
+			l->ivMaxLagUs = lag;
+	}
+	l->ivSent += num;
+	tx->sent += num;
+	tx->ivSent += num;
+	return 1;
+}
+
+/********************************* Due *************************************/
+/** Number of due words of a label
+ *
+ *  \param l          \IN  label
+ *  \param nowUs      \IN  current time [us]
+ *
+ *  \return	          words due and not yet sent
+ */
+static u_int32 Due(GEN_LABEL *l, u_int64 nowUs)
+{
+	u_int64 total = 0;
+
+	if (l->rate == 0)
+		return MAX_RUN;
+	total = (u_int64)((double)(nowUs - G_start) * l->rate / 1000000.0);
+	total -= total % l->burst;
+	return (total > l->sent) ? (u_int32)(total - l->sent) : 0;
+}
+
+/********************************* DueUs ***********************************/
+/** Due time of a word of a label
+ *
+ *  \param l          \IN  label
+ *  \param word       \IN  word number
+ *
+ *  \return	          time since start [us]
+ */
+static u_int64 DueUs(GEN_LABEL *l, u_int32 word)
+{
+	if (l->rate == 0)
+		return 0;
+	/* the burst of the word is complete */
+	word += l->burst;
+	word -= word % l->burst;
+	return (u_int64)((double)word * 1000000.0 / l->rate);
+}
+
+/********************************* WordData ********************************/
+/** Build the data field of the next word of a label
+ *
+ *  Data field bit 0..1: SDI, 2..20: ARINC bits 11..29, 21..22: SSM.
+ *
+ *  \param l          \IN  label, the word is counted
+ *  \param tUs        \IN  time since start [us]
+ *
+ *  \return	          data field
+ */
+static u_int32 WordData(GEN_LABEL *l, u_int64 tUs)
+{
+	u_int32 data = 0;
+	u_int32 ssm = 0;
+	u_int32 d = 0;
+	int32 raw = 0;
+	int32 lim = 0;
+	double v = 0;
+
+	switch (l->type) {
+	case TYPE_BNR:
+		/* two's complement, sign in bit 29 */
+		v = Triangle(l, tUs) * (1 << (l->bits - 1)) / l->range;
+		lim = 1 << (l->bits - 1);
+		raw = (int32)(v < 0 ? v - 0.5 : v + 0.5);
+		if (raw >= lim)
+			raw = lim - 1;
+		if (raw < -lim)
+			raw = -lim;
+		data = ((u_int32)raw & ((1 << l->bits) - 1)) << (19 - l->bits);
+		ssm = 3;
+		break;
+	case TYPE_BCD:
+		/* 5 digits, the most significant one with 3 bits */
+		v = Triangle(l, tUs);
+		raw = (int32)(v < 0 ? -v + 0.5 : v + 0.5);
+		if (raw > 79999)
+			raw = 79999;
+		for (d = 0; d < 5; d++) {
+			data |= (u_int32)(raw % 10) << (d * 4);
+			raw /= 10;
+		}
+		ssm = (v < 0) ? 3 : 0;
+		break;
+	case TYPE_DISC:
+		if (l->pattern == DISC_WALK)
+			data = 1 << (l->sent % 19);
+		else if (l->pattern == DISC_COUNT)
+			data = l->sent;
+		else
+			data = l->value;
+		data &= 0x7FFFF;
+		break;
+	}
+	if (l->ssmNum)
+		ssm = l->ssm[l->sent % l->ssmNum];
+	l->sent++;
+	return (l->sdi & 0x3) | (data << 2) | ((ssm & 0x3) << 21);
+}
+
+/********************************* Triangle ********************************/
+/** Value of a label at a time
+ *
+ *  \param l          \IN  label
+ *  \param tUs        \IN  time since start [us]
+ *
+ *  \return	          triangle between min and max, min if period is 0
+ */
+static double Triangle(GEN_LABEL *l, u_int64 tUs)
+{
+	u_int64 per = (u_int64)l->periodS * 1000000;
+	u_int64 ph = 0;
+
+	if (per == 0)
+		return l->min;
+	ph = (tUs % per) * 2;
+	if (ph >= per)
+		ph = 2 * per - ph;
+	return l->min + (l->max - l->min) * (double)ph / (double)per;
+}
+
+/********************************* ProfileRead *****************************/
+/** Read the traffic profile
+ *
+ *  \param file       \IN  file name
+ *
+ *  \return	          0 or 1 on error
+ */
+static int ProfileRead(char *file)
+{
+	char line[LINE_LEN];
+	u_int32 lineNo = 0;
+	GEN_LABEL *l = NULL;
+	FILE *fp = NULL;
+	u_int32 i = 0;
+	int error = 0;
+
+	if ((fp = fopen(file, "r")) == NULL) {
+		printf("*** can't open profile %s\n", file);
+		return 1;
+	}
+	while (!error && fgets(line, sizeof(line), fp) != NULL) {
+		lineNo++;
+		error = EntryParse(line, lineNo);
+	}
+	fclose(fp);
+	if (!error && G_labNum == 0) {
+		printf("*** profile %s has no labels\n", file);
+		error = 1;
+	}
+
+	/* rate 0 would keep the transmitter from its other labels */
+	for (i = 0; !error && i < G_labNum; i++) {
+		l = &G_lab[i];
+		if (l->rate == 0 && G_tx[l->tx].labNum > 1) {
+			printf("*** profile line %lu invalid: rate 0 needs a transmitter "
+				   "with a single label\n", (unsigned long)l->lineNo);
+			error = 1;
+		}
+	}
+	return error;
+}
+
+/********************************* EntryParse ******************************/
+/** Parse one profile line
+ *
+ *  \param line       \IN  line
+ *  \param lineNo     \IN  line number for messages
+ *
+ *  \return	          0 or 1 on error
+ */
+static int EntryParse(char *line, u_int32 lineNo)
+{
+	GEN_LABEL *l = &G_lab[G_labNum];
+	char *tok[4];
+	char *key = NULL;
+	char *val = NULL;
+	char *end = NULL;
+	u_int32 label = 0;
+	u_int32 i = 0;
+
+	if ((end = strchr(line, '#')) != NULL)
+		*end = '\0';
+	for (i = 0; i < 4; i++) {
+		if ((tok[i] = strtok(i ? NULL : line, " \t\r\n")) == NULL)
+			break;
+	}
+	if (i == 0)
+		return 0;
+	if (i < 4 || G_labNum == MAX_LABELS)
+		goto ERR;
+
+	memset(l, 0, sizeof(*l));
+	l->lineNo = lineNo;
+	l->burst  = 1;
+	l->bits   = 18;
+	l->range  = 1024;
+	l->tx     = strtoul(tok[0], &end, 0);
+	if (*end || l->tx >= G_txNum)
+		goto ERR;
+	label = strtoul(tok[1], &end, 0);
+	if (*end || label > 0xFF)
+		goto ERR;
+	l->label = (u_int8)label;
+	l->rate = strtod(tok[2], &end);
+	if (*end || l->rate < 0)
+		goto ERR;
+	if (strcmp(tok[3], "bnr") == 0)
+		l->type = TYPE_BNR;
+	else if (strcmp(tok[3], "bcd") == 0)
+		l->type = TYPE_BCD;
+	else if (strcmp(tok[3], "disc") == 0)
+		l->type = TYPE_DISC;
+	else
+		goto ERR;
+
+	while ((key = strtok(NULL, " \t\r\n")) != NULL) {
+		if ((val = strchr(key, '=')) == NULL)
+			goto ERR;
+		*val++ = '\0';
+		if (KeyParse(l, key, val))
+			goto ERR;
+	}
+	G_tx[l->tx].lab[G_tx[l->tx].labNum++] = G_labNum++;
+	return 0;
+
+ERR:
+	printf("*** profile line %lu invalid\n", (unsigned long)lineNo);
+	return 1;
+}
+
+/********************************* KeyParse ********************************/
+/** Parse a key of a profile entry
+ *
+ *  \param l          \IN  entry, \OUT key applied
+ *  \param key        \IN  key
+ *  \param val        \IN  value
+ *
+ *  \return	          0 or 1 on error
+ */
+static int KeyParse(GEN_LABEL *l, char *key, char *val)
+{
+	char *end = NULL;
+
+	if (strcmp(key, "ssm") == 0) {
+		for (l->ssmNum = 0; *val && l->ssmNum < MAX_SSM; ) {
+			l->ssm[l->ssmNum++] = strtoul(val, &end, 0);
+			if (end == val || l->ssm[l->ssmNum - 1] > 3)
+				return 1;
+			val = (*end == ',') ? end + 1 : end;
+		}
+		return (*val != '\0');
+	}
+	if (strcmp(key, "pattern") == 0) {
+		if (strcmp(val, "fixed") == 0)
+			l->pattern = DISC_FIXED;
+		else if (strcmp(val, "walk") == 0)
+			l->pattern = DISC_WALK;
+		else if (strcmp(val, "count") == 0)
+			l->pattern = DISC_COUNT;
+		else
+			return 1;
+		return 0;
+	}
+	if (strcmp(key, "min") == 0 || strcmp(key, "max") == 0 ||
+		strcmp(key, "range") == 0) {
+		double d = strtod(val, &end);
+
+		if (*end)
+			return 1;
+		if (key[1] == 'i')
+			l->min = d;
+		else if (key[1] == 'a')
+			l->max = d;
+		else if (d > 0)
+			l->range = d;
+		else
+			return 1;
+		return 0;
+	}
+	if (strcmp(key, "sdi") == 0)
+		l->sdi = strtoul(val, &end, 0);
+	else if (strcmp(key, "burst") == 0)
+		l->burst = strtoul(val, &end, 0);
+	else if (strcmp(key, "period") == 0)
+		l->periodS = strtoul(val, &end, 0);
+	else if (strcmp(key, "bits") == 0)
+		l->bits = strtoul(val, &end, 0);
+	else if (strcmp(key, "value") == 0)
+		l->value = strtoul(val, &end, 0);
+	else
+		return 1;
+
+	return (*end || l->sdi > 3 || l->burst == 0 || l->burst > MAX_RUN ||
+			l->bits < 2 || l->bits > 19);
+}
+
+/********************************* Report **********************************/
+/** Print the achieved rates
+ *
+ *  \param what       \IN  "interval" or "total"
+ *  \param final      \IN  print the totals
+ */
+static void Report(char *what, int final)
+{
+	u_int64 now = TimeUs();
+	u_int64 us = final ? now - G_start : now - G_ivStart;
+	GEN_TX *tx = NULL;
+	GEN_LABEL *l = NULL;
+	u_int32 sent = 0;
+	u_int32 lag = 0;
+	u_int32 i = 0;
+	u_int32 j = 0;
+
+	if (us == 0)
+		us = 1;
+	for (i = 0; i < G_txNum; i++) {
+		tx = &G_tx[i];
+		if (tx->labNum == 0)
+			continue;
+		if (!final)
+			TxStatsGet(tx);
+		sent = final ? tx->written : tx->ivWritten;
+		printf("t=%lus %s tx %s: queued %lu rate %lu/s busUtil %lu%% busy %lu "
+			   "labelChanges %lu idleGaps %lu\n",
+			   (unsigned long)((now - G_start) / 1000000), what, tx->dev,
+			   (unsigned long)(final ? tx->sent : tx->ivSent),
+			   (unsigned long)((u_int64)sent * 1000000 / us),
+			   (unsigned long)((u_int64)sent * G_wordUs * 100 / us),
+			   (unsigned long)tx->busy, (unsigned long)tx->labelChanges,
+			   (unsigned long)tx->idleGaps);
+
+		for (j = 0; j < tx->labNum; j++) {
+			l = &G_lab[tx->lab[j]];
+			if (!final) {
+				l->maxLagUs = (l->ivMaxLagUs > l->maxLagUs) ?
+							  l->ivMaxLagUs : l->maxLagUs;
+			}
+			sent = final ? l->sent : l->ivSent;
+			lag  = final ? l->maxLagUs : l->ivMaxLagUs;
+			printf("t=%lus %s tx %s label %04o: target %.2f/s achieved %.2f/s "
+				   "words %lu maxLag %lu.%03lums\n",
+				   (unsigned long)((now - G_start) / 1000000), what, tx->dev,
+				   l->label, l->rate, (double)sent * 1000000.0 / us,
+				   (unsigned long)sent, (unsigned long)(lag / 1000),
+				   (unsigned long)(lag % 1000));
+			if (!final) {
+				l->ivSent = 0;
+				l->ivMaxLagUs = 0;
+			}
+		}
+		if (!final) {
+			tx->ivSent = 0;
+			tx->ivWritten = 0;
+		}
+	}
+	fflush(stdout);
+}
+
+/********************************* TxStatsGet ******************************/
+/** Add the words written to the FIFO and the idle gaps of a transmitter
+ *
+ *  \param tx         \IN  transmitter, \OUT counters added
+ */
+static void TxStatsGet(GEN_TX *tx)
+{
+	Z246_TX_STATS stats;
+	M_SG_BLOCK blk;
+
+	memset(&stats, 0, sizeof(stats));
+	blk.size = sizeof(stats);
+	blk.data = (void*)&stats;
+	if (M_getstat(tx->path, Z246_BLK_TX_STATS, (int32*)&blk) < 0) {
+		PrintError("getstat Z246_BLK_TX_STATS", tx->dev);
+		return;
+	}
+	tx->written   += stats.wordsWritten;
+	tx->ivWritten += stats.wordsWritten;
+	tx->idleGaps  += stats.idleGaps;
+}
+
+/********************************* TimeUs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [us]
+ */
+static u_int64 TimeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/********************************* SigHandler ******************************/
+/** Stop on SIGINT/SIGTERM, the totals are printed
+ */
+static void SigHandler(int sig)
+{
+	G_stop = 1;
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_gen [<opts>] -p <profile> <txDevice> [<txDevice>...]\n");
+	printf("Function: ARINC 429 traffic generator, sends the labels of the\n");
+	printf("          profile at their rates and reports the achieved rates\n");
+	printf("Options:\n");
+	printf("    -p file    traffic profile, see z146_gen.c\n");
+	printf("    -t s       duration, 0 = until Ctrl-C       (default 60)\n");
+	printf("    -r s       report interval                  (default 10)\n");
+	printf("    -s speed   0 = 12.5 kHz, 1 = 100 kHz        (default 1)\n");
+	printf("Up to %d transmitters and %d labels.\n", MAX_TX, MAX_LABELS);
+	printf("Profile line: <tx> <label> <rate> bnr|bcd|disc [key=value ...]\n");
+	printf("\n");
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ *  \param dev        \IN  device name
+ */
+static void PrintError(char *info, char *dev)
+{
+	printf("*** can't %s %s: %s\n", info, dev, M_errstring(UOS_ErrnoGet()));
+}
@@ -0,0 +1,449 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                     Z146_LATENCY                   ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_latency.c
+ *
+ *       \brief  End-to-end latency from M_setblock() on a Z246 path until
+ *               the word is returned by M_getblock() on a Z146 path
+ *
+ *               A transmit thread sends words with a sequence number in
+ *               the data field and stores the submit time of each number.
+ *               A receive thread polls M_getblock() and computes the
+ *               latency of each word from its sequence number. Both threads
+ *               can be pinned to a CPU and run with SCHED_FIFO. The
+ *               measurement is done in RX interrupt mode, RX polled mode
+ *               (Z146_RX_RXC_IRQ_STAT) or both. The receiver must get the
+ *               transmitter data, either wired or with Z246_LOOPBACK.
+ *
+ *               Reported per mode: min, median, p99, p99.9 and max latency
+ *               and the jitter as mean difference of consecutive latencies.
+ *
+ *     Required: libraries: mdis_api, usr_oss, pthread
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z246_drv.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_SAMPLES		1000000
+#define SEQ_TBL_SIZE	(1 << 20)		/* submit times, power of 2 */
+#define SEQ_MASK		0x7FFFFF		/* data field */
+#define MAX_BURST		255
+#define RX_BUF_LEN		4096
+#define DRAIN_NS		500000000ULL	/* wait for the last words */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** parameters and state shared by the threads */
+typedef struct {
+	MDIS_PATH	rxPath;
+	MDIS_PATH	txPath;
+	u_int32		count;			/* words to send */
+	u_int32		burst;			/* words per M_setblock() */
+	u_int32		intervalUs;		/* time between two bursts */
+	int			cpu[2];			/* CPU of TX and RX thread, -1 = any */
+	int			prio;			/* SCHED_FIFO priority, 0 = normal */
+	volatile int txDone;		/* TX thread finished */
+	u_int32		sent;
+	u_int32		txErrors;
+	u_int32		received;
+	u_int32		seqErrors;
+	u_int32		rxErrors;
+} LAT_CTX;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int RunMode(LAT_CTX *ctx, int irqMode);
+static void *TxThread(void *arg);
+static void *RxThread(void *arg);
+static int ThreadStart(pthread_t *thr, void *(*fn)(void*), LAT_CTX *ctx,
+					   int cpu);
+static u_int64 TimeNs(void);
+static int CmpU64(const void *a, const void *b);
+static void PrintError(char *info);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static volatile u_int64 G_txTime[SEQ_TBL_SIZE];
+static u_int64 G_lat[MAX_SAMPLES];
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	LAT_CTX ctx;
+	u_int32 label = 1;
+	int loop = 0;
+	int modes = 3;			/* bit 0: irq, bit 1: poll */
+	int ret = 0;
+	int argi = 1;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.count = 10000;
+	ctx.burst = 1;
+	ctx.intervalUs = 2000;
+	ctx.cpu[0] = ctx.cpu[1] = -1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0) {
+			Usage();
+			return(1);
+		}
+		if (strcmp(argv[argi], "-L") == 0) {
+			loop = 1;
+			continue;
+		}
+		if (argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 'n': ctx.count = strtoul(argv[argi], NULL, 0);		break;
+		case 'b': ctx.burst = strtoul(argv[argi], NULL, 0);		break;
+		case 'i': ctx.intervalUs = strtoul(argv[argi], NULL, 0);	break;
+		case 'l': label = strtoul(argv[argi], NULL, 0);			break;
+		case 'p': ctx.prio = strtol(argv[argi], NULL, 0);		break;
+		case 'c':
+			if (sscanf(argv[argi], "%d,%d", &ctx.cpu[0], &ctx.cpu[1]) != 2) {
+				Usage();
+				return(1);
+			}
+			break;
+		case 'm':
+			modes = (strstr(argv[argi], "irq") ? 1 : 0) |
+					(strstr(argv[argi], "poll") ? 2 : 0);
+			break;
+		default:
+			Usage();
+			return(1);
+		}
+	}
+	if (argc != argi + 2 || modes == 0 || ctx.burst == 0 ||
+		ctx.burst > MAX_BURST) {
+		Usage();
+		return(1);
+	}
+	if (ctx.count == 0 || ctx.count > MAX_SAMPLES)
+		ctx.count = MAX_SAMPLES;
+
+	/*--------------------+
+	|  open               |
+	+--------------------*/
+	if ((ctx.rxPath = M_open(argv[argi])) < 0) {
+		PrintError("open");
+		return(1);
+	}
+	if ((ctx.txPath = M_open(argv[argi + 1])) < 0) {
+		PrintError("open");
+		M_close(ctx.rxPath);
+		return(1);
+	}
+	M_setstat(ctx.rxPath, Z146_RX_SET_LABEL, label);
+	M_setstat(ctx.txPath, Z246_TX_LABEL, label);
+	if (loop)
+		M_setstat(ctx.txPath, Z246_LOOPBACK, 1);
+
+	/*--------------------+
+	|  measure            |
+	+--------------------*/
+	if ((modes & 1) && RunMode(&ctx, 1) != 0)
+		ret = 1;
+	if ((modes & 2) && RunMode(&ctx, 0) != 0)
+		ret = 1;
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+	M_setstat(ctx.rxPath, Z146_RX_RXC_IRQ_STAT, 1);
+	if (loop)
+		M_setstat(ctx.txPath, Z246_LOOPBACK, 0);
+	if (M_close(ctx.rxPath) < 0)
+		PrintError("close");
+	if (M_close(ctx.txPath) < 0)
+		PrintError("close");
+	return(ret);
+}
+
+/********************************* RunMode *********************************/
+/** Measure and print the latency distribution in one RX mode
+ *
+ *  \param ctx        \IN  parameters
+ *  \param irqMode    \IN  1 = RX interrupt mode, 0 = polled
+ *
+ *  \return	          0 or 1 on error
+ */
+static int RunMode(LAT_CTX *ctx, int irqMode)
+{
+	pthread_t rxThr, txThr;
+	u_int32 buf[RX_BUF_LEN];
+	u_int64 sum = 0;
+	u_int64 jit = 0;
+	u_int32 n = 0;
+	u_int32 i = 0;
+
+	if (M_setstat(ctx->rxPath, Z146_RX_RXC_IRQ_STAT, irqMode) < 0) {
+		PrintError("setstat Z146_RX_RXC_IRQ_STAT");
+		return 1;
+	}
+	/* discard old data */
+	UOS_Delay(100);
+	while (M_getblock(ctx->rxPath, (u_int8*)buf, sizeof(buf)) > 0)
+		;
+
+	ctx->txDone = 0;
+	ctx->sent = ctx->txErrors = 0;
+	ctx->received = ctx->seqErrors = ctx->rxErrors = 0;
+
+	if (ThreadStart(&rxThr, RxThread, ctx, ctx->cpu[1]) != 0)
+		return 1;
+	if (ThreadStart(&txThr, TxThread, ctx, ctx->cpu[0]) != 0) {
+		ctx->txDone = 1;
+		pthread_join(rxThr, NULL);
+		return 1;
+	}
+	pthread_join(txThr, NULL);
+	pthread_join(rxThr, NULL);
+
+	/*--------------------+
+	|  result             |
+	+--------------------*/
+	n = ctx->received;
+	printf("%s mode: %lu sent, %lu received, %lu out of sequence, "
+		   "%lu TX / %lu RX errors\n", irqMode ? "RX irq" : "RX poll",
+		   (unsigned long)ctx->sent, (unsigned long)n,
+		   (unsigned long)ctx->seqErrors, (unsigned long)ctx->txErrors,
+		   (unsigned long)ctx->rxErrors);
+	if (n == 0)
+		return 1;
+
+	/* jitter in receive order, before sorting */
+	for (i = 1; i < n; i++)
+		jit += (G_lat[i] > G_lat[i - 1]) ? G_lat[i] - G_lat[i - 1] :
+										   G_lat[i - 1] - G_lat[i];
+	qsort(G_lat, n, sizeof(u_int64), CmpU64);
+	for (i = 0; i < n; i++)
+		sum += G_lat[i];
+
+	printf("  latency [us]: min %lu  median %lu  avg %lu  p99 %lu  "
+		   "p99.9 %lu  max %lu  jitter %lu\n",
+		   (unsigned long)(G_lat[0] / 1000),
+		   (unsigned long)(G_lat[n / 2] / 1000),
+		   (unsigned long)(sum / n / 1000),
+		   (unsigned long)(G_lat[(u_int64)n * 99 / 100] / 1000),
+		   (unsigned long)(G_lat[(u_int64)n * 999 / 1000] / 1000),
+		   (unsigned long)(G_lat[n - 1] / 1000),
+		   (unsigned long)(n > 1 ? jit / (n - 1) / 1000 : 0));
+	return (ctx->sent == n && ctx->seqErrors == 0) ? 0 : 1;
+}
+
+/********************************* TxThread ********************************/
+/** Send the sequence numbers
+ *
+ *  The submit time is stored before M_setblock(), it includes the system
+ *  call and the driver.
+ */
+static void *TxThread(void *arg)
+{
+	LAT_CTX *ctx = (LAT_CTX*)arg;
+	u_int32 data[MAX_BURST];
+	struct timespec next;
+	u_int64 t = 0;
+	u_int32 seq = 0;
+	u_int32 i = 0;
+	u_int32 n = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	while (ctx->sent < ctx->count) {
+		n = ctx->count - ctx->sent;
+		if (n > ctx->burst)
+			n = ctx->burst;
+
+		t = TimeNs();
+		for (i = 0; i < n; i++) {
+			data[i] = (seq + i) & SEQ_MASK;
+			G_txTime[data[i] & (SEQ_TBL_SIZE - 1)] = t;
+		}
+		__sync_synchronize();
+
+		if (M_setblock(ctx->txPath, (u_int8*)data, n * 4) > 0) {
+			seq += n;
+			ctx->sent += n;
+		} else {
+			ctx->txErrors++;
+		}
+
+		/* absolute period, no drift by the send time */
+		next.tv_nsec += ctx->intervalUs * 1000;
+		while (next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
+	ctx->txDone = 1;
+	return NULL;
+}
+
+/********************************* RxThread ********************************/
+/** Receive the sequence numbers and compute the latencies
+ */
+static void *RxThread(void *arg)
+{
+	LAT_CTX *ctx = (LAT_CTX*)arg;
+	u_int32 buf[RX_BUF_LEN];
+	u_int64 now = 0;
+	u_int64 last = 0;
+	u_int32 expect = 0;
+	u_int32 seq = 0;
+	int32 got = 0;
+	int32 i = 0;
+
+	last = TimeNs();
+	for (;;) {
+		got = M_getblock(ctx->rxPath, (u_int8*)buf, sizeof(buf));
+		now = TimeNs();
+
+		if (got < 0) {
+			ctx->rxErrors++;
+			got = 0;
+		}
+		for (i = 0; i < got / 4 && ctx->received < MAX_SAMPLES; i++) {
+			seq = (buf[i] >> 8) & SEQ_MASK;
+			if (seq != expect)
+				ctx->seqErrors++;
+			expect = (seq + 1) & SEQ_MASK;
+			G_lat[ctx->received++] = now - G_txTime[seq & (SEQ_TBL_SIZE - 1)];
+		}
+		if (got > 0)
+			last = now;
+
+		/* stop when all words arrived or the line stays quiet */
+		if (ctx->txDone &&
+			(ctx->received >= ctx->sent || now - last > DRAIN_NS))
+			break;
+	}
+	return NULL;
+}
+
+/********************************* ThreadStart *****************************/
+/** Start a thread, optionally pinned to a CPU and with SCHED_FIFO
+ *
+ *  \param thr        \OUT thread
+ *  \param fn         \IN  thread function
+ *  \param ctx        \IN  argument
+ *  \param cpu        \IN  CPU or -1
+ *
+ *  \return	          0 or 1 on error
+ */
+static int ThreadStart(pthread_t *thr, void *(*fn)(void*), LAT_CTX *ctx,
+					   int cpu)
+{
+	pthread_attr_t attr;
+	struct sched_param sp;
+	cpu_set_t set;
+	int rc = 0;
+
+	pthread_attr_init(&attr);
+	if (cpu >= 0) {
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+	}
+	if (ctx->prio > 0) {
+		memset(&sp, 0, sizeof(sp));
+		sp.sched_priority = ctx->prio;
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &sp);
+	}
+	if ((rc = pthread_create(thr, &attr, fn, ctx)) != 0)
+		printf("*** can't create thread: %s\n", strerror(rc));
+	pthread_attr_destroy(&attr);
+	return rc ? 1 : 0;
+}
+
+/********************************* TimeNs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [ns]
+ */
+static u_int64 TimeNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/********************************* CmpU64 **********************************/
+/** qsort() compare function
+ */
+static int CmpU64(const void *a, const void *b)
+{
+	u_int64 x = *(const u_int64*)a;
+	u_int64 y = *(const u_int64*)b;
+
+	return (x > y) - (x < y);
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_latency [<opts>] <rxDevice> <txDevice>\n");
+	printf("Function: latency from M_setblock() until M_getblock() returns\n");
+	printf("          the word\n");
+	printf("Options:\n");
+	printf("    -n count     words to send (default 10000, max. %d)\n", MAX_SAMPLES);
+	printf("    -b words     words per M_setblock() (default 1, max. %d)\n", MAX_BURST);
+	printf("    -i us        time between two M_setblock() (default 2000)\n");
+	printf("    -m modes     RX mode irq, poll or irq,poll (default irq,poll)\n");
+	printf("    -c tx,rx     pin the TX and RX thread to these CPUs\n");
+	printf("    -p prio      run the threads with SCHED_FIFO and this priority\n");
+	printf("    -l label     label of the words (default 1)\n");
+	printf("    -L           use the loop back mode of the transmitter\n");
+	printf("\n");
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ */
+static void PrintError(char *info)
+{
+	printf("*** can't %s: %s\n", info, M_errstring(UOS_ErrnoGet()));
+}
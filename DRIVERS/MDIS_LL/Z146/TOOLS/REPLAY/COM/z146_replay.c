@@ -0,0 +1,899 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                    Z146_REPLAY                     ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_replay.c
+ *
+ *       \brief  Replays a capture of z146_capture on Z246 transmitters
+ *               with the recorded timing
+ *
+ *               The capture file is read in chunks with the z146_cap
+ *               library, so captures of any size are replayed with a
+ *               constant amount of memory. A split capture is replayed
+ *               completely when its first file (<name>.000) is given.
+ *
+ *               Each recorded channel is mapped to a transmitter (-c,
+ *               default channel n to the n-th transmitter). The words of
+ *               a channel are sent with the timed transmission of the
+ *               driver (Z246_BLK_TX_TIMED): words with the same label which
+ *               follow each other without a gap form a burst of up to 64
+ *               words, which is submitted up to LEAD_MS in advance with
+ *               the tick of its recorded time. The driver releases the
+ *               burst at that tick, the timing does not depend on the
+ *               scheduling of this program.
+ *
+ *               The 16Z246 has one label register which is used when a
+ *               word is sent. Before a burst with another label is
+ *               submitted, the previous bursts must have left the FIFO
+ *               (Z246_TX_LEVEL 0), so a label change costs at least the
+ *               time until this program notices the end of the previous
+ *               burst. Bursts
+ *               submitted after their recorded time are counted as late.
+ *
+ *               The timing error of a burst is the time from its recorded
+ *               time (scaled with -x) until the first word is on the bus:
+ *               the release error reported by the driver
+ *               (Z246_BLK_TX_TIMED_RES) plus the rounding of the recorded
+ *               time to a tick, which is bounded by the tick resolution
+ *               of the operating system.
+ *
+ *               Options:
+ *               - -x factor: speed-up, 2 = replay twice as fast. Words
+ *                 closer than one word time are sent back-to-back.
+ *               - -L [<ch>/]<old>=<new>: send label old (of channel ch)
+ *                 as label new, labels octal with leading 0
+ *               - -l loops: replay the capture n times, 0 = endless
+ *
+ *               Loss records of the capture are skipped and reported as
+ *               gaps of the recording.
+ *
+ *     Required: libraries: mdis_api, usr_oss, z146_cap
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z246_drv.h>
+#include <MEN/z146_cap.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_TX			4
+#define Q_SIZE			16384		/* words read ahead per transmitter */
+#define OUT_SIZE		64			/* submitted bursts without result */
+#define READ_RECS		4096		/* records per Z146_CapRead() */
+#define BURST_MAX		64			/* Z246_BLK_TX_TIMED words */
+#define RES_MAX			16			/* results of the driver */
+#define LEAD_MS			50			/* bursts are submitted ahead */
+#define START_MS		200			/* delay of the first word */
+#define HIST_US			50			/* timing error histogram */
+#define HIST_NUM		2000
+#define NAME_LEN		512
+#define WORD_US(speed)	((speed) ? 360 : 2880)	/* incl. 4 bit gap */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** word read ahead */
+typedef struct {
+	u_int64	dueUs;			/* time since start */
+	u_int32	word;			/* label in bits 7..0, data 30..8 */
+} RP_WORD;
+
+/** burst submitted, waiting for its result */
+typedef struct {
+	u_int32	tick;
+	u_int64	dueUs;
+	u_int32	words;
+} RP_BURST;
+
+/** transmitter */
+typedef struct {
+	char		*dev;
+	MDIS_PATH	path;
+	int32		chan;			/* replayed channel, -1 = none */
+	u_int32		wordUs;
+	RP_WORD		q[Q_SIZE];
+	u_int32		qHead;
+	u_int32		qNum;
+	u_int64		lastDueUs;
+	RP_BURST	out[OUT_SIZE];
+	u_int32		outHead;
+	u_int32		outNum;
+	int32		curLabel;		/* label register, -1 = unknown */
+	u_int64		busyUs;			/* end of the last burst on the bus */
+	/* statistics */
+	u_int64		words;
+	u_int64		ivWords;
+	u_int64		bursts;
+	u_int32		labelChanges;
+	u_int32		late;			/* bursts submitted after their time */
+	u_int32		missed;			/* results overwritten in the driver */
+	u_int64		results;
+	int64		errSum;
+	u_int64		errAbsSum;
+	int32		errMin;
+	int32		errMax;
+	u_int32		ivErrAbsMax;
+	u_int32		hist[HIST_NUM];	/* absolute timing error */
+} RP_TX;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int MapParse(char *arg);
+static int RemapParse(char *arg);
+static int FileOpen(u_int32 no);
+static int32 Fill(void);
+static int32 TxService(RP_TX *tx, u_int64 nowUs);
+static int32 ResultsRead(RP_TX *tx);
+static void TickSync(MDIS_PATH path);
+static u_int32 TickOf(u_int64 us);
+static int64 TickUs(u_int32 tick);
+static void Report(char *what, int final);
+static u_int64 TimeUs(void);
+static void SigHandler(int sig);
+static void PrintError(char *info, char *dev);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static RP_TX G_tx[MAX_TX];
+static u_int32 G_txNum;
+static int32 G_chTx[Z146_CAP_CH_MAX];		/* channel -> transmitter */
+static u_int8 G_remap[Z146_CAP_CH_MAX][256];	/* channel, label -> label */
+static u_int64 G_chGaps[Z146_CAP_CH_MAX];		/* lost words in the recording */
+
+/* capture file */
+static char *G_name;
+static char G_base[NAME_LEN];	/* name without ".000" of a split capture */
+static int G_split;
+static u_int32 G_fileNo;
+static Z146_CAP_FILE G_cf;
+static Z146_CAP_HDR G_hdr;		/* header of the first file */
+static Z146_CAP_REC G_rec[READ_RECS];
+static u_int32 G_recIdx;
+static u_int32 G_recNum;
+static int G_eof;				/* all loops read */
+
+/* timing */
+static double G_factor = 1.0;
+static u_int32 G_loops = 1;
+static u_int32 G_loop;
+static int G_t0Set;
+static u_int64 G_t0;			/* time of the first recorded word */
+static u_int64 G_tLast;			/* time of the last recorded word */
+static u_int64 G_loopUs;		/* offset of the current loop */
+static u_int64 G_loopGapUs;
+static u_int32 G_tickBase;
+static u_int64 G_tickBaseUs;
+static u_int32 G_tickRate;
+
+static u_int64 G_start;
+static u_int64 G_ivStart;
+static volatile int G_stop;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	u_int32 repS = 10;
+	u_int32 speed = 0;
+	u_int32 speedSet = 0;
+	u_int32 i = 0;
+	u_int32 j = 0;
+	u_int64 now = 0;
+	u_int64 ivSync = 0;
+	size_t len = 0;
+	int32 progress = 0;
+	int32 rc = 0;
+	int mapped = 0;
+	int error = 0;
+	int ret = 1;
+	int argi = 1;
+
+	for (i = 0; i < Z146_CAP_CH_MAX; i++) {
+		G_chTx[i] = -1;
+		for (j = 0; j < 256; j++)
+			G_remap[i][j] = (u_int8)j;
+	}
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0 || argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 'x': G_factor = strtod(argv[argi], NULL);		break;
+		case 'l': G_loops  = strtoul(argv[argi], NULL, 0);	break;
+		case 'r': repS     = strtoul(argv[argi], NULL, 0);	break;
+		case 's':
+			speed    = strtoul(argv[argi], NULL, 0);
+			speedSet = 1;
+			break;
+		case 'c':
+			error  = MapParse(argv[argi]);
+			mapped = 1;
+			break;
+		case 'L': error = RemapParse(argv[argi]);			break;
+		default:
+			error = 1;
+		}
+		if (error) {
+			Usage();
+			return(1);
+		}
+	}
+	if (argi < argc)
+		G_name = argv[argi++];
+	for (; argi < argc && G_txNum < MAX_TX; argi++) {
+		G_tx[G_txNum].dev  = argv[argi];
+		G_tx[G_txNum].path = -1;
+		G_tx[G_txNum].chan = -1;
+		G_txNum++;
+	}
+	if (G_name == NULL || G_txNum == 0 || argi != argc || repS == 0 ||
+		G_factor <= 0) {
+		Usage();
+		return(1);
+	}
+	if (!mapped) {
+		for (i = 0; i < G_txNum; i++)
+			G_chTx[i] = i;
+	}
+	for (i = 0; i < Z146_CAP_CH_MAX; i++) {
+		if (G_chTx[i] < 0)
+			continue;
+		if (G_chTx[i] >= (int32)G_txNum || G_tx[G_chTx[i]].chan >= 0) {
+			printf("*** channel %lu: no or shared transmitter\n",
+				   (unsigned long)i);
+			return(1);
+		}
+		G_tx[G_chTx[i]].chan = i;
+	}
+
+	/* first file of a split capture */
+	len = strlen(G_name);
+	if (len > 4 && len < NAME_LEN && strcmp(G_name + len - 4, ".000") == 0) {
+		G_split = 1;
+		memcpy(G_base, G_name, len - 4);
+		G_base[len - 4] = '\0';
+	}
+	if (FileOpen(0))
+		return(1);
+	G_hdr = G_cf.hdr;
+
+	/*--------------------+
+	|  open, configure    |
+	+--------------------*/
+	for (i = 0; i < G_txNum; i++) {
+		RP_TX *tx = &G_tx[i];
+		u_int32 txSpeed = speed;
+
+		if (tx->chan < 0 || tx->chan >= G_hdr.chNum) {
+			printf("tx %s: no channel in the capture, not used\n", tx->dev);
+			tx->chan = -1;
+			continue;
+		}
+		if (!speedSet)
+			txSpeed = (G_hdr.speed >> tx->chan) & 1;
+		tx->wordUs   = WORD_US(txSpeed);
+		tx->curLabel = -1;
+		tx->errMin   = 0x7FFFFFFF;
+		tx->errMax   = -0x7FFFFFFF;
+		if (tx->wordUs > G_loopGapUs)
+			G_loopGapUs = tx->wordUs;
+
+		if ((tx->path = M_open(tx->dev)) < 0) {
+			PrintError("open", tx->dev);
+			goto CLEANUP;
+		}
+		if (M_setstat(tx->path, Z246_TX_SPEED, txSpeed) < 0 ||
+			M_setstat(tx->path, Z246_PAR_EN, 1) < 0 ||
+			M_setstat(tx->path, Z246_PAR_TYPE, 0) < 0 ||
+			M_setstat(tx->path, Z246_SDI_EN, 0) < 0 ||
+			M_getstat(tx->path, Z246_TX_TICK_RATE, (int32*)&G_tickRate) < 0) {
+			PrintError("configure", tx->dev);
+			goto CLEANUP;
+		}
+		printf("tx %s: channel %lu %s at %s kHz\n", tx->dev,
+			   (unsigned long)tx->chan, G_hdr.chName[tx->chan],
+			   txSpeed ? "100" : "12.5");
+	}
+	for (i = 0; i < G_txNum && G_tx[i].path < 0; i++)
+		;
+	if (i == G_txNum) {
+		printf("*** no transmitter to replay\n");
+		goto CLEANUP;
+	}
+	if (G_tickRate == 0) {
+		printf("*** tx %s: no timed transmission\n", G_tx[i].dev);
+		goto CLEANUP;
+	}
+	printf("replay %s, speed-up %.2f, %lu loop(s), tick %lu us\n", G_name,
+		   G_factor, (unsigned long)G_loops,
+		   (unsigned long)(1000000 / G_tickRate));
+	fflush(stdout);
+
+	signal(SIGINT, SigHandler);
+	signal(SIGTERM, SigHandler);
+
+	/*--------------------+
+	|  replay             |
+	+--------------------*/
+	G_start = TimeUs();
+	TickSync(G_tx[i].path);
+	G_ivStart = ivSync = 0;
+	while (!G_stop) {
+		if (Fill() < 0)
+			goto CLEANUP;
+
+		progress = 0;
+		now = TimeUs() - G_start;
+		for (j = 0; j < G_txNum; j++) {
+			if (G_tx[j].path < 0)
+				continue;
+			if ((rc = TxService(&G_tx[j], now)) < 0)
+				goto CLEANUP;
+			progress |= rc;
+		}
+
+		/* done when all words were sent and all results are in */
+		if (G_eof) {
+			for (j = 0; j < G_txNum; j++) {
+				if (G_tx[j].qNum || (G_tx[j].outNum && now < G_tx[j].busyUs +
+									 (u_int64)START_MS * 1000))
+					break;
+			}
+			if (j == G_txNum)
+				break;
+		}
+
+		if (now - G_ivStart >= (u_int64)repS * 1000000) {
+			Report("interval", 0);
+			G_ivStart = now;
+		}
+		/* follow the drift of the tick against the monotonic clock */
+		if (now - ivSync >= 60000000) {
+			TickSync(G_tx[i].path);
+			ivSync = now;
+		}
+		if (!progress)
+			UOS_Delay(1);
+	}
+	Report("total", 1);
+	ret = 0;
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+CLEANUP:
+	Z146_CapClose(&G_cf);
+	for (i = 0; i < G_txNum; i++) {
+		if (G_tx[i].path >= 0 && M_close(G_tx[i].path) < 0)
+			PrintError("close", G_tx[i].dev);
+	}
+	return(ret);
+}
+
+/********************************* MapParse ********************************/
+/** Parse a channel mapping <ch>=<tx>
+ *
+ *  \param arg        \IN  argument
+ *
+ *  \return	          0 or 1 on error
+ */
+static int MapParse(char *arg)
+{
+	char *end = NULL;
+	u_int32 ch = strtoul(arg, &end, 0);
+	u_int32 tx = 0;
+
+	if (*end != '=' || ch >= Z146_CAP_CH_MAX)
+		return 1;
+	tx = strtoul(end + 1, &end, 0);
+	if (*end || tx >= MAX_TX)
+		return 1;
+	G_chTx[ch] = tx;
+	return 0;
+}
+
+/********************************* RemapParse ******************************/
+/** Parse a label mapping [<ch>/]<old>=<new>
+ *
+ *  \param arg        \IN  argument
+ *
+ *  \return	          0 or 1 on error
+ */
+static int RemapParse(char *arg)
+{
+	char *end = NULL;
+	u_int32 ch = 0;
+	u_int32 chNum = Z146_CAP_CH_MAX;
+	u_int32 from = 0;
+	u_int32 to = 0;
+
+	if (strchr(arg, '/') != NULL) {
+		ch = strtoul(arg, &end, 0);
+		if (*end != '/' || ch >= Z146_CAP_CH_MAX)
+			return 1;
+		chNum = ch + 1;
+		arg = end + 1;
+	}
+	from = strtoul(arg, &end, 0);
+	if (*end != '=' || from > 0xFF)
+		return 1;
+	to = strtoul(end + 1, &end, 0);
+	if (*end || to > 0xFF)
+		return 1;
+	for (; ch < chNum; ch++)
+		G_remap[ch][from] = (u_int8)to;
+	return 0;
+}
+
+/********************************* FileOpen ********************************/
+/** Open a file of the capture
+ *
+ *  \param no         \IN  number of the file of a split capture
+ *
+ *  \return	          0, 1 on error or -1 if a split capture has no
+ *                    such file
+ */
+static int FileOpen(u_int32 no)
+{
+	char name[NAME_LEN];
+
+	Z146_CapClose(&G_cf);
+	if (G_split)
+		snprintf(name, sizeof(name), "%s.%03lu", G_base, (unsigned long)no);
+	else
+		snprintf(name, sizeof(name), "%s", G_name);
+
+	if (Z146_CapOpen(&G_cf, name) < 0) {
+		if (no && errno == ENOENT)
+			return -1;
+		printf("*** can't open %s: %s\n", name,
+			   errno == EINVAL ? "no capture file" : strerror(errno));
+		return 1;
+	}
+	if (no && (G_cf.hdr.startUs != G_hdr.startUs ||
+			   G_cf.hdr.chNum != G_hdr.chNum || G_cf.hdr.fileNo != no)) {
+		printf("*** %s is not part of the capture\n", name);
+		return 1;
+	}
+	G_fileNo  = no;
+	G_recIdx  = 0;
+	G_recNum  = 0;
+	return 0;
+}
+
+/********************************* Fill ************************************/
+/** Read records into the queues of the transmitters
+ *
+ *  Reading stops when the queue of the next word is full. The records of
+ *  the channels are nearly in time order, so the other queues get their
+ *  words when the full one is sent.
+ *
+ *  \return	          0 or -1 on error
+ */
+static int32 Fill(void)
+{
+	Z146_CAP_REC *r = NULL;
+	RP_TX *tx = NULL;
+	RP_WORD *w = NULL;
+	u_int64 due = 0;
+	int32 n = 0;
+	int rc = 0;
+
+	while (!G_eof) {
+		if (G_recIdx == G_recNum) {
+			if ((n = Z146_CapRead(&G_cf, G_rec, READ_RECS)) < 0) {
+				printf("*** can't read %s: %s\n", G_name, strerror(errno));
+				return -1;
+			}
+			G_recIdx = 0;
+			G_recNum = (u_int32)n;
+			if (n)
+				continue;
+
+			/* next file of a split capture */
+			if (G_split) {
+				if ((rc = FileOpen(G_fileNo + 1)) == 0)
+					continue;
+				if (rc > 0)
+					return -1;
+			}
+			/* next loop or end */
+			if (++G_loop == G_loops || !G_t0Set) {
+				G_eof = 1;
+				break;
+			}
+			G_loopUs += (u_int64)((G_tLast - G_t0) / G_factor) + G_loopGapUs;
+			if (FileOpen(0))
+				return -1;
+			continue;
+		}
+
+		r = &G_rec[G_recIdx];
+		if (r->chan >= G_hdr.chNum || G_chTx[r->chan] < 0) {
+			G_recIdx++;
+			continue;
+		}
+		if (r->flags & Z146_CAP_F_LOSS) {
+			if (G_loop == 0)
+				G_chGaps[r->chan] += r->word;
+			G_recIdx++;
+			continue;
+		}
+		tx = &G_tx[G_chTx[r->chan]];
+		if (tx->qNum == Q_SIZE)
+			break;
+
+		if (!G_t0Set) {
+			G_t0 = r->timeUs;
+			G_t0Set = 1;
+		}
+		due = (r->timeUs > G_t0) ? r->timeUs - G_t0 : 0;
+		if (r->timeUs > G_tLast)
+			G_tLast = r->timeUs;
+		due = (u_int64)(due / G_factor) + G_loopUs + (u_int64)START_MS * 1000;
+		if (due < tx->lastDueUs)
+			due = tx->lastDueUs;
+		tx->lastDueUs = due;
+
+		w = &tx->q[(tx->qHead + tx->qNum) % Q_SIZE];
+		w->dueUs = due;
+		w->word  = (r->word & ~0xFF) | G_remap[r->chan][r->word & 0xFF];
+		tx->qNum++;
+		G_recIdx++;
+	}
+	return 0;
+}
+
+/********************************* TxService *******************************/
+/** Submit the bursts of a transmitter which are due within LEAD_MS
+ *
+ *  \param tx         \IN  transmitter
+ *  \param nowUs      \IN  current time [us since start]
+ *
+ *  \return	          1 = bursts submitted, 0 = nothing to do, -1 on error
+ */
+static int32 TxService(RP_TX *tx, u_int64 nowUs)
+{
+	u_int32 buf[1 + BURST_MAX];
+	M_SG_BLOCK blk;
+	RP_WORD *w = NULL;
+	RP_BURST *b = NULL;
+	u_int64 due = 0;
+	u_int64 tol = (G_tickRate > 2) ? 500000 / G_tickRate : 0;
+	u_int32 label = 0;
+	u_int32 n = 0;
+	int32 level = 0;
+	int32 sent = 0;
+
+	if (ResultsRead(tx) < 0)
+		return -1;
+
+	while (tx->qNum && tx->outNum < OUT_SIZE) {
+		w = &tx->q[tx->qHead];
+		due = w->dueUs;
+		label = w->word & 0xFF;
+		if (due > nowUs + (u_int64)LEAD_MS * 1000)
+			break;
+
+		/*
+		 * The label register applies to all words not yet sent: change it
+		 * when all bursts were released (outNum) and the driver queues and
+		 * the FIFO are empty.
+		 */
+		if ((int32)label != tx->curLabel) {
+			if (tx->outNum)
+				break;
+			if (M_getstat(tx->path, Z246_TX_LEVEL, &level) < 0) {
+				PrintError("getstat Z246_TX_LEVEL", tx->dev);
+				return -1;
+			}
+			if (level != 0)
+				break;
+			if (M_setstat(tx->path, Z246_TX_LABEL, label) < 0) {
+				PrintError("setstat Z246_TX_LABEL", tx->dev);
+				return -1;
+			}
+			tx->curLabel = label;
+			tx->labelChanges++;
+		}
+
+		/* words of the label which the bus sends back-to-back */
+		for (n = 0; n < BURST_MAX && n < tx->qNum; n++) {
+			w = &tx->q[(tx->qHead + n) % Q_SIZE];
+			if ((w->word & 0xFF) != label ||
+				w->dueUs > due + (u_int64)n * tx->wordUs + tol)
+				break;
+			buf[1 + n] = (w->word >> 8) & 0x7FFFFF;
+		}
+		buf[0] = TickOf(due);
+		blk.size = (1 + n) * 4;
+		blk.data = (void*)buf;
+		if (M_setstat(tx->path, Z246_BLK_TX_TIMED, (INT32_OR_64)&blk) < 0) {
+			/* all timed slots in use */
+			if (UOS_ErrnoGet() == ERR_MBUF_OVERFLOW)
+				break;
+			PrintError("setstat Z246_BLK_TX_TIMED", tx->dev);
+			return -1;
+		}
+
+		b = &tx->out[(tx->outHead + tx->outNum) % OUT_SIZE];
+		b->tick  = buf[0];
+		b->dueUs = due;
+		b->words = n;
+		tx->outNum++;
+		if (due < nowUs)
+			tx->late++;
+		if (tx->busyUs < due)
+			tx->busyUs = due;
+		tx->busyUs += (u_int64)n * tx->wordUs;
+
+		tx->qHead = (tx->qHead + n) % Q_SIZE;
+		tx->qNum -= n;
+		tx->words += n;
+		tx->ivWords += n;
+		tx->bursts++;
+		sent = 1;
+	}
+	return sent;
+}
+
+/********************************* ResultsRead *****************************/
+/** Read the release errors of the bursts sent
+ *
+ *  The results arrive in the order of submission. A burst without result
+ *  was overwritten in the log of the driver.
+ *
+ *  \param tx         \IN  transmitter
+ *
+ *  \return	          0 or -1 on error
+ */
+static int32 ResultsRead(RP_TX *tx)
+{
+	Z246_TX_TIMED_RES res[RES_MAX];
+	M_SG_BLOCK blk;
+	RP_BURST *b = NULL;
+	int64 onBus = 0;
+	int64 end = 0;
+	int32 err = 0;
+	u_int32 absErr = 0;
+	u_int32 n = 0;
+	u_int32 i = 0;
+
+	if (tx->outNum == 0)
+		return 0;
+
+	blk.size = sizeof(res);
+	blk.data = (void*)res;
+	if (M_getstat(tx->path, Z246_BLK_TX_TIMED_RES, (int32*)&blk) < 0) {
+		PrintError("getstat Z246_BLK_TX_TIMED_RES", tx->dev);
+		return -1;
+	}
+	n = blk.size / sizeof(Z246_TX_TIMED_RES);
+
+	for (i = 0; i < n; i++) {
+		while (tx->outNum && tx->out[tx->outHead].tick != res[i].releaseTick) {
+			tx->missed++;
+			tx->outHead = (tx->outHead + 1) % OUT_SIZE;
+			tx->outNum--;
+		}
+		if (tx->outNum == 0)
+			break;
+		b = &tx->out[tx->outHead];
+
+		/* first word on the bus, relative to the recorded time */
+		onBus = TickUs(b->tick) + res[i].errUs;
+		err = (int32)(onBus - (int64)b->dueUs);
+		absErr = (err < 0) ? -err : err;
+		tx->results++;
+		tx->errSum += err;
+		tx->errAbsSum += absErr;
+		if (err < tx->errMin)
+			tx->errMin = err;
+		if (err > tx->errMax)
+			tx->errMax = err;
+		if (absErr > tx->ivErrAbsMax)
+			tx->ivErrAbsMax = absErr;
+		tx->hist[(absErr / HIST_US < HIST_NUM) ? absErr / HIST_US : HIST_NUM - 1]++;
+
+		end = onBus + (int64)b->words * tx->wordUs;
+		if (end > (int64)tx->busyUs)
+			tx->busyUs = (u_int64)end;
+		tx->outHead = (tx->outHead + 1) % OUT_SIZE;
+		tx->outNum--;
+	}
+	return 0;
+}
+
+/********************************* TickSync ********************************/
+/** Take the time of a tick of the timed transmission
+ *
+ *  Waits for the next tick so the time is exact to the resolution of
+ *  the monotonic clock.
+ *
+ *  \param path       \IN  transmitter
+ */
+static void TickSync(MDIS_PATH path)
+{
+	u_int32 tick = 0;
+	u_int32 t = 0;
+
+	M_getstat(path, Z246_TX_TICK, (int32*)&tick);
+	do {
+		if (M_getstat(path, Z246_TX_TICK, (int32*)&t) < 0)
+			break;
+	} while (t == tick);
+	G_tickBaseUs = TimeUs() - G_start;
+	G_tickBase   = t;
+}
+
+/********************************* TickOf **********************************/
+/** Tick nearest to a time
+ *
+ *  \param us         \IN  time [us since start]
+ *
+ *  \return	          tick
+ */
+static u_int32 TickOf(u_int64 us)
+{
+	int64 d = (int64)us - (int64)G_tickBaseUs;
+
+	d = d * G_tickRate;
+	d += (d < 0) ? -500000 : 500000;
+	return G_tickBase + (int32)(d / 1000000);
+}
+
+/********************************* TickUs **********************************/
+/** Time of a tick
+ *
+ *  \param tick       \IN  tick
+ *
+ *  \return	          time [us since start]
+ */
+static int64 TickUs(u_int32 tick)
+{
+	return (int64)G_tickBaseUs +
+		(int64)(int32)(tick - G_tickBase) * 1000000 / G_tickRate;
+}
+
+/********************************* Report **********************************/
+/** Print the words sent and the timing errors
+ *
+ *  \param what       \IN  "interval" or "total"
+ *  \param final      \IN  print the totals
+ */
+static void Report(char *what, int final)
+{
+	u_int64 now = TimeUs() - G_start;
+	u_int64 us = final ? now : now - G_ivStart;
+	u_int64 sum = 0;
+	RP_TX *tx = NULL;
+	u_int32 p99 = 0;
+	u_int32 i = 0;
+	u_int32 k = 0;
+
+	if (us == 0)
+		us = 1;
+	for (i = 0; i < G_txNum; i++) {
+		tx = &G_tx[i];
+		if (tx->path < 0)
+			continue;
+		if (!final) {
+			printf("t=%lus %s tx %s: words %llu rate %llu/s max. error %lu us\n",
+				   (unsigned long)(now / 1000000), what, tx->dev,
+				   (unsigned long long)tx->ivWords,
+				   (unsigned long long)(tx->ivWords * 1000000 / us),
+				   (unsigned long)tx->ivErrAbsMax);
+			tx->ivWords = 0;
+			tx->ivErrAbsMax = 0;
+			continue;
+		}
+
+		for (k = 0; k < HIST_NUM && tx->results; k++) {
+			sum += tx->hist[k];
+			if (sum * 100 >= tx->results * 99)
+				break;
+		}
+		p99 = (k + 1) * HIST_US;
+		printf("t=%lus %s tx %s: words %llu bursts %llu labelChanges %lu "
+			   "late %lu\n",
+			   (unsigned long)(now / 1000000), what, tx->dev,
+			   (unsigned long long)tx->words, (unsigned long long)tx->bursts,
+			   (unsigned long)tx->labelChanges, (unsigned long)tx->late);
+		if (tx->results) {
+			printf("t=%lus %s tx %s: timing error min %ld mean %ld max %ld "
+				   "us, |error| mean %llu p99 <%lu us, results %llu missed %lu\n",
+				   (unsigned long)(now / 1000000), what, tx->dev,
+				   (long)tx->errMin, (long)(tx->errSum / (int64)tx->results),
+				   (long)tx->errMax,
+				   (unsigned long long)(tx->errAbsSum / tx->results),
+				   (unsigned long)p99, (unsigned long long)tx->results,
+				   (unsigned long)tx->missed);
+		}
+		if (G_chGaps[tx->chan])
+			printf("t=%lus %s tx %s: %llu words lost in the recording\n",
+				   (unsigned long)(now / 1000000), what, tx->dev,
+				   (unsigned long long)G_chGaps[tx->chan]);
+		sum = 0;
+	}
+	fflush(stdout);
+}
+
+/********************************* TimeUs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [us]
+ */
+static u_int64 TimeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/********************************* SigHandler ******************************/
+/** Stop on SIGINT/SIGTERM, the totals are printed
+ */
+static void SigHandler(int sig)
+{
+	G_stop = 1;
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_replay [<opts>] <file> <txDevice> [<txDevice>...]\n");
+	printf("Function: replay a capture of z146_capture with the recorded\n");
+	printf("          timing, <name>.000 replays a split capture\n");
+	printf("Options:\n");
+	printf("    -x factor  speed-up                         (default 1.0)\n");
+	printf("    -l num     loops, 0 = endless               (default 1)\n");
+	printf("    -c ch=tx   replay channel ch on the tx-th transmitter\n");
+	printf("               (default channel n on the n-th transmitter)\n");
+	printf("    -L [ch/]old=new  send label old as new, e.g. -L 0205=0206\n");
+	printf("    -s speed   0 = 12.5 kHz, 1 = 100 kHz   (default as recorded)\n");
+	printf("    -r s       report interval                  (default 10)\n");
+	printf("\n");
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ *  \param dev        \IN  device name
+ */
+static void PrintError(char *info, char *dev)
+{
+	printf("*** can't %s %s: %s\n", info, dev, M_errstring(UOS_ErrnoGet()));
+}
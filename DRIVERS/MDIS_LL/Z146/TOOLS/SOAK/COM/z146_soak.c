@@ -0,0 +1,809 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                      Z146_SOAK                     ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_soak.c
+ *
+ *       \brief  Long-duration soak test of the Z146/Z246 drivers with
+ *               sequence checked traffic
+ *
+ *               Every transmitter sends a continuous stream of words on
+ *               its own label. The data field carries a 15 bit sequence
+ *               number and a CRC-8 over the sequence number and the label:
+ *
+ *               data bits 22..8: sequence, bits 7..0: CRC-8 (poly 0x07)
+ *
+ *               Every receiver checks the stream of its transmitter and
+ *               classifies each deviation:
+ *               - drop: sequence numbers missing (gap)
+ *               - duplicate: the previous sequence number again
+ *               - reorder: an older sequence number, the word is removed
+ *                 from the drop count again
+ *               - corrupt: CRC or label mismatch, the word is not counted
+ *                 as dropped
+ *
+ *               A gap or step back of more than 16384 words can not be
+ *               told apart because of the 15 bit sequence number. Words
+ *               with a broken ARINC parity or framing are discarded by the
+ *               core, they show up as drops together with line errors.
+ *
+ *               On every anomaly the receive (Z146_BLK_RX_STATS, in
+ *               broadcast mode also Z146_RX_OVERRUN) and transmit
+ *               (Z246_BLK_TX_STATS) counters of the driver are read and
+ *               printed with the event, so each loss can be matched with
+ *               a buffer overflow or line error. Drops not covered by these
+ *               counters are reported as unexplained. Rates and losses of
+ *               all paths are reported periodically and at the end.
+ *
+ *     Required: libraries: mdis_api, usr_oss
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z246_drv.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_TX			4
+#define MAX_RX			8
+#define MAX_BURST		255
+#define RX_BUF_WORDS	65536		/* max. RX_RING_SIZE */
+#define SEQ_BITS		15
+#define SEQ_MASK		((1 << SEQ_BITS) - 1)
+#define SEQ_HALF		(1 << (SEQ_BITS - 1))
+#define DATA_MASK		0x7FFFFF
+#define DRAIN_MS		500			/* wait for the last words */
+
+/* anomaly classes */
+#define EV_DROP			0
+#define EV_DUP			1
+#define EV_REORDER		2
+#define EV_CORRUPT		3
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/** transmitter counters */
+typedef struct {
+	u_int32 sent;			/* words accepted by M_setblock() */
+	u_int32 busy;			/* M_setblock() rejected with ERR_MBUF_OVERFLOW */
+	u_int32 overflows;		/* Z246_TX_STATS */
+	u_int32 underruns;
+	u_int32 idleGaps;
+} TX_CNT;
+
+/** receiver counters */
+typedef struct {
+	u_int32 words;			/* words received */
+	u_int32 drops;			/* sequence numbers missing */
+	u_int32 dropEvents;		/* gaps */
+	u_int32 dups;
+	u_int32 reorders;
+	u_int32 corrupt;
+	u_int32 ringDropped;	/* Z146_RX_STATS */
+	u_int32 ringRejected;
+	u_int32 lineErrIrqs;
+	u_int32 lineErrWords;
+	u_int32 lineErrLsr;		/* ORed */
+	u_int32 overruns;		/* Z146_RX_OVERRUN */
+} RX_CNT;
+
+/** transmitter */
+typedef struct {
+	char		*dev;
+	MDIS_PATH	path;
+	u_int8		label;
+	u_int32		seq;		/* next sequence number */
+	TX_CNT		iv;			/* current report interval */
+	TX_CNT		tot;
+} TX_DEV;
+
+/** receiver */
+typedef struct {
+	char		*dev;
+	MDIS_PATH	path;
+	TX_DEV		*tx;		/* transmitter of the stream */
+	u_int32		expect;		/* next expected sequence number */
+	u_int32		last;		/* last received sequence number */
+	u_int32		corrupt;	/* corrupted words since the last good word */
+	int			bcast;		/* Z146_RX_OVERRUN supported */
+	RX_CNT		iv;
+	RX_CNT		tot;
+} RX_DEV;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void Usage(void);
+static int PairParse(char *str);
+static int32 Send(TX_DEV *tx, u_int32 burst);
+static int32 Receive(RX_DEV *rx);
+static void Check(RX_DEV *rx, u_int32 word, u_int32 *evCnt, u_int32 *evSeq);
+static int32 DrvCntGet(RX_DEV *rx, RX_CNT *rxd, TX_CNT *txd);
+static void Event(RX_DEV *rx, u_int32 *evCnt, u_int32 *evSeq);
+static void Report(char *what, int final);
+static void TxCntAdd(TX_CNT *dst, TX_CNT *src);
+static void RxCntAdd(RX_CNT *dst, RX_CNT *src);
+static u_int32 Unexplained(RX_CNT *c);
+static u_int8 Crc8(u_int32 seq, u_int8 label);
+static u_int32 WordData(u_int32 seq, u_int8 label);
+static u_int64 TimeMs(void);
+static void SigHandler(int sig);
+static void PrintError(char *info, char *dev);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static TX_DEV G_tx[MAX_TX];
+static RX_DEV G_rx[MAX_RX];
+static u_int32 G_txNum;
+static u_int32 G_rxNum;
+static u_int32 G_rxBuf[RX_BUF_WORDS];
+static u_int32 G_txBuf[MAX_BURST];
+static u_int32 G_evMax = 20;	/* events printed per report interval */
+static u_int32 G_evPrinted;
+static u_int64 G_start;
+static u_int64 G_ivStart;
+static volatile int G_stop;
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          0 = no anomaly, 1 = error, 2 = anomalies detected
+ */
+int main(int argc, char *argv[])
+{
+	u_int32 durS = 3600;
+	u_int32 repS = 60;
+	u_int32 speed = 1;
+	u_int32 burst = 64;
+	u_int32 label = 0x10;
+	u_int32 loop = 0;
+	u_int32 i = 0;
+	u_int64 now = 0;
+	int32 got = 0;
+	int progress = 0;
+	int error = 0;
+	int ret = 1;
+	int argi = 1;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+		if (strcmp(argv[argi], "-?") == 0) {
+			Usage();
+			return(1);
+		}
+		if (strcmp(argv[argi], "-L") == 0) {
+			loop = 1;
+			continue;
+		}
+		if (argi + 1 >= argc) {
+			Usage();
+			return(1);
+		}
+		switch (argv[argi++][1]) {
+		case 't': durS  = strtoul(argv[argi], NULL, 0);		break;
+		case 'r': repS  = strtoul(argv[argi], NULL, 0);		break;
+		case 's': speed = strtoul(argv[argi], NULL, 0);		break;
+		case 'b': burst = strtoul(argv[argi], NULL, 0);		break;
+		case 'l': label = strtoul(argv[argi], NULL, 0);		break;
+		case 'e': G_evMax = strtoul(argv[argi], NULL, 0);	break;
+		default:
+			error = 1;
+		}
+		if (error) {
+			Usage();
+			return(1);
+		}
+	}
+	for (; argi < argc; argi++) {
+		if (PairParse(argv[argi])) {
+			Usage();
+			return(1);
+		}
+	}
+	if (G_txNum == 0 || repS == 0 || burst == 0 || burst > MAX_BURST ||
+		label + G_txNum > 0x100) {
+		Usage();
+		return(1);
+	}
+
+	/*--------------------+
+	|  open, configure    |
+	+--------------------*/
+	for (i = 0; i < G_txNum; i++) {
+		G_tx[i].label = (u_int8)(label + i);
+		if ((G_tx[i].path = M_open(G_tx[i].dev)) < 0) {
+			PrintError("open", G_tx[i].dev);
+			goto CLEANUP;
+		}
+		if (M_setstat(G_tx[i].path, Z246_TX_SPEED, speed) < 0 ||
+			M_setstat(G_tx[i].path, Z246_TX_LABEL, G_tx[i].label) < 0 ||
+			M_setstat(G_tx[i].path, Z246_LOOPBACK, loop) < 0) {
+			PrintError("setstat", G_tx[i].dev);
+			goto CLEANUP;
+		}
+	}
+	for (i = 0; i < G_rxNum; i++) {
+		if ((G_rx[i].path = M_open(G_rx[i].dev)) < 0) {
+			PrintError("open", G_rx[i].dev);
+			goto CLEANUP;
+		}
+		if (M_setstat(G_rx[i].path, Z146_RX_SPEED, speed) < 0 ||
+			M_setstat(G_rx[i].path, Z146_RX_SET_LABEL, G_rx[i].tx->label) < 0 ||
+			M_setstat(G_rx[i].path, Z146_RX_RXC_IRQ_STAT, 1) < 0) {
+			PrintError("setstat", G_rx[i].dev);
+			goto CLEANUP;
+		}
+		G_rx[i].bcast = 1;
+	}
+
+	/* discard old data, reset the driver counters */
+	UOS_Delay(DRAIN_MS);
+	for (i = 0; i < G_rxNum; i++) {
+		while ((got = M_getblock(G_rx[i].path, (u_int8*)G_rxBuf,
+								 sizeof(G_rxBuf))) > 0)
+			;
+		if (got < 0) {
+			PrintError("getblock", G_rx[i].dev);
+			goto CLEANUP;
+		}
+		if (DrvCntGet(&G_rx[i], &G_rx[i].iv, &G_rx[i].tx->iv) < 0)
+			goto CLEANUP;
+	}
+	for (i = 0; i < G_txNum; i++)
+		memset(&G_tx[i].iv, 0, sizeof(TX_CNT));
+	for (i = 0; i < G_rxNum; i++)
+		memset(&G_rx[i].iv, 0, sizeof(RX_CNT));
+
+	signal(SIGINT, SigHandler);
+	signal(SIGTERM, SigHandler);
+
+	printf("soak: %lu transmitter(s), %lu receiver(s), %s, burst %lu, "
+		   "duration %lus, report every %lus\n",
+		   (unsigned long)G_txNum, (unsigned long)G_rxNum,
+		   speed ? "100 kHz" : "12.5 kHz", (unsigned long)burst,
+		   (unsigned long)durS, (unsigned long)repS);
+	fflush(stdout);
+
+	/*--------------------+
+	|  traffic            |
+	+--------------------*/
+	G_start = TimeMs();
+	G_ivStart = G_start;
+	while (!G_stop && (durS == 0 || TimeMs() - G_start < (u_int64)durS * 1000)) {
+		progress = 0;
+		for (i = 0; i < G_txNum; i++) {
+			if ((got = Send(&G_tx[i], burst)) < 0)
+				goto CLEANUP;
+			progress |= got;
+		}
+		for (i = 0; i < G_rxNum; i++) {
+			if ((got = Receive(&G_rx[i])) < 0)
+				goto CLEANUP;
+			progress |= got;
+		}
+		now = TimeMs();
+		if (now - G_ivStart >= (u_int64)repS * 1000) {
+			Report("interval", 0);
+			G_ivStart = now;
+		}
+		if (!progress)
+			UOS_Delay(1);
+	}
+
+	/* receive the remaining words */
+	now = TimeMs();
+	while (TimeMs() - now < DRAIN_MS) {
+		progress = 0;
+		for (i = 0; i < G_rxNum; i++) {
+			if ((got = Receive(&G_rx[i])) < 0)
+				goto CLEANUP;
+			progress |= got;
+		}
+		if (progress)
+			now = TimeMs();
+		else
+			UOS_Delay(1);
+	}
+	Report("interval", 0);
+	Report("total", 1);
+
+	ret = 0;
+	for (i = 0; i < G_rxNum; i++) {
+		RX_CNT *c = &G_rx[i].tot;
+
+		if (c->drops || c->dups || c->reorders || c->corrupt ||
+			c->words != G_rx[i].tx->tot.sent)
+			ret = 2;
+	}
+	printf("soak: %s\n", ret ? "ANOMALIES DETECTED" : "no anomalies");
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+CLEANUP:
+	for (i = 0; i < G_rxNum; i++) {
+		if (G_rx[i].path >= 0 && M_close(G_rx[i].path) < 0)
+			PrintError("close", G_rx[i].dev);
+	}
+	for (i = 0; i < G_txNum; i++) {
+		if (G_tx[i].path >= 0 && M_close(G_tx[i].path) < 0)
+			PrintError("close", G_tx[i].dev);
+	}
+	return(ret);
+}
+
+/********************************* PairParse *******************************/
+/** Parse a transmitter and its receivers
+ *
+ *  \param str        \IN  "<txDevice>:<rxDevice>[,<rxDevice>...]"
+ *
+ *  \return	          0 or 1 on error
+ */
+static int PairParse(char *str)
+{
+	TX_DEV *tx = &G_tx[G_txNum];
+	char *rx = strchr(str, ':');
+
+	if (rx == NULL || rx == str || rx[1] == '\0' || G_txNum == MAX_TX)
+		return 1;
+	*rx++ = '\0';
+	tx->dev  = str;
+	tx->path = -1;
+	G_txNum++;
+
+	while (rx) {
+		if (*rx == '\0' || G_rxNum == MAX_RX)
+			return 1;
+		G_rx[G_rxNum].dev  = rx;
+		G_rx[G_rxNum].path = -1;
+		G_rx[G_rxNum].tx   = tx;
+		G_rxNum++;
+		if ((rx = strchr(rx, ',')) != NULL)
+			*rx++ = '\0';
+	}
+	return 0;
+}
+
+/********************************* Send ************************************/
+/** Send the next burst of a transmitter
+ *
+ *  \param tx         \IN  transmitter
+ *  \param burst      \IN  words per M_setblock()
+ *
+ *  \return	          1 = sent, 0 = queue full, -1 on error
+ */
+static int32 Send(TX_DEV *tx, u_int32 burst)
+{
+	u_int32 i = 0;
+
+	for (i = 0; i < burst; i++)
+		G_txBuf[i] = WordData(tx->seq + i, tx->label);
+
+	if (M_setblock(tx->path, (u_int8*)G_txBuf, burst * 4) < 0) {
+		if (UOS_ErrnoGet() == ERR_MBUF_OVERFLOW) {
+			tx->iv.busy++;
+			return 0;
+		}
+		PrintError("setblock", tx->dev);
+		return -1;
+	}
+	tx->seq += burst;
+	tx->iv.sent += burst;
+	return 1;
+}
+
+/********************************* Receive *********************************/
+/** Read and check the received words of a receiver
+ *
+ *  \param rx         \IN  receiver
+ *
+ *  \return	          1 = words received, 0 = none, -1 on error
+ */
+static int32 Receive(RX_DEV *rx)
+{
+	u_int32 evCnt[4];
+	u_int32 evSeq[4];
+	int32 got = 0;
+	int32 i = 0;
+
+	got = M_getblock(rx->path, (u_int8*)G_rxBuf, sizeof(G_rxBuf));
+	if (got < 0) {
+		PrintError("getblock", rx->dev);
+		return -1;
+	}
+	if (got == 0)
+		return 0;
+
+	memset(evCnt, 0, sizeof(evCnt));
+	for (i = 0; i < got / 4; i++)
+		Check(rx, G_rxBuf[i], evCnt, evSeq);
+	rx->iv.words += got / 4;
+
+	if (evCnt[EV_DROP] || evCnt[EV_DUP] || evCnt[EV_REORDER] ||
+		evCnt[EV_CORRUPT])
+		Event(rx, evCnt, evSeq);
+	return 1;
+}
+
+/********************************* Check ***********************************/
+/** Check one received word against the stream of the transmitter
+ *
+ *  \param rx         \IN  receiver
+ *  \param word       \IN  received word
+ *  \param evCnt      \OUT anomalies of the current block are counted
+ *  \param evSeq      \OUT sequence number of the first anomaly per class
+ */
+static void Check(RX_DEV *rx, u_int32 word, u_int32 *evCnt, u_int32 *evSeq)
+{
+	u_int32 data = (word >> 8) & DATA_MASK;
+	u_int32 seq  = data >> 8;
+	u_int32 dist = 0;
+	int ev = -1;
+
+	if ((word & 0xFF) != rx->tx->label ||
+		(data & 0xFF) != Crc8(seq, rx->tx->label)) {
+		rx->iv.corrupt++;
+		rx->corrupt++;
+		ev = EV_CORRUPT;
+	} else {
+		dist = (seq - rx->expect) & SEQ_MASK;
+		/* corrupted words fill the gap */
+		if (dist < SEQ_HALF)
+			dist -= (dist < rx->corrupt) ? dist : rx->corrupt;
+		rx->corrupt = 0;
+		if (dist == 0) {
+			rx->expect = (seq + 1) & SEQ_MASK;
+		} else if (dist < SEQ_HALF) {
+			rx->iv.drops += dist;
+			rx->iv.dropEvents++;
+			rx->expect = (seq + 1) & SEQ_MASK;
+			ev = EV_DROP;
+		} else if (seq == rx->last) {
+			rx->iv.dups++;
+			ev = EV_DUP;
+		} else {
+			/* the late word was counted as dropped before */
+			rx->iv.reorders++;
+			if (rx->iv.drops)
+				rx->iv.drops--;
+			else if (rx->tot.drops)
+				rx->tot.drops--;
+			ev = EV_REORDER;
+		}
+		rx->last = seq;
+	}
+	if (ev >= 0 && evCnt[ev]++ == 0)
+		evSeq[ev] = seq;
+}
+
+/********************************* Event ***********************************/
+/** Correlate the anomalies of a received block with the driver counters
+ *
+ *  Reads the counters of the receiver and its transmitter, which cover
+ *  the time since the last read, and prints them with the anomalies.
+ *
+ *  \param rx         \IN  receiver
+ *  \param evCnt      \IN  anomalies per class
+ *  \param evSeq      \IN  sequence number of the first anomaly per class
+ */
+static void Event(RX_DEV *rx, u_int32 *evCnt, u_int32 *evSeq)
+{
+	static const char *name[4] = { "drop", "dup", "reorder", "corrupt" };
+	RX_CNT rxd;
+	TX_CNT txd;
+	int ev = 0;
+
+	memset(&rxd, 0, sizeof(rxd));
+	memset(&txd, 0, sizeof(txd));
+	DrvCntGet(rx, &rxd, &txd);
+	RxCntAdd(&rx->iv, &rxd);
+	TxCntAdd(&rx->tx->iv, &txd);
+
+	if (G_evPrinted++ >= G_evMax)
+		return;
+
+	printf("t=%lus event %s:", (unsigned long)((TimeMs() - G_start) / 1000),
+		   rx->dev);
+	for (ev = 0; ev < 4; ev++) {
+		if (evCnt[ev])
+			printf(" %s %lu@0x%04lx", name[ev], (unsigned long)evCnt[ev],
+				   (unsigned long)evSeq[ev]);
+	}
+	printf(" | rx ringDropped %lu rejected %lu lineErr %lu/%lu lsr 0x%02lx"
+		   " overrun %lu | tx %s overflows %lu underruns %lu idleGaps %lu\n",
+		   (unsigned long)rxd.ringDropped, (unsigned long)rxd.ringRejected,
+		   (unsigned long)rxd.lineErrIrqs, (unsigned long)rxd.lineErrWords,
+		   (unsigned long)rxd.lineErrLsr, (unsigned long)rxd.overruns,
+		   rx->tx->dev, (unsigned long)txd.overflows,
+		   (unsigned long)txd.underruns, (unsigned long)txd.idleGaps);
+	if (G_evPrinted == G_evMax)
+		printf("t=%lus event limit reached, further events of this interval"
+			   " are only counted\n",
+			   (unsigned long)((TimeMs() - G_start) / 1000));
+	fflush(stdout);
+}
+
+/********************************* DrvCntGet *******************************/
+/** Get and reset the driver counters of a receiver and its transmitter
+ *
+ *  \param rx         \IN  receiver
+ *  \param rxd        \OUT receiver counters are added
+ *  \param txd        \OUT transmitter counters are added
+ *
+ *  \return	          0 or -1 on error
+ */
+static int32 DrvCntGet(RX_DEV *rx, RX_CNT *rxd, TX_CNT *txd)
+{
+	Z146_RX_STATS rxs;
+	Z246_TX_STATS txs;
+	M_SG_BLOCK blk;
+	int32 overrun = 0;
+
+	blk.size = sizeof(rxs);
+	blk.data = (void*)&rxs;
+	if (M_getstat(rx->path, Z146_BLK_RX_STATS, (int32*)&blk) < 0) {
+		PrintError("getstat Z146_BLK_RX_STATS", rx->dev);
+		return -1;
+	}
+	rxd->ringDropped  += rxs.ringDropped;
+	rxd->ringRejected += rxs.ringRejected;
+	rxd->lineErrIrqs  += rxs.lineErrIrqs;
+	rxd->lineErrWords += rxs.lineErrWords;
+	rxd->lineErrLsr   |= rxs.lineErrLsr;
+
+	/* only supported in broadcast mode */
+	if (rx->bcast) {
+		if (M_getstat(rx->path, Z146_RX_OVERRUN, &overrun) < 0)
+			rx->bcast = 0;
+		else
+			rxd->overruns += overrun;
+	}
+
+	blk.size = sizeof(txs);
+	blk.data = (void*)&txs;
+	if (M_getstat(rx->tx->path, Z246_BLK_TX_STATS, (int32*)&blk) < 0) {
+		PrintError("getstat Z246_BLK_TX_STATS", rx->tx->dev);
+		return -1;
+	}
+	txd->overflows += txs.overflows;
+	txd->underruns += txs.underruns;
+	txd->idleGaps  += txs.idleGaps;
+	return 0;
+}
+
+/********************************* Report **********************************/
+/** Print the counters of all paths
+ *
+ *  For an interval report the driver counters are read first, then the
+ *  interval counters are added to the totals and reset.
+ *
+ *  \param what       \IN  "interval" or "total"
+ *  \param final      \IN  print the totals
+ */
+static void Report(char *what, int final)
+{
+	u_int64 now = TimeMs();
+	u_int64 ms = final ? now - G_start : now - G_ivStart;
+	TX_CNT *tc = NULL;
+	RX_CNT *rc = NULL;
+	u_int32 i = 0;
+
+	if (ms == 0)
+		ms = 1;
+	for (i = 0; i < G_rxNum && !final; i++)
+		DrvCntGet(&G_rx[i], &G_rx[i].iv, &G_rx[i].tx->iv);
+
+	for (i = 0; i < G_txNum; i++) {
+		tc = final ? &G_tx[i].tot : &G_tx[i].iv;
+		printf("t=%lus %s tx %s label 0x%02x: sent %lu rate %lu/s busy %lu | "
+			   "overflows %lu underruns %lu idleGaps %lu\n",
+			   (unsigned long)((now - G_start) / 1000), what, G_tx[i].dev,
+			   G_tx[i].label, (unsigned long)tc->sent,
+			   (unsigned long)((u_int64)tc->sent * 1000 / ms),
+			   (unsigned long)tc->busy, (unsigned long)tc->overflows,
+			   (unsigned long)tc->underruns, (unsigned long)tc->idleGaps);
+		if (!final) {
+			TxCntAdd(&G_tx[i].tot, &G_tx[i].iv);
+			memset(&G_tx[i].iv, 0, sizeof(TX_CNT));
+		}
+	}
+	for (i = 0; i < G_rxNum; i++) {
+		rc = final ? &G_rx[i].tot : &G_rx[i].iv;
+		printf("t=%lus %s rx %s: words %lu rate %lu/s drop %lu (%lu gaps) "
+			   "dup %lu reorder %lu corrupt %lu loss %luppm | ringDropped %lu "
+			   "rejected %lu lineErr %lu/%lu lsr 0x%02lx overrun %lu "
+			   "unexplained %lu\n",
+			   (unsigned long)((now - G_start) / 1000), what, G_rx[i].dev,
+			   (unsigned long)rc->words,
+			   (unsigned long)((u_int64)rc->words * 1000 / ms),
+			   (unsigned long)rc->drops, (unsigned long)rc->dropEvents,
+			   (unsigned long)rc->dups, (unsigned long)rc->reorders,
+			   (unsigned long)rc->corrupt,
+			   (unsigned long)(rc->words + rc->drops ? (u_int64)rc->drops *
+				   1000000 / (rc->words + rc->drops) : 0),
+			   (unsigned long)rc->ringDropped, (unsigned long)rc->ringRejected,
+			   (unsigned long)rc->lineErrIrqs, (unsigned long)rc->lineErrWords,
+			   (unsigned long)rc->lineErrLsr, (unsigned long)rc->overruns,
+			   (unsigned long)Unexplained(rc));
+		if (!final) {
+			RxCntAdd(&G_rx[i].tot, &G_rx[i].iv);
+			memset(&G_rx[i].iv, 0, sizeof(RX_CNT));
+		}
+	}
+	if (final) {
+		for (i = 0; i < G_rxNum; i++)
+			printf("t=%lus total rx %s: received %lu of %lu sent words\n",
+				   (unsigned long)((now - G_start) / 1000), G_rx[i].dev,
+				   (unsigned long)G_rx[i].tot.words,
+				   (unsigned long)G_rx[i].tx->tot.sent);
+	}
+	G_evPrinted = 0;
+	fflush(stdout);
+}
+
+/********************************* Unexplained *****************************/
+/** Dropped words not covered by the driver counters
+ *
+ *  \param c          \IN  receiver counters
+ *
+ *  \return	          words
+ */
+static u_int32 Unexplained(RX_CNT *c)
+{
+	u_int32 known = c->ringDropped + c->ringRejected + c->lineErrWords +
+					c->overruns;
+
+	return (c->drops > known) ? c->drops - known : 0;
+}
+
+/********************************* TxCntAdd ********************************/
+/** Add transmitter counters
+ *
+ *  \param dst        \IN  counters, \OUT sum
+ *  \param src        \IN  counters to add
+ */
+static void TxCntAdd(TX_CNT *dst, TX_CNT *src)
+{
+	dst->sent      += src->sent;
+	dst->busy      += src->busy;
+	dst->overflows += src->overflows;
+	dst->underruns += src->underruns;
+	dst->idleGaps  += src->idleGaps;
+}
+
+/********************************* RxCntAdd ********************************/
+/** Add receiver counters
+ *
+ *  \param dst        \IN  counters, \OUT sum
+ *  \param src        \IN  counters to add
+ */
+static void RxCntAdd(RX_CNT *dst, RX_CNT *src)
+{
+	dst->words        += src->words;
+	dst->drops        += src->drops;
+	dst->dropEvents   += src->dropEvents;
+	dst->dups         += src->dups;
+	dst->reorders     += src->reorders;
+	dst->corrupt      += src->corrupt;
+	dst->ringDropped  += src->ringDropped;
+	dst->ringRejected += src->ringRejected;
+	dst->lineErrIrqs  += src->lineErrIrqs;
+	dst->lineErrWords += src->lineErrWords;
+	dst->lineErrLsr   |= src->lineErrLsr;
+	dst->overruns     += src->overruns;
+}
+
+/********************************* Crc8 ************************************/
+/** CRC-8 (poly 0x07) over the sequence number and the label
+ *
+ *  \param seq        \IN  sequence number
+ *  \param label      \IN  label of the stream
+ *
+ *  \return	          CRC
+ */
+static u_int8 Crc8(u_int32 seq, u_int8 label)
+{
+	u_int8 msg[3];
+	u_int8 crc = 0;
+	u_int32 i = 0;
+	u_int32 b = 0;
+
+	msg[0] = (u_int8)((seq >> 8) & 0x7F);
+	msg[1] = (u_int8)seq;
+	msg[2] = label;
+	for (i = 0; i < sizeof(msg); i++) {
+		crc ^= msg[i];
+		for (b = 0; b < 8; b++)
+			crc = (u_int8)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+	}
+	return crc;
+}
+
+/********************************* WordData ********************************/
+/** Data field of a word
+ *
+ *  \param seq        \IN  sequence number (only the lower 15 bits are used)
+ *  \param label      \IN  label of the stream
+ *
+ *  \return	          data field
+ */
+static u_int32 WordData(u_int32 seq, u_int8 label)
+{
+	seq &= SEQ_MASK;
+	return (seq << 8) | Crc8(seq, label);
+}
+
+/********************************* TimeMs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [ms]
+ */
+static u_int64 TimeMs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/********************************* SigHandler ******************************/
+/** Stop the test on SIGINT/SIGTERM, the totals are printed
+ */
+static void SigHandler(int sig)
+{
+	G_stop = 1;
+}
+
+/********************************* Usage ***********************************/
+/** Print program usage
+ */
+static void Usage(void)
+{
+	printf("Syntax: z146_soak [<opts>] <txDevice>:<rxDevice>[,<rxDevice>...] [...]\n");
+	printf("Function: soak test with sequence checked traffic, every transmitter\n");
+	printf("          sends on its own label to the listed receivers\n");
+	printf("Options:\n");
+	printf("    -t s       duration, 0 = until Ctrl-C       (default 3600)\n");
+	printf("    -r s       report interval                  (default 60)\n");
+	printf("    -s speed   0 = 12.5 kHz, 1 = 100 kHz        (default 1)\n");
+	printf("    -b words   words per M_setblock() 1..%d    (default 64)\n",
+		   MAX_BURST);
+	printf("    -l label   label of the first transmitter   (default 0x10)\n");
+	printf("    -e num     events printed per interval      (default 20)\n");
+	printf("    -L         loop back mode of the transmitters\n");
+	printf("Up to %d transmitters and %d receivers.\n", MAX_TX, MAX_RX);
+	printf("Exit code: 0 = no anomaly, 1 = error, 2 = anomalies detected\n");
+	printf("\n");
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ *  \param dev        \IN  device name
+ */
+static void PrintError(char *info, char *dev)
+{
+	printf("*** can't %s %s: %s\n", info, dev, M_errstring(UOS_ErrnoGet()));
+}
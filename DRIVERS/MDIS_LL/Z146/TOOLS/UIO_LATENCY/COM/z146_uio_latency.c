@@ -0,0 +1,231 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                   Z146_UIO_LATENCY                 ************
+ ************                                                    ************
+ ****************************************************************************/
+/*!
+ *         \file z146_uio_latency.c
+ *
+ *       \brief  Loopback latency of the MDIS path and the polled UIO path
+ *
+ *               Sends single words on the transmitter and measures the
+ *               time until they are read from the receiver, either with
+ *               M_write()/M_getblock() through the drivers or with the
+ *               polled user space access of z146_uio.h. The receiver must
+ *               get the transmitter data (wired or TX loop mode) and
+ *               accept label 1.
+ *
+ *     Required: libraries: mdis_api, usr_oss, z146_uio
+ *     \switches (none)
+ */
+/*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2003 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/usr_oss.h>
+#include <MEN/z146_drv.h>
+#include <MEN/z246_drv.h>
+#include <MEN/z146_regs.h>
+#include <MEN/z146_uio.h>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define MAX_SAMPLES		100000
+#define RX_BUF_LEN		256
+#define TIMEOUT_US		100000		/* max. wait for one word */
+#define LABEL			1
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void PrintError(char *info);
+static u_int32 TimeUs(void);
+static int CmpU32(const void *a, const void *b);
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static u_int32 G_lat[MAX_SAMPLES];
+
+/********************************* main ************************************/
+/** Program main function
+ *
+ *  \param argc       \IN  argument counter
+ *  \param argv       \IN  argument vector
+ *
+ *  \return	          success (0) or error (1)
+ */
+int main(int argc, char *argv[])
+{
+	MDIS_PATH rxPath = -1;
+	MDIS_PATH txPath = -1;
+	Z146_UIO rxUio;
+	Z146_UIO txUio;
+	u_int8 label = LABEL;
+	u_int32 rxBuf[RX_BUF_LEN];
+	u_int32 count = 1000;
+	u_int32 lost = 0;
+	u_int32 n = 0;
+	u_int32 i = 0;
+	u_int32 t0 = 0;
+	u_int32 data = 0;
+	u_int64 sum = 0;
+	int32 got = 0;
+	int useUio = 0;
+	int argi = 1;
+
+	if (argc < 3 || strcmp(argv[1],"-?")==0) {
+		printf("Syntax: z146_uio_latency [-u] <rxDevice> <txDevice> [<count>]\n");
+		printf("Function: loopback latency of single words\n");
+		printf("Options:\n");
+		printf("    -u         devices are UIO devices (e.g. /dev/uio0), the\n");
+		printf("               cores are polled from user space\n");
+		printf("    count      number of words (default 1000, max. %d)\n", MAX_SAMPLES);
+		printf("\n");
+		return(1);
+	}
+
+	if (strcmp(argv[argi], "-u") == 0) {
+		useUio = 1;
+		argi++;
+	}
+	if (argc < argi + 2) {
+		printf("*** missing device\n");
+		return(1);
+	}
+	if (argc > argi + 2)
+		count = strtoul(argv[argi + 2], NULL, 0);
+	if (count == 0 || count > MAX_SAMPLES)
+		count = MAX_SAMPLES;
+
+	/*--------------------+
+	|  open               |
+	+--------------------*/
+	if (useUio) {
+		if (Z146_UioOpen(&rxUio, argv[argi], 0) != 0 ||
+			Z146_UioOpen(&txUio, argv[argi + 1], 0) != 0) {
+			printf("*** can't map %s or %s\n", argv[argi], argv[argi + 1]);
+			return(1);
+		}
+		/* 100 kHz, parity, label filter */
+		Z146_UioRxInit(&rxUio, Z146_RX_SPEED_MASK | Z146_RX_PAR_EN_MASK |
+					   Z146_RX_LAB_EN_MASK, Z146_RX_FCR_DEFAULT, &label, 1);
+		Z146_UioTxInit(&txUio, Z246_TX_SPEED_MASK | Z246_TX_PAR_EN_MASK, label);
+	} else {
+		if ((rxPath = M_open(argv[argi])) < 0) {
+			PrintError("open");
+			return(1);
+		}
+		if ((txPath = M_open(argv[argi + 1])) < 0) {
+			PrintError("open");
+			M_close(rxPath);
+			return(1);
+		}
+		M_setstat(rxPath, Z146_RX_SET_LABEL, label);
+		M_setstat(txPath, Z246_TX_LABEL, label);
+		/* discard old data */
+		while (M_getblock(rxPath, (u_int8*)rxBuf, sizeof(rxBuf)) > 0)
+			;
+	}
+
+	/*--------------------+
+	|  measure            |
+	+--------------------*/
+	for (i = 0; i < count; i++) {
+		data = i & Z246_23_BIT_MASK;
+		t0 = TimeUs();
+
+		if (useUio)
+			Z146_UioTxWrite(&txUio, &data, 1);
+		else if (M_write(txPath, data) < 0) {
+			PrintError("write");
+			break;
+		}
+
+		do {
+			if (useUio)
+				got = Z146_UioRxPoll(&rxUio, rxBuf, RX_BUF_LEN);
+			else
+				got = M_getblock(rxPath, (u_int8*)rxBuf, sizeof(rxBuf)) / 4;
+		} while (got <= 0 && (TimeUs() - t0) < TIMEOUT_US);
+
+		if (got <= 0 || ((rxBuf[got - 1] >> 8) & Z246_23_BIT_MASK) != data) {
+			lost++;
+			continue;
+		}
+		G_lat[n++] = TimeUs() - t0;
+	}
+
+	/*--------------------+
+	|  result             |
+	+--------------------*/
+	if (n != 0) {
+		qsort(G_lat, n, sizeof(u_int32), CmpU32);
+		for (i = 0; i < n; i++)
+			sum += G_lat[i];
+		printf("%s path, %lu words, %lu lost\n", useUio ? "UIO" : "MDIS",
+			   (unsigned long)n, (unsigned long)lost);
+		printf("latency [us]: min %lu  avg %lu  p99 %lu  max %lu\n",
+			   (unsigned long)G_lat[0], (unsigned long)(sum / n),
+			   (unsigned long)G_lat[(n * 99) / 100], (unsigned long)G_lat[n - 1]);
+	} else {
+		printf("*** no word received (%lu lost)\n", (unsigned long)lost);
+	}
+
+	/*--------------------+
+	|  cleanup            |
+	+--------------------*/
+	if (useUio) {
+		Z146_UioClose(&rxUio);
+		Z146_UioClose(&txUio);
+	} else {
+		if (M_close(rxPath) < 0)
+			PrintError("close");
+		if (M_close(txPath) < 0)
+			PrintError("close");
+	}
+	return(n != 0 ? 0 : 1);
+}
+
+/********************************* TimeUs **********************************/
+/** Get a monotonic time stamp
+ *
+ *  \return	          time [us]
+ */
+static u_int32 TimeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u_int32)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/********************************* CmpU32 **********************************/
+/** qsort() compare function
+ */
+static int CmpU32(const void *a, const void *b)
+{
+	u_int32 x = *(const u_int32*)a;
+	u_int32 y = *(const u_int32*)b;
+
+	return (x > y) - (x < y);
+}
+
+/********************************* PrintError ******************************/
+/** Print MDIS error message
+ *
+ *  \param info       \IN  info string
+ */
+static void PrintError(char *info)
+{
+	printf("*** can't %s: %s\n", info, M_errstring(UOS_ErrnoGet()));
+}
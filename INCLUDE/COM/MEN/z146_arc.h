@@ -0,0 +1,160 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  z146_arc.h
+ *
+ *       \brief  Indexed capture archive of z146_archive and functions to
+ *               write and query it
+ *
+ *               An archive holds the records of a capture partitioned by
+ *               channel and label into series. Each series is stored in
+ *               chunks of up to Z146_ARC_HDR.chunkWords words in time
+ *               order:
+ *
+ *               Z146_ARC_HDR | chunk | chunk | ... | Z146_ARC_IDX[idxNum]
+ *
+ *               The index has one entry per chunk with channel, label,
+ *               time range and file position, sorted by channel, label
+ *               and time, so a query reads only the chunks of its series
+ *               and time range. Header and index are stored little
+ *               endian like a capture file, the chunks are byte streams.
+ *
+ *               A chunk has no header, the words are encoded relative to
+ *               the previous word of the chunk as unsigned LEB128
+ *               varints of zigzag coded differences:
+ *               - time: difference to the previous time difference (0 for
+ *                 periodic labels), the first word starts at the tFirst of
+ *                 the index entry with a difference of 0
+ *               - value: difference to the previous value (start 0); the
+ *                 value is bits 31..8 of the received word, for loss series
+ *                 the number of lost words
+ *
+ *               Periodic labels with slowly changing values encode to
+ *               about two bytes per word, runs of equal bytes which
+ *               general purpose compressors reduce further. The
+ *               Z146_CAP_F_BATCH flag of the capture is not stored,
+ *               Z146_CAP_F_TIME_EST is kept for the whole archive in
+ *               Z146_ARC_HDR.recFlags.
+ *
+ *    \switches  (none)
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _Z146_ARC_H
+#define _Z146_ARC_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define Z146_ARC_MAGIC			0x5A314152	/**< "Z1AR" */
+#define Z146_ARC_VERSION		1
+#define Z146_ARC_HDR_SIZE		256			/**< sizeof(Z146_ARC_HDR) */
+#define Z146_ARC_CHUNK_WORDS	4096		/**< default words per chunk */
+#define Z146_ARC_CHUNK_MAX		16384		/**< max. bytes per chunk */
+
+/** \name series labels above the ARINC labels 0..0377 */
+/**@{*/
+#define Z146_ARC_LOSS_DRV		0x100	/**< loss records Z146_CAP_F_LOSS_DRV */
+#define Z146_ARC_LOSS_LINE		0x101	/**< loss records Z146_CAP_F_LOSS_LINE */
+#define Z146_ARC_LOSS_CAP		0x102	/**< loss records Z146_CAP_F_LOSS_CAP */
+#define Z146_ARC_LABELS			0x103	/**< series per channel */
+#define Z146_ARC_ANY			-1		/**< query: any channel or label */
+/**@}*/
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** file header */
+typedef struct {
+	u_int32	magic;			/**< Z146_ARC_MAGIC */
+	u_int16	version;		/**< Z146_ARC_VERSION */
+	u_int16	hdrSize;		/**< Z146_ARC_HDR_SIZE */
+	u_int16	chNum;			/**< channels of the capture */
+	u_int16	recFlags;		/**< Z146_CAP_F_TIME_EST of the data records */
+	u_int32	speed;			/**< bit n set: channel n at 100 kHz */
+	u_int64	startUs;		/**< capture start [us since 1970] */
+	u_int64	idxOff;			/**< file position of the index */
+	u_int32	idxNum;			/**< index entries (chunks) */
+	u_int32	chunkWords;		/**< max. words per chunk */
+	u_int64	words;			/**< records stored */
+	u_int64	tFirst;			/**< time of the first record [us since 1970] */
+	u_int64	tLast;			/**< time of the last record */
+	char	chName[Z146_CAP_CH_MAX][Z146_CAP_NAME_LEN];	/**< device names */
+} Z146_ARC_HDR;
+
+/** index entry of a chunk */
+typedef struct {
+	u_int64	off;			/**< file position */
+	u_int64	tFirst;			/**< time of the first word [us since 1970] */
+	u_int64	tLast;			/**< time of the last word */
+	u_int32	size;			/**< bytes */
+	u_int32	words;			/**< words */
+	u_int8	chan;			/**< channel */
+	u_int8	reserved;
+	u_int16	label;			/**< label 0..0377 or Z146_ARC_LOSS_xxx */
+	u_int32	reserved2;
+} Z146_ARC_IDX;
+
+/** archive being written */
+typedef struct {
+	void			*fp;		/**< stdio stream */
+	Z146_ARC_HDR	hdr;		/**< file header */
+	void			*ser;		/**< series being collected */
+	Z146_ARC_IDX	*idx;		/**< index */
+	u_int32			idxMax;		/**< allocated index entries */
+	u_int64			off;		/**< file position of the next chunk */
+} Z146_ARC_WRITER;
+
+/** archive opened for queries */
+typedef struct {
+	void			*fp;		/**< stdio stream */
+	Z146_ARC_HDR	hdr;		/**< file header */
+	Z146_ARC_IDX	*idx;		/**< index, hdr.idxNum entries */
+} Z146_ARC_FILE;
+
+/** query, see Z146_ArcQueryInit() */
+typedef struct {
+	Z146_ARC_FILE	*af;
+	int32			chan;		/**< channel or Z146_ARC_ANY */
+	int32			label;		/**< label or Z146_ARC_ANY */
+	u_int64			fromUs;		/**< time range [us since 1970] */
+	u_int64			toUs;
+	u_int32			next;		/**< next index entry */
+	u_int32			chunksRead;	/**< chunks read so far */
+	/* chunk being decoded */
+	Z146_ARC_IDX	*cur;
+	u_int32			pos;		/**< byte position */
+	u_int32			left;		/**< words left */
+	u_int64			t;
+	int64			dt;
+	u_int32			v;
+	u_int8			buf[Z146_ARC_CHUNK_MAX];
+} Z146_ARC_QUERY;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern int32 Z146_ArcCreate(Z146_ARC_WRITER *aw, const char *name,
+							const Z146_CAP_HDR *cap, u_int32 chunkWords);
+extern int32 Z146_ArcPut(Z146_ARC_WRITER *aw, const Z146_CAP_REC *rec);
+extern int32 Z146_ArcFinish(Z146_ARC_WRITER *aw);
+extern int32 Z146_ArcOpen(Z146_ARC_FILE *af, const char *name);
+extern void Z146_ArcQueryInit(Z146_ARC_QUERY *q, Z146_ARC_FILE *af,
+							  int32 chan, int32 label,
+							  u_int64 fromUs, u_int64 toUs);
+extern int32 Z146_ArcQueryRead(Z146_ARC_QUERY *q, Z146_CAP_REC *rec,
+							   u_int32 max);
+extern void Z146_ArcClose(Z146_ARC_FILE *af);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _Z146_ARC_H */
@@ -0,0 +1,111 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  z146_cap.h
+ *
+ *       \brief  Capture file format of z146_capture and functions to
+ *               read it
+ *
+ *               A capture file is a Z146_CAP_HDR followed by fixed size
+ *               Z146_CAP_REC records in the order they were captured.
+ *               All fields are stored little endian on every host, the
+ *               structures are converted with Z146_CapHdrLe() and
+ *               Z146_CapRecLe() before a write and after a read.
+ *
+ *    \switches  (none)
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _Z146_CAP_H
+#define _Z146_CAP_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define Z146_CAP_MAGIC			0x5A314341	/**< "Z1CA" */
+#define Z146_CAP_VERSION		1
+#define Z146_CAP_HDR_SIZE		256			/**< sizeof(Z146_CAP_HDR) */
+#define Z146_CAP_CH_MAX			8			/**< channels per file */
+#define Z146_CAP_NAME_LEN		24			/**< channel name incl. '\\0' */
+
+/** \name record flags (Z146_CAP_REC.flags) */
+/**@{*/
+#define Z146_CAP_F_BATCH		0x01	/**< first word of a M_getblock() batch */
+#define Z146_CAP_F_TIME_EST		0x02	/**< time estimated from the read time */
+#define Z146_CAP_F_LOSS_DRV		0x10	/**< loss record: words lost in the driver buffer */
+#define Z146_CAP_F_LOSS_LINE	0x20	/**< loss record: words discarded with a line error */
+#define Z146_CAP_F_LOSS_CAP		0x40	/**< loss record: words dropped by the capture, no write buffer free */
+#define Z146_CAP_F_LOSS			0x70	/**< any loss record */
+/**@}*/
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** file header */
+typedef struct {
+	u_int32	magic;			/**< Z146_CAP_MAGIC */
+	u_int16	version;		/**< Z146_CAP_VERSION */
+	u_int16	hdrSize;		/**< Z146_CAP_HDR_SIZE */
+	u_int16	recSize;		/**< sizeof(Z146_CAP_REC) */
+	u_int16	chNum;			/**< channels */
+	u_int32	speed;			/**< bit n set: channel n at 100 kHz */
+	u_int64	startUs;		/**< capture start [us since 1970] */
+	u_int32	fileNo;			/**< number of the file in a split capture */
+	u_int32	parEn;			/**< bit n set: receiver n checks parity (Z146_PAR_EN) */
+	u_int32	parTyp;			/**< bit n set: receiver n even parity (Z146_PAR_TYP) */
+	char	chName[Z146_CAP_CH_MAX][Z146_CAP_NAME_LEN];	/**< device names */
+	u_int8	pad[Z146_CAP_HDR_SIZE - 36 - Z146_CAP_CH_MAX * Z146_CAP_NAME_LEN];
+} Z146_CAP_HDR;
+
+/** record
+ *
+ *  Data records carry a received word as returned by M_getblock() (label
+ *  in bits 7..0). The driver has no receive time per word, so the time
+ *  is synthesized: the M_getblock() return time minus the word time of
+ *  the words behind it in the batch. Such records have the
+ *  Z146_CAP_F_TIME_EST flag; their intervals are exact within a batch
+ *  of back-to-back words only, gaps and jitter of a label are blurred
+ *  by up to the read interval of the capture. Loss records carry the
+ *  number of lost words in word and one of the Z146_CAP_F_LOSS_xxx flags.
+ */
+typedef struct {
+	u_int64	timeUs;			/**< time [us since 1970] */
+	u_int32	word;			/**< received word or lost words */
+	u_int8	chan;			/**< channel 0..chNum-1 */
+	u_int8	flags;			/**< Z146_CAP_F_xxx */
+	u_int16	reserved;
+} Z146_CAP_REC;
+
+/** capture file opened for reading */
+typedef struct {
+	void			*fp;		/**< stdio stream */
+	Z146_CAP_HDR	hdr;		/**< file header */
+	u_int64			recNum;		/**< records in the file */
+} Z146_CAP_FILE;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern void Z146_CapHdrInit(Z146_CAP_HDR *hdr);
+extern void Z146_CapHdrLe(Z146_CAP_HDR *hdr);
+extern void Z146_CapRecLe(Z146_CAP_REC *rec, u_int32 num);
+extern u_int16 Z146_CapLe16(u_int16 v);
+extern u_int32 Z146_CapLe32(u_int32 v);
+extern u_int64 Z146_CapLe64(u_int64 v);
+extern int32 Z146_CapOpen(Z146_CAP_FILE *cf, const char *name);
+extern int32 Z146_CapRead(Z146_CAP_FILE *cf, Z146_CAP_REC *rec, u_int32 max);
+extern int32 Z146_CapSeek(Z146_CAP_FILE *cf, u_int64 rec);
+extern void Z146_CapClose(Z146_CAP_FILE *cf);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _Z146_CAP_H */
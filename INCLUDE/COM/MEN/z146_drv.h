@@ -38,7 +38,60 @@
 /*-----------------------------------------+
 |  TYPEDEFS                                |
 +-----------------------------------------*/
-
+/** line configuration, see #Z146_BLK_LINE_CFG */
+typedef struct {
+	u_int32 speed;			/**< 0 = 12.5 kHz, 1 = 100 kHz */
+	u_int32 errWe;			/**< error write enable */
+	u_int32 parEn;			/**< parity enable */
+	u_int32 parTyp;			/**< parity type */
+	u_int32 labEn;			/**< label enable */
+	u_int32 sdiEn;			/**< source/destination identifier enable */
+	u_int32 sdi;			/**< source/destination identifier 0..3 */
+	u_int32 flush;			/**< S: 1 = discard received data in the FIFO and the ring buffer */
+} Z146_LINE_CFG;
+
+
+#define Z146_IRQLAT_BINS		16		/**< histogram bins of Z146_IRQLAT */
+
+/** interrupt instrumentation, see #Z146_BLK_IRQLAT
+ *
+ *  All values except resUs are reset when read. Histogram bin 0 counts
+ *  the value 0, bin n the values 2^(n-1)..2^n-1 and the last bin all
+ *  larger values. The threshold latency is computed from the FIFO level
+ *  at ISR entry and the word time, so its resolution is one word. The
+ *  threshold in words is the lowest FIFO level seen at a threshold
+ *  interrupt since the threshold level was set.
+ */
+typedef struct {
+	u_int32 irqs;			/**< interrupts handled */
+	u_int32 words;			/**< words handled */
+	u_int32 maxWords;		/**< max. words per interrupt */
+	u_int32 durMaxUs;		/**< max. ISR execution time [us] */
+	u_int32 durSumUs;		/**< sum of the ISR execution times [us] */
+	u_int32 latNum;			/**< interrupts with a threshold latency */
+	u_int32 latMaxUs;		/**< max. time from FIFO threshold to ISR entry [us] */
+	u_int32 latSumUs;		/**< sum of the threshold latencies [us] */
+	u_int32 resUs;			/**< resolution of the execution time [us] */
+	u_int32 durHist[Z146_IRQLAT_BINS];		/**< ISR execution time [us] */
+	u_int32 wordsHist[Z146_IRQLAT_BINS];	/**< words per interrupt */
+	u_int32 latHist[Z146_IRQLAT_BINS];		/**< time from FIFO threshold to ISR entry [us] */
+} Z146_IRQLAT;
+
+/** receive statistics, see #Z146_BLK_RX_STATS
+ *
+ *  All counters are reset when the statistics are read. Words discarded
+ *  by a line error are counted from RXC when the error interrupt is
+ *  handled, so they are only counted with the RX interrupt enabled.
+ */
+typedef struct {
+	u_int32 wordsStored;	/**< words stored in the ring buffer */
+	u_int32 ringDropped;	/**< oldest words overwritten (drop old policy) */
+	u_int32 ringRejected;	/**< new words discarded because the ring buffer was full */
+	u_int32 maxRingDepth;	/**< maximum number of words in the ring buffer (consuming mode) */
+	u_int32 lineErrIrqs;	/**< line status interrupts */
+	u_int32 lineErrWords;	/**< words discarded by a line error */
+	u_int32 lineErrLsr;		/**< LSR error bits seen since the last read (ORed) */
+} Z146_RX_STATS;
 
 /*-----------------------------------------+
 |  DEFINES                                 |
@@ -65,6 +118,16 @@
 #define Z146_RX_RESET_LABEL      M_DEV_OF+0x10    /**<   S: Set RX_LA  RX Label reset. */
 #define Z146_SET_ERROR_SIGNAL    M_DEV_OF+0x11    /**<   S: Set signal sent on error IRQ  */
 #define Z146_CLR_ERROR_SIGNAL    M_DEV_OF+0x12    /**<   S: Uninstall error signal        */
+#define Z146_RX_LABEL_CFG_US     M_DEV_OF+0x13    /**< G  : Get duration of the last label change [us]. */
+#define Z146_RX_LABEL_GATED      M_DEV_OF+0x14    /**< G  : Get and reset words dropped by the software label filter. */
+#define Z146_RX_OVERRUN          M_DEV_OF+0x15    /**< G  : Get and reset words lost by the reader of the channel (broadcast mode). */
+#define Z146_RX_READER_SYNC      M_DEV_OF+0x16    /**<   S: Move the reader of the channel to the newest word (broadcast mode). */
+
+/* Z146 specific Getstat/Setstat block codes */
+#define Z146_BLK_LINE_CFG        M_DEV_BLK_OF+0x01 /**< G,S: Get/Set complete line configuration (Z146_LINE_CFG). */
+#define Z146_BLK_RX_LABELS       M_DEV_BLK_OF+0x02 /**< G,S: Get/Set complete receive label list (one byte per label). */
+#define Z146_BLK_IRQLAT          M_DEV_BLK_OF+0x03 /**< G  : Get and reset interrupt instrumentation (Z146_IRQLAT). */
+#define Z146_BLK_RX_STATS        M_DEV_BLK_OF+0x04 /**< G  : Get and reset receive statistics (Z146_RX_STATS). */
 
 /**@}*/
 
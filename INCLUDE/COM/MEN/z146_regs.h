@@ -0,0 +1,139 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  z146_regs.h
+ *
+ *       \brief  Register map of the 16Z146 ARINC 429 receiver and the
+ *               16Z246 ARINC 429 transmitter
+ *
+ *               Shared by the low-level drivers and the user space
+ *               access library, see z146_uio.h.
+ *
+ *    \switches  (none)
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _Z146_REGS_H
+#define _Z146_REGS_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  16Z146 receiver                         |
++-----------------------------------------*/
+#define Z146_STAT_REG				0x400			/**< Offset of the status register. */
+#define Z146_LSR_REG_OFFSET			0x402		/**< Offset of the LSR status register. */
+#define Z146_LSR_RESET_VAL 			0x1E		/**< Reset value of the LSR status register. */
+#define Z146_RX_IRQ_MASK    		0x7			/**< Receive IRQ mask. */
+#define Z146_RX_RXC_OFFSET			0x03		/**< Status register for received word count. */
+#define Z146_RX_RXC_REG_OFFSET  	0x403		/**< Status register for received word count. */
+
+#define Z146_RX_RXA_OFFSET			0x404		/**< Status register for acknowledge word count. */
+
+#define Z146_RX_IER_OFFSET			0x408		/**< Offset of the RX interrupt register */
+#define Z146_RX_IER_DEFAULT			0x3		    /**< Default value of the RX interrupt register */
+
+#define Z146_RX_RXCIEN_OFFSET		0x0	    	/**< Offset of the RX and character timout interrupt enable bit. */
+#define Z146_RX_RXCIEN_MASK 		0x1	    	/**< Mask of the RX and character timout interrupt enable bit. */
+#define Z146_RX_RLSIEN_OFFSET		0x1  		/**< Offset of the receive line status interrupt enable bit. */
+#define Z146_RX_RLSIEN_MASK  		0x2  		/**< Mask of the receive line status interrupt enable bit. */
+
+#define Z146_RX_LCR_OFFSET			0x409		/**< Offset of the RX_LCR register */
+#define Z146_RX_LCR_DEFAULT			0x17		/**< Default value of the RX_LCR register */
+
+
+#define Z146_RX_SPEED_OFFSET		0x00		/**< Offset of the register RX_LCR RX_SPEED bit */
+#define Z146_RX_SPEED_MASK  		0x01		/**< Mask of the register RX_LCR RX_SPEED bit */
+#define Z146_RX_ERR_WE_OFFSET		0x01		/**< Offset of the register RX_LCR RX error write enable bit */
+#define Z146_RX_ERR_WE_MASK			0x02		/**< Mask of the register RX_LCR RX error write enable bit */
+#define Z146_RX_PAR_EN_OFFSET		0x02		/**< Offset of the register RX_LCR RX parity enable bit */
+#define Z146_RX_PAR_EN_MASK 		0x04		/**< Mask of the register RX_LCR RX parity enable bit */
+#define Z146_RX_PAR_TYP_OFFSET		0x03		/**< Offset of the register RX_LCR RX parity type bit */
+#define Z146_RX_PAR_TYP_MASK		0x08		/**< Mask of the register RX_LCR RX parity type bit */
+#define Z146_RX_LAB_EN_OFFSET		0x04		/**< Offset of the register RX_LCR RX label enable bit */
+#define Z146_RX_LAB_EN_MASK			0x10		/**< Mask of the register RX_LCR RX label enable bit */
+#define Z146_RX_SDI_EN_OFFSET		0x05		/**< Offset of the register RX_LCR RX source/destination identifier enable bit */
+#define Z146_RX_SDI_EN_MASK  		0x20		/**< Mask of the register RX_LCR RX source/destination identifier enable bit */
+#define Z146_RX_SDI_OFFSET	     	0x06		/**< Offset of the register RX_LCR RX source/destination identifier mask */
+#define Z146_RX_SDI_MASK	     	0xC0		/**< Mask of the register RX_LCR RX source/destination identifier mask */
+#define Z146_RX_SDI_MAX  	     	0x03		/**< RX_LCR RX source/destination identifier max value */
+#define Z146_RX_THR_LEV_MASK		0x07		/**< Offset of the register RX_LCR RX threshold level mask */
+
+#define Z146_RX_FCR_OFFSET			0x40A		/**< Offset of the RX_FCR register */
+#define Z146_RX_FCR_DEFAULT			0x5			/**< Default value of the RX_FCR register */
+
+#define Z146_RX_TIMEOUT_OFFSET		0x414		/**< Offset of the RX timeout register */
+#define Z146_RX_TIMEOUT_DEFAULT		0x1E		/**< Default value of the RX timeout register */
+
+
+#define Z146_RX_LA_OFFSET			0x480		/**< Offset of the receive labels register */
+#define Z146_RX_LA_SIZE				16			/**< Size of the receive labels register in bytes */
+#define Z146_RX_LA_DEFAULT			0		    /**< Default value of the receive label register */
+
+#define Z146_RX_LA_NUM_OFFSET		0x40B		/**< Offset of the RX label numbers register */
+#define Z146_RX_LA_NUM_DEFAULT		0		    /**< Default value of the RX label numbers register */
+#define Z146_RX_LA_NUM_MASK 		0x1F		/**< Bit mask of the RX label numbers register */
+
+#define Z146_RX_FIFO_START_ADDR		0x000		/**< Receive FIFO start address. */
+#define Z146_RX_FIFO_LEN			255		    /**< Receive FIFO size. */
+
+#define Z146_RX_LINE_STAT_IRQ		1			/**< Receive line status interrupt offset */
+#define Z146_RX_DATA_AVAIL_IRQ		2			/**< Receive data available interrupt offset */
+#define Z146_RX_CHAR_TIMEOUT_IRQ	4			/**< Receive character timeout offset */
+
+/*-----------------------------------------+
+|  16Z246 transmitter                      |
++-----------------------------------------*/
+#define Z246_TX_IIR_OFFSET		0x400		/**< Offset of the TX_IIR register */
+#define Z246_TX_TXC_OFFSET		0x403		/**< Offset of the TX_TXC register */
+#define Z246_TX_TXA_OFFSET	    0x404		/**< Offset of the TX_TXA register */
+#define Z246_TX_IER_OFFSET	    0x408		/**< Offset of the TX_IER register */
+#define Z246_TX_IER_DEFAULT	    0x0         /**< Offset of the TX_LA register */
+#define Z246_TX_IRQ_MASK    	0x1			/**< Transmit IRQ mask. */
+
+#define Z246_TX_LCR_OFFSET		0x409		/**< Offset of the TX_LCR register */
+#define Z246_TX_SPEED_OFFSET	0			/**< Offset of the TX_LCR SPEED bit */
+#define Z246_TX_SPEED_MASK  	0x01		/**< MASK of the TX_LCR SPEED bit */
+#define Z246_TX_LOOP_OFFSET		1			/**< Offset of the TX_LCR LOOP bit */
+#define Z246_TX_LOOP_MASK  		0x02		/**< MASK of the TX_LCR LOOP bit */
+#define Z246_TX_PAR_EN_OFFSET	2			/**< Offset of the TX_LCR PAR_EN bit */
+#define Z246_TX_PAR_EN_MASK  	0x04		/**< MASK of the TX_LCR PAR_EN bit */
+#define Z246_TX_PAR_TYP_OFFSET	3			/**< Offset of the TX_LCR PAR_TYP bit */
+#define Z246_TX_PAR_TYP_MASK  	0x08		/**< MASK of the TX_LCR PAR_TYP bit */
+#define Z246_TX_SDI_EN_OFFSET	5			/**< Offset of the TX_LCR SDI_EN bit */
+#define Z246_TX_SDI_EN_MASK  	0x20		/**< MASK of the TX_LCR SDI_EN bit */
+#define Z246_TX_SDI_OFFSET	    6			/**< Offset of the TX_LCR SDI_EN bit */
+#define Z246_TX_SDI_MASK    	0xC0		/**< MASK of the TX_LCR SDI bit */
+#define Z146_TX_SDI_MAX    	    0x03		/**< TX_LCR SDI max value */
+
+#define Z246_LCR_PAR_MASK		0x04
+#define Z246_LCR_SDI_MASK		0x20
+
+#define Z246_TX_LCR_DEFAULT		0x05		/**< Offset of the TX_LCR register */
+
+#define Z246_TX_FCR_OFFSET		0x40A		/**< Offset of the TX_FCR register */
+#define Z246_TX_FCR_DEFAULT 	0x6			/**< Default of the TX_FCR register */
+#define Z246_TX_FCR_MASK    	0x7			/**< Mask of the TX_FCR register */
+
+#define Z246_TX_LA_OFFSET		0x40B		/**< Default of the TX_IER register */
+#define Z246_TX_LA_DEFAULT		0x0			/**< Default of the TX_LA register */
+
+#define Z246_FIFO_START_ADDR    0x000		/**< Start address of the hardware FIFO of the transmitter. */
+#define Z246_TX_FIFO_MAX 		255			/**< Size of the hardware FIFO of the transmitter. */
+
+/* data bits per FIFO word, depending on TX_LCR PAR_EN and SDI_EN */
+#define Z246_24_BIT_MASK			0xFFFFFF
+#define Z246_23_BIT_MASK			0x7FFFFF
+#define Z246_22_BIT_MASK			0x3FFFFF
+#define Z246_21_BIT_MASK			0x1FFFFF
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _Z146_REGS_H */
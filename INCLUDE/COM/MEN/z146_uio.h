@@ -0,0 +1,60 @@
+/***********************  I n c l u d e  -  F i l e  ***********************/
+/*!
+ *        \file  z146_uio.h
+ *
+ *       \brief  Polled user space access to the 16Z146 receiver and the
+ *               16Z246 transmitter over a mapped register window (Linux UIO)
+ *
+ *    \switches  (none)
+ */
+ /*-------------------------------[ History ]--------------------------------
+ *
+ *---------------------------------------------------------------------------
+ * (c) Copyright 2004 by MEN mikro elektronik GmbH, Nuernberg, Germany
+ ****************************************************************************/
+
+#ifndef _Z146_UIO_H
+#define _Z146_UIO_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define Z146_UIO_WIN_SIZE		0x800		/**< size of the register window of one core */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** register window of one 16Z146 or 16Z246 core */
+typedef struct {
+	volatile u_int8		*base;		/**< start of the register window */
+	void				*map;		/**< mapping, NULL if attached */
+	u_int32				mapSize;	/**< size of the mapping */
+	int					fd;			/**< UIO device, -1 if attached */
+	u_int32				txMask;		/**< TX data mask for the current TX_LCR */
+	u_int32				rxLsrErrors;	/**< RX line status errors seen */
+} Z146_UIO;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern int32 Z146_UioOpen(Z146_UIO *uio, const char *device, u_int32 size);
+extern void Z146_UioAttach(Z146_UIO *uio, void *base);
+extern void Z146_UioClose(Z146_UIO *uio);
+
+extern void Z146_UioRxInit(Z146_UIO *uio, u_int8 lcr, u_int8 fcr,
+						   const u_int8 *labels, u_int32 labNum);
+extern int32 Z146_UioRxPoll(Z146_UIO *uio, u_int32 *buf, u_int32 max);
+
+extern void Z146_UioTxInit(Z146_UIO *uio, u_int8 lcr, u_int8 label);
+extern u_int32 Z146_UioTxFree(Z146_UIO *uio);
+extern u_int32 Z146_UioTxWrite(Z146_UIO *uio, const u_int32 *buf, u_int32 num);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _Z146_UIO_H */
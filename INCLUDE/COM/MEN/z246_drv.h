@@ -34,6 +34,79 @@
       extern "C" {
 #endif
 
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/** TX statistics, see #Z246_BLK_TX_STATS
+ *
+ *  All counters are reset when the statistics are read.
+ */
+typedef struct {
+	u_int32 wordsAccepted;	/**< words accepted by M_setblock() */
+	u_int32 wordsWritten;	/**< words written to the FIFO (directWords + ringWords) */
+	u_int32 directWords;	/**< words written directly from the user buffer to the FIFO */
+	u_int32 ringWords;		/**< words written to the FIFO from the ring buffer */
+	u_int32 refillIrqs;		/**< FIFO refill interrupts */
+	u_int32 underruns;		/**< refills aborted with ERR_MBUF_UNDERRUN */
+	u_int32 overflows;		/**< M_setblock() calls rejected with ERR_MBUF_OVERFLOW */
+	u_int32 maxRingDepth;	/**< maximum number of words queued in the ring buffer */
+	u_int32 minFifoFree;	/**< minimum observed free FIFO space in words */
+	u_int32 idleGaps;		/**< refill interrupts serviced after the FIFO ran empty */
+	u_int32 minMarginUs;	/**< minimum refill margin: FIFO drain time at refill interrupt
+							     entry minus the time until the FIFO was written [us] */
+	u_int32 thrLevel;		/**< current TX_FCR threshold level (not reset) */
+	u_int32 urgentWords;	/**< urgent words written to the FIFO */
+	u_int32 urgMaxLatUs;	/**< maximum latency of an urgent word until its transmission [us] */
+	u_int32 throttledWords;	/**< words held back or rejected by the rate limits */
+	u_int32 busUtil;		/**< bus utilization at the configured speed [permille] */
+} Z246_TX_STATS;
+
+/** result of a timed burst, see #Z246_BLK_TX_TIMED_RES */
+typedef struct {
+	u_int32 releaseTick;	/**< requested release tick */
+	int32   errUs;			/**< release error [us], time from the requested tick until the
+							     first word of the burst is on the bus, measured at its
+							     fifo write plus the words ahead in the fifo */
+	u_int32 words;			/**< number of words in the burst */
+} Z246_TX_TIMED_RES;
+
+/** line configuration, see #Z246_BLK_LINE_CFG */
+typedef struct {
+	u_int32 speed;			/**< 0 = 12.5 kHz, 1 = 100 kHz */
+	u_int32 loop;			/**< loop back mode */
+	u_int32 parEn;			/**< parity enable */
+	u_int32 parTyp;			/**< parity type */
+	u_int32 sdiEn;			/**< source/destination identifier enable */
+	u_int32 sdi;			/**< source/destination identifier 0..3 */
+	u_int32 flush;			/**< S: 1 = discard queued data and wait until the FIFO is sent */
+} Z246_LINE_CFG;
+
+#define Z246_IRQLAT_BINS		16		/**< histogram bins of Z246_IRQLAT */
+
+/** interrupt instrumentation, see #Z246_BLK_IRQLAT
+ *
+ *  All values except resUs are reset when read. Histogram bin 0 counts
+ *  the value 0, bin n the values 2^(n-1)..2^n-1 and the last bin all
+ *  larger values. The threshold latency is computed from the FIFO level
+ *  at ISR entry and the word time, so its resolution is one word. The
+ *  threshold in words is the highest FIFO level seen at a threshold
+ *  interrupt at the current threshold level.
+ */
+typedef struct {
+	u_int32 irqs;			/**< interrupts handled */
+	u_int32 words;			/**< words handled */
+	u_int32 maxWords;		/**< max. words per interrupt */
+	u_int32 durMaxUs;		/**< max. ISR execution time [us] */
+	u_int32 durSumUs;		/**< sum of the ISR execution times [us] */
+	u_int32 latNum;			/**< interrupts with a threshold latency */
+	u_int32 latMaxUs;		/**< max. time from FIFO threshold to ISR entry [us] */
+	u_int32 latSumUs;		/**< sum of the threshold latencies [us] */
+	u_int32 resUs;			/**< resolution of the execution time [us] */
+	u_int32 durHist[Z246_IRQLAT_BINS];		/**< ISR execution time [us] */
+	u_int32 wordsHist[Z246_IRQLAT_BINS];	/**< words per interrupt */
+	u_int32 latHist[Z246_IRQLAT_BINS];		/**< time from FIFO threshold to ISR entry [us] */
+} Z246_IRQLAT;
+
 /*-----------------------------------------+
 |  DEFINES                                 |
 +-----------------------------------------*/
@@ -52,6 +125,24 @@
 #define Z246_SDI                 M_DEV_OF+0x09    /**< G,S: Get/Set TX_LCR TX source/destination identifier. */
 #define Z246_TX_THR_LEV          M_DEV_OF+0x0A    /**< G,S: Get/Set TX_FCR TX threshold level. */
 #define Z246_TX_LABEL            M_DEV_OF+0x0B    /**< G,S: Get/Set TX_LA TX label. */
+#define Z246_TX_THR_AUTO         M_DEV_OF+0x0C    /**< G,S: Get/Set automatic TX threshold level. */
+#define Z246_TX_LOW_RESERVE      M_DEV_OF+0x0D    /**< G,S: Get/Set FIFO words kept for bulk traffic per refill. */
+#define Z246_TX_TIMED_PEND       M_DEV_OF+0x0E    /**< G  : Get number of pending timed bursts. */
+#define Z246_TX_TICK             M_DEV_OF+0x0F    /**< G  : Get current tick of the timed transmission. */
+#define Z246_TX_TICK_RATE        M_DEV_OF+0x10    /**< G  : Get ticks per second of the timed transmission. */
+#define Z246_TX_RATE_LOW         M_DEV_OF+0x11    /**< G,S: Get/Set rate limit of bulk data [words/s], 0 = unlimited, shared by all writers. */
+#define Z246_TX_RATE_HIGH        M_DEV_OF+0x12    /**< G,S: Get/Set rate limit of urgent data [words/s], 0 = unlimited, shared by all writers. */
+#define Z246_TX_RATE_BURST       M_DEV_OF+0x13    /**< G,S: Get/Set burst size of the rate limits [words]. */
+#define Z246_TX_LEVEL            M_DEV_OF+0x14    /**< G  : Get words not yet sent: TX FIFO level plus queued words. */
+#define Z246_TX_RATE_WRITER      M_DEV_OF+0x15    /**< G,S: Get/Set rate limit of the writer channel of the path [words/s], 0 = unlimited. */
+
+/* Z246 specific Getstat/Setstat block codes */
+#define Z246_BLK_TX_STATS        M_DEV_BLK_OF+0x01 /**< G  : Get and reset TX statistics (Z246_TX_STATS). */
+#define Z246_BLK_TX_URGENT       M_DEV_BLK_OF+0x02 /**<   S: Transmit data words ahead of queued bulk data. */
+#define Z246_BLK_TX_TIMED        M_DEV_BLK_OF+0x03 /**<   S: Transmit data words at a tick: release tick, data words. */
+#define Z246_BLK_TX_TIMED_RES    M_DEV_BLK_OF+0x04 /**< G  : Get and remove timed burst results (Z246_TX_TIMED_RES). */
+#define Z246_BLK_LINE_CFG        M_DEV_BLK_OF+0x05 /**< G,S: Get/Set complete line configuration (Z246_LINE_CFG). */
+#define Z246_BLK_IRQLAT          M_DEV_BLK_OF+0x06 /**< G  : Get and reset interrupt instrumentation (Z246_IRQLAT). */
 
 /**@}*/
 